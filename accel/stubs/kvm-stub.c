@@ -115,7 +115,7 @@ int kvm_memcrypt_encrypt_data(uint8_t *ptr, uint64_t len)
 }
 
 #ifndef CONFIG_USER_ONLY
-int kvm_irqchip_add_msi_route(KVMState *s, int vector, PCIDevice *dev)
+int kvm_irqchip_add_msi_route(KVMRouteChange *c, int vector, PCIDevice *dev)
 {
     return -ENOSYS;
 }
@@ -138,6 +138,10 @@ void kvm_irqchip_commit_routes(KVMState *s)
 {
 }
 
+void kvm_irqchip_commit_route_changes(KVMRouteChange *c)
+{
+}
+
 void kvm_irqchip_add_change_notifier(Notifier *n)
 {
 }
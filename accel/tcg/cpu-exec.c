@@ -204,6 +204,7 @@ static void cpu_exec_nocache(CPUState *cpu, int max_cycles,
 {
     TranslationBlock *tb;
     uint32_t cflags = curr_cflags() | CF_NOCACHE;
+    void *gen_ptr;
 
     if (ignore_icount) {
         cflags &= ~CF_USE_ICOUNT;
@@ -217,6 +218,7 @@ static void cpu_exec_nocache(CPUState *cpu, int max_cycles,
     tb = tb_gen_code(cpu, orig_tb->pc, orig_tb->cs_base,
                      orig_tb->flags, cflags);
     tb->orig_tb = orig_tb;
+    gen_ptr = atomic_read(&tcg_ctx->code_gen_ptr);
     mmap_unlock();
 
     /* execute the generated code */
@@ -227,6 +229,7 @@ static void cpu_exec_nocache(CPUState *cpu, int max_cycles,
     tb_phys_invalidate(tb, -1);
     mmap_unlock();
     tcg_tb_remove(tb);
+    tb_nocache_reclaim(tb, gen_ptr);
 }
 #endif
 
@@ -240,6 +243,21 @@ void cpu_exec_step_atomic(CPUState *cpu)
     uint32_t cf_mask = cflags & CF_HASH_MASK;
 
     if (sigsetjmp(cpu->jmp_env, 0) == 0) {
+        /*
+         * Translate outside the exclusive region: codegen only depends on
+         * the cflags baked into the TB (not on parallel_cpus), and a storm
+         * of contended atomics then serializes the other vCPUs only for
+         * the single-insn execution, not for translation as well.  The TB
+         * may be invalidated before we get exclusive access, so it is
+         * looked up again below.
+         */
+        tb = tb_lookup__cpu_state(cpu, &pc, &cs_base, &flags, cf_mask);
+        if (tb == NULL) {
+            mmap_lock();
+            tb_gen_code(cpu, pc, cs_base, flags, cflags);
+            mmap_unlock();
+        }
+
         start_exclusive();
 
         tb = tb_lookup__cpu_state(cpu, &pc, &cs_base, &flags, cf_mask);
@@ -269,11 +287,18 @@ void cpu_exec_step_atomic(CPUState *cpu)
         }
         assert_no_pages_locked();
         qemu_plugin_disable_mem_helpers(cpu);
+        if (!cpu_in_exclusive_context(cpu)) {
+            /*
+             * The optimistic translation above ran out of code buffer
+             * and flushed; let the outer loop retry the atomic insn.
+             */
+            return;
+        }
     }
 
 
     /*
-     * As we start the exclusive region before codegen we must still
+     * As we start the exclusive region before execution we must still
      * be in the region if we longjump out of either the codegen or
      * the execution.
      */
@@ -360,6 +385,16 @@ static inline void tb_add_jump(TranslationBlock *tb, int n,
     uintptr_t old;
 
     assert(n < ARRAY_SIZE(tb->jmp_list_next));
+
+    /*
+     * Repeated transitions through an already-claimed slot (e.g. after an
+     * interrupt-forced exit) are common; don't touch tb_next's jmp_lock
+     * just to rediscover that there is nothing to do.
+     */
+    if (atomic_read(&tb->jmp_dest[n])) {
+        return;
+    }
+
     qemu_spin_lock(&tb_next->jmp_lock);
 
     /* make sure the destination TB is valid */
@@ -524,8 +559,17 @@ static inline bool cpu_handle_interrupt(CPUState *cpu,
      * cpu->interrupt_request and cpu->exit_request.
      * Ensure zeroing happens before reading cpu->exit_request or
      * cpu->interrupt_request (see also smp_wmb in cpu_exit())
+     *
+     * Skip the zeroing, and with it the full barrier, when the flag is
+     * already clear: this is the common case when we get here through a
+     * normal TB exit. Requesters store to interrupt_request/exit_request
+     * before raising the flag, so if we miss a store made after our
+     * reads below, the still-raised flag makes the next TB exit at once
+     * and we pick the request up on the following iteration.
      */
-    atomic_mb_set(&cpu_neg(cpu)->icount_decr.u16.high, 0);
+    if (atomic_read(&cpu_neg(cpu)->icount_decr.u16.high) != 0) {
+        atomic_mb_set(&cpu_neg(cpu)->icount_decr.u16.high, 0);
+    }
 
     if (unlikely(atomic_read(&cpu->interrupt_request))) {
         int interrupt_request;
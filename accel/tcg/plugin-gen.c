@@ -128,18 +128,34 @@ static void gen_empty_udata_cb(void)
 /*
  * For now we only support addi_i64.
  * When we support more ops, we can generate one empty inline cb for each.
+ *
+ * The target address is computed as @ptr + cpu_index * stride, so that
+ * per-vCPU callbacks can direct each vCPU at its own counter.  For
+ * callbacks on a single shared location the stride is patched to 0,
+ * which the optimizer folds back into a plain load/add/store of @ptr.
  */
 static void gen_empty_inline_cb(void)
 {
+    TCGv_i32 cpu_index = tcg_temp_new_i32();
+    TCGv_ptr cpu_index_as_ptr = tcg_temp_new_ptr();
     TCGv_i64 val = tcg_temp_new_i64();
-    TCGv_ptr ptr = tcg_const_ptr(NULL); /* overwritten later */
+    TCGv_ptr ptr;
 
+    tcg_gen_ld_i32(cpu_index, cpu_env,
+                   -offsetof(ArchCPU, env) + offsetof(CPUState, cpu_index));
+    /* pass an immediate that is not 0 or a power of 2; stride patched later */
+    tcg_gen_muli_i32(cpu_index, cpu_index, 0xdeadbeef);
+    tcg_gen_ext_i32_ptr(cpu_index_as_ptr, cpu_index);
+    ptr = tcg_const_ptr(NULL); /* overwritten later */
+    tcg_gen_add_ptr(ptr, ptr, cpu_index_as_ptr);
     tcg_gen_ld_i64(val, ptr, 0);
     /* pass an immediate != 0 so that it doesn't get optimized away */
     tcg_gen_addi_i64(val, val, 0xdeadface);
     tcg_gen_st_i64(val, ptr, 0);
     tcg_temp_free_ptr(ptr);
     tcg_temp_free_i64(val);
+    tcg_temp_free_ptr(cpu_index_as_ptr);
+    tcg_temp_free_i32(cpu_index);
 }
 
 static void gen_empty_mem_cb(TCGv addr, uint32_t info)
@@ -403,6 +419,39 @@ static TCGOp *copy_st_ptr(TCGOp **begin_op, TCGOp *op)
     return op;
 }
 
+static TCGOp *copy_muli_i32(TCGOp **begin_op, TCGOp *op, uint32_t v)
+{
+    /* tcg_gen_muli_i32() with a non-trivial constant is movi + mul */
+    op = copy_op(begin_op, op, INDEX_op_movi_i32);
+    op->args[1] = v;
+    op = copy_op(begin_op, op, INDEX_op_mul_i32);
+    return op;
+}
+
+static TCGOp *copy_ext_i32_ptr(TCGOp **begin_op, TCGOp *op)
+{
+    if (UINTPTR_MAX == UINT32_MAX) {
+        /* mov_i32 */
+        op = copy_op(begin_op, op, INDEX_op_mov_i32);
+    } else {
+        /* ext_i32_i64 */
+        op = copy_op(begin_op, op, INDEX_op_ext_i32_i64);
+    }
+    return op;
+}
+
+static TCGOp *copy_add_ptr(TCGOp **begin_op, TCGOp *op)
+{
+    if (UINTPTR_MAX == UINT32_MAX) {
+        /* add_i32 */
+        op = copy_op(begin_op, op, INDEX_op_add_i32);
+    } else {
+        /* add_i64 */
+        op = copy_op(begin_op, op, INDEX_op_add_i64);
+    }
+    return op;
+}
+
 static TCGOp *copy_call(TCGOp **begin_op, TCGOp *op, void *empty_func,
                         void *func, unsigned tcg_flags, int *cb_idx)
 {
@@ -461,9 +510,24 @@ static TCGOp *append_inline_cb(const struct qemu_plugin_dyn_cb *cb,
                                TCGOp *begin_op, TCGOp *op,
                                int *unused)
 {
+    /* a stride of 0 keeps every vCPU on the single shared counter */
+    uint32_t stride = cb->inline_insn.per_vcpu ? sizeof(uint64_t) : 0;
+
+    /* ld_i32 cpu_index */
+    op = copy_op(&begin_op, op, INDEX_op_ld_i32);
+
+    /* movi_i32 + mul_i32 */
+    op = copy_muli_i32(&begin_op, op, stride);
+
+    /* ext_i32_ptr */
+    op = copy_ext_i32_ptr(&begin_op, op);
+
     /* const_ptr */
     op = copy_const_ptr(&begin_op, op, cb->userp);
 
+    /* add_ptr */
+    op = copy_add_ptr(&begin_op, op);
+
     /* ld_i64 */
     op = copy_ld_i64(&begin_op, op);
 
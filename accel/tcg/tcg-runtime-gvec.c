@@ -398,14 +398,17 @@ void HELPER(gvec_neg64)(void *d, void *a, uint32_t desc)
     clear_high(d, oprsz, desc);
 }
 
+/* Branchless abs, valid for both the vector and base types: the sign
+   mask folds (aa ^ mm) - mm to -aa for negative lanes and aa otherwise.  */
 void HELPER(gvec_abs8)(void *d, void *a, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int8_t)) {
-        int8_t aa = *(int8_t *)(a + i);
-        *(int8_t *)(d + i) = aa < 0 ? -aa : aa;
+    for (i = 0; i < oprsz; i += sizeof(svec8)) {
+        svec8 aa = *(svec8 *)(a + i);
+        svec8 mm = aa >> 7;
+        *(svec8 *)(d + i) = (aa ^ mm) - mm;
     }
     clear_high(d, oprsz, desc);
 }
@@ -415,9 +418,10 @@ void HELPER(gvec_abs16)(void *d, void *a, uint32_t desc)
     intptr_t oprsz = simd_oprsz(desc);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int16_t)) {
-        int16_t aa = *(int16_t *)(a + i);
-        *(int16_t *)(d + i) = aa < 0 ? -aa : aa;
+    for (i = 0; i < oprsz; i += sizeof(svec16)) {
+        svec16 aa = *(svec16 *)(a + i);
+        svec16 mm = aa >> 15;
+        *(svec16 *)(d + i) = (aa ^ mm) - mm;
     }
     clear_high(d, oprsz, desc);
 }
@@ -427,9 +431,10 @@ void HELPER(gvec_abs32)(void *d, void *a, uint32_t desc)
     intptr_t oprsz = simd_oprsz(desc);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int32_t)) {
-        int32_t aa = *(int32_t *)(a + i);
-        *(int32_t *)(d + i) = aa < 0 ? -aa : aa;
+    for (i = 0; i < oprsz; i += sizeof(svec32)) {
+        svec32 aa = *(svec32 *)(a + i);
+        svec32 mm = aa >> 31;
+        *(svec32 *)(d + i) = (aa ^ mm) - mm;
     }
     clear_high(d, oprsz, desc);
 }
@@ -439,9 +444,10 @@ void HELPER(gvec_abs64)(void *d, void *a, uint32_t desc)
     intptr_t oprsz = simd_oprsz(desc);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int64_t)) {
-        int64_t aa = *(int64_t *)(a + i);
-        *(int64_t *)(d + i) = aa < 0 ? -aa : aa;
+    for (i = 0; i < oprsz; i += sizeof(svec64)) {
+        svec64 aa = *(svec64 *)(a + i);
+        svec64 mm = aa >> 63;
+        *(svec64 *)(d + i) = (aa ^ mm) - mm;
     }
     clear_high(d, oprsz, desc);
 }
@@ -773,14 +779,17 @@ void HELPER(gvec_sar64i)(void *d, void *a, uint32_t desc)
     clear_high(d, oprsz, desc);
 }
 
+/* The variable shifts use element-wise vector shift counts; the configure
+   probe for CONFIG_VECTOR16 checks that the compiler accepts these.  */
 void HELPER(gvec_shl8v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec8 msk = (vec8)DUP16(7);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint8_t)) {
-        uint8_t sh = *(uint8_t *)(b + i) & 7;
-        *(uint8_t *)(d + i) = *(uint8_t *)(a + i) << sh;
+    for (i = 0; i < oprsz; i += sizeof(vec8)) {
+        vec8 sh = *(vec8 *)(b + i) & msk;
+        *(vec8 *)(d + i) = *(vec8 *)(a + i) << sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -788,11 +797,12 @@ void HELPER(gvec_shl8v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shl16v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec16 msk = (vec16)DUP8(15);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint16_t)) {
-        uint8_t sh = *(uint16_t *)(b + i) & 15;
-        *(uint16_t *)(d + i) = *(uint16_t *)(a + i) << sh;
+    for (i = 0; i < oprsz; i += sizeof(vec16)) {
+        vec16 sh = *(vec16 *)(b + i) & msk;
+        *(vec16 *)(d + i) = *(vec16 *)(a + i) << sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -800,11 +810,12 @@ void HELPER(gvec_shl16v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shl32v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec32 msk = (vec32)DUP4(31);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint32_t)) {
-        uint8_t sh = *(uint32_t *)(b + i) & 31;
-        *(uint32_t *)(d + i) = *(uint32_t *)(a + i) << sh;
+    for (i = 0; i < oprsz; i += sizeof(vec32)) {
+        vec32 sh = *(vec32 *)(b + i) & msk;
+        *(vec32 *)(d + i) = *(vec32 *)(a + i) << sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -812,11 +823,12 @@ void HELPER(gvec_shl32v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shl64v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec64 msk = (vec64)DUP2(63);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint64_t)) {
-        uint8_t sh = *(uint64_t *)(b + i) & 63;
-        *(uint64_t *)(d + i) = *(uint64_t *)(a + i) << sh;
+    for (i = 0; i < oprsz; i += sizeof(vec64)) {
+        vec64 sh = *(vec64 *)(b + i) & msk;
+        *(vec64 *)(d + i) = *(vec64 *)(a + i) << sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -824,11 +836,12 @@ void HELPER(gvec_shl64v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shr8v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec8 msk = (vec8)DUP16(7);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint8_t)) {
-        uint8_t sh = *(uint8_t *)(b + i) & 7;
-        *(uint8_t *)(d + i) = *(uint8_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(vec8)) {
+        vec8 sh = *(vec8 *)(b + i) & msk;
+        *(vec8 *)(d + i) = *(vec8 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -836,11 +849,12 @@ void HELPER(gvec_shr8v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shr16v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec16 msk = (vec16)DUP8(15);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint16_t)) {
-        uint8_t sh = *(uint16_t *)(b + i) & 15;
-        *(uint16_t *)(d + i) = *(uint16_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(vec16)) {
+        vec16 sh = *(vec16 *)(b + i) & msk;
+        *(vec16 *)(d + i) = *(vec16 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -848,11 +862,12 @@ void HELPER(gvec_shr16v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shr32v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec32 msk = (vec32)DUP4(31);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint32_t)) {
-        uint8_t sh = *(uint32_t *)(b + i) & 31;
-        *(uint32_t *)(d + i) = *(uint32_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(vec32)) {
+        vec32 sh = *(vec32 *)(b + i) & msk;
+        *(vec32 *)(d + i) = *(vec32 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -860,11 +875,12 @@ void HELPER(gvec_shr32v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_shr64v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    vec64 msk = (vec64)DUP2(63);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(uint64_t)) {
-        uint8_t sh = *(uint64_t *)(b + i) & 63;
-        *(uint64_t *)(d + i) = *(uint64_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(vec64)) {
+        vec64 sh = *(vec64 *)(b + i) & msk;
+        *(vec64 *)(d + i) = *(vec64 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -872,11 +888,12 @@ void HELPER(gvec_shr64v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_sar8v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    svec8 msk = (svec8)DUP16(7);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int8_t)) {
-        uint8_t sh = *(uint8_t *)(b + i) & 7;
-        *(int8_t *)(d + i) = *(int8_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(svec8)) {
+        svec8 sh = *(svec8 *)(b + i) & msk;
+        *(svec8 *)(d + i) = *(svec8 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -884,11 +901,12 @@ void HELPER(gvec_sar8v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_sar16v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    svec16 msk = (svec16)DUP8(15);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int16_t)) {
-        uint8_t sh = *(uint16_t *)(b + i) & 15;
-        *(int16_t *)(d + i) = *(int16_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(svec16)) {
+        svec16 sh = *(svec16 *)(b + i) & msk;
+        *(svec16 *)(d + i) = *(svec16 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -896,11 +914,12 @@ void HELPER(gvec_sar16v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_sar32v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    svec32 msk = (svec32)DUP4(31);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int32_t)) {
-        uint8_t sh = *(uint32_t *)(b + i) & 31;
-        *(int32_t *)(d + i) = *(int32_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(svec32)) {
+        svec32 sh = *(svec32 *)(b + i) & msk;
+        *(svec32 *)(d + i) = *(svec32 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
@@ -908,11 +927,12 @@ void HELPER(gvec_sar32v)(void *d, void *a, void *b, uint32_t desc)
 void HELPER(gvec_sar64v)(void *d, void *a, void *b, uint32_t desc)
 {
     intptr_t oprsz = simd_oprsz(desc);
+    svec64 msk = (svec64)DUP2(63);
     intptr_t i;
 
-    for (i = 0; i < oprsz; i += sizeof(int64_t)) {
-        uint8_t sh = *(uint64_t *)(b + i) & 63;
-        *(int64_t *)(d + i) = *(int64_t *)(a + i) >> sh;
+    for (i = 0; i < oprsz; i += sizeof(svec64)) {
+        svec64 sh = *(svec64 *)(b + i) & msk;
+        *(svec64 *)(d + i) = *(svec64 *)(a + i) >> sh;
     }
     clear_high(d, oprsz, desc);
 }
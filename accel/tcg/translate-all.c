@@ -58,6 +58,10 @@
 #include "exec/log.h"
 #include "sysemu/cpus.h"
 #include "sysemu/tcg.h"
+#ifndef CONFIG_USER_ONLY
+#include "qapi/error.h"
+#include "qapi/qapi-commands-machine.h"
+#endif
 
 /* #define DEBUG_TB_INVALIDATE */
 /* #define DEBUG_TB_FLUSH */
@@ -487,12 +491,27 @@ static void page_init(void)
 #endif
 }
 
+/*
+ * The l1_map radix tree is only ever extended, never pruned: interior
+ * nodes and PageDesc leaves are installed with cmpxchg and stay valid
+ * for the lifetime of the process.  A leaf pointer may therefore be
+ * cached indefinitely once observed.  Keep the last leaf per thread,
+ * since translation, SMC checks and range operations tend to touch
+ * runs of neighbouring pages.
+ */
+static __thread tb_page_addr_t page_leaf_cache_index = -1;
+static __thread PageDesc *page_leaf_cache;
+
 static PageDesc *page_find_alloc(tb_page_addr_t index, int alloc)
 {
     PageDesc *pd;
     void **lp;
     int i;
 
+    if (index >> V_L2_BITS == page_leaf_cache_index) {
+        return page_leaf_cache + (index & (V_L2_SIZE - 1));
+    }
+
     /* Level 1.  Always allocated.  */
     lp = l1_map + ((index >> v_l1_shift) & (v_l1_size - 1));
 
@@ -541,6 +560,9 @@ static PageDesc *page_find_alloc(tb_page_addr_t index, int alloc)
         }
     }
 
+    page_leaf_cache_index = index >> V_L2_BITS;
+    page_leaf_cache = pd;
+
     return pd + (index & (V_L2_SIZE - 1));
 }
 
@@ -1146,8 +1168,17 @@ static bool tb_cmp(const void *ap, const void *bp)
 static void tb_htable_init(void)
 {
     unsigned int mode = QHT_MODE_AUTO_RESIZE;
+    size_t nb_tbs_est;
 
-    qht_init(&tb_ctx.htable, tb_cmp, CODE_GEN_HTABLE_SIZE, mode);
+    /*
+     * Size the hash table for the number of TBs the code buffer can
+     * plausibly hold, so that short-lived guests do not pay for a series
+     * of auto-resizes while the table warms up.  The estimate errs low
+     * for user-mode; auto-resize still handles outliers.
+     */
+    nb_tbs_est = tcg_ctx->code_gen_buffer_size / CODE_GEN_AVG_BLOCK_SIZE;
+    qht_init(&tb_ctx.htable, tb_cmp,
+             MAX(nb_tbs_est, CODE_GEN_HTABLE_SIZE), mode);
 }
 
 /* Must be called before using the QEMU cpus. 'tb_size' is the size
@@ -1158,8 +1189,8 @@ void tcg_exec_init(unsigned long tb_size)
     tcg_allowed = true;
     cpu_gen_init();
     page_init();
-    tb_htable_init();
     code_gen_alloc(tb_size);
+    tb_htable_init();
 #if defined(CONFIG_SOFTMMU)
     /* There's no guest base to take into account, so go ahead and
        initialize the prologue now.  */
@@ -1249,7 +1280,8 @@ static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
         cpu_tb_jmp_cache_clear(cpu);
     }
 
-    qht_reset_size(&tb_ctx.htable, CODE_GEN_HTABLE_SIZE);
+    /* Keep the bucket count the workload grew into across flushes.  */
+    qht_reset(&tb_ctx.htable);
     page_flush_tb();
 
     tcg_region_reset_all();
@@ -1887,6 +1919,26 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     return tb;
 }
 
+/*
+ * Reclaim the code generated for a CF_NOCACHE TB that has been executed
+ * and invalidated.  @gen_ptr must be the context's code_gen_ptr sampled
+ * right after tb_gen_code() returned @tb, in the same thread.  If nothing
+ * else has been translated since, rewind the allocation so that one-shot
+ * TBs do not accumulate as dead space and bring the next full tb_flush
+ * forward.
+ */
+void tb_nocache_reclaim(TranslationBlock *tb, void *gen_ptr)
+{
+    uintptr_t orig_aligned = (uintptr_t)tb->tc.ptr;
+
+    assert(tb->cflags & CF_NOCACHE);
+    if (atomic_read(&tcg_ctx->code_gen_ptr) != gen_ptr) {
+        return;
+    }
+    orig_aligned -= ROUND_UP(sizeof(*tb), qemu_icache_linesize);
+    atomic_set(&tcg_ctx->code_gen_ptr, (void *)orig_aligned);
+}
+
 /*
  * @p must be non-NULL.
  * user-mode: call with mmap_lock held.
@@ -2377,6 +2429,31 @@ void dump_exec_info(void)
     tcg_dump_info();
 }
 
+#ifndef CONFIG_USER_ONLY
+JitStats *qmp_x_query_jit_stats(Error **errp)
+{
+    struct tb_tree_stats tst = {};
+    JitStats *stats;
+
+    if (!tcg_enabled()) {
+        error_setg(errp, "JIT information is only available with accel=tcg");
+        return NULL;
+    }
+
+    tcg_tb_foreach(tb_tree_stats_iter, &tst);
+
+    stats = g_new0(JitStats, 1);
+    stats->code_size = tcg_code_size();
+    stats->code_capacity = tcg_code_capacity();
+    stats->tb_count = tst.nb_tbs;
+    stats->tb_host_size = tst.host_size;
+    stats->tb_target_size = tst.target_size;
+    stats->flush_count = atomic_read(&tb_ctx.tb_flush_count);
+    stats->invalidate_count = tcg_tb_phys_invalidate_count();
+    return stats;
+}
+#endif
+
 void dump_opcount_info(void)
 {
     tcg_dump_op_count();
@@ -2537,19 +2614,30 @@ void page_set_flags(target_ulong start, target_ulong end, int flags)
         flags |= PAGE_WRITE_ORG;
     }
 
-    for (addr = start, len = end - start;
-         len != 0;
-         len -= TARGET_PAGE_SIZE, addr += TARGET_PAGE_SIZE) {
+    for (addr = start, len = end - start; len != 0; ) {
         PageDesc *p = page_find_alloc(addr >> TARGET_PAGE_BITS, 1);
+        target_ulong leaf_left = V_L2_SIZE -
+            ((addr >> TARGET_PAGE_BITS) & (V_L2_SIZE - 1));
+        target_ulong n = MIN(leaf_left, len >> TARGET_PAGE_BITS);
+        target_ulong i;
 
-        /* If the write protection bit is set, then we invalidate
-           the code inside.  */
-        if (!(p->flags & PAGE_WRITE) &&
-            (flags & PAGE_WRITE) &&
-            p->first_tb) {
-            tb_invalidate_phys_page(addr, 0);
+        /*
+         * Descriptors within one leaf of the radix tree are contiguous,
+         * so walk the tree once per leaf instead of once per page.  This
+         * matters for large mappings, e.g. when loading big static
+         * binaries in user mode.
+         */
+        for (i = 0; i < n; i++, p++, addr += TARGET_PAGE_SIZE) {
+            /* If the write protection bit is set, then we invalidate
+               the code inside.  */
+            if (!(p->flags & PAGE_WRITE) &&
+                (flags & PAGE_WRITE) &&
+                p->first_tb) {
+                tb_invalidate_phys_page(addr, 0);
+            }
+            p->flags = flags;
         }
-        p->flags = flags;
+        len -= n * TARGET_PAGE_SIZE;
     }
 }
 
@@ -2578,32 +2666,44 @@ int page_check_range(target_ulong start, target_ulong len, int flags)
     end = TARGET_PAGE_ALIGN(start + len);
     start = start & TARGET_PAGE_MASK;
 
-    for (addr = start, len = end - start;
-         len != 0;
-         len -= TARGET_PAGE_SIZE, addr += TARGET_PAGE_SIZE) {
+    for (addr = start, len = end - start; len != 0; ) {
+        target_ulong leaf_left = V_L2_SIZE -
+            ((addr >> TARGET_PAGE_BITS) & (V_L2_SIZE - 1));
+        target_ulong n = MIN(leaf_left, len >> TARGET_PAGE_BITS);
+        target_ulong i;
+
+        /*
+         * As in page_set_flags(), walk the radix tree once per leaf and
+         * then sweep the contiguous descriptors.  access_ok() funnels
+         * every guest buffer a syscall touches through here, so large
+         * read/write buffers hit this loop with many pages at a time.
+         */
         p = page_find(addr >> TARGET_PAGE_BITS);
         if (!p) {
             return -1;
         }
-        if (!(p->flags & PAGE_VALID)) {
-            return -1;
-        }
+        for (i = 0; i < n; i++, p++, addr += TARGET_PAGE_SIZE) {
+            if (!(p->flags & PAGE_VALID)) {
+                return -1;
+            }
 
-        if ((flags & PAGE_READ) && !(p->flags & PAGE_READ)) {
-            return -1;
-        }
-        if (flags & PAGE_WRITE) {
-            if (!(p->flags & PAGE_WRITE_ORG)) {
+            if ((flags & PAGE_READ) && !(p->flags & PAGE_READ)) {
                 return -1;
             }
-            /* unprotect the page if it was put read-only because it
-               contains translated code */
-            if (!(p->flags & PAGE_WRITE)) {
-                if (!page_unprotect(addr, 0)) {
+            if (flags & PAGE_WRITE) {
+                if (!(p->flags & PAGE_WRITE_ORG)) {
                     return -1;
                 }
+                /* unprotect the page if it was put read-only because it
+                   contains translated code */
+                if (!(p->flags & PAGE_WRITE)) {
+                    if (!page_unprotect(addr, 0)) {
+                        return -1;
+                    }
+                }
             }
         }
+        len -= n * TARGET_PAGE_SIZE;
     }
     return 0;
 }
@@ -456,6 +456,18 @@ void mixeng_volume (struct st_sample *buf, int len, struct mixeng_volume *vol)
         return;
     }
 
+    /* Nominal volume is by far the common case; skip the sweep over the
+       buffer rather than multiplying every frame by one. */
+#ifdef FLOAT_MIXENG
+    if (vol->l == 1.0 && vol->r == 1.0) {
+        return;
+    }
+#else
+    if (vol->l == 1ULL << 32 && vol->r == 1ULL << 32) {
+        return;
+    }
+#endif
+
     while (len--) {
 #ifdef FLOAT_MIXENG
         buf->l = buf->l * vol->l;
@@ -23,6 +23,8 @@
 
 #ifdef CONFIG_NUMA
 #include <numaif.h>
+#include <numa.h>
+#include <sched.h>
 QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_DEFAULT != MPOL_DEFAULT);
 QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_PREFERRED != MPOL_PREFERRED);
 QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_BIND != MPOL_BIND);
@@ -328,6 +330,54 @@ size_t host_memory_backend_pagesize(HostMemoryBackend *memdev)
 }
 #endif
 
+#ifdef CONFIG_NUMA
+/*
+ * The threads spawned by os_mem_prealloc() inherit the CPU affinity of
+ * the thread that creates them.  Restrict ourselves to the CPUs of the
+ * backend's host nodes for the duration of the preallocation, so that
+ * the faulting and zeroing of the pages runs on the node that will hold
+ * them instead of wherever the monitor thread happens to be scheduled.
+ * Returns true iff the affinity was changed and *saved must be restored.
+ */
+static bool host_memory_backend_bind_prealloc(HostMemoryBackend *backend,
+                                              cpu_set_t *saved)
+{
+    cpu_set_t set;
+    unsigned long node;
+    bool found = false;
+
+    if (backend->policy != MPOL_BIND || numa_available() < 0) {
+        return false;
+    }
+
+    CPU_ZERO(&set);
+    for (node = find_first_bit(backend->host_nodes, MAX_NODES);
+         node < MAX_NODES;
+         node = find_next_bit(backend->host_nodes, MAX_NODES, node + 1)) {
+        struct bitmask *cpus = numa_allocate_cpumask();
+        unsigned int i;
+
+        if (numa_node_to_cpus(node, cpus) == 0) {
+            for (i = 0; i < cpus->size; i++) {
+                if (numa_bitmask_isbitset(cpus, i)) {
+                    CPU_SET(i, &set);
+                    found = true;
+                }
+            }
+        }
+        numa_free_cpumask(cpus);
+    }
+
+    /* Affinity is only an optimization; any failure just leaves it alone. */
+    if (!found ||
+        sched_getaffinity(0, sizeof(*saved), saved) ||
+        sched_setaffinity(0, sizeof(set), &set)) {
+        return false;
+    }
+    return true;
+}
+#endif
+
 static void
 host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
 {
@@ -396,8 +446,18 @@ host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
          * specified NUMA policy in place.
          */
         if (backend->prealloc) {
+#ifdef CONFIG_NUMA
+            cpu_set_t saved_set;
+            bool rebind = host_memory_backend_bind_prealloc(backend,
+                                                            &saved_set);
+#endif
             os_mem_prealloc(memory_region_get_fd(&backend->mr), ptr, sz,
                             backend->prealloc_threads, &local_err);
+#ifdef CONFIG_NUMA
+            if (rebind) {
+                sched_setaffinity(0, sizeof(saved_set), &saved_set);
+            }
+#endif
             if (local_err) {
                 goto out;
             }
@@ -2050,6 +2050,21 @@ static int bdrv_check_perm(BlockDriverState *bs, BlockReopenQueue *q,
         bdrv_child_perm(bs, c->bs, c, c->role, q,
                         cumulative_perms, cumulative_shared_perms,
                         &cur_perm, &cur_shared);
+
+        /*
+         * If this edge keeps exactly the permissions it already has, the
+         * child's cumulative permissions cannot change and neither can
+         * anything below it, so the subtree does not need to be visited
+         * again.  This keeps permission updates O(changed) rather than
+         * O(graph); without it every blockdev-add walks the whole chain.
+         * A reopen queue still forces the full walk because deeper nodes
+         * may change between read-only and read-write even when the edge
+         * permissions are identical.
+         */
+        if (!q && cur_perm == c->perm && cur_shared == c->shared_perm) {
+            continue;
+        }
+
         ret = bdrv_child_check_perm(c, q, cur_perm, cur_shared, ignore_children,
                                     tighten_restrictions ? &child_tighten_restr
                                                          : NULL,
@@ -2086,6 +2101,14 @@ static void bdrv_abort_perm_update(BlockDriverState *bs)
     }
 
     QLIST_FOREACH(c, &bs->children, next) {
+        /*
+         * Edges that the preceding bdrv_check_perm() never visited (it
+         * skips subtrees whose permissions do not change) have nothing
+         * to roll back.
+         */
+        if (!c->has_backup_perm) {
+            continue;
+        }
         bdrv_child_abort_perm_update(c);
     }
 }
@@ -2117,6 +2140,18 @@ static void bdrv_set_perm(BlockDriverState *bs, uint64_t cumulative_perms,
         bdrv_child_perm(bs, c->bs, c, c->role, NULL,
                         cumulative_perms, cumulative_shared_perms,
                         &cur_perm, &cur_shared);
+
+        /*
+         * Skip subtrees that bdrv_check_perm() did not visit: their
+         * edge permissions are unchanged, so re-notifying the drivers
+         * below with identical cumulative permissions would be a no-op
+         * walk of the rest of the graph.
+         */
+        if (!c->has_backup_perm && cur_perm == c->perm &&
+            cur_shared == c->shared_perm) {
+            continue;
+        }
+
         bdrv_child_set_perm(c, cur_perm, cur_shared);
     }
 }
@@ -32,6 +32,13 @@
 static QEMUClockType clock_type = QEMU_CLOCK_REALTIME;
 static const int qtest_latency_ns = NANOSECONDS_PER_SECOND / 1000;
 
+/* Accounting only ever runs on behalf of guest device frontends, so these
+ * globals track guest-visible I/O activity across all devices.  They are
+ * updated with atomics since devices may run in different AioContexts.
+ */
+static int64_t last_guest_io_ns;
+static int guest_io_in_flight;
+
 void block_acct_init(BlockAcctStats *stats)
 {
     qemu_mutex_init(&stats->lock);
@@ -92,6 +99,11 @@ void block_acct_start(BlockAcctStats *stats, BlockAcctCookie *cookie,
     cookie->bytes = bytes;
     cookie->start_time_ns = qemu_clock_get_ns(clock_type);
     cookie->type = type;
+
+    if (type != BLOCK_ACCT_NONE) {
+        atomic_set_i64(&last_guest_io_ns, cookie->start_time_ns);
+        atomic_inc(&guest_io_in_flight);
+    }
 }
 
 /* block_latency_histogram_compare_func:
@@ -155,6 +167,8 @@ int block_latency_histogram_set(BlockAcctStats *stats, enum BlockAcctType type,
         prev = entry->value;
     }
 
+    qemu_mutex_lock(&stats->lock);
+
     hist->nbins = new_nbins;
     g_free(hist->boundaries);
     hist->boundaries = g_new(uint64_t, hist->nbins - 1);
@@ -167,6 +181,8 @@ int block_latency_histogram_set(BlockAcctStats *stats, enum BlockAcctType type,
     g_free(hist->bins);
     hist->bins = g_new0(uint64_t, hist->nbins);
 
+    qemu_mutex_unlock(&stats->lock);
+
     return 0;
 }
 
@@ -174,12 +190,14 @@ void block_latency_histograms_clear(BlockAcctStats *stats)
 {
     int i;
 
+    qemu_mutex_lock(&stats->lock);
     for (i = 0; i < BLOCK_MAX_IOTYPE; i++) {
         BlockLatencyHistogram *hist = &stats->latency_histogram[i];
         g_free(hist->bins);
         g_free(hist->boundaries);
         memset(hist, 0, sizeof(*hist));
     }
+    qemu_mutex_unlock(&stats->lock);
 }
 
 static void block_account_one_io(BlockAcctStats *stats, BlockAcctCookie *cookie,
@@ -199,28 +217,38 @@ static void block_account_one_io(BlockAcctStats *stats, BlockAcctCookie *cookie,
         return;
     }
 
-    qemu_mutex_lock(&stats->lock);
+    atomic_set_i64(&last_guest_io_ns, time_ns);
+    atomic_dec(&guest_io_in_flight);
 
     if (failed) {
-        stats->failed_ops[cookie->type]++;
+        stat64_add(&stats->failed_ops[cookie->type], 1);
     } else {
-        stats->nr_bytes[cookie->type] += cookie->bytes;
-        stats->nr_ops[cookie->type]++;
+        stat64_add(&stats->nr_bytes[cookie->type], cookie->bytes);
+        stat64_add(&stats->nr_ops[cookie->type], 1);
     }
 
-    block_latency_histogram_account(&stats->latency_histogram[cookie->type],
-                                    latency_ns);
-
     if (!failed || stats->account_failed) {
-        stats->total_time_ns[cookie->type] += latency_ns;
-        stats->last_access_time_ns = time_ns;
+        stat64_add(&stats->total_time_ns[cookie->type], latency_ns);
+        /* Timestamps grow monotonically, so the largest is the latest */
+        stat64_max(&stats->last_access_time_ns, time_ns);
+    }
 
-        QSLIST_FOREACH(s, &stats->intervals, entries) {
-            timed_average_account(&s->latency[cookie->type], latency_ns);
+    /* Only the interval averages and histogram bins need the lock */
+    if (stats->latency_histogram[cookie->type].bins ||
+        !QSLIST_EMPTY(&stats->intervals)) {
+        qemu_mutex_lock(&stats->lock);
+
+        block_latency_histogram_account(
+            &stats->latency_histogram[cookie->type], latency_ns);
+
+        if (!failed || stats->account_failed) {
+            QSLIST_FOREACH(s, &stats->intervals, entries) {
+                timed_average_account(&s->latency[cookie->type], latency_ns);
+            }
         }
-    }
 
-    qemu_mutex_unlock(&stats->lock);
+        qemu_mutex_unlock(&stats->lock);
+    }
 
     cookie->type = BLOCK_ACCT_NONE;
 }
@@ -243,13 +271,12 @@ void block_acct_invalid(BlockAcctStats *stats, enum BlockAcctType type)
      * not.  The reason is that invalid requests are accounted during their
      * submission, therefore there's no actual I/O involved.
      */
-    qemu_mutex_lock(&stats->lock);
-    stats->invalid_ops[type]++;
+    stat64_add(&stats->invalid_ops[type], 1);
 
     if (stats->account_invalid) {
-        stats->last_access_time_ns = qemu_clock_get_ns(clock_type);
+        stat64_max(&stats->last_access_time_ns,
+                   qemu_clock_get_ns(clock_type));
     }
-    qemu_mutex_unlock(&stats->lock);
 }
 
 void block_acct_merge_done(BlockAcctStats *stats, enum BlockAcctType type,
@@ -257,14 +284,21 @@ void block_acct_merge_done(BlockAcctStats *stats, enum BlockAcctType type,
 {
     assert(type < BLOCK_MAX_IOTYPE);
 
-    qemu_mutex_lock(&stats->lock);
-    stats->merged[type] += num_requests;
-    qemu_mutex_unlock(&stats->lock);
+    stat64_add(&stats->merged[type], num_requests);
 }
 
 int64_t block_acct_idle_time_ns(BlockAcctStats *stats)
 {
-    return qemu_clock_get_ns(clock_type) - stats->last_access_time_ns;
+    return qemu_clock_get_ns(clock_type) -
+           stat64_get(&stats->last_access_time_ns);
+}
+
+int64_t block_acct_guest_idle_ns(void)
+{
+    if (atomic_read(&guest_io_in_flight) > 0) {
+        return 0;
+    }
+    return qemu_clock_get_ns(clock_type) - atomic_read_i64(&last_guest_io_ns);
 }
 
 double block_acct_queue_depth(BlockAcctTimedStats *stats,
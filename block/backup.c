@@ -31,6 +31,12 @@
 #include "block/backup-top.h"
 
 #define BACKUP_CLUSTER_SIZE_DEFAULT (1 << 16)
+/*
+ * Largest chunk handed to block_copy() in one go.  Keeps cancellation and
+ * rate limiting responsive while still letting contiguous dirty extents be
+ * copied with few calls.
+ */
+#define BACKUP_MAX_EXTENT (1 << 20)
 
 typedef struct BackupBlockJob {
     BlockJob common;
@@ -187,27 +193,37 @@ static bool coroutine_fn yield_and_check(BackupBlockJob *job)
 static int coroutine_fn backup_loop(BackupBlockJob *job)
 {
     bool error_is_read;
-    int64_t offset;
-    BdrvDirtyBitmapIter *bdbi;
+    uint64_t offset = 0;
+    uint64_t bytes;
+    uint64_t max_extent = MAX(job->cluster_size, BACKUP_MAX_EXTENT);
+    BdrvDirtyBitmap *bcs_bitmap = block_copy_dirty_bitmap(job->bcs);
     int ret = 0;
 
-    bdbi = bdrv_dirty_iter_new(block_copy_dirty_bitmap(job->bcs));
-    while ((offset = bdrv_dirty_iter_next(bdbi)) != -1) {
+    /*
+     * Ask the bitmap for maximal dirty extents instead of iterating
+     * cluster by cluster: contiguous dirty ranges are then copied with
+     * one block_copy() call per max_extent instead of one per cluster.
+     */
+    for (; offset < job->len; offset += bytes) {
+        bytes = job->len - offset;
+        if (!bdrv_dirty_bitmap_next_dirty_area(bcs_bitmap, &offset, &bytes)) {
+            break;
+        }
+        bytes = MIN(bytes, max_extent);
+
         do {
             if (yield_and_check(job)) {
-                goto out;
+                return ret;
             }
-            ret = backup_do_cow(job, offset, job->cluster_size, &error_is_read);
+            ret = backup_do_cow(job, offset, bytes, &error_is_read);
             if (ret < 0 && backup_error_action(job, error_is_read, -ret) ==
                            BLOCK_ERROR_ACTION_REPORT)
             {
-                goto out;
+                return ret;
             }
         } while (ret < 0);
     }
 
- out:
-    bdrv_dirty_iter_free(bdbi);
     return ret;
 }
 
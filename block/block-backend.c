@@ -82,7 +82,10 @@ struct BlockBackend {
     NotifierList remove_bs_notifiers, insert_bs_notifiers;
     QLIST_HEAD(, BlockBackendAioNotifier) aio_notifiers;
 
-    int quiesce_counter;
+    int quiesce_counter; /* atomic: written under BQL, read by other threads */
+
+    /* Protects queued_requests */
+    QemuMutex queued_requests_lock;
     CoQueue queued_requests;
     bool disable_request_queuing;
 
@@ -346,6 +349,7 @@ BlockBackend *blk_new(AioContext *ctx, uint64_t perm, uint64_t shared_perm)
 
     block_acct_init(&blk->stats);
 
+    qemu_mutex_init(&blk->queued_requests_lock);
     qemu_co_queue_init(&blk->queued_requests);
     notifier_list_init(&blk->remove_bs_notifiers);
     notifier_list_init(&blk->insert_bs_notifiers);
@@ -429,6 +433,7 @@ static void blk_delete(BlockBackend *blk)
     assert(QLIST_EMPTY(&blk->insert_bs_notifiers.notifiers));
     assert(QLIST_EMPTY(&blk->aio_notifiers));
     QTAILQ_REMOVE(&block_backends, blk, link);
+    qemu_mutex_destroy(&blk->queued_requests_lock);
     drive_info_del(blk->legacy_dinfo);
     block_acct_cleanup(&blk->stats);
     g_free(blk);
@@ -946,7 +951,7 @@ void blk_set_dev_ops(BlockBackend *blk, const BlockDevOps *ops,
     blk->dev_opaque = opaque;
 
     /* Are we currently quiesced? Should we enforce this right now? */
-    if (blk->quiesce_counter && ops->drained_begin) {
+    if (atomic_read(&blk->quiesce_counter) && ops->drained_begin) {
         ops->drained_begin(opaque);
     }
 }
@@ -1142,8 +1147,19 @@ static int blk_check_byte_request(BlockBackend *blk, int64_t offset,
 
 static void coroutine_fn blk_wait_while_drained(BlockBackend *blk)
 {
-    if (blk->quiesce_counter && !blk->disable_request_queuing) {
-        qemu_co_queue_wait(&blk->queued_requests, NULL);
+    if (atomic_read(&blk->quiesce_counter) && !blk->disable_request_queuing) {
+        /*
+         * Re-check under queued_requests_lock: blk_root_drained_end()
+         * resumes the queue with the lock held, so once it has observed
+         * quiesce_counter == 0 we cannot enqueue ourselves any more and
+         * wait for a wakeup that already happened.
+         */
+        qemu_mutex_lock(&blk->queued_requests_lock);
+        if (atomic_read(&blk->quiesce_counter)) {
+            qemu_co_queue_wait(&blk->queued_requests,
+                               &blk->queued_requests_lock);
+        }
+        qemu_mutex_unlock(&blk->queued_requests_lock);
     }
 }
 
@@ -1387,7 +1403,7 @@ static void blk_aio_read_entry(void *opaque)
     BlkRwCo *rwco = &acb->rwco;
     QEMUIOVector *qiov = rwco->iobuf;
 
-    if (rwco->blk->quiesce_counter) {
+    if (atomic_read(&rwco->blk->quiesce_counter)) {
         blk_dec_in_flight(rwco->blk);
         blk_wait_while_drained(rwco->blk);
         blk_inc_in_flight(rwco->blk);
@@ -1405,7 +1421,7 @@ static void blk_aio_write_entry(void *opaque)
     BlkRwCo *rwco = &acb->rwco;
     QEMUIOVector *qiov = rwco->iobuf;
 
-    if (rwco->blk->quiesce_counter) {
+    if (atomic_read(&rwco->blk->quiesce_counter)) {
         blk_dec_in_flight(rwco->blk);
         blk_wait_while_drained(rwco->blk);
         blk_inc_in_flight(rwco->blk);
@@ -2257,7 +2273,7 @@ static void blk_root_drained_begin(BdrvChild *child)
 {
     BlockBackend *blk = child->opaque;
 
-    if (++blk->quiesce_counter == 1) {
+    if (atomic_fetch_inc(&blk->quiesce_counter) == 0) {
         if (blk->dev_ops && blk->dev_ops->drained_begin) {
             blk->dev_ops->drained_begin(blk->dev_opaque);
         }
@@ -2274,25 +2290,33 @@ static void blk_root_drained_begin(BdrvChild *child)
 static bool blk_root_drained_poll(BdrvChild *child)
 {
     BlockBackend *blk = child->opaque;
-    assert(blk->quiesce_counter);
-    return !!blk->in_flight;
+    assert(atomic_read(&blk->quiesce_counter));
+    return !!atomic_read(&blk->in_flight);
 }
 
 static void blk_root_drained_end(BdrvChild *child, int *drained_end_counter)
 {
     BlockBackend *blk = child->opaque;
-    assert(blk->quiesce_counter);
+    assert(atomic_read(&blk->quiesce_counter));
 
     assert(blk->public.throttle_group_member.io_limits_disabled);
     atomic_dec(&blk->public.throttle_group_member.io_limits_disabled);
 
-    if (--blk->quiesce_counter == 0) {
+    /*
+     * Decrement before taking queued_requests_lock: a request that
+     * observes the new counter value under the lock must not enqueue
+     * itself, see blk_wait_while_drained().
+     */
+    if (atomic_fetch_dec(&blk->quiesce_counter) == 1) {
         if (blk->dev_ops && blk->dev_ops->drained_end) {
             blk->dev_ops->drained_end(blk->dev_opaque);
         }
-        while (qemu_co_enter_next(&blk->queued_requests, NULL)) {
+        qemu_mutex_lock(&blk->queued_requests_lock);
+        while (qemu_co_enter_next(&blk->queued_requests,
+                                  &blk->queued_requests_lock)) {
             /* Resume all queued requests */
         }
+        qemu_mutex_unlock(&blk->queued_requests_lock);
     }
 }
 
@@ -31,6 +31,8 @@
 struct BdrvDirtyBitmap {
     BlockDriverState *bs;
     HBitmap *bitmap;            /* Dirty bitmap implementation */
+    HBitmap *meta;              /* Meta dirty bitmap: tracks changes of
+                                   @bitmap itself, for incremental storing */
     bool busy;                  /* Bitmap is busy, it can't be used via QMP */
     BdrvDirtyBitmap *successor; /* Anonymous child, if any. */
     char *name;                 /* Optional non-empty unique ID */
@@ -132,6 +134,58 @@ BdrvDirtyBitmap *bdrv_create_dirty_bitmap(BlockDriverState *bs,
     return bitmap;
 }
 
+/**
+ * bdrv_create_meta_dirty_bitmap
+ *
+ * Create a meta dirty bitmap that tracks the changes of bits in @bitmap. I.e.
+ * when a dirty status bit in @bitmap is changed (either from reset to set or
+ * the other way), its respective meta dirty bitmap bit will be marked dirty as
+ * well. One meta bit covers @chunk_size bits of @bitmap.
+ *
+ * Called with BQL taken.
+ */
+void bdrv_create_meta_dirty_bitmap(BdrvDirtyBitmap *bitmap, int chunk_size)
+{
+    assert(!bitmap->meta);
+    bdrv_dirty_bitmaps_lock(bitmap->bs);
+    bitmap->meta = hbitmap_create_meta(bitmap->bitmap, chunk_size);
+    bdrv_dirty_bitmaps_unlock(bitmap->bs);
+}
+
+/* Called with BQL taken. */
+void bdrv_release_meta_dirty_bitmap(BdrvDirtyBitmap *bitmap)
+{
+    assert(bitmap->meta);
+    bdrv_dirty_bitmaps_lock(bitmap->bs);
+    hbitmap_free_meta(bitmap->bitmap);
+    bitmap->meta = NULL;
+    bdrv_dirty_bitmaps_unlock(bitmap->bs);
+}
+
+bool bdrv_dirty_bitmap_has_meta(BdrvDirtyBitmap *bitmap)
+{
+    return bitmap->meta;
+}
+
+/* Query whether the meta bit covering @offset is dirty */
+bool bdrv_dirty_bitmap_get_meta(BdrvDirtyBitmap *bitmap, int64_t offset)
+{
+    bool dirty;
+
+    bdrv_dirty_bitmaps_lock(bitmap->bs);
+    dirty = hbitmap_get(bitmap->meta, offset);
+    bdrv_dirty_bitmaps_unlock(bitmap->bs);
+
+    return dirty;
+}
+
+void bdrv_dirty_bitmap_reset_meta(BdrvDirtyBitmap *bitmap)
+{
+    bdrv_dirty_bitmaps_lock(bitmap->bs);
+    hbitmap_reset_all(bitmap->meta);
+    bdrv_dirty_bitmaps_unlock(bitmap->bs);
+}
+
 int64_t bdrv_dirty_bitmap_size(const BdrvDirtyBitmap *bitmap)
 {
     return bitmap->size;
@@ -295,6 +349,9 @@ static void bdrv_release_dirty_bitmap_locked(BdrvDirtyBitmap *bitmap)
     assert(!bdrv_dirty_bitmap_busy(bitmap));
     assert(!bdrv_dirty_bitmap_has_successor(bitmap));
     QLIST_REMOVE(bitmap, list);
+    if (bitmap->meta) {
+        hbitmap_free_meta(bitmap->bitmap);
+    }
     hbitmap_free(bitmap->bitmap);
     g_free(bitmap->name);
     g_free(bitmap);
@@ -387,6 +444,13 @@ void bdrv_dirty_bitmap_truncate(BlockDriverState *bs, int64_t bytes)
         assert(!bitmap->active_iterators);
         hbitmap_truncate(bitmap->bitmap, bytes);
         bitmap->size = bytes;
+        if (bitmap->meta) {
+            /*
+             * The resize may have shifted the serialized layout; be
+             * conservative and make the next incremental store a full one.
+             */
+            hbitmap_set(bitmap->meta, 0, bytes);
+        }
     }
     bdrv_dirty_bitmaps_unlock(bs);
 }
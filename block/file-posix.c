@@ -157,6 +157,7 @@ typedef struct BDRVRawState {
     bool discard_zeroes:1;
     bool use_linux_aio:1;
     bool use_linux_io_uring:1;
+    bool use_nowait_read:1;
     bool page_cache_inconsistent:1;
     bool has_fallocate;
     bool needs_alignment;
@@ -464,6 +465,12 @@ static QemuOptsList raw_runtime_opts = {
             .help = "invalidate page cache during live migration (default: on)",
         },
 #endif
+        {
+            .name = "write-lifetime-hint",
+            .type = QEMU_OPT_STRING,
+            .help = "expected write lifetime (none, short, medium, long, "
+                    "extreme; default: no hint)",
+        },
         {
             .name = "x-check-cache-dropped",
             .type = QEMU_OPT_BOOL,
@@ -475,6 +482,16 @@ static QemuOptsList raw_runtime_opts = {
 
 static const char *const mutable_opts[] = { "x-check-cache-dropped", NULL };
 
+#ifdef F_SET_RW_HINT
+static const uint64_t write_lifetime_hints[] = {
+    [BLOCKDEV_FILE_WRITE_LIFETIME_HINT_NONE]    = RWH_WRITE_LIFE_NONE,
+    [BLOCKDEV_FILE_WRITE_LIFETIME_HINT_SHORT]   = RWH_WRITE_LIFE_SHORT,
+    [BLOCKDEV_FILE_WRITE_LIFETIME_HINT_MEDIUM]  = RWH_WRITE_LIFE_MEDIUM,
+    [BLOCKDEV_FILE_WRITE_LIFETIME_HINT_LONG]    = RWH_WRITE_LIFE_LONG,
+    [BLOCKDEV_FILE_WRITE_LIFETIME_HINT_EXTREME] = RWH_WRITE_LIFE_EXTREME,
+};
+#endif
+
 static int raw_open_common(BlockDriverState *bs, QDict *options,
                            int bdrv_flags, int open_flags,
                            bool device, Error **errp)
@@ -488,6 +505,7 @@ static int raw_open_common(BlockDriverState *bs, QDict *options,
     int fd, ret;
     struct stat st;
     OnOffAuto locking;
+    int write_hint;
 
     opts = qemu_opts_create(&raw_runtime_opts, NULL, 0, &error_abort);
     qemu_opts_absorb_qdict(opts, options, &local_err);
@@ -570,6 +588,15 @@ static int raw_open_common(BlockDriverState *bs, QDict *options,
     s->check_cache_dropped = qemu_opt_get_bool(opts, "x-check-cache-dropped",
                                                false);
 
+    write_hint = qapi_enum_parse(&BlockdevFileWriteLifetimeHint_lookup,
+                                 qemu_opt_get(opts, "write-lifetime-hint"),
+                                 -1, &local_err);
+    if (local_err) {
+        error_propagate(errp, local_err);
+        ret = -EINVAL;
+        goto fail;
+    }
+
     s->open_flags = open_flags;
     raw_parse_flags(bdrv_flags, &s->open_flags, false);
 
@@ -586,6 +613,22 @@ static int raw_open_common(BlockDriverState *bs, QDict *options,
     }
     s->fd = fd;
 
+    if (write_hint != -1) {
+#ifdef F_SET_RW_HINT
+        uint64_t hint = write_lifetime_hints[write_hint];
+
+        /* The hint is stored on the inode, so it survives a reopen. */
+        if (fcntl(s->fd, F_SET_RW_HINT, &hint) < 0) {
+            warn_report("Could not set write lifetime hint on '%s': %s",
+                        filename, strerror(errno));
+        }
+#else
+        error_setg(errp, "write-lifetime-hint is not supported on this host");
+        ret = -ENOTSUP;
+        goto fail;
+#endif
+    }
+
     s->perm = 0;
     s->shared_perm = BLK_PERM_ALL;
 
@@ -633,6 +676,13 @@ static int raw_open_common(BlockDriverState *bs, QDict *options,
     if ((bs->open_flags & BDRV_O_NOCACHE) != 0) {
         s->needs_alignment = true;
     }
+#ifdef CONFIG_PREADV2
+    /*
+     * Attempt reads with RWF_NOWAIT from the IOThread first; cleared
+     * again if the kernel or filesystem turns out not to support it.
+     */
+    s->use_nowait_read = true;
+#endif
 
     if (fstat(s->fd, &st) < 0) {
         ret = -errno;
@@ -1043,6 +1093,23 @@ out:
     return ret;
 }
 
+/*
+ * io_uring holds a reference on registered (fixed) files; drop it before
+ * closing a descriptor that saw I/O, or the inode would stay open (and
+ * locked) until the ring is torn down.
+ */
+static void raw_luring_fd_closing(BlockDriverState *bs, int fd)
+{
+#ifdef CONFIG_LINUX_IO_URING
+    BDRVRawState *s = bs->opaque;
+
+    if (s->use_linux_io_uring) {
+        LuringState *aio = aio_get_linux_io_uring(bdrv_get_aio_context(bs));
+        luring_fd_closing(aio, fd);
+    }
+#endif
+}
+
 static void raw_reopen_commit(BDRVReopenState *state)
 {
     BDRVRawReopenState *rs = state->opaque;
@@ -1052,6 +1119,7 @@ static void raw_reopen_commit(BDRVReopenState *state)
     s->check_cache_dropped = rs->check_cache_dropped;
     s->open_flags = rs->open_flags;
 
+    raw_luring_fd_closing(state->bs, s->fd);
     qemu_close(s->fd);
     s->fd = rs->fd;
 
@@ -1894,6 +1962,15 @@ static int coroutine_fn raw_thread_pool_submit(BlockDriverState *bs,
     return thread_pool_submit_co(pool, func, arg);
 }
 
+static int coroutine_fn raw_thread_pool_submit_affine(BlockDriverState *bs,
+                                                      ThreadPoolFunc func,
+                                                      void *arg,
+                                                      unsigned long affinity)
+{
+    ThreadPool *pool = aio_get_thread_pool(bdrv_get_aio_context(bs));
+    return thread_pool_submit_co_affine(pool, func, arg, affinity);
+}
+
 static int coroutine_fn raw_co_prw(BlockDriverState *bs, uint64_t offset,
                                    uint64_t bytes, QEMUIOVector *qiov, int type)
 {
@@ -1925,6 +2002,37 @@ static int coroutine_fn raw_co_prw(BlockDriverState *bs, uint64_t offset,
 #endif
     }
 
+#ifdef CONFIG_PREADV2
+    /*
+     * For buffered reads, first try a non-blocking read in this thread.
+     * When the data is already in the page cache this completes
+     * synchronously and saves handing the request off to a worker
+     * thread; RWF_NOWAIT makes the kernel return EAGAIN instead of
+     * blocking when it is not.
+     */
+    if (type == QEMU_AIO_READ && s->use_nowait_read && !s->needs_alignment) {
+        ssize_t len;
+
+        do {
+            len = preadv2(s->fd, qiov->iov, qiov->niov, offset, RWF_NOWAIT);
+        } while (len == -1 && errno == EINTR);
+
+        if (len == bytes) {
+            return 0;
+        }
+        if (len == -1 && (errno == EOPNOTSUPP || errno == ENOSYS ||
+                          errno == EINVAL)) {
+            /* No RWF_NOWAIT support in this kernel or filesystem */
+            s->use_nowait_read = false;
+        }
+        /*
+         * EAGAIN and short reads (near end of file, where the buffered
+         * path pads with zeroes) fall back to the thread pool below;
+         * reads are idempotent, so restarting from scratch is safe.
+         */
+    }
+#endif
+
     acb = (RawPosixAIOData) {
         .bs             = bs,
         .aio_fildes     = s->fd,
@@ -1938,7 +2046,14 @@ static int coroutine_fn raw_co_prw(BlockDriverState *bs, uint64_t offset,
     };
 
     assert(qiov->size == bytes);
-    return raw_thread_pool_submit(bs, handle_aiocb_rw, &acb);
+    /* Requests to the same file that are close together prefer the same
+     * worker thread: sequential streams keep their page cache and
+     * readahead state warm on one CPU, while streams on other files or
+     * in distant 4MB chunks spread across workers.
+     */
+    return raw_thread_pool_submit_affine(bs, handle_aiocb_rw, &acb,
+                                         (unsigned long)s->fd ^
+                                         (offset >> 22));
 }
 
 static int coroutine_fn raw_co_preadv(BlockDriverState *bs, uint64_t offset,
@@ -2047,6 +2162,7 @@ static void raw_close(BlockDriverState *bs)
     BDRVRawState *s = bs->opaque;
 
     if (s->fd >= 0) {
+        raw_luring_fd_closing(bs, s->fd);
         qemu_close(s->fd);
         s->fd = -1;
     }
@@ -3006,6 +3122,7 @@ static void raw_set_perm(BlockDriverState *bs, uint64_t perm, uint64_t shared)
     /* For reopen, we have already switched to the new fd (.bdrv_set_perm is
      * called after .bdrv_reopen_commit) */
     if (s->perm_change_fd && s->fd != s->perm_change_fd) {
+        raw_luring_fd_closing(bs, s->fd);
         qemu_close(s->fd);
         s->fd = s->perm_change_fd;
         s->open_flags = s->perm_change_flags;
@@ -260,18 +260,47 @@ static void bdrv_drain_invoke(BlockDriverState *bs, bool begin,
     aio_co_schedule(bdrv_get_aio_context(bs), data->co);
 }
 
+/*
+ * The condition of a polling drain is re-evaluated after every event, and a
+ * single evaluation visits nodes through all edges of the graph: checking a
+ * node polls all of its parents, which recursively poll their own parents.
+ * On long chains this makes one evaluation quadratic in the depth of the
+ * graph. Nothing can change during one evaluation (all checks are pure
+ * reads, with no yield in between), so nodes that have already been found
+ * quiescent need not be checked again and the evaluation becomes linear in
+ * the size of the graph.
+ *
+ * The memo is only valid during a single evaluation, and per-thread:
+ * concurrent drains in other AioContexts evaluate their own condition
+ * against their own memo.
+ */
+static __thread GHashTable *drain_poll_memo;
+
 /* Returns true if BDRV_POLL_WHILE() should go into a blocking aio_poll() */
 bool bdrv_drain_poll(BlockDriverState *bs, bool recursive,
                      BdrvChild *ignore_parent, bool ignore_bds_parents)
 {
     BdrvChild *child, *next;
 
-    if (bdrv_parent_drained_poll(bs, ignore_parent, ignore_bds_parents)) {
-        return true;
-    }
+    if (drain_poll_memo && g_hash_table_contains(drain_poll_memo, bs)) {
+        /* Already found quiescent earlier during this evaluation. Any
+         * parents ignored back then have had their own quiescence checked
+         * when they were visited themselves. */
+        if (!recursive) {
+            return false;
+        }
+    } else {
+        if (bdrv_parent_drained_poll(bs, ignore_parent, ignore_bds_parents)) {
+            return true;
+        }
 
-    if (atomic_read(&bs->in_flight)) {
-        return true;
+        if (atomic_read(&bs->in_flight)) {
+            return true;
+        }
+
+        if (drain_poll_memo) {
+            g_hash_table_add(drain_poll_memo, bs);
+        }
     }
 
     if (recursive) {
@@ -289,7 +318,17 @@ bool bdrv_drain_poll(BlockDriverState *bs, bool recursive,
 static bool bdrv_drain_poll_top_level(BlockDriverState *bs, bool recursive,
                                       BdrvChild *ignore_parent)
 {
-    return bdrv_drain_poll(bs, recursive, ignore_parent, false);
+    bool busy;
+
+    assert(!drain_poll_memo);
+    drain_poll_memo = g_hash_table_new(NULL, NULL);
+
+    busy = bdrv_drain_poll(bs, recursive, ignore_parent, false);
+
+    g_hash_table_destroy(drain_poll_memo);
+    drain_poll_memo = NULL;
+
+    return busy;
 }
 
 static void bdrv_do_drained_begin(BlockDriverState *bs, bool recursive,
@@ -22,6 +22,9 @@
 /* io_uring ring size */
 #define MAX_ENTRIES 128
 
+/* maximum number of file descriptors registered as fixed files */
+#define MAX_FIXED_FILES 16
+
 typedef struct LuringAIOCB {
     Coroutine *co;
     struct io_uring_sqe sqeq;
@@ -56,8 +59,99 @@ typedef struct LuringState {
 
     /* I/O completion processing.  Only runs in I/O thread.  */
     QEMUBH *completion_bh;
+
+    /*
+     * Fixed files (IOSQE_FIXED_FILE).  Free slots hold placeholder_fd so
+     * that re-registering never changes the index of another entry.
+     * Protected by AioContext lock.
+     */
+    int fixed_fds[MAX_FIXED_FILES];
+    unsigned int nr_fixed_fds;
+    int placeholder_fd;
+    bool fixed_fds_broken;
 } LuringState;
 
+static int ioq_submit(LuringState *s);
+
+/**
+ * luring_fixed_fd:
+ *
+ * Return the fixed-file index for @fd, registering it on first use.  The
+ * kernel quiesces the ring while the file table changes, so registration
+ * is only attempted when nothing is in flight or queued; otherwise -1 is
+ * returned and the request is submitted with a regular file descriptor.
+ */
+static int luring_fixed_fd(LuringState *s, int fd)
+{
+    unsigned int i, slot;
+
+    slot = s->nr_fixed_fds;
+    for (i = 0; i < s->nr_fixed_fds; i++) {
+        if (s->fixed_fds[i] == fd) {
+            return i;
+        }
+        if (s->fixed_fds[i] == s->placeholder_fd && slot == s->nr_fixed_fds) {
+            slot = i;
+        }
+    }
+
+    if (s->fixed_fds_broken || slot == MAX_FIXED_FILES ||
+        s->io_q.in_flight > 0 || s->io_q.in_queue > 0) {
+        return -1;
+    }
+
+    if (s->nr_fixed_fds > 0 && io_uring_unregister_files(&s->ring) < 0) {
+        s->fixed_fds_broken = true;
+        return -1;
+    }
+    s->fixed_fds[slot] = fd;
+    if (slot == s->nr_fixed_fds) {
+        s->nr_fixed_fds++;
+    }
+    if (io_uring_register_files(&s->ring, s->fixed_fds,
+                                s->nr_fixed_fds) < 0) {
+        /* Typically an old kernel; don't retry on every request */
+        s->nr_fixed_fds = 0;
+        s->fixed_fds_broken = true;
+        return -1;
+    }
+    trace_luring_fd_register(s, fd, slot);
+    return slot;
+}
+
+void luring_fd_closing(LuringState *s, int fd)
+{
+    unsigned int i;
+
+    for (i = 0; i < s->nr_fixed_fds; i++) {
+        if (s->fixed_fds[i] == fd) {
+            break;
+        }
+    }
+    if (i == s->nr_fixed_fds) {
+        return;
+    }
+
+    /*
+     * The caller has drained @fd, but requests for other files may still
+     * sit in submit_queue with fixed indices; flush them so that they are
+     * in flight (where the kernel resolves the index at submission time,
+     * before quiescing for the re-registration below).
+     */
+    if (s->io_q.in_queue > 0) {
+        ioq_submit(s);
+    }
+
+    trace_luring_fd_unregister(s, fd, i);
+    s->fixed_fds[i] = s->placeholder_fd;
+    if (io_uring_unregister_files(&s->ring) < 0 ||
+        io_uring_register_files(&s->ring, s->fixed_fds,
+                                s->nr_fixed_fds) < 0) {
+        s->nr_fixed_fds = 0;
+        s->fixed_fds_broken = true;
+    }
+}
+
 /**
  * luring_resubmit:
  *
@@ -330,6 +424,7 @@ static int luring_do_submit(int fd, LuringAIOCB *luringcb, LuringState *s,
                             uint64_t offset, int type)
 {
     int ret;
+    int fixed = luring_fixed_fd(s, fd);
     struct io_uring_sqe *sqes = &luringcb->sqeq;
 
     switch (type) {
@@ -349,6 +444,10 @@ static int luring_do_submit(int fd, LuringAIOCB *luringcb, LuringState *s,
                         __func__, type);
         abort();
     }
+    if (fixed >= 0) {
+        sqes->fd = fixed;
+        sqes->flags |= IOSQE_FIXED_FILE;
+    }
     io_uring_sqe_set_data(sqes, luringcb);
 
     QSIMPLEQ_INSERT_TAIL(&s->io_q.submit_queue, luringcb, next);
@@ -420,6 +519,16 @@ LuringState *luring_init(Error **errp)
         return NULL;
     }
 
+    /*
+     * Keeps free fixed-file slots occupied, so that replacing an entry
+     * never shifts the index of another one.  Fixed files are merely an
+     * optimization, so failure here just disables them.
+     */
+    s->placeholder_fd = qemu_open("/dev/null", O_RDONLY);
+    if (s->placeholder_fd < 0) {
+        s->fixed_fds_broken = true;
+    }
+
     ioq_init(&s->io_q);
     return s;
 
@@ -427,6 +536,12 @@ LuringState *luring_init(Error **errp)
 
 void luring_cleanup(LuringState *s)
 {
+    if (s->nr_fixed_fds > 0) {
+        io_uring_unregister_files(&s->ring);
+    }
+    if (s->placeholder_fd >= 0) {
+        qemu_close(s->placeholder_fd);
+    }
     io_uring_queue_exit(&s->ring);
     g_free(s);
     trace_luring_cleanup_state(s);
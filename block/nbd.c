@@ -44,7 +44,13 @@
 #include "block/block_int.h"
 
 #define EN_OPTSTR ":exportname="
-#define MAX_NBD_REQUESTS    16
+/*
+ * On a remote connection the per-request round trip dominates, so allow
+ * enough requests in flight to keep a high-latency link busy.  The
+ * request slots themselves are small; the data buffers belong to the
+ * callers.
+ */
+#define MAX_NBD_REQUESTS    64
 
 #define HANDLE_TO_INDEX(bs, handle) ((handle) ^ (uint64_t)(intptr_t)(bs))
 #define INDEX_TO_HANDLE(bs, index)  ((index)  ^ (uint64_t)(intptr_t)(bs))
@@ -445,34 +445,41 @@ static void bdrv_query_blk_stats(BlockDeviceStats *ds, BlockBackend *blk)
     BlockAcctStats *stats = blk_get_stats(blk);
     BlockAcctTimedStats *ts = NULL;
 
-    ds->rd_bytes = stats->nr_bytes[BLOCK_ACCT_READ];
-    ds->wr_bytes = stats->nr_bytes[BLOCK_ACCT_WRITE];
-    ds->unmap_bytes = stats->nr_bytes[BLOCK_ACCT_UNMAP];
-    ds->rd_operations = stats->nr_ops[BLOCK_ACCT_READ];
-    ds->wr_operations = stats->nr_ops[BLOCK_ACCT_WRITE];
-    ds->unmap_operations = stats->nr_ops[BLOCK_ACCT_UNMAP];
-
-    ds->failed_rd_operations = stats->failed_ops[BLOCK_ACCT_READ];
-    ds->failed_wr_operations = stats->failed_ops[BLOCK_ACCT_WRITE];
-    ds->failed_flush_operations = stats->failed_ops[BLOCK_ACCT_FLUSH];
-    ds->failed_unmap_operations = stats->failed_ops[BLOCK_ACCT_UNMAP];
-
-    ds->invalid_rd_operations = stats->invalid_ops[BLOCK_ACCT_READ];
-    ds->invalid_wr_operations = stats->invalid_ops[BLOCK_ACCT_WRITE];
+    ds->rd_bytes = stat64_get(&stats->nr_bytes[BLOCK_ACCT_READ]);
+    ds->wr_bytes = stat64_get(&stats->nr_bytes[BLOCK_ACCT_WRITE]);
+    ds->unmap_bytes = stat64_get(&stats->nr_bytes[BLOCK_ACCT_UNMAP]);
+    ds->rd_operations = stat64_get(&stats->nr_ops[BLOCK_ACCT_READ]);
+    ds->wr_operations = stat64_get(&stats->nr_ops[BLOCK_ACCT_WRITE]);
+    ds->unmap_operations = stat64_get(&stats->nr_ops[BLOCK_ACCT_UNMAP]);
+
+    ds->failed_rd_operations = stat64_get(&stats->failed_ops[BLOCK_ACCT_READ]);
+    ds->failed_wr_operations = stat64_get(&stats->failed_ops[BLOCK_ACCT_WRITE]);
+    ds->failed_flush_operations =
+        stat64_get(&stats->failed_ops[BLOCK_ACCT_FLUSH]);
+    ds->failed_unmap_operations =
+        stat64_get(&stats->failed_ops[BLOCK_ACCT_UNMAP]);
+
+    ds->invalid_rd_operations =
+        stat64_get(&stats->invalid_ops[BLOCK_ACCT_READ]);
+    ds->invalid_wr_operations =
+        stat64_get(&stats->invalid_ops[BLOCK_ACCT_WRITE]);
     ds->invalid_flush_operations =
-        stats->invalid_ops[BLOCK_ACCT_FLUSH];
-    ds->invalid_unmap_operations = stats->invalid_ops[BLOCK_ACCT_UNMAP];
-
-    ds->rd_merged = stats->merged[BLOCK_ACCT_READ];
-    ds->wr_merged = stats->merged[BLOCK_ACCT_WRITE];
-    ds->unmap_merged = stats->merged[BLOCK_ACCT_UNMAP];
-    ds->flush_operations = stats->nr_ops[BLOCK_ACCT_FLUSH];
-    ds->wr_total_time_ns = stats->total_time_ns[BLOCK_ACCT_WRITE];
-    ds->rd_total_time_ns = stats->total_time_ns[BLOCK_ACCT_READ];
-    ds->flush_total_time_ns = stats->total_time_ns[BLOCK_ACCT_FLUSH];
-    ds->unmap_total_time_ns = stats->total_time_ns[BLOCK_ACCT_UNMAP];
-
-    ds->has_idle_time_ns = stats->last_access_time_ns > 0;
+        stat64_get(&stats->invalid_ops[BLOCK_ACCT_FLUSH]);
+    ds->invalid_unmap_operations =
+        stat64_get(&stats->invalid_ops[BLOCK_ACCT_UNMAP]);
+
+    ds->rd_merged = stat64_get(&stats->merged[BLOCK_ACCT_READ]);
+    ds->wr_merged = stat64_get(&stats->merged[BLOCK_ACCT_WRITE]);
+    ds->unmap_merged = stat64_get(&stats->merged[BLOCK_ACCT_UNMAP]);
+    ds->flush_operations = stat64_get(&stats->nr_ops[BLOCK_ACCT_FLUSH]);
+    ds->wr_total_time_ns = stat64_get(&stats->total_time_ns[BLOCK_ACCT_WRITE]);
+    ds->rd_total_time_ns = stat64_get(&stats->total_time_ns[BLOCK_ACCT_READ]);
+    ds->flush_total_time_ns =
+        stat64_get(&stats->total_time_ns[BLOCK_ACCT_FLUSH]);
+    ds->unmap_total_time_ns =
+        stat64_get(&stats->total_time_ns[BLOCK_ACCT_UNMAP]);
+
+    ds->has_idle_time_ns = stat64_get(&stats->last_access_time_ns) > 0;
     if (ds->has_idle_time_ns) {
         ds->idle_time_ns = block_acct_idle_time_ns(stats);
     }
@@ -480,6 +487,9 @@ static void bdrv_query_blk_stats(BlockDeviceStats *ds, BlockBackend *blk)
     ds->account_invalid = stats->account_invalid;
     ds->account_failed = stats->account_failed;
 
+    /* Interval averages and histogram bins are protected by stats->lock,
+     * not by the AioContext of the device. */
+    qemu_mutex_lock(&stats->lock);
     while ((ts = block_acct_interval_next(stats, ts))) {
         BlockDeviceTimedStatsList *timed_stats =
             g_malloc0(sizeof(*timed_stats));
@@ -521,6 +531,7 @@ static void bdrv_query_blk_stats(BlockDeviceStats *ds, BlockBackend *blk)
     bdrv_latency_histogram_stats(&stats->latency_histogram[BLOCK_ACCT_FLUSH],
                                  &ds->has_flush_latency_histogram,
                                  &ds->flush_latency_histogram);
+    qemu_mutex_unlock(&stats->lock);
 }
 
 static BlockStats *bdrv_query_bds_stats(BlockDriverState *bs,
@@ -605,15 +616,18 @@ BlockStatsList *qmp_query_blockstats(bool has_query_nodes,
     BlockBackend *blk;
     BlockDriverState *bs;
 
+    /* The stats read below are either lock-free (Stat64 counters, plain
+     * aligned 64 bit counters, graph pointers under the BQL we hold) or
+     * taken under stats->lock, so the AioContext of the device is not
+     * acquired.  Polling this command therefore never stalls a device's
+     * iothread. */
+
     /* Just to be safe if query_nodes is not always initialized */
     if (has_query_nodes && query_nodes) {
         for (bs = bdrv_next_node(NULL); bs; bs = bdrv_next_node(bs)) {
             BlockStatsList *info = g_malloc0(sizeof(*info));
-            AioContext *ctx = bdrv_get_aio_context(bs);
 
-            aio_context_acquire(ctx);
             info->value = bdrv_query_bds_stats(bs, false);
-            aio_context_release(ctx);
 
             *p_next = info;
             p_next = &info->next;
@@ -621,7 +635,6 @@ BlockStatsList *qmp_query_blockstats(bool has_query_nodes,
     } else {
         for (blk = blk_all_next(NULL); blk; blk = blk_all_next(blk)) {
             BlockStatsList *info;
-            AioContext *ctx = blk_get_aio_context(blk);
             BlockStats *s;
             char *qdev;
 
@@ -629,7 +642,6 @@ BlockStatsList *qmp_query_blockstats(bool has_query_nodes,
                 continue;
             }
 
-            aio_context_acquire(ctx);
             s = bdrv_query_bds_stats(blk_bs(blk), true);
             s->has_device = true;
             s->device = g_strdup(blk_name(blk));
@@ -643,7 +655,6 @@ BlockStatsList *qmp_query_blockstats(bool has_query_nodes,
             }
 
             bdrv_query_blk_stats(s->stats, blk);
-            aio_context_release(ctx);
 
             info = g_malloc0(sizeof(*info));
             info->value = s;
@@ -86,6 +86,8 @@ typedef struct Qcow2Bitmap {
     char *name;
 
     BdrvDirtyBitmap *dirty_bitmap;
+    bool store_in_place; /* update the stored bitmap incrementally instead of
+                            rewriting it from scratch */
 
     QSIMPLEQ_ENTRY(Qcow2Bitmap) entry;
 } Qcow2Bitmap;
@@ -1022,6 +1024,14 @@ bool qcow2_load_dirty_bitmaps(BlockDriverState *bs, Error **errp)
         if (!(bm->flags & BME_FLAG_AUTO)) {
             bdrv_disable_dirty_bitmap(bitmap);
         }
+        if (can_write(bs) && !bdrv_dirty_bitmap_inconsistent(bitmap)) {
+            /*
+             * Track which clusters of the stored bitmap change, so that
+             * the next store only needs to rewrite those. One meta bit
+             * covers the bits serialized into one cluster.
+             */
+            bdrv_create_meta_dirty_bitmap(bitmap, s->cluster_size << 3);
+        }
         created_dirty_bitmaps =
             g_slist_append(created_dirty_bitmaps, bitmap);
     }
@@ -1136,6 +1146,7 @@ int qcow2_reopen_bitmaps_rw(BlockDriverState *bs, Error **errp)
     Qcow2BitmapList *bm_list;
     Qcow2Bitmap *bm;
     GSList *ro_dirty_bitmaps = NULL;
+    GSList *item;
     int ret = -EINVAL;
     bool need_header_update = false;
 
@@ -1219,6 +1230,18 @@ int qcow2_reopen_bitmaps_rw(BlockDriverState *bs, Error **errp)
     }
 
     g_slist_foreach(ro_dirty_bitmaps, set_readonly_helper, false);
+
+    /*
+     * The in-memory bitmaps still match what is stored in the image, so
+     * start tracking changes to allow incremental stores from now on.
+     */
+    for (item = ro_dirty_bitmaps; item != NULL; item = g_slist_next(item)) {
+        BdrvDirtyBitmap *bitmap = item->data;
+
+        if (!bdrv_dirty_bitmap_has_meta(bitmap)) {
+            bdrv_create_meta_dirty_bitmap(bitmap, s->cluster_size << 3);
+        }
+    }
     ret = 0;
 
 out:
@@ -1377,6 +1400,144 @@ fail:
     return NULL;
 }
 
+/*
+ * Check whether the bitmap can be stored by rewriting in place only the
+ * clusters that changed since it was loaded or last stored: the on-disk
+ * version (which is marked IN_USE and therefore invalid until the directory
+ * update) must have a matching layout and the changes must have been tracked
+ * in a meta dirty bitmap.
+ */
+static bool can_store_bitmap_in_place(BlockDriverState *bs, Qcow2Bitmap *bm,
+                                      BdrvDirtyBitmap *bitmap)
+{
+    BDRVQcow2State *s = bs->opaque;
+    uint64_t bm_size = bdrv_dirty_bitmap_size(bitmap);
+    uint64_t tb_size =
+            size_to_clusters(s,
+                bdrv_dirty_bitmap_serialization_size(bitmap, 0, bm_size));
+
+    return bdrv_dirty_bitmap_has_meta(bitmap) &&
+           bm->table.offset != 0 &&
+           bm->table.size == tb_size &&
+           bm->granularity_bits == ctz32(bdrv_dirty_bitmap_granularity(bitmap));
+}
+
+/* store_bitmap_in_place()
+ * Update the stored bitmap, rewriting only the clusters whose bits changed
+ * according to the meta dirty bitmap of bm->dirty_bitmap. The bitmap table
+ * is rewritten (in place) only when entries had to be added or dropped.
+ * Clusters that became all-zero keep their allocation, so that the on-disk
+ * table never references freed clusters, whatever happens to us in between.
+ */
+static int store_bitmap_in_place(BlockDriverState *bs, Qcow2Bitmap *bm,
+                                 Error **errp)
+{
+    int ret;
+    BDRVQcow2State *s = bs->opaque;
+    BdrvDirtyBitmap *bitmap = bm->dirty_bitmap;
+    const char *bm_name = bdrv_dirty_bitmap_name(bitmap);
+    uint64_t bm_size = bdrv_dirty_bitmap_size(bitmap);
+    uint64_t limit = bytes_covered_by_bitmap_cluster(s, bitmap);
+    uint64_t *tb = NULL;
+    uint8_t *buf = NULL;
+    bool table_modified = false;
+    uint64_t i;
+
+    ret = bitmap_table_load(bs, &bm->table, &tb);
+    if (ret < 0) {
+        error_setg_errno(errp, -ret, "Failed to read bitmap table of '%s'",
+                         bm_name);
+        return ret;
+    }
+
+    buf = g_malloc(s->cluster_size);
+
+    for (i = 0; i < bm->table.size; i++) {
+        uint64_t offset = i * limit;
+        uint64_t end = MIN(bm_size, offset + limit);
+        uint64_t write_size;
+        uint64_t off = tb[i] & BME_TABLE_ENTRY_OFFSET_MASK;
+        int64_t alloc;
+
+        if (!bdrv_dirty_bitmap_get_meta(bitmap, offset)) {
+            continue;
+        }
+
+        write_size = bdrv_dirty_bitmap_serialization_size(bitmap, offset,
+                                                          end - offset);
+        assert(write_size <= s->cluster_size);
+
+        bdrv_dirty_bitmap_serialize_part(bitmap, buf, offset, end - offset);
+
+        if (off == 0) {
+            if (buffer_is_zero(buf, write_size)) {
+                if (tb[i] != 0) {
+                    /* Was the all-ones shortcut; the range is clear now */
+                    tb[i] = 0;
+                    table_modified = true;
+                }
+                continue;
+            }
+
+            alloc = qcow2_alloc_clusters(bs, s->cluster_size);
+            if (alloc < 0) {
+                error_setg_errno(errp, -alloc,
+                                 "Failed to allocate clusters for bitmap '%s'",
+                                 bm_name);
+                ret = alloc;
+                goto out;
+            }
+            off = alloc;
+            tb[i] = off;
+            table_modified = true;
+        }
+
+        if (write_size < s->cluster_size) {
+            memset(buf + write_size, 0, s->cluster_size - write_size);
+        }
+
+        ret = qcow2_pre_write_overlap_check(bs, 0, off, s->cluster_size, false);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "Qcow2 overlap check failed");
+            goto out;
+        }
+
+        ret = bdrv_pwrite(bs->file, off, buf, s->cluster_size);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "Failed to write bitmap '%s' to file",
+                             bm_name);
+            goto out;
+        }
+    }
+
+    if (table_modified) {
+        ret = qcow2_pre_write_overlap_check(bs, 0, bm->table.offset,
+                                            bm->table.size * sizeof(tb[0]),
+                                            false);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "Qcow2 overlap check failed");
+            goto out;
+        }
+
+        bitmap_table_to_be(tb, bm->table.size);
+        ret = bdrv_pwrite(bs->file, bm->table.offset, tb,
+                          bm->table.size * sizeof(tb[0]));
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "Failed to write bitmap '%s' to file",
+                             bm_name);
+            goto out;
+        }
+    }
+
+    ret = 0;
+
+out:
+    g_free(buf);
+    g_free(tb);
+
+    return ret;
+}
+
 /* store_bitmap()
  * Store bm->dirty_bitmap to qcow2.
  * Set bm->table_offset and bm->table_size accordingly.
@@ -1602,10 +1763,14 @@ void qcow2_store_persistent_dirty_bitmaps(BlockDriverState *bs,
                            name);
                 goto fail;
             }
-            tb = g_memdup(&bm->table, sizeof(bm->table));
-            bm->table.offset = 0;
-            bm->table.size = 0;
-            QSIMPLEQ_INSERT_TAIL(&drop_tables, tb, entry);
+            if (can_store_bitmap_in_place(bs, bm, bitmap)) {
+                bm->store_in_place = true;
+            } else {
+                tb = g_memdup(&bm->table, sizeof(bm->table));
+                bm->table.offset = 0;
+                bm->table.size = 0;
+                QSIMPLEQ_INSERT_TAIL(&drop_tables, tb, entry);
+            }
         }
         bm->flags = bdrv_dirty_bitmap_enabled(bitmap) ? BME_FLAG_AUTO : 0;
         bm->granularity_bits = ctz32(bdrv_dirty_bitmap_granularity(bitmap));
@@ -1627,7 +1792,8 @@ void qcow2_store_persistent_dirty_bitmaps(BlockDriverState *bs,
             continue;
         }
 
-        ret = store_bitmap(bs, bm, errp);
+        ret = bm->store_in_place ? store_bitmap_in_place(bs, bm, errp)
+                                 : store_bitmap(bs, bm, errp);
         if (ret < 0) {
             goto fail;
         }
@@ -1646,6 +1812,21 @@ void qcow2_store_persistent_dirty_bitmaps(BlockDriverState *bs,
         g_free(tb);
     }
 
+    /* The stored version is in sync with memory again */
+    QSIMPLEQ_FOREACH(bm, bm_list, entry) {
+        if (bm->dirty_bitmap == NULL) {
+            continue;
+        }
+
+        if (bdrv_dirty_bitmap_has_meta(bm->dirty_bitmap)) {
+            bdrv_dirty_bitmap_reset_meta(bm->dirty_bitmap);
+        } else if (!release_stored) {
+            /* Let the next store be an incremental one */
+            bdrv_create_meta_dirty_bitmap(bm->dirty_bitmap,
+                                          s->cluster_size << 3);
+        }
+    }
+
     if (release_stored) {
         QSIMPLEQ_FOREACH(bm, bm_list, entry) {
             if (bm->dirty_bitmap == NULL) {
@@ -1662,7 +1843,8 @@ success:
 
 fail:
     QSIMPLEQ_FOREACH(bm, bm_list, entry) {
-        if (bm->dirty_bitmap == NULL || bm->table.offset == 0) {
+        if (bm->dirty_bitmap == NULL || bm->table.offset == 0 ||
+            bm->store_in_place) {
             continue;
         }
 
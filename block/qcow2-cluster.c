@@ -856,8 +856,15 @@ static int perform_cow(BlockDriverState *bs, QCowL2Meta *m)
     qemu_co_mutex_unlock(&s->lock);
     /* First we read the existing data from both COW regions. We
      * either read the whole region in one go, or the start and end
-     * regions separately. */
-    if (merge_reads) {
+     * regions separately.  If the source is known to read as zeroes
+     * (fresh image, nothing in the backing chain), skip the reads and
+     * fill the buffer instead; this catches the allocations that
+     * handle_alloc_space() could not shortcut, e.g. encrypted images
+     * or data files without BDRV_REQ_NO_FALLBACK zero support. */
+    if (qcow2_is_zero_cow(bs, m)) {
+        memset(start_buffer, 0, buffer_size);
+        ret = 0;
+    } else if (merge_reads) {
         qemu_iovec_add(&qiov, start_buffer, buffer_size);
         ret = do_perform_cow_read(bs, m->offset, start->offset, &qiov);
     } else {
@@ -30,6 +30,8 @@
 
 #include "qcow2.h"
 #include "block/thread-pool.h"
+#include "qemu/notify.h"
+#include "qemu/thread.h"
 #include "crypto.h"
 
 static int coroutine_fn
@@ -61,6 +63,40 @@ qcow2_co_process(BlockDriverState *bs, ThreadPoolFunc *func, void *arg)
  * Compression
  */
 
+/*
+ * Per-thread cached zlib streams.  deflateInit2() allocates a fresh
+ * window of some 270 kB on every call, which at one call per cluster
+ * dominates the cost of compressing small clusters.  The streams are
+ * reused with deflateReset()/inflateReset() instead, and torn down
+ * again when the worker thread exits since the generic thread pool
+ * reaps idle threads.
+ */
+static __thread z_stream qcow2_deflate_strm;
+static __thread z_stream qcow2_inflate_strm;
+static __thread bool qcow2_deflate_inited;
+static __thread bool qcow2_inflate_inited;
+static __thread Notifier qcow2_strm_cleanup_notifier;
+
+static void qcow2_strm_cleanup(Notifier *n, void *data)
+{
+    if (qcow2_deflate_inited) {
+        deflateEnd(&qcow2_deflate_strm);
+        qcow2_deflate_inited = false;
+    }
+    if (qcow2_inflate_inited) {
+        inflateEnd(&qcow2_inflate_strm);
+        qcow2_inflate_inited = false;
+    }
+}
+
+static void qcow2_strm_cleanup_register(void)
+{
+    if (!qcow2_strm_cleanup_notifier.notify) {
+        qcow2_strm_cleanup_notifier.notify = qcow2_strm_cleanup;
+        qemu_thread_atexit_add(&qcow2_strm_cleanup_notifier);
+    }
+}
+
 typedef ssize_t (*Qcow2CompressFunc)(void *dest, size_t dest_size,
                                      const void *src, size_t src_size);
 typedef struct Qcow2CompressData {
@@ -87,13 +123,21 @@ static ssize_t qcow2_compress(void *dest, size_t dest_size,
                               const void *src, size_t src_size)
 {
     ssize_t ret;
-    z_stream strm;
-
-    /* best compression, small window, no zlib header */
-    memset(&strm, 0, sizeof(strm));
-    ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
-                       -12, 9, Z_DEFAULT_STRATEGY);
-    if (ret != Z_OK) {
+    z_stream *strm = &qcow2_deflate_strm;
+
+    if (!qcow2_deflate_inited) {
+        /* best compression, small window, no zlib header */
+        memset(strm, 0, sizeof(*strm));
+        ret = deflateInit2(strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                           -12, 9, Z_DEFAULT_STRATEGY);
+        if (ret != Z_OK) {
+            return -EIO;
+        }
+        qcow2_deflate_inited = true;
+        qcow2_strm_cleanup_register();
+    } else if (deflateReset(strm) != Z_OK) {
+        deflateEnd(strm);
+        qcow2_deflate_inited = false;
         return -EIO;
     }
 
@@ -101,20 +145,18 @@ static ssize_t qcow2_compress(void *dest, size_t dest_size,
      * strm.next_in is not const in old zlib versions, such as those used on
      * OpenBSD/NetBSD, so cast the const away
      */
-    strm.avail_in = src_size;
-    strm.next_in = (void *) src;
-    strm.avail_out = dest_size;
-    strm.next_out = dest;
+    strm->avail_in = src_size;
+    strm->next_in = (void *) src;
+    strm->avail_out = dest_size;
+    strm->next_out = dest;
 
-    ret = deflate(&strm, Z_FINISH);
+    ret = deflate(strm, Z_FINISH);
     if (ret == Z_STREAM_END) {
-        ret = dest_size - strm.avail_out;
+        ret = dest_size - strm->avail_out;
     } else {
         ret = (ret == Z_OK ? -ENOMEM : -EIO);
     }
 
-    deflateEnd(&strm);
-
     return ret;
 }
 
@@ -134,21 +176,29 @@ static ssize_t qcow2_decompress(void *dest, size_t dest_size,
                                 const void *src, size_t src_size)
 {
     int ret;
-    z_stream strm;
-
-    memset(&strm, 0, sizeof(strm));
-    strm.avail_in = src_size;
-    strm.next_in = (void *) src;
-    strm.avail_out = dest_size;
-    strm.next_out = dest;
-
-    ret = inflateInit2(&strm, -12);
-    if (ret != Z_OK) {
+    z_stream *strm = &qcow2_inflate_strm;
+
+    if (!qcow2_inflate_inited) {
+        memset(strm, 0, sizeof(*strm));
+        ret = inflateInit2(strm, -12);
+        if (ret != Z_OK) {
+            return -EIO;
+        }
+        qcow2_inflate_inited = true;
+        qcow2_strm_cleanup_register();
+    } else if (inflateReset(strm) != Z_OK) {
+        inflateEnd(strm);
+        qcow2_inflate_inited = false;
         return -EIO;
     }
 
-    ret = inflate(&strm, Z_FINISH);
-    if ((ret == Z_STREAM_END || ret == Z_BUF_ERROR) && strm.avail_out == 0) {
+    strm->avail_in = src_size;
+    strm->next_in = (void *) src;
+    strm->avail_out = dest_size;
+    strm->next_out = dest;
+
+    ret = inflate(strm, Z_FINISH);
+    if ((ret == Z_STREAM_END || ret == Z_BUF_ERROR) && strm->avail_out == 0) {
         /*
          * We approve Z_BUF_ERROR because we need @dest buffer to be filled, but
          * @src buffer may be processed partly (because in qcow2 we know size of
@@ -159,8 +209,6 @@ static ssize_t qcow2_decompress(void *dest, size_t dest_size,
         ret = -EIO;
     }
 
-    inflateEnd(&strm);
-
     return ret;
 }
 
@@ -684,6 +684,7 @@ static const char *const mutable_opts[] = {
     QCOW2_OPT_L2_CACHE_ENTRY_SIZE,
     QCOW2_OPT_REFCOUNT_CACHE_SIZE,
     QCOW2_OPT_CACHE_CLEAN_INTERVAL,
+    QCOW2_OPT_METADATA_PRELOAD,
     NULL
 };
 
@@ -795,6 +796,12 @@ static QemuOptsList qcow2_runtime_opts = {
             .type = QEMU_OPT_NUMBER,
             .help = "Clean unused cache entries after this time (in seconds)",
         },
+        {
+            .name = QCOW2_OPT_METADATA_PRELOAD,
+            .type = QEMU_OPT_BOOL,
+            .help = "Preload L2 tables and refcount blocks into the cache "
+                    "when the image is opened",
+        },
         BLOCK_CRYPTO_OPT_DEF_KEY_SECRET("encrypt.",
             "ID of secret providing qcow2 AES key or LUKS passphrase"),
         { /* end of list */ }
@@ -951,6 +958,7 @@ typedef struct Qcow2ReopenState {
     Qcow2Cache *refcount_block_cache;
     int l2_slice_size; /* Number of entries in a slice of the L2 table */
     bool use_lazy_refcounts;
+    bool metadata_preload;
     int overlap_check;
     bool discard_passthrough[QCOW2_DISCARD_MAX];
     uint64_t cache_clean_interval;
@@ -1060,6 +1068,9 @@ static int qcow2_update_options_prepare(BlockDriverState *bs,
         goto fail;
     }
 
+    r->metadata_preload = qemu_opt_get_bool(opts, QCOW2_OPT_METADATA_PRELOAD,
+                                            false);
+
     /* lazy-refcounts; flush if going from enabled to disabled */
     r->use_lazy_refcounts = qemu_opt_get_bool(opts, QCOW2_OPT_LAZY_REFCOUNTS,
         (s->compatible_features & QCOW2_COMPAT_LAZY_REFCOUNTS));
@@ -1199,6 +1210,7 @@ static void qcow2_update_options_commit(BlockDriverState *bs,
 
     s->overlap_check = r->overlap_check;
     s->use_lazy_refcounts = r->use_lazy_refcounts;
+    s->metadata_preload = r->metadata_preload;
 
     for (i = 0; i < QCOW2_DISCARD_MAX; i++) {
         s->discard_passthrough[i] = r->discard_passthrough[i];
@@ -1242,6 +1254,59 @@ static int qcow2_update_options(BlockDriverState *bs, QDict *options,
     return ret;
 }
 
+/*
+ * Populate the metadata caches with the L2 slices and refcount blocks
+ * reachable from the active tables, so that the first burst of random
+ * guest I/O after opening a large image does not pay one synchronous
+ * metadata read per cluster.  This is best effort: preloading stops
+ * when the respective cache is full or on the first read error, and
+ * anything not loaded here is simply read on demand later as usual.
+ *
+ * Called with s->lock held.
+ */
+static void coroutine_fn qcow2_preload_metadata(BlockDriverState *bs)
+{
+    BDRVQcow2State *s = bs->opaque;
+    size_t l2_slice_bytes = s->l2_slice_size * sizeof(uint64_t);
+    int slices_per_table = s->cluster_size / l2_slice_bytes;
+    int budget, i, j, ret;
+    uint32_t rt_i;
+    void *table;
+
+    budget = qcow2_cache_get_num_tables(s->l2_table_cache);
+    for (i = 0; i < s->l1_size && budget > 0; i++) {
+        uint64_t l2_offset = s->l1_table[i] & L1E_OFFSET_MASK;
+
+        if (!l2_offset) {
+            continue;
+        }
+        for (j = 0; j < slices_per_table && budget > 0; j++, budget--) {
+            ret = qcow2_cache_get(bs, s->l2_table_cache,
+                                  l2_offset + j * l2_slice_bytes, &table);
+            if (ret < 0) {
+                return;
+            }
+            qcow2_cache_put(s->l2_table_cache, &table);
+        }
+    }
+
+    budget = qcow2_cache_get_num_tables(s->refcount_block_cache);
+    for (rt_i = 0; rt_i < s->refcount_table_size && budget > 0; rt_i++) {
+        uint64_t refblock_offset = s->refcount_table[rt_i] & REFT_OFFSET_MASK;
+
+        if (!refblock_offset) {
+            continue;
+        }
+        ret = qcow2_cache_get(bs, s->refcount_block_cache, refblock_offset,
+                              &table);
+        if (ret < 0) {
+            return;
+        }
+        qcow2_cache_put(s->refcount_block_cache, &table);
+        budget--;
+    }
+}
+
 /* Called with s->lock held.  */
 static int coroutine_fn qcow2_do_open(BlockDriverState *bs, QDict *options,
                                       int flags, Error **errp)
@@ -1750,6 +1815,10 @@ static int coroutine_fn qcow2_do_open(BlockDriverState *bs, QDict *options,
     }
 #endif
 
+    if (s->metadata_preload && !(flags & (BDRV_O_CHECK | BDRV_O_INACTIVE))) {
+        qcow2_preload_metadata(bs);
+    }
+
     qemu_co_queue_init(&s->thread_task_queue);
 
     return ret;
@@ -2313,7 +2382,7 @@ static bool is_unallocated(BlockDriverState *bs, int64_t offset, int64_t bytes)
          nr == bytes);
 }
 
-static bool is_zero_cow(BlockDriverState *bs, QCowL2Meta *m)
+bool qcow2_is_zero_cow(BlockDriverState *bs, QCowL2Meta *m)
 {
     /*
      * This check is designed for optimization shortcut so it must be
@@ -2347,7 +2416,7 @@ static int handle_alloc_space(BlockDriverState *bs, QCowL2Meta *l2meta)
             continue;
         }
 
-        if (!is_zero_cow(bs, m)) {
+        if (!qcow2_is_zero_cow(bs, m)) {
             continue;
         }
 
@@ -123,6 +123,7 @@
 #define QCOW2_OPT_L2_CACHE_ENTRY_SIZE "l2-cache-entry-size"
 #define QCOW2_OPT_REFCOUNT_CACHE_SIZE "refcount-cache-size"
 #define QCOW2_OPT_CACHE_CLEAN_INTERVAL "cache-clean-interval"
+#define QCOW2_OPT_METADATA_PRELOAD "metadata-preload"
 
 typedef struct QCowHeader {
     uint32_t magic;
@@ -278,7 +279,13 @@ typedef struct Qcow2BitmapHeaderExt {
     uint64_t bitmap_directory_offset;
 } QEMU_PACKED Qcow2BitmapHeaderExt;
 
-#define QCOW2_MAX_THREADS 4
+/*
+ * Keep this in step with QCOW2_MAX_WORKERS: a single guest request is
+ * split into up to QCOW2_MAX_WORKERS cluster tasks, and each compressed
+ * cluster hands off to a worker thread.  A lower thread cap would make
+ * the extra tasks queue behind the decompressors.
+ */
+#define QCOW2_MAX_THREADS QCOW2_MAX_WORKERS
 
 typedef struct BDRVQcow2State {
     int cluster_bits;
@@ -333,6 +340,7 @@ typedef struct BDRVQcow2State {
     int flags;
     int qcow_version;
     bool use_lazy_refcounts;
+    bool metadata_preload;
     int refcount_order;
     int refcount_bits;
     uint64_t refcount_max;
@@ -619,6 +627,8 @@ int qcow2_validate_table(BlockDriverState *bs, uint64_t offset,
                          int64_t max_size_bytes, const char *table_name,
                          Error **errp);
 
+bool qcow2_is_zero_cow(BlockDriverState *bs, QCowL2Meta *m);
+
 /* qcow2-refcount.c functions */
 int qcow2_refcount_init(BlockDriverState *bs);
 void qcow2_refcount_close(BlockDriverState *bs);
@@ -729,6 +739,7 @@ int coroutine_fn qcow2_check_fix_snapshot_table(BlockDriverState *bs,
 Qcow2Cache *qcow2_cache_create(BlockDriverState *bs, int num_tables,
                                unsigned table_size);
 int qcow2_cache_destroy(Qcow2Cache *c);
+int qcow2_cache_get_num_tables(Qcow2Cache *c);
 
 void qcow2_cache_entry_mark_dirty(Qcow2Cache *c, void *table);
 int qcow2_cache_flush(BlockDriverState *bs, Qcow2Cache *c);
@@ -27,6 +27,13 @@ enum {
      * that populating contiguous regions of the image is efficient.
      */
     STREAM_CHUNK = 512 * 1024, /* in bytes */
+
+    /*
+     * Maximum number of chunks copied in parallel.  A single chunk at
+     * a time serializes the read from the backing chain with the write
+     * into the top layer and saturates neither side on deep chains.
+     */
+    STREAM_MAX_IN_FLIGHT = 16,
 };
 
 typedef struct StreamBlockJob {
@@ -36,8 +43,19 @@ typedef struct StreamBlockJob {
     char *backing_file_str;
     bool bs_read_only;
     bool chain_frozen;
+
+    int in_flight;
+    CoQueue slot_queue;         /* wait here for a free in-flight slot */
+    int op_ret;                 /* first error of a parallel request */
+    int64_t op_ret_offset;      /* ...and the offset it happened at */
 } StreamBlockJob;
 
+typedef struct StreamOp {
+    StreamBlockJob *s;
+    int64_t offset;
+    uint64_t bytes;
+} StreamOp;
+
 static int coroutine_fn stream_populate(BlockBackend *blk,
                                         int64_t offset, uint64_t bytes)
 {
@@ -47,6 +65,38 @@ static int coroutine_fn stream_populate(BlockBackend *blk,
                          BDRV_REQ_COPY_ON_READ | BDRV_REQ_PREFETCH);
 }
 
+static void coroutine_fn stream_op_entry(void *opaque)
+{
+    StreamOp *op = opaque;
+    StreamBlockJob *s = op->s;
+    int ret;
+
+    ret = stream_populate(s->common.blk, op->offset, op->bytes);
+    if (ret < 0) {
+        if (s->op_ret == 0) {
+            s->op_ret = ret;
+            s->op_ret_offset = op->offset;
+        }
+    } else {
+        job_progress_update(&s->common.job, op->bytes);
+    }
+
+    s->in_flight--;
+    qemu_co_queue_next(&s->slot_queue);
+    g_free(op);
+}
+
+/* Called with in_flight == 0 */
+static BlockErrorAction stream_handle_op_error(StreamBlockJob *s)
+{
+    BlockErrorAction action;
+
+    assert(s->in_flight == 0);
+    action = block_job_error_action(&s->common, s->on_error, true, -s->op_ret);
+    s->op_ret = 0;
+    return action;
+}
+
 static void stream_abort(Job *job)
 {
     StreamBlockJob *s = container_of(job, StreamBlockJob, common.job);
@@ -136,6 +186,8 @@ static int coroutine_fn stream_run(Job *job, Error **errp)
         bdrv_enable_copy_on_read(bs);
     }
 
+    qemu_co_queue_init(&s->slot_queue);
+
     for ( ; offset < len; offset += n) {
         bool copy;
         int ret;
@@ -148,6 +200,35 @@ static int coroutine_fn stream_run(Job *job, Error **errp)
             break;
         }
 
+        /* Surface errors of parallel requests issued earlier */
+        if (s->op_ret < 0) {
+            BlockErrorAction action;
+            int64_t op_ret_offset;
+
+            while (s->in_flight > 0) {
+                qemu_co_queue_wait(&s->slot_queue, NULL);
+            }
+            ret = s->op_ret;
+            op_ret_offset = s->op_ret_offset;
+            action = stream_handle_op_error(s);
+            if (action == BLOCK_ERROR_ACTION_STOP) {
+                /*
+                 * Go back to the failed chunk; anything copied after it
+                 * in the meantime is now allocated in the top layer and
+                 * will be skipped quickly.
+                 */
+                offset = MIN(offset, op_ret_offset);
+                n = 0;
+                continue;
+            }
+            if (error == 0) {
+                error = ret;
+            }
+            if (action == BLOCK_ERROR_ACTION_REPORT) {
+                break;
+            }
+        }
+
         copy = false;
 
         ret = bdrv_is_allocated(bs, offset, STREAM_CHUNK, &n);
@@ -167,9 +248,27 @@ static int coroutine_fn stream_run(Job *job, Error **errp)
         }
         trace_stream_one_iteration(s, offset, n, ret);
         if (copy) {
-            ret = stream_populate(blk, offset, n);
+            StreamOp *op;
+            Coroutine *co;
+
+            while (s->in_flight >= STREAM_MAX_IN_FLIGHT) {
+                qemu_co_queue_wait(&s->slot_queue, NULL);
+            }
+
+            /* The entry point above reports errors of earlier requests */
+            if (s->op_ret == 0) {
+                op = g_new(StreamOp, 1);
+                op->s = s;
+                op->offset = offset;
+                op->bytes = n;
+                s->in_flight++;
+                co = qemu_coroutine_create(stream_op_entry, op);
+                qemu_coroutine_enter(co);
+            }
+            ret = 0;
         }
         if (ret < 0) {
+            /* Chain allocation queries are not worth retrying */
             BlockErrorAction action =
                 block_job_error_action(&s->common, s->on_error, true, -ret);
             if (action == BLOCK_ERROR_ACTION_STOP) {
@@ -184,8 +283,10 @@ static int coroutine_fn stream_run(Job *job, Error **errp)
             }
         }
 
-        /* Publish progress */
-        job_progress_update(&s->common.job, n);
+        /* Copied chunks publish their progress on completion */
+        if (!copy) {
+            job_progress_update(&s->common.job, n);
+        }
         if (copy) {
             delay_ns = block_job_ratelimit_get_delay(&s->common, n);
         } else {
@@ -193,6 +294,18 @@ static int coroutine_fn stream_run(Job *job, Error **errp)
         }
     }
 
+    while (s->in_flight > 0) {
+        qemu_co_queue_wait(&s->slot_queue, NULL);
+    }
+
+    if (error == 0 && s->op_ret < 0) {
+        int op_ret = s->op_ret;
+
+        if (stream_handle_op_error(s) != BLOCK_ERROR_ACTION_IGNORE) {
+            error = op_ret;
+        }
+    }
+
     if (enable_cor) {
         bdrv_disable_copy_on_read(bs);
     }
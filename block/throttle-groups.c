@@ -77,6 +77,10 @@ typedef struct ThrottleGroup {
     bool any_timer_armed[2];
     QEMUClockType clock_type;
 
+    /* Incremented (with atomic operations) on every configuration change,
+     * invalidating the members' token caches */
+    int token_cache_gen;
+
     /* This field is protected by the global QEMU mutex */
     QTAILQ_ENTRY(ThrottleGroup) list;
 } ThrottleGroup;
@@ -349,6 +353,109 @@ static void schedule_next_request(ThrottleGroupMember *tgm, bool is_write)
     }
 }
 
+/* Try to serve an I/O request from the member's token cache, without
+ * taking the group's lock.
+ *
+ * The cache is spent and refilled only from the member's own AioContext,
+ * where all of its requests are submitted, so plain accesses are enough;
+ * only the group's generation counter, which other threads bump when the
+ * configuration changes, needs an atomic read. For the same reason the
+ * racy read of pending_reqs is safe: it is only incremented from this
+ * AioContext.
+ *
+ * The cached tokens have already been accounted to the group, so admitting
+ * I/O with them never exceeds the configured limits. Requests go through
+ * the slow path whenever the member has queued requests, to preserve their
+ * ordering.
+ *
+ * @tgm:       the current ThrottleGroupMember
+ * @bytes:     the number of bytes for this I/O
+ * @is_write:  the type of operation (read/write)
+ * @ret:       whether the request has been fully accounted for and can
+ *             proceed immediately
+ */
+static bool throttle_group_try_cached_tokens(ThrottleGroupMember *tgm,
+                                             unsigned int bytes,
+                                             bool is_write)
+{
+    ThrottleGroup *tg = container_of(tgm->throttle_state, ThrottleGroup, ts);
+    uint64_t ops_cost = 1;
+
+    if (tgm->token_cache_gen != atomic_read(&tg->token_cache_gen)) {
+        return false;
+    }
+
+    if (tgm_has_pending_reqs(tgm, is_write)) {
+        return false;
+    }
+
+    /* Overestimate the cost in operations: unused tokens remain accounted
+     * to the group, they never allow extra I/O. */
+    if (tgm->token_cache_op_size && bytes > tgm->token_cache_op_size) {
+        ops_cost = DIV_ROUND_UP(bytes, tgm->token_cache_op_size);
+    }
+
+    if (tgm->token_cache_bytes[is_write] < bytes ||
+        tgm->token_cache_ops[is_write] < ops_cost) {
+        return false;
+    }
+
+    if (tgm->token_cache_bytes[is_write] != UINT64_MAX) {
+        tgm->token_cache_bytes[is_write] -= bytes;
+    }
+    if (tgm->token_cache_ops[is_write] != UINT64_MAX) {
+        tgm->token_cache_ops[is_write] -= ops_cost;
+    }
+
+    return true;
+}
+
+/* Refill the member's token cache by withdrawing a batch of tokens from
+ * the group's ThrottleState.
+ *
+ * No tokens are handed out while a timer is armed or the member has queued
+ * requests, so cache hits cannot overtake throttled requests, and
+ * throttle_account_lease() never grants more than the buckets can absorb
+ * without making the next request wait.
+ *
+ * This assumes that tg->lock is held and that the caller runs in the
+ * member's AioContext.
+ *
+ * @tgm:       the current ThrottleGroupMember
+ * @is_write:  the type of operation (read/write)
+ */
+static void throttle_group_refill_token_cache(ThrottleGroupMember *tgm,
+                                              bool is_write)
+{
+    ThrottleState *ts = tgm->throttle_state;
+    ThrottleGroup *tg = container_of(ts, ThrottleGroup, ts);
+    uint64_t grant_bytes, grant_ops;
+
+    if (tg->any_timer_armed[is_write] || tgm_has_pending_reqs(tgm, is_write)) {
+        return;
+    }
+
+    throttle_account_lease(ts, is_write, &grant_bytes, &grant_ops);
+
+    /* Tokens left over from a previous batch are already accounted for,
+     * so put them back into the cache unless the configuration changed */
+    if (tgm->token_cache_gen == atomic_read(&tg->token_cache_gen)) {
+        if (grant_bytes != UINT64_MAX &&
+            tgm->token_cache_bytes[is_write] != UINT64_MAX) {
+            grant_bytes += tgm->token_cache_bytes[is_write];
+        }
+        if (grant_ops != UINT64_MAX &&
+            tgm->token_cache_ops[is_write] != UINT64_MAX) {
+            grant_ops += tgm->token_cache_ops[is_write];
+        }
+    }
+
+    tgm->token_cache_gen = atomic_read(&tg->token_cache_gen);
+    tgm->token_cache_op_size = ts->cfg.op_size;
+    tgm->token_cache_bytes[is_write] = grant_bytes;
+    tgm->token_cache_ops[is_write] = grant_ops;
+}
+
 /* Check if an I/O request needs to be throttled, wait and set a timer
  * if necessary, and schedule the next request using a round robin
  * algorithm.
@@ -364,6 +471,13 @@ void coroutine_fn throttle_group_co_io_limits_intercept(ThrottleGroupMember *tgm
     bool must_wait;
     ThrottleGroupMember *token;
     ThrottleGroup *tg = container_of(tgm->throttle_state, ThrottleGroup, ts);
+
+    /* Lockless fast path: serve the request entirely from the member's
+     * token cache */
+    if (throttle_group_try_cached_tokens(tgm, bytes, is_write)) {
+        return;
+    }
+
     qemu_mutex_lock(&tg->lock);
 
     /* First we check if this I/O has to be throttled. */
@@ -385,6 +499,9 @@ void coroutine_fn throttle_group_co_io_limits_intercept(ThrottleGroupMember *tgm
     /* The I/O will be executed, so do the accounting */
     throttle_account(tgm->throttle_state, is_write, bytes);
 
+    /* Withdraw the next batch of tokens while we hold the lock anyway */
+    throttle_group_refill_token_cache(tgm, is_write);
+
     /* Schedule the next request */
     schedule_next_request(tgm, is_write);
 
@@ -472,6 +589,8 @@ void throttle_group_config(ThrottleGroupMember *tgm, ThrottleConfig *cfg)
     ThrottleGroup *tg = container_of(ts, ThrottleGroup, ts);
     qemu_mutex_lock(&tg->lock);
     throttle_config(ts, tg->clock_type, cfg);
+    /* Invalidate all members' token caches */
+    atomic_inc(&tg->token_cache_gen);
     qemu_mutex_unlock(&tg->lock);
 
     throttle_group_restart_tgm(tgm);
@@ -546,6 +665,14 @@ void throttle_group_register_tgm(ThrottleGroupMember *tgm,
     tgm->aio_context = ctx;
     atomic_set(&tgm->restart_pending, 0);
 
+    /* The token cache starts out empty */
+    tgm->token_cache_gen = atomic_read(&tg->token_cache_gen);
+    tgm->token_cache_op_size = 0;
+    for (i = 0; i < 2; i++) {
+        tgm->token_cache_bytes[i] = 0;
+        tgm->token_cache_ops[i] = 0;
+    }
+
     qemu_mutex_lock(&tg->lock);
     /* If the ThrottleGroup is new set this ThrottleGroupMember as the token */
     for (i = 0; i < 2; i++) {
@@ -907,6 +1034,8 @@ static void throttle_group_set_limits(Object *obj, Visitor *v,
         goto unlock;
     }
     throttle_config(&tg->ts, tg->clock_type, &cfg);
+    /* Invalidate all members' token caches */
+    atomic_inc(&tg->token_cache_gen);
 
 unlock:
     qemu_mutex_unlock(&tg->lock);
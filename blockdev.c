@@ -773,6 +773,7 @@ DriveInfo *drive_new(QemuOpts *all_opts, BlockInterfaceType block_default_type,
     bool copy_on_read;
     const char *filename;
     Error *local_err = NULL;
+    int64_t open_start_us;
     int i;
 
     /* Change legacy command line options into QMP ones */
@@ -986,6 +987,7 @@ DriveInfo *drive_new(QemuOpts *all_opts, BlockInterfaceType block_default_type,
     }
 
     /* Actual block device init: Functionality shared with blockdev-add */
+    open_start_us = g_get_monotonic_time();
     blk = blockdev_init(filename, bs_opts, &local_err);
     bs_opts = NULL;
     if (!blk) {
@@ -994,6 +996,8 @@ DriveInfo *drive_new(QemuOpts *all_opts, BlockInterfaceType block_default_type,
     } else {
         assert(!local_err);
     }
+    trace_drive_new_open(filename ? filename : "",
+                         g_get_monotonic_time() - open_start_us);
 
     /* Create legacy DriveInfo */
     dinfo = g_malloc0(sizeof(*dinfo));
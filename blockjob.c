@@ -24,6 +24,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "block/accounting.h"
 #include "block/block.h"
 #include "block/blockjob_int.h"
 #include "block/block_int.h"
@@ -277,12 +278,22 @@ void block_job_set_speed(BlockJob *job, int64_t speed, Error **errp)
     job_enter_cond(&job->job, job_timer_pending);
 }
 
+/* If the guest has not touched any block device for this long, speed
+ * limits are lifted: they exist to protect guest I/O latency, and with
+ * no guest I/O there is nobody to protect, so use the idle bandwidth.
+ */
+#define BLOCK_JOB_IDLE_BOOST_NS (NANOSECONDS_PER_SECOND / 10)
+
 int64_t block_job_ratelimit_get_delay(BlockJob *job, uint64_t n)
 {
     if (!job->speed) {
         return 0;
     }
 
+    if (block_acct_guest_idle_ns() >= BLOCK_JOB_IDLE_BOOST_NS) {
+        return 0;
+    }
+
     return ratelimit_calculate_delay(&job->limit, n);
 }
 
@@ -106,6 +106,89 @@ static void qemu_chr_write_log(Chardev *s, const uint8_t *buf, size_t len)
     }
 }
 
+/*
+ * Push out buffered ring data.  Called with chr_write_lock held.
+ * Returns 0 once the ring is empty, a negative value otherwise; on
+ * errors other than EAGAIN the buffered data is dropped, as failed
+ * unbuffered writes are.
+ */
+static int qemu_chr_write_ring_flush(Chardev *s)
+{
+    ChardevClass *cc = CHARDEV_GET_CLASS(s);
+
+    while (s->wbuf_len) {
+        size_t chunk = MIN(s->wbuf_len, s->wbuf_size - s->wbuf_head);
+        int res = cc->chr_write(s, s->wbuf + s->wbuf_head, chunk);
+
+        if (res < 0 && errno != EAGAIN) {
+            s->wbuf_head = s->wbuf_len = 0;
+            return res;
+        }
+        if (res <= 0) {
+            return -1;
+        }
+        s->wbuf_head = (s->wbuf_head + res) % s->wbuf_size;
+        s->wbuf_len -= res;
+    }
+    return 0;
+}
+
+static gboolean qemu_chr_write_ring_drain(GIOChannel *chan, GIOCondition cond,
+                                          void *opaque)
+{
+    Chardev *s = opaque;
+    gboolean rearm;
+
+    qemu_mutex_lock(&s->chr_write_lock);
+    qemu_chr_write_ring_flush(s);
+    rearm = s->wbuf_len != 0;
+    if (!rearm) {
+        /* returning FALSE removes the source from its context */
+        g_source_unref(s->wbuf_src);
+        s->wbuf_src = NULL;
+    }
+    qemu_mutex_unlock(&s->chr_write_lock);
+
+    return rearm;
+}
+
+/*
+ * Queue as much of @buf as fits behind the data already in the ring
+ * and make sure a drain watch is armed.  Called with chr_write_lock
+ * held.  Returns the number of bytes queued, or -1 with errno set to
+ * EAGAIN when the ring is full.
+ */
+static int qemu_chr_write_ring_append(Chardev *s, const uint8_t *buf, int len)
+{
+    size_t avail = s->wbuf_size - s->wbuf_len;
+    size_t pos, first, n;
+
+    if (!avail) {
+        errno = EAGAIN;
+        return -1;
+    }
+    n = MIN((size_t)len, avail);
+    pos = (s->wbuf_head + s->wbuf_len) % s->wbuf_size;
+    first = MIN(n, s->wbuf_size - pos);
+    memcpy(s->wbuf + pos, buf, first);
+    memcpy(s->wbuf, buf + first, n - first);
+    s->wbuf_len += n;
+
+    if (!s->wbuf_src) {
+        ChardevClass *cc = CHARDEV_GET_CLASS(s);
+        GSource *src = cc->chr_add_watch(s, G_IO_OUT | G_IO_HUP);
+
+        if (src) {
+            g_source_set_callback(src, (GSourceFunc)qemu_chr_write_ring_drain,
+                                  s, NULL);
+            g_source_attach(src, s->gcontext);
+            /* keep our reference so teardown can g_source_destroy() it */
+            s->wbuf_src = src;
+        }
+    }
+    return n;
+}
+
 static int qemu_chr_write_buffer(Chardev *s,
                                  const uint8_t *buf, int len,
                                  int *offset, bool write_all)
@@ -117,10 +200,30 @@ static int qemu_chr_write_buffer(Chardev *s,
     qemu_mutex_lock(&s->chr_write_lock);
     while (*offset < len) {
     retry:
-        res = cc->chr_write(s, buf + *offset, len - *offset);
-        if (res < 0 && errno == EAGAIN && write_all) {
-            g_usleep(100);
-            goto retry;
+        if (s->wbuf && s->wbuf_len) {
+            /* Ring data drains first; append behind it to keep order. */
+            res = qemu_chr_write_ring_append(s, buf + *offset, len - *offset);
+            if (res < 0 && write_all) {
+                /*
+                 * The ring is full and we must not return short.  Flush
+                 * synchronously: the event-loop drain may be unable to
+                 * run while this thread holds the BQL.
+                 */
+                if (qemu_chr_write_ring_flush(s) < 0) {
+                    g_usleep(100);
+                }
+                goto retry;
+            }
+        } else {
+            res = cc->chr_write(s, buf + *offset, len - *offset);
+            if (res < 0 && errno == EAGAIN && s->wbuf) {
+                res = qemu_chr_write_ring_append(s, buf + *offset,
+                                                 len - *offset);
+            }
+            if (res < 0 && errno == EAGAIN && write_all) {
+                g_usleep(100);
+                goto retry;
+            }
         }
 
         if (res <= 0) {
@@ -239,6 +342,16 @@ static void qemu_char_open(Chardev *chr, ChardevBackend *backend,
         }
     }
 
+    if (common && common->has_write_buffer && common->write_buffer) {
+        if (!cc->chr_add_watch) {
+            error_setg(errp, "write-buffer is not supported by %s",
+                       object_get_typename(OBJECT(chr)));
+            return;
+        }
+        chr->wbuf_size = common->write_buffer;
+        chr->wbuf = g_malloc(chr->wbuf_size);
+    }
+
     if (cc->open) {
         cc->open(chr, backend, be_opened, errp);
     }
@@ -283,6 +396,11 @@ static void char_finalize(Object *obj)
     }
     g_free(chr->filename);
     g_free(chr->label);
+    if (chr->wbuf_src) {
+        g_source_destroy(chr->wbuf_src);
+        g_source_unref(chr->wbuf_src);
+    }
+    g_free(chr->wbuf);
     if (chr->logfd != -1) {
         close(chr->logfd);
     }
@@ -514,6 +632,9 @@ void qemu_chr_parse_common(QemuOpts *opts, ChardevCommon *backend)
 
     backend->has_logappend = true;
     backend->logappend = qemu_opt_get_bool(opts, "logappend", false);
+
+    backend->has_write_buffer = qemu_opt_find(opts, "write-buffer") != NULL;
+    backend->write_buffer = qemu_opt_get_size(opts, "write-buffer", 0);
 }
 
 static const ChardevClass *char_get_class(const char *driver, Error **errp)
@@ -939,6 +1060,9 @@ QemuOptsList qemu_chardev_opts = {
         },{
             .name = "logappend",
             .type = QEMU_OPT_BOOL,
+        },{
+            .name = "write-buffer",
+            .type = QEMU_OPT_SIZE,
         },
         { /* end of list */ }
     },
@@ -107,8 +107,11 @@ struct qemu_work_item {
 
 static void queue_work_on_cpu(CPUState *cpu, struct qemu_work_item *wi)
 {
+    bool was_empty;
+
     qemu_mutex_lock(&cpu->work_mutex);
-    if (cpu->queued_work_first == NULL) {
+    was_empty = cpu->queued_work_first == NULL;
+    if (was_empty) {
         cpu->queued_work_first = wi;
     } else {
         cpu->queued_work_last->next = wi;
@@ -118,7 +121,16 @@ static void queue_work_on_cpu(CPUState *cpu, struct qemu_work_item *wi)
     wi->done = false;
     qemu_mutex_unlock(&cpu->work_mutex);
 
-    qemu_cpu_kick(cpu);
+    /*
+     * If the queue was not empty, the target has already been kicked for
+     * an earlier item and drains the whole queue when it reacts; the item
+     * we just appended under work_mutex is guaranteed to be seen by that
+     * drain.  Bursts of work (e.g. a guest invalidating a range of TLB
+     * pages across vCPUs) thus collapse into a single wakeup.
+     */
+    if (was_empty) {
+        qemu_cpu_kick(cpu);
+    }
 }
 
 void do_run_on_cpu(CPUState *cpu, run_on_cpu_func func, run_on_cpu_data data,
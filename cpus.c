@@ -53,6 +53,7 @@
 #include "qemu/bitmap.h"
 #include "qemu/seqlock.h"
 #include "qemu/guest-random.h"
+#include "qemu/rcu.h"
 #include "tcg/tcg.h"
 #include "hw/nmi.h"
 #include "sysemu/replay.h"
@@ -90,6 +91,11 @@ static unsigned int throttle_percentage;
 #define CPU_THROTTLE_PCT_MIN 1
 #define CPU_THROTTLE_PCT_MAX 99
 #define CPU_THROTTLE_TIMESLICE_NS 10000000
+/* Longest uninterrupted stall one throttle cycle may impose on a vcpu */
+#define CPU_THROTTLE_MAX_SLEEP_NS 2000000
+
+/* Duty-cycle period currently in use, written by the timer tick */
+static unsigned int throttle_period_us;
 
 bool cpu_is_stopped(CPUState *cpu)
 {
@@ -709,20 +715,29 @@ static const VMStateDescription vmstate_timers = {
     }
 };
 
+static int cpu_throttle_get_effective_percentage(CPUState *cpu)
+{
+    int pct = atomic_read(&cpu->throttle_percentage);
+
+    return pct ? pct : cpu_throttle_get_percentage();
+}
+
 static void cpu_throttle_thread(CPUState *cpu, run_on_cpu_data opaque)
 {
     double pct;
-    double throttle_ratio;
     int64_t sleeptime_ns, endtime_ns;
 
-    if (!cpu_throttle_get_percentage()) {
+    pct = (double)cpu_throttle_get_effective_percentage(cpu) / 100;
+    if (!pct) {
+        atomic_set(&cpu->throttle_thread_scheduled, 0);
         return;
     }
 
-    pct = (double)cpu_throttle_get_percentage()/100;
-    throttle_ratio = pct / (1 - pct);
-    /* Add 1ns to fix double's rounding error (like 0.9999999...) */
-    sleeptime_ns = (int64_t)(throttle_ratio * CPU_THROTTLE_TIMESLICE_NS + 1);
+    /* Sleep for the throttled share of the current duty-cycle period.
+     * Add 1ns to fix double's rounding error (like 0.9999999...)
+     */
+    sleeptime_ns =
+        (int64_t)(pct * atomic_read(&throttle_period_us) * SCALE_US + 1);
     endtime_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME) + sleeptime_ns;
     while (sleeptime_ns > 0 && !cpu->stop) {
         if (sleeptime_ns > SCALE_MS) {
@@ -742,21 +757,43 @@ static void cpu_throttle_timer_tick(void *opaque)
 {
     CPUState *cpu;
     double pct;
+    int max_pct;
+    int64_t period_ns;
 
+    max_pct = cpu_throttle_get_percentage();
+    CPU_FOREACH(cpu) {
+        max_pct = MAX(max_pct, cpu_throttle_get_vcpu_percentage(cpu));
+    }
     /* Stop the timer if needed */
-    if (!cpu_throttle_get_percentage()) {
+    if (!max_pct) {
         return;
     }
+
+    /*
+     * Size the duty-cycle period so that the unthrottled share keeps the
+     * historical 10ms timeslice, but never let a single sleep exceed
+     * CPU_THROTTLE_MAX_SLEEP_NS: at high percentages shrink the period
+     * instead, turning one long stall into many short ones.
+     */
+    pct = (double)max_pct / 100;
+    period_ns = (int64_t)(CPU_THROTTLE_TIMESLICE_NS / (1 - pct));
+    if (pct * period_ns > CPU_THROTTLE_MAX_SLEEP_NS) {
+        period_ns = (int64_t)(CPU_THROTTLE_MAX_SLEEP_NS / pct);
+    }
+    atomic_set(&throttle_period_us, period_ns / SCALE_US);
+
     CPU_FOREACH(cpu) {
+        if (!cpu_throttle_get_effective_percentage(cpu)) {
+            continue;
+        }
         if (!atomic_xchg(&cpu->throttle_thread_scheduled, 1)) {
             async_run_on_cpu(cpu, cpu_throttle_thread,
                              RUN_ON_CPU_NULL);
         }
     }
 
-    pct = (double)cpu_throttle_get_percentage()/100;
     timer_mod(throttle_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL_RT) +
-                                   CPU_THROTTLE_TIMESLICE_NS / (1-pct));
+                                   period_ns);
 }
 
 void cpu_throttle_set(int new_throttle_pct)
@@ -771,6 +808,27 @@ void cpu_throttle_set(int new_throttle_pct)
                                        CPU_THROTTLE_TIMESLICE_NS);
 }
 
+void cpu_throttle_set_vcpu(CPUState *cpu, int new_throttle_pct)
+{
+    if (new_throttle_pct) {
+        /* Ensure throttle percentage is within valid range */
+        new_throttle_pct = MIN(new_throttle_pct, CPU_THROTTLE_PCT_MAX);
+        new_throttle_pct = MAX(new_throttle_pct, CPU_THROTTLE_PCT_MIN);
+    }
+
+    atomic_set(&cpu->throttle_percentage, new_throttle_pct);
+
+    if (new_throttle_pct) {
+        timer_mod(throttle_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL_RT) +
+                                           CPU_THROTTLE_TIMESLICE_NS);
+    }
+}
+
+int cpu_throttle_get_vcpu_percentage(CPUState *cpu)
+{
+    return atomic_read(&cpu->throttle_percentage);
+}
+
 void cpu_throttle_stop(void)
 {
     atomic_set(&throttle_percentage, 0);
@@ -1316,10 +1374,15 @@ static int64_t tcg_get_icount_limit(void)
          */
         deadline = qemu_clock_deadline_ns_all(QEMU_CLOCK_VIRTUAL,
                                               QEMU_TIMER_ATTR_ALL);
-        /* Check realtime timers, because they help with input processing */
-        deadline = qemu_soonest_timeout(deadline,
-                qemu_clock_deadline_ns_all(QEMU_CLOCK_REALTIME,
-                                           QEMU_TIMER_ATTR_ALL));
+        /* Check realtime timers, because they help with input processing.
+         * No realtime deadline can beat an already expired virtual one,
+         * so don't bother scanning a second clock in that case.
+         */
+        if (deadline != 0) {
+            deadline = qemu_soonest_timeout(deadline,
+                    qemu_clock_deadline_ns_all(QEMU_CLOCK_REALTIME,
+                                               QEMU_TIMER_ATTR_ALL));
+        }
 
         /* Maintain prior (possibly buggy) behaviour where if no deadline
          * was set (as there is no QEMU_CLOCK_VIRTUAL timer) or it is more than
@@ -1428,6 +1491,15 @@ static void deal_with_unplugged_cpus(void)
     }
 }
 
+static void rr_force_rcu(Notifier *notify, void *data)
+{
+    /* The round robin vCPU thread is stuck in a read-side critical
+     * section; kick whichever vCPU it is currently running so that it
+     * returns to the main loop and reaches a quiescent state.
+     */
+    qemu_cpu_kick_rr_next_cpu();
+}
+
 /* Single-threaded TCG
  *
  * In the single-threaded case each vCPU is simulated in turn. If
@@ -1439,10 +1511,13 @@ static void deal_with_unplugged_cpus(void)
 
 static void *qemu_tcg_rr_cpu_thread_fn(void *arg)
 {
+    Notifier force_rcu;
     CPUState *cpu = arg;
 
     assert(tcg_enabled());
     rcu_register_thread();
+    force_rcu.notify = rr_force_rcu;
+    rcu_add_force_rcu_notifier(&force_rcu);
     tcg_register_thread();
 
     qemu_mutex_lock_iothread();
@@ -1547,6 +1622,7 @@ static void *qemu_tcg_rr_cpu_thread_fn(void *arg)
         deal_with_unplugged_cpus();
     }
 
+    rcu_remove_force_rcu_notifier(&force_rcu);
     rcu_unregister_thread();
     return NULL;
 }
@@ -1683,14 +1759,34 @@ static void CALLBACK dummy_apc_func(ULONG_PTR unused)
  * current CPUState for a given thread.
  */
 
+typedef struct MttcgForceRcuNotifier {
+    Notifier notifier;
+    CPUState *cpu;
+} MttcgForceRcuNotifier;
+
+static void mttcg_force_rcu(Notifier *notify, void *data)
+{
+    CPUState *cpu = container_of(notify, MttcgForceRcuNotifier, notifier)->cpu;
+
+    /* Called from another thread; the vCPU may be executing a tight
+     * loop of translated code without ever leaving its read-side
+     * critical section, so kick it out.
+     */
+    cpu_exit(cpu);
+}
+
 static void *qemu_tcg_cpu_thread_fn(void *arg)
 {
+    MttcgForceRcuNotifier force_rcu;
     CPUState *cpu = arg;
 
     assert(tcg_enabled());
     g_assert(!use_icount);
 
     rcu_register_thread();
+    force_rcu.notifier.notify = mttcg_force_rcu;
+    force_rcu.cpu = cpu;
+    rcu_add_force_rcu_notifier(&force_rcu.notifier);
     tcg_register_thread();
 
     qemu_mutex_lock_iothread();
@@ -1744,6 +1840,7 @@ static void *qemu_tcg_cpu_thread_fn(void *arg)
     cpu->created = false;
     qemu_cond_signal(&qemu_cpu_cond);
     qemu_mutex_unlock_iothread();
+    rcu_remove_force_rcu_notifier(&force_rcu.notifier);
     rcu_unregister_thread();
     return NULL;
 }
@@ -37,6 +37,75 @@ int dma_memory_set(AddressSpace *as, dma_addr_t addr, uint8_t c, dma_addr_t len)
     return error;
 }
 
+void dma_map_cache_init(DMAMapCache *cache, AddressSpace *as)
+{
+    cache->as = as;
+    cache->fv = NULL;
+    cache->addr = 0;
+    cache->len = 0;
+    cache->ptr = NULL;
+}
+
+void dma_map_cache_invalidate(DMAMapCache *cache)
+{
+    if (cache->ptr) {
+        dma_memory_unmap(cache->as, cache->ptr, cache->len,
+                         DMA_DIRECTION_TO_DEVICE, 0);
+        cache->ptr = NULL;
+        cache->fv = NULL;
+    }
+}
+
+void *dma_map_cache_read(DMAMapCache *cache, dma_addr_t addr, dma_addr_t *len)
+{
+    struct FlatView *fv;
+    MemoryRegion *mr;
+    hwaddr xlat, plen;
+    dma_addr_t requested = *len;
+    dma_addr_t mapped = *len;
+    void *ptr;
+
+    if (cache->ptr && addr == cache->addr && requested <= cache->len &&
+        address_space_to_flatview(cache->as) == cache->fv) {
+        return cache->ptr;
+    }
+
+    dma_map_cache_invalidate(cache);
+
+    RCU_READ_LOCK_GUARD();
+    fv = address_space_to_flatview(cache->as);
+    ptr = dma_memory_map(cache->as, addr, &mapped,
+                         DMA_DIRECTION_TO_DEVICE);
+    *len = mapped;
+    if (!ptr || mapped < requested ||
+        address_space_to_flatview(cache->as) != fv) {
+        /* Short mapping, or raced with a topology change: don't cache.
+         * dma_map_cache_finish() unmaps pointers it doesn't own. */
+        return ptr;
+    }
+
+    /* Don't hold on to a bounce buffer mapping */
+    plen = mapped;
+    mr = address_space_translate(cache->as, addr, &xlat, &plen, false,
+                                 MEMTXATTRS_UNSPECIFIED);
+    if (!memory_access_is_direct(mr, false)) {
+        return ptr;
+    }
+
+    cache->fv = fv;
+    cache->addr = addr;
+    cache->len = mapped;
+    cache->ptr = ptr;
+    return ptr;
+}
+
+void dma_map_cache_finish(DMAMapCache *cache, void *ptr, dma_addr_t len)
+{
+    if (ptr && ptr != cache->ptr) {
+        dma_memory_unmap(cache->as, ptr, len, DMA_DIRECTION_TO_DEVICE, len);
+    }
+}
+
 void qemu_sglist_init(QEMUSGList *qsg, DeviceState *dev, int alloc_hint,
                       AddressSpace *as)
 {
@@ -68,6 +137,31 @@ void qemu_sglist_destroy(QEMUSGList *qsg)
     memset(qsg, 0, sizeof(*qsg));
 }
 
+/*
+ * address_space_map() has a single global bounce buffer, so two requests
+ * that both touch MMIO serialize on it (and on the map-client wait that
+ * follows).  Bounce through a small pool of our own buffers instead.
+ */
+#define DMA_BOUNCE_BUFFER_SIZE 4096
+#define DMA_BOUNCE_POOL_SIZE 8
+
+typedef struct DMABounceBuffer {
+    void *host;
+    dma_addr_t addr;
+    dma_addr_t len;
+    QSIMPLEQ_ENTRY(DMABounceBuffer) next;
+} DMABounceBuffer;
+
+static QemuMutex dma_bounce_pool_lock;
+static QSIMPLEQ_HEAD(, DMABounceBuffer) dma_bounce_pool =
+    QSIMPLEQ_HEAD_INITIALIZER(dma_bounce_pool);
+static unsigned int dma_bounce_pool_count;
+
+static void __attribute__((constructor)) dma_bounce_pool_init(void)
+{
+    qemu_mutex_init(&dma_bounce_pool_lock);
+}
+
 typedef struct {
     BlockAIOCB common;
     AioContext *ctx;
@@ -79,6 +173,7 @@ typedef struct {
     int sg_cur_index;
     dma_addr_t sg_cur_byte;
     QEMUIOVector iov;
+    QSIMPLEQ_HEAD(, DMABounceBuffer) bounce;
     QEMUBH *bh;
     DMAIOFunc *io_func;
     void *io_func_opaque;
@@ -96,14 +191,70 @@ static void reschedule_dma(void *opaque)
     dma_blk_cb(dbs, 0);
 }
 
+static void *dma_blk_bounce_map(DMAAIOCB *dbs, dma_addr_t addr,
+                                dma_addr_t *len)
+{
+    DMABounceBuffer *bounce = NULL;
+
+    qemu_mutex_lock(&dma_bounce_pool_lock);
+    if (!QSIMPLEQ_EMPTY(&dma_bounce_pool)) {
+        bounce = QSIMPLEQ_FIRST(&dma_bounce_pool);
+        QSIMPLEQ_REMOVE_HEAD(&dma_bounce_pool, next);
+        dma_bounce_pool_count--;
+    }
+    qemu_mutex_unlock(&dma_bounce_pool_lock);
+
+    if (!bounce) {
+        bounce = g_new(DMABounceBuffer, 1);
+        bounce->host = g_malloc(DMA_BOUNCE_BUFFER_SIZE);
+    }
+    *len = MIN(*len, DMA_BOUNCE_BUFFER_SIZE);
+    bounce->addr = addr;
+    bounce->len = *len;
+    if (dbs->dir == DMA_DIRECTION_TO_DEVICE) {
+        dma_memory_read(dbs->sg->as, addr, bounce->host, *len);
+    }
+    QSIMPLEQ_INSERT_TAIL(&dbs->bounce, bounce, next);
+    return bounce->host;
+}
+
+static void dma_blk_bounce_unmap(DMAAIOCB *dbs, DMABounceBuffer *bounce,
+                                 dma_addr_t access_len)
+{
+    if (dbs->dir == DMA_DIRECTION_FROM_DEVICE) {
+        dma_memory_write(dbs->sg->as, bounce->addr, bounce->host, access_len);
+    }
+
+    qemu_mutex_lock(&dma_bounce_pool_lock);
+    if (dma_bounce_pool_count < DMA_BOUNCE_POOL_SIZE) {
+        QSIMPLEQ_INSERT_HEAD(&dma_bounce_pool, bounce, next);
+        dma_bounce_pool_count++;
+        bounce = NULL;
+    }
+    qemu_mutex_unlock(&dma_bounce_pool_lock);
+
+    if (bounce) {
+        g_free(bounce->host);
+        g_free(bounce);
+    }
+}
+
 static void dma_blk_unmap(DMAAIOCB *dbs)
 {
     int i;
 
     for (i = 0; i < dbs->iov.niov; ++i) {
-        dma_memory_unmap(dbs->sg->as, dbs->iov.iov[i].iov_base,
-                         dbs->iov.iov[i].iov_len, dbs->dir,
-                         dbs->iov.iov[i].iov_len);
+        DMABounceBuffer *bounce = QSIMPLEQ_FIRST(&dbs->bounce);
+
+        /* Bounce buffers were appended in iovec order. */
+        if (bounce && bounce->host == dbs->iov.iov[i].iov_base) {
+            QSIMPLEQ_REMOVE_HEAD(&dbs->bounce, next);
+            dma_blk_bounce_unmap(dbs, bounce, dbs->iov.iov[i].iov_len);
+        } else {
+            dma_memory_unmap(dbs->sg->as, dbs->iov.iov[i].iov_base,
+                             dbs->iov.iov[i].iov_len, dbs->dir,
+                             dbs->iov.iov[i].iov_len);
+        }
     }
     qemu_iovec_reset(&dbs->iov);
 }
@@ -142,6 +293,11 @@ static void dma_blk_cb(void *opaque, int ret)
         cur_addr = dbs->sg->sg[dbs->sg_cur_index].base + dbs->sg_cur_byte;
         cur_len = dbs->sg->sg[dbs->sg_cur_index].len - dbs->sg_cur_byte;
         mem = dma_memory_map(dbs->sg->as, cur_addr, &cur_len, dbs->dir);
+        if (!mem) {
+            /* The global bounce buffer is taken; use a pooled one. */
+            trace_dma_blk_bounce(dbs, cur_addr, cur_len);
+            mem = dma_blk_bounce_map(dbs, cur_addr, &cur_len);
+        }
         if (!mem)
             break;
         qemu_iovec_add(&dbs->iov, mem, cur_len);
@@ -229,6 +385,7 @@ BlockAIOCB *dma_blk_io(AioContext *ctx,
     dbs->io_func_opaque = io_func_opaque;
     dbs->bh = NULL;
     qemu_iovec_init(&dbs->iov, sg->nsg);
+    QSIMPLEQ_INIT(&dbs->bounce);
     dma_blk_cb(dbs, 0);
     return &dbs->common;
 }
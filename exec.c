@@ -141,8 +141,16 @@ typedef struct PhysPageMap {
     MemoryRegionSection *sections;
 } PhysPageMap;
 
+#define PHYS_MRU_SECTIONS 4
+
 struct AddressSpaceDispatch {
-    MemoryRegionSection *mru_section;
+    /*
+     * Small most-recently-used cache in front of the phys_map walk.
+     * The entries live inside the dispatch, which is swapped wholesale
+     * under RCU on topology changes, so no generation check is needed.
+     */
+    MemoryRegionSection *mru_sections[PHYS_MRU_SECTIONS];
+    unsigned mru_next;
     /* This is a multi-level map on the physical address space.
      * The bottom level has pointers to MemoryRegionSections.
      */
@@ -355,13 +363,26 @@ static MemoryRegionSection *address_space_lookup_region(AddressSpaceDispatch *d,
                                                         hwaddr addr,
                                                         bool resolve_subpage)
 {
-    MemoryRegionSection *section = atomic_read(&d->mru_section);
+    MemoryRegionSection *section = NULL;
     subpage_t *subpage;
+    unsigned i;
 
-    if (!section || section == &d->map.sections[PHYS_SECTION_UNASSIGNED] ||
-        !section_covers_addr(section, addr)) {
+    for (i = 0; i < PHYS_MRU_SECTIONS; i++) {
+        MemoryRegionSection *mru = atomic_read(&d->mru_sections[i]);
+
+        if (mru && section_covers_addr(mru, addr)) {
+            section = mru;
+            break;
+        }
+    }
+    if (!section) {
         section = phys_page_find(d, addr);
-        atomic_set(&d->mru_section, section);
+        if (section != &d->map.sections[PHYS_SECTION_UNASSIGNED]) {
+            /* Benign race: the worst case is a duplicated entry.  */
+            i = d->mru_next;
+            d->mru_next = (i + 1) % PHYS_MRU_SECTIONS;
+            atomic_set(&d->mru_sections[i], section);
+        }
     }
     if (resolve_subpage && section->mr->subpage) {
         subpage = container_of(section->mr, subpage_t, iomem);
@@ -3347,15 +3368,23 @@ void cpu_flush_icache_range(hwaddr start, hwaddr len)
                                      NULL, len, FLUSH_CACHE);
 }
 
-typedef struct {
+typedef struct BounceBuffer {
     MemoryRegion *mr;
-    void *buffer;
     hwaddr addr;
     hwaddr len;
-    bool in_use;
+    QLIST_ENTRY(BounceBuffer) link;
+    uint8_t buffer[];
 } BounceBuffer;
 
-static BounceBuffer bounce;
+/* Cap on the total bounce buffer memory per address space; a map that
+ * would exceed it fails and the caller retries via the map clients. */
+#define BOUNCE_BUFFER_TOTAL_MAX (32 * TARGET_PAGE_SIZE)
+
+/* Number of bounce buffers outstanding across all address spaces; used
+ * to decide whether a newly registered map client may be notified
+ * immediately. The per-address-space byte budget lives in the
+ * AddressSpace itself. */
+static unsigned int bounce_buffers_in_use;
 
 typedef struct MapClient {
     QEMUBH *bh;
@@ -3390,7 +3419,7 @@ void cpu_register_map_client(QEMUBH *bh)
     qemu_mutex_lock(&map_client_list_lock);
     client->bh = bh;
     QLIST_INSERT_HEAD(&map_client_list, client, link);
-    if (!atomic_read(&bounce.in_use)) {
+    if (!atomic_read(&bounce_buffers_in_use)) {
         cpu_notify_map_clients_locked();
     }
     qemu_mutex_unlock(&map_client_list_lock);
@@ -3524,24 +3553,34 @@ void *address_space_map(AddressSpace *as,
     mr = flatview_translate(fv, addr, &xlat, &l, is_write, attrs);
 
     if (!memory_access_is_direct(mr, is_write)) {
-        if (atomic_xchg(&bounce.in_use, true)) {
-            return NULL;
-        }
+        BounceBuffer *bounce;
+
         /* Avoid unbounded allocations */
         l = MIN(l, TARGET_PAGE_SIZE);
-        bounce.buffer = qemu_memalign(TARGET_PAGE_SIZE, l);
-        bounce.addr = addr;
-        bounce.len = l;
 
+        qemu_mutex_lock(&as->bounce_lock);
+        if (as->bounce_buffer_size + l > BOUNCE_BUFFER_TOTAL_MAX) {
+            qemu_mutex_unlock(&as->bounce_lock);
+            return NULL;
+        }
+        bounce = g_malloc(sizeof(*bounce) + l);
+        bounce->addr = addr;
+        bounce->len = l;
         memory_region_ref(mr);
-        bounce.mr = mr;
+        bounce->mr = mr;
+        as->bounce_buffer_size += l;
+        QLIST_INSERT_HEAD(&as->bounce_buffers, bounce, link);
+        qemu_mutex_unlock(&as->bounce_lock);
+        atomic_inc(&bounce_buffers_in_use);
+        trace_address_space_map_bounce(as->name, addr, l);
+
         if (!is_write) {
             flatview_read(fv, addr, MEMTXATTRS_UNSPECIFIED,
-                               bounce.buffer, l);
+                               bounce->buffer, l);
         }
 
         *plen = l;
-        return bounce.buffer;
+        return bounce->buffer;
     }
 
 
@@ -3560,7 +3599,19 @@ void *address_space_map(AddressSpace *as,
 void address_space_unmap(AddressSpace *as, void *buffer, hwaddr len,
                          bool is_write, hwaddr access_len)
 {
-    if (buffer != bounce.buffer) {
+    BounceBuffer *bounce;
+
+    qemu_mutex_lock(&as->bounce_lock);
+    QLIST_FOREACH(bounce, &as->bounce_buffers, link) {
+        if (buffer == bounce->buffer) {
+            QLIST_REMOVE(bounce, link);
+            as->bounce_buffer_size -= bounce->len;
+            break;
+        }
+    }
+    qemu_mutex_unlock(&as->bounce_lock);
+
+    if (!bounce) {
         MemoryRegion *mr;
         ram_addr_t addr1;
 
@@ -3576,13 +3627,12 @@ void address_space_unmap(AddressSpace *as, void *buffer, hwaddr len,
         return;
     }
     if (is_write) {
-        address_space_write(as, bounce.addr, MEMTXATTRS_UNSPECIFIED,
-                            bounce.buffer, access_len);
+        address_space_write(as, bounce->addr, MEMTXATTRS_UNSPECIFIED,
+                            bounce->buffer, access_len);
     }
-    qemu_vfree(bounce.buffer);
-    bounce.buffer = NULL;
-    memory_region_unref(bounce.mr);
-    atomic_mb_set(&bounce.in_use, false);
+    memory_region_unref(bounce->mr);
+    g_free(bounce);
+    atomic_dec(&bounce_buffers_in_use);
     cpu_notify_map_clients();
 }
 
@@ -3957,6 +4007,19 @@ void page_size_init(void)
 
 #if !defined(CONFIG_USER_ONLY)
 
+static bool phys_section_is_mru(const AddressSpaceDispatch *d,
+                                const MemoryRegionSection *s)
+{
+    unsigned i;
+
+    for (i = 0; i < PHYS_MRU_SECTIONS; i++) {
+        if (d->mru_sections[i] == s) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static void mtree_print_phys_entries(int start, int end, int skip, int ptr)
 {
     if (start == end - 1) {
@@ -3998,7 +4061,7 @@ void mtree_print_dispatch(AddressSpaceDispatch *d, MemoryRegion *root)
             s->mr->name ? s->mr->name : "(noname)",
             i < ARRAY_SIZE(names) ? names[i] : "",
             s->mr == root ? " [ROOT]" : "",
-            s == d->mru_section ? " [MRU]" : "",
+            phys_section_is_mru(d, s) ? " [MRU]" : "",
             s->mr->is_iommu ? " [iommu]" : "");
 
         if (s->mr->alias) {
@@ -84,6 +84,7 @@ this code that are retained.
  */
 #include "qemu/osdep.h"
 #include <math.h>
+#include <fenv.h>
 #include "qemu/bitops.h"
 #include "fpu/softfloat.h"
 
@@ -241,6 +242,39 @@ static inline bool can_use_fpu(const float_status *s)
                   s->float_rounding_mode == float_round_nearest_even);
 }
 
+/*
+ * When the inexact flag is not set yet we can still use the host FPU,
+ * provided we recover the inexact bit from the host's accrued exceptions
+ * instead of assuming it: clear FE_INEXACT, run the operation, and read
+ * the flag back.  The extra fenv traffic only ever runs until the guest
+ * accrues inexact, at which point can_use_fpu() takes over.
+ */
+static inline bool can_use_fpu_lazy(const float_status *s)
+{
+    if (QEMU_NO_HARDFLOAT) {
+        return false;
+    }
+    return likely(s->float_rounding_mode == float_round_nearest_even);
+}
+
+/*
+ * Compilers do not implement FENV_ACCESS and will happily move an FP
+ * operation across feclearexcept()/fetestexcept() calls.  Round-tripping
+ * an operand through a volatile object pins the operation inside the
+ * cleared-flag window.
+ */
+static inline float f32_fence(float x)
+{
+    volatile float y = x;
+    return y;
+}
+
+static inline double f64_fence(double x)
+{
+    volatile double y = x;
+    return y;
+}
+
 /*
  * Hardfloat generation functions. Each operation can have two flavors:
  * either using softfloat primitives (e.g. float32_is_zero_or_normal) for
@@ -347,12 +381,16 @@ float32_gen2(float32 xa, float32 xb, float_status *s,
              f32_check_fn fast_test, soft_f32_op2_fn fast_op)
 {
     union_float32 ua, ub, ur;
+    bool lazy_inexact = false;
 
     ua.s = xa;
     ub.s = xb;
 
     if (unlikely(!can_use_fpu(s))) {
-        goto soft;
+        if (!can_use_fpu_lazy(s)) {
+            goto soft;
+        }
+        lazy_inexact = true;
     }
 
     float32_input_flush2(&ua.s, &ub.s, s);
@@ -363,7 +401,15 @@ float32_gen2(float32 xa, float32 xb, float_status *s,
         return fast_op(ua.s, ub.s, s);
     }
 
+    if (unlikely(lazy_inexact)) {
+        feclearexcept(FE_INEXACT);
+        ua.h = f32_fence(ua.h);
+        ub.h = f32_fence(ub.h);
+    }
     ur.h = hard(ua.h, ub.h);
+    if (unlikely(lazy_inexact)) {
+        ur.h = f32_fence(ur.h);
+    }
     if (unlikely(f32_is_inf(ur))) {
         s->float_exception_flags |= float_flag_overflow;
     } else if (unlikely(fabsf(ur.h) <= FLT_MIN)) {
@@ -371,6 +417,9 @@ float32_gen2(float32 xa, float32 xb, float_status *s,
             goto soft;
         }
     }
+    if (unlikely(lazy_inexact) && fetestexcept(FE_INEXACT)) {
+        s->float_exception_flags |= float_flag_inexact;
+    }
     return ur.s;
 
  soft:
@@ -384,12 +433,16 @@ float64_gen2(float64 xa, float64 xb, float_status *s,
              f64_check_fn fast_test, soft_f64_op2_fn fast_op)
 {
     union_float64 ua, ub, ur;
+    bool lazy_inexact = false;
 
     ua.s = xa;
     ub.s = xb;
 
     if (unlikely(!can_use_fpu(s))) {
-        goto soft;
+        if (!can_use_fpu_lazy(s)) {
+            goto soft;
+        }
+        lazy_inexact = true;
     }
 
     float64_input_flush2(&ua.s, &ub.s, s);
@@ -400,7 +453,15 @@ float64_gen2(float64 xa, float64 xb, float_status *s,
         return fast_op(ua.s, ub.s, s);
     }
 
+    if (unlikely(lazy_inexact)) {
+        feclearexcept(FE_INEXACT);
+        ua.h = f64_fence(ua.h);
+        ub.h = f64_fence(ub.h);
+    }
     ur.h = hard(ua.h, ub.h);
+    if (unlikely(lazy_inexact)) {
+        ur.h = f64_fence(ur.h);
+    }
     if (unlikely(f64_is_inf(ur))) {
         s->float_exception_flags |= float_flag_overflow;
     } else if (unlikely(fabs(ur.h) <= DBL_MIN)) {
@@ -408,6 +469,9 @@ float64_gen2(float64 xa, float64 xb, float_status *s,
             goto soft;
         }
     }
+    if (unlikely(lazy_inexact) && fetestexcept(FE_INEXACT)) {
+        s->float_exception_flags |= float_flag_inexact;
+    }
     return ur.s;
 
  soft:
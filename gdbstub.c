@@ -1780,6 +1780,42 @@ static void handle_read_mem(GdbCmdContext *gdb_ctx, void *user_ctx)
     put_packet(gdb_ctx->s, gdb_ctx->str_buf);
 }
 
+static void handle_read_mem_bin(GdbCmdContext *gdb_ctx, void *user_ctx)
+{
+    int len;
+
+    if (gdb_ctx->num_params != 2) {
+        put_packet(gdb_ctx->s, "E22");
+        return;
+    }
+
+    /*
+     * memtox() doubles the required space in the worst case, and one
+     * byte is needed for the leading 'b'.
+     */
+    if (gdb_ctx->params[1].val_ull > (MAX_PACKET_LENGTH - 1) / 2) {
+        put_packet(gdb_ctx->s, "E22");
+        return;
+    }
+
+    if (target_memory_rw_debug(gdb_ctx->s->g_cpu, gdb_ctx->params[0].val_ull,
+                               gdb_ctx->mem_buf,
+                               gdb_ctx->params[1].val_ull, false)) {
+        put_packet(gdb_ctx->s, "E14");
+        return;
+    }
+
+    /*
+     * The reply is 'b' followed by the escaped binary data; a zero
+     * length request is how gdb probes for 'x' support, and gets the
+     * bare 'b' back.
+     */
+    gdb_ctx->str_buf[0] = 'b';
+    len = memtox(gdb_ctx->str_buf + 1, (const char *)gdb_ctx->mem_buf,
+                 gdb_ctx->params[1].val_ull);
+    put_packet_binary(gdb_ctx->s, gdb_ctx->str_buf, len + 1, true);
+}
+
 static void handle_write_all_regs(GdbCmdContext *gdb_ctx, void *user_ctx)
 {
     target_ulong addr, len;
@@ -2498,6 +2534,17 @@ static int gdb_handle_packet(GDBState *s, const char *line_buf)
             cmd_parser = &write_mem_cmd_desc;
         }
         break;
+    case 'x':
+        {
+            static const GdbCmdParseEntry read_mem_bin_cmd_desc = {
+                .handler = handle_read_mem_bin,
+                .cmd = "x",
+                .cmd_startswith = 1,
+                .schema = "L,L0"
+            };
+            cmd_parser = &read_mem_bin_cmd_desc;
+        }
+        break;
     case 'p':
         {
             static const GdbCmdParseEntry get_reg_cmd_desc = {
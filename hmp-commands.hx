@@ -612,17 +612,24 @@ SRST
 ERST
     {
         .name       = "sync-profile",
-        .args_type  = "op:s?",
-        .params     = "[on|off|reset]",
-        .help       = "enable, disable or reset synchronization profiling. "
-                      "With no arguments, prints whether profiling is on or off.",
+        .args_type  = "op:s?,period:i?",
+        .params     = "[on|off|reset|sample [period]]",
+        .help       = "enable, disable or reset synchronization profiling, or "
+                      "set its sampling period ('sample n' profiles 1 out of "
+                      "every n acquisitions per thread; default: 1, i.e. all "
+                      "of them). With no arguments, prints whether profiling "
+                      "is on or off.",
         .cmd        = hmp_sync_profile,
     },
 
 SRST
-``sync-profile [on|off|reset]``
-  Enable, disable or reset synchronization profiling. With no arguments, prints
-  whether profiling is on or off.
+``sync-profile [on|off|reset|sample [period]]``
+  Enable, disable or reset synchronization profiling, or set its sampling
+  period. ``sample`` *period* profiles 1 out of every *period* acquisitions
+  per thread, scaling the sampled measurements accordingly; this makes
+  always-on profiling cheap enough for production use. The default period
+  of 1 profiles every acquisition. With no arguments, prints whether
+  profiling is on or off.
 ERST
 
     {
@@ -853,12 +853,22 @@ void virt_acpi_build(VirtMachineState *vms, AcpiBuildTables *tables)
 static void acpi_ram_update(MemoryRegion *mr, GArray *data)
 {
     uint32_t size = acpi_data_len(data);
+    void *ram;
 
     /* Make sure RAM size is correct - in case it got changed
      * e.g. by migration */
     memory_region_ram_resize(mr, size, &error_abort);
 
-    memcpy(memory_region_get_ram_ptr(mr), data->data, size);
+    /* Across a reboot of an unchanged machine the rebuilt tables are
+     * usually byte-identical; skip the copy then so the pages are not
+     * re-dirtied and re-sent by a migration in progress.
+     */
+    ram = memory_region_get_ram_ptr(mr);
+    if (memcmp(ram, data->data, size) == 0) {
+        return;
+    }
+
+    memcpy(ram, data->data, size);
     memory_region_set_dirty(mr, 0, size);
 }
 
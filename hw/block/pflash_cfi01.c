@@ -90,7 +90,12 @@ struct PFlashCFI01 {
     uint16_t ident3;
     uint8_t cfi_table[0x52];
     uint64_t counter;
-    unsigned int writeblock_size;
+    uint32_t writeblock_size;
+    /* Buffer for the current write-to-buffer sequence, flushed to the
+     * flash contents only on the confirm command.
+     */
+    uint8_t *blk_bytes;
+    uint32_t blk_offset;
     QEMUTimer *timer;
     MemoryRegion mem;
     char *name;
@@ -101,6 +106,26 @@ struct PFlashCFI01 {
 
 static int pflash_post_load(void *opaque, int version_id);
 
+static bool pflash_blk_write_state_needed(void *opaque)
+{
+    PFlashCFI01 *pfl = opaque;
+
+    return (pfl->blk_offset != -1);
+}
+
+static const VMStateDescription vmstate_pflash_blk_write = {
+    .name = "pflash_cfi01_blk_write",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .needed = pflash_blk_write_state_needed,
+    .fields = (VMStateField[]) {
+        VMSTATE_VBUFFER_UINT32(blk_bytes, PFlashCFI01, 0, NULL,
+                               writeblock_size),
+        VMSTATE_UINT32(blk_offset, PFlashCFI01),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static const VMStateDescription vmstate_pflash = {
     .name = "pflash_cfi01",
     .version_id = 1,
@@ -112,6 +137,10 @@ static const VMStateDescription vmstate_pflash = {
         VMSTATE_UINT8(status, PFlashCFI01),
         VMSTATE_UINT64(counter, PFlashCFI01),
         VMSTATE_END_OF_LIST()
+    },
+    .subsections = (const VMStateDescription * []) {
+        &vmstate_pflash_blk_write,
+        NULL
     }
 };
 
@@ -409,10 +438,43 @@ static void pflash_update(PFlashCFI01 *pfl, int offset,
     }
 }
 
+static void pflash_blk_write_start(PFlashCFI01 *pfl, hwaddr offset)
+{
+    /* Buffer the whole write block so it can be programmed to the
+     * flash contents (or discarded) in one go on the confirm command.
+     */
+    pfl->blk_offset = offset & ~(pfl->writeblock_size - 1);
+    memcpy(pfl->blk_bytes, pfl->storage + pfl->blk_offset,
+           pfl->writeblock_size);
+}
+
+static void pflash_blk_write_flush(PFlashCFI01 *pfl)
+{
+    memcpy(pfl->storage + pfl->blk_offset, pfl->blk_bytes,
+           pfl->writeblock_size);
+    pflash_update(pfl, pfl->blk_offset, pfl->writeblock_size);
+    pfl->blk_offset = -1;
+}
+
+static void pflash_blk_write_abort(PFlashCFI01 *pfl)
+{
+    pfl->blk_offset = -1;
+}
+
 static inline void pflash_data_write(PFlashCFI01 *pfl, hwaddr offset,
                                      uint32_t value, int width, int be)
 {
-    uint8_t *p = pfl->storage;
+    uint8_t *p;
+
+    if (pfl->blk_offset != -1) {
+        /* block write: redirect writes to the block buffer */
+        assert(offset >= pfl->blk_offset);
+        assert(offset + width <= pfl->blk_offset + pfl->writeblock_size);
+        p = pfl->blk_bytes;
+        offset -= pfl->blk_offset;
+    } else {
+        p = pfl->storage;
+    }
 
     trace_pflash_data_write(offset, width, value, pfl->counter);
     switch (width) {
@@ -504,10 +566,6 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
             break;
         case 0xe8: /* Write to buffer */
             DPRINTF("%s: Write to buffer\n", __func__);
-            /* FIXME should save @offset, @width for case 1+ */
-            qemu_log_mask(LOG_UNIMP,
-                          "%s: Write to buffer emulation is flawed\n",
-                          __func__);
             pfl->status |= 0x80; /* Ready! */
             break;
         case 0xf0: /* Probe for AMD flash */
@@ -551,13 +609,13 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
             /* Mask writeblock size based on device width, or bank width if
              * device width not specified.
              */
-            /* FIXME check @offset, @width */
             if (pfl->device_width) {
                 value = extract32(value, 0, pfl->device_width * 8);
             } else {
                 value = extract32(value, 0, pfl->bank_width * 8);
             }
             DPRINTF("%s: block write of %x bytes\n", __func__, value);
+            pflash_blk_write_start(pfl, offset);
             pfl->counter = value;
             pfl->wcycle++;
             break;
@@ -589,13 +647,9 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
     case 2:
         switch (pfl->cmd) {
         case 0xe8: /* Block write */
-            /* FIXME check @offset, @width */
-            if (!pfl->ro) {
-                /*
-                 * FIXME writing straight to memory is *wrong*.  We
-                 * should write to a buffer, and flush it to memory
-                 * only on confirm command (see below).
-                 */
+            /* Writes are restricted to the block started at cycle 1 */
+            if (!pfl->ro && offset >= pfl->blk_offset &&
+                offset + width <= pfl->blk_offset + pfl->writeblock_size) {
                 pflash_data_write(pfl, offset, value, width, be);
             } else {
                 pfl->status |= 0x10; /* Programming error */
@@ -604,18 +658,8 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
             pfl->status |= 0x80;
 
             if (!pfl->counter) {
-                hwaddr mask = pfl->writeblock_size - 1;
-                mask = ~mask;
-
                 DPRINTF("%s: block write finished\n", __func__);
                 pfl->wcycle++;
-                if (!pfl->ro) {
-                    /* Flush the entire write buffer onto backing storage.  */
-                    /* FIXME premature! */
-                    pflash_update(pfl, offset & mask, pfl->writeblock_size);
-                } else {
-                    pfl->status |= 0x10; /* Programming error */
-                }
             }
 
             pfl->counter--;
@@ -628,15 +672,15 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
         switch (pfl->cmd) {
         case 0xe8: /* Block write */
             if (cmd == 0xd0) {
-                /* FIXME this is where we should write out the buffer */
+                /* Flush the entire write buffer onto backing storage */
+                if (pfl->ro) {
+                    pflash_blk_write_abort(pfl);
+                } else {
+                    pflash_blk_write_flush(pfl);
+                }
                 pfl->wcycle = 0;
                 pfl->status |= 0x80;
             } else {
-                qemu_log_mask(LOG_UNIMP,
-                    "%s: Aborting write to buffer not implemented,"
-                    " the data is already written to storage!\n"
-                    "Flash device reset into READ mode.\n",
-                    __func__);
                 goto reset_flash;
             }
             break;
@@ -658,6 +702,7 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
 
  reset_flash:
     trace_pflash_reset();
+    pflash_blk_write_abort(pfl);
     memory_region_rom_device_set_romd(&pfl->mem, true);
     pfl->wcycle = 0;
     pfl->cmd = 0;
@@ -835,6 +880,8 @@ static void pflash_cfi01_realize(DeviceState *dev, Error **errp)
     if (!pfl->old_multiple_chip_handling && num_devices > 1) {
         pfl->writeblock_size *= num_devices;
     }
+    pfl->blk_bytes = g_malloc(pfl->writeblock_size);
+    pfl->blk_offset = -1;
 
     pfl->cfi_table[0x2B] = 0x00;
     /* Number of erase block regions (uniform) */
@@ -876,6 +923,7 @@ static void pflash_cfi01_system_reset(DeviceState *dev)
      */
     pfl->cmd = 0x00;
     pfl->wcycle = 0;
+    pfl->blk_offset = -1;
     memory_region_rom_device_set_romd(&pfl->mem, true);
     /*
      * The WSM ready timer occurs at most 150ns after system reset.
@@ -36,6 +36,9 @@
 /* Config size before the discard support (hide associated config fields) */
 #define VIRTIO_BLK_CFG_SIZE offsetof(struct virtio_blk_config, \
                                      max_discard_sectors)
+
+/* Number of requests to pop from the virtqueue in one go */
+#define VIRTIO_BLK_POP_BATCH 16
 /*
  * Starting from the discard feature, we can use this array to properly
  * set the config size depending on the features enabled.
@@ -251,16 +254,6 @@ out:
 
 #endif
 
-static VirtIOBlockReq *virtio_blk_get_request(VirtIOBlock *s, VirtQueue *vq)
-{
-    VirtIOBlockReq *req = virtqueue_pop(vq, sizeof(VirtIOBlockReq));
-
-    if (req) {
-        virtio_blk_init_request(s, vq, req);
-    }
-    return req;
-}
-
 static int virtio_blk_handle_scsi_req(VirtIOBlockReq *req)
 {
     int status = VIRTIO_BLK_S_OK;
@@ -611,7 +604,18 @@ err:
     return err_status;
 }
 
-static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
+/* How many read or write requests to batch up before submitting them to
+ * the block layer.  Scale the batch with the ring so that a deep queue
+ * gets large merges while small rings keep the flush latency low.
+ */
+static unsigned int virtio_blk_max_merge_reqs(VirtIOBlock *s)
+{
+    return MIN(s->conf.queue_size, VIRTIO_BLK_MAX_MERGE_REQS);
+}
+
+static int virtio_blk_handle_request(VirtIOBlockReq *req,
+                                     MultiReqBuffer *mrb_rd,
+                                     MultiReqBuffer *mrb_wr)
 {
     uint32_t type;
     struct iovec *in_iov = req->elem.in_sg;
@@ -655,6 +659,8 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
     case VIRTIO_BLK_T_IN:
     {
         bool is_write = type & VIRTIO_BLK_T_OUT;
+        MultiReqBuffer *mrb = is_write ? mrb_wr : mrb_rd;
+
         req->sector_num = virtio_ldq_p(vdev, &req->out.sector);
 
         if (is_write) {
@@ -678,11 +684,10 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
         block_acct_start(blk_get_stats(s->blk), &req->acct, req->qiov.size,
                          is_write ? BLOCK_ACCT_WRITE : BLOCK_ACCT_READ);
 
-        /* merge would exceed maximum number of requests or IO direction
-         * changes */
-        if (mrb->num_reqs > 0 && (mrb->num_reqs == VIRTIO_BLK_MAX_MERGE_REQS ||
-                                  is_write != mrb->is_write ||
-                                  !s->conf.request_merging)) {
+        /* merge would exceed maximum number of requests */
+        if (mrb->num_reqs > 0 &&
+            (mrb->num_reqs == virtio_blk_max_merge_reqs(s) ||
+             !s->conf.request_merging)) {
             virtio_blk_submit_multireq(s->blk, mrb);
         }
 
@@ -692,7 +697,7 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
         break;
     }
     case VIRTIO_BLK_T_FLUSH:
-        virtio_blk_handle_flush(req, mrb);
+        virtio_blk_handle_flush(req, mrb_wr);
         break;
     case VIRTIO_BLK_T_SCSI_CMD:
         virtio_blk_handle_scsi(req);
@@ -762,10 +767,12 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
 
 bool virtio_blk_handle_vq(VirtIOBlock *s, VirtQueue *vq)
 {
-    VirtIOBlockReq *req;
-    MultiReqBuffer mrb = {};
+    VirtIOBlockReq *reqs[VIRTIO_BLK_POP_BATCH];
+    MultiReqBuffer mrb_rd = {};
+    MultiReqBuffer mrb_wr = {};
     bool suppress_notifications = virtio_queue_get_notification(vq);
     bool progress = false;
+    unsigned int count;
 
     aio_context_acquire(blk_get_aio_context(s->blk));
     blk_io_plug(s->blk);
@@ -775,12 +782,24 @@ bool virtio_blk_handle_vq(VirtIOBlock *s, VirtQueue *vq)
             virtio_queue_set_notification(vq, 0);
         }
 
-        while ((req = virtio_blk_get_request(s, vq))) {
+        while ((count = virtqueue_pop_batch(vq, sizeof(VirtIOBlockReq),
+                                            (void **)reqs,
+                                            ARRAY_SIZE(reqs))) > 0) {
+            unsigned int i;
+
             progress = true;
-            if (virtio_blk_handle_request(req, &mrb)) {
-                virtqueue_detach_element(req->vq, &req->elem, 0);
-                virtio_blk_free_request(req);
-                break;
+            for (i = 0; i < count; i++) {
+                virtio_blk_init_request(s, vq, reqs[i]);
+            }
+            for (i = 0; i < count; i++) {
+                if (virtio_blk_handle_request(reqs[i], &mrb_rd, &mrb_wr)) {
+                    /* Give back this and the not yet started requests */
+                    for (; i < count; i++) {
+                        virtqueue_detach_element(vq, &reqs[i]->elem, 0);
+                        virtio_blk_free_request(reqs[i]);
+                    }
+                    break;
+                }
             }
         }
 
@@ -789,8 +808,11 @@ bool virtio_blk_handle_vq(VirtIOBlock *s, VirtQueue *vq)
         }
     } while (!virtio_queue_empty(vq));
 
-    if (mrb.num_reqs) {
-        virtio_blk_submit_multireq(s->blk, &mrb);
+    if (mrb_rd.num_reqs) {
+        virtio_blk_submit_multireq(s->blk, &mrb_rd);
+    }
+    if (mrb_wr.num_reqs) {
+        virtio_blk_submit_multireq(s->blk, &mrb_wr);
     }
 
     blk_io_unplug(s->blk);
@@ -823,7 +845,8 @@ static void virtio_blk_dma_restart_bh(void *opaque)
 {
     VirtIOBlock *s = opaque;
     VirtIOBlockReq *req = s->rq;
-    MultiReqBuffer mrb = {};
+    MultiReqBuffer mrb_rd = {};
+    MultiReqBuffer mrb_wr = {};
 
     qemu_bh_delete(s->bh);
     s->bh = NULL;
@@ -833,7 +856,7 @@ static void virtio_blk_dma_restart_bh(void *opaque)
     aio_context_acquire(blk_get_aio_context(s->conf.conf.blk));
     while (req) {
         VirtIOBlockReq *next = req->next;
-        if (virtio_blk_handle_request(req, &mrb)) {
+        if (virtio_blk_handle_request(req, &mrb_rd, &mrb_wr)) {
             /* Device is now broken and won't do any processing until it gets
              * reset. Already queued requests will be lost: let's purge them.
              */
@@ -848,8 +871,11 @@ static void virtio_blk_dma_restart_bh(void *opaque)
         req = next;
     }
 
-    if (mrb.num_reqs) {
-        virtio_blk_submit_multireq(s->blk, &mrb);
+    if (mrb_rd.num_reqs) {
+        virtio_blk_submit_multireq(s->blk, &mrb_rd);
+    }
+    if (mrb_wr.num_reqs) {
+        virtio_blk_submit_multireq(s->blk, &mrb_wr);
     }
     blk_dec_in_flight(s->conf.conf.blk);
     aio_context_release(blk_get_aio_context(s->conf.conf.blk));
@@ -982,13 +982,35 @@ int rom_add_file(const char *file, const char *fw_dir,
     }
 
     rom->datasize = rom->romsize;
-    rom->data     = g_malloc0(rom->datasize);
-    lseek(fd, 0, SEEK_SET);
-    rc = read(fd, rom->data, rom->datasize);
-    if (rc != rom->datasize) {
-        fprintf(stderr, "rom: file %-20s: read error: rc=%d (expected %zd)\n",
-                rom->name, rc, rom->datasize);
-        goto err;
+
+    /*
+     * Map the file MAP_PRIVATE instead of reading it into an anonymous
+     * buffer: identical firmware blobs (OVMF, BIOS, option ROMs) then
+     * share the page cache across all QEMU processes on the host until
+     * a page is actually written.
+     */
+    if (rom->datasize > 0) {
+        GError *gerr = NULL;
+
+        rom->mapped_file = g_mapped_file_new_from_fd(fd, true, &gerr);
+        if (rom->mapped_file) {
+            rom->data = (uint8_t *)g_mapped_file_get_contents(rom->mapped_file);
+        } else {
+            /* Pseudo file systems may not support mmap; fall back to read */
+            g_error_free(gerr);
+        }
+    }
+
+    if (rom->data == NULL && rom->datasize > 0) {
+        rom->data = g_malloc0(rom->datasize);
+        lseek(fd, 0, SEEK_SET);
+        rc = read(fd, rom->data, rom->datasize);
+        if (rc != rom->datasize) {
+            fprintf(stderr,
+                    "rom: file %-20s: read error: rc=%d (expected %zd)\n",
+                    rom->name, rc, rom->datasize);
+            goto err;
+        }
     }
     close(fd);
     rom_insert(rom);
@@ -14,6 +14,7 @@
 #include "qapi/qapi-commands-machine.h"
 #include "qapi/qmp/qerror.h"
 #include "qemu/main-loop.h"
+#include "qemu/timer.h"
 #include "sysemu/hostmem.h"
 #include "sysemu/hw_accel.h"
 #include "sysemu/numa.h"
@@ -204,6 +205,195 @@ CpuInfoFastList *qmp_query_cpus_fast(Error **errp)
     return head;
 }
 
+/*
+ * Guest program counter sampler.  A timer periodically queues work on
+ * every vCPU; the work item records the current guest PC into a flat
+ * buffer.  All state below is protected by the BQL: the timer and the
+ * QMP commands run in the main loop, and queued CPU work runs with the
+ * BQL held (see process_queued_cpu_work() callers).
+ */
+typedef struct PCSamplerRecord {
+    uint64_t pc;
+    uint32_t cpu_index;
+} PCSamplerRecord;
+
+#define PC_SAMPLER_MIN_INTERVAL_US  100
+#define PC_SAMPLER_MAX_INTERVAL_US  1000000
+#define PC_SAMPLER_DEFAULT_SAMPLES  (1 << 20)
+#define PC_SAMPLER_MAX_SAMPLES      (16 << 20)
+
+static QEMUTimer *pc_sampler_timer;
+static int64_t pc_sampler_interval_ns;
+static PCSamplerRecord *pc_sampler_buf;
+static size_t pc_sampler_capacity;
+static size_t pc_sampler_pos;
+static uint64_t pc_sampler_dropped;
+
+static void pc_sampler_cpu_sample(CPUState *cpu, run_on_cpu_data data)
+{
+    target_ulong pc, cs_base;
+    uint32_t flags;
+
+    /* The sampler may have been stopped since this work was queued */
+    if (!pc_sampler_timer) {
+        return;
+    }
+    if (pc_sampler_pos == pc_sampler_capacity) {
+        pc_sampler_dropped++;
+        return;
+    }
+    cpu_synchronize_state(cpu);
+    cpu_get_tb_cpu_state(cpu->env_ptr, &pc, &cs_base, &flags);
+    pc_sampler_buf[pc_sampler_pos].pc = pc;
+    pc_sampler_buf[pc_sampler_pos].cpu_index = cpu->cpu_index;
+    pc_sampler_pos++;
+}
+
+static void pc_sampler_timer_tick(void *opaque)
+{
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        async_run_on_cpu(cpu, pc_sampler_cpu_sample, RUN_ON_CPU_NULL);
+    }
+    timer_mod(pc_sampler_timer,
+              qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL_RT) +
+              pc_sampler_interval_ns);
+}
+
+void qmp_pc_sampler_start(int64_t interval_us, bool has_max_samples,
+                          int64_t max_samples, Error **errp)
+{
+    if (pc_sampler_timer) {
+        error_setg(errp, "PC sampler is already running");
+        return;
+    }
+    if (interval_us < PC_SAMPLER_MIN_INTERVAL_US ||
+        interval_us > PC_SAMPLER_MAX_INTERVAL_US) {
+        error_setg(errp, "interval-us must be between %d and %d",
+                   PC_SAMPLER_MIN_INTERVAL_US, PC_SAMPLER_MAX_INTERVAL_US);
+        return;
+    }
+    if (!has_max_samples) {
+        max_samples = PC_SAMPLER_DEFAULT_SAMPLES;
+    }
+    if (max_samples < 1024 || max_samples > PC_SAMPLER_MAX_SAMPLES) {
+        error_setg(errp, "max-samples must be between %d and %d",
+                   1024, PC_SAMPLER_MAX_SAMPLES);
+        return;
+    }
+
+    g_free(pc_sampler_buf);
+    pc_sampler_buf = g_new(PCSamplerRecord, max_samples);
+    pc_sampler_capacity = max_samples;
+    pc_sampler_pos = 0;
+    pc_sampler_dropped = 0;
+    pc_sampler_interval_ns = interval_us * (int64_t)SCALE_US;
+    pc_sampler_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL_RT,
+                                    pc_sampler_timer_tick, NULL);
+    timer_mod(pc_sampler_timer,
+              qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL_RT) +
+              pc_sampler_interval_ns);
+}
+
+void qmp_pc_sampler_stop(Error **errp)
+{
+    if (!pc_sampler_timer) {
+        error_setg(errp, "PC sampler is not running");
+        return;
+    }
+    timer_del(pc_sampler_timer);
+    timer_free(pc_sampler_timer);
+    pc_sampler_timer = NULL;
+}
+
+static guint pc_sampler_record_hash(gconstpointer key)
+{
+    const PCSamplerRecord *r = key;
+
+    return (guint)(r->pc ^ (r->pc >> 32)) * 31 + r->cpu_index;
+}
+
+static gboolean pc_sampler_record_equal(gconstpointer a, gconstpointer b)
+{
+    const PCSamplerRecord *ra = a;
+    const PCSamplerRecord *rb = b;
+
+    return ra->pc == rb->pc && ra->cpu_index == rb->cpu_index;
+}
+
+PCSamplerInfo *qmp_query_pc_samples(Error **errp)
+{
+    PCSamplerInfo *info = g_new0(PCSamplerInfo, 1);
+    PCSampleList *head = NULL, *cur_item = NULL;
+    GHashTable *ht;
+    size_t i;
+
+    info->running = pc_sampler_timer != NULL;
+    info->interval_us = pc_sampler_interval_ns / SCALE_US;
+    info->total_samples = pc_sampler_pos;
+    info->dropped_samples = pc_sampler_dropped;
+
+    /* aggregate (cpu, pc) pairs so repeated hits cost one list entry */
+    ht = g_hash_table_new(pc_sampler_record_hash, pc_sampler_record_equal);
+    for (i = 0; i < pc_sampler_pos; i++) {
+        PCSamplerRecord *r = &pc_sampler_buf[i];
+        PCSample *sample = g_hash_table_lookup(ht, r);
+        PCSampleList *entry;
+
+        if (sample) {
+            sample->count++;
+            continue;
+        }
+        sample = g_new0(PCSample, 1);
+        sample->cpu_index = r->cpu_index;
+        sample->pc = r->pc;
+        sample->count = 1;
+        g_hash_table_insert(ht, r, sample);
+
+        entry = g_new0(PCSampleList, 1);
+        entry->value = sample;
+        if (!cur_item) {
+            head = cur_item = entry;
+        } else {
+            cur_item->next = entry;
+            cur_item = entry;
+        }
+    }
+    g_hash_table_destroy(ht);
+
+    info->samples = head;
+    return info;
+}
+
+void qmp_cpu_throttle_set(bool has_cpu_index, int64_t cpu_index,
+                          int64_t percentage, Error **errp)
+{
+    if (percentage < 0 || percentage > 99) {
+        error_setg(errp, QERR_INVALID_PARAMETER_VALUE, "percentage",
+                   "a percentage between 0 and 99");
+        return;
+    }
+
+    if (has_cpu_index) {
+        CPUState *cpu = qemu_get_cpu(cpu_index);
+
+        if (!cpu) {
+            error_setg(errp, QERR_INVALID_PARAMETER_VALUE, "cpu-index",
+                       "a valid CPU index");
+            return;
+        }
+        cpu_throttle_set_vcpu(cpu, percentage);
+        return;
+    }
+
+    if (percentage) {
+        cpu_throttle_set(percentage);
+    } else {
+        cpu_throttle_stop();
+    }
+}
+
 MachineInfoList *qmp_query_machines(Error **errp)
 {
     GSList *el, *machines = object_class_get_list(TYPE_MACHINE, false);
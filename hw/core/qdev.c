@@ -539,6 +539,7 @@ qemu_irq qdev_get_gpio_in(DeviceState *dev, int n)
 void qdev_connect_gpio_out_named(DeviceState *dev, const char *name, int n,
                                  qemu_irq pin)
 {
+    static int non_qdev_gpio_count;
     char *propname = g_strdup_printf("%s[%d]",
                                      name ? name : "unnamed-gpio-out", n);
     if (pin) {
@@ -546,10 +547,20 @@ void qdev_connect_gpio_out_named(DeviceState *dev, const char *name, int n,
          * object has a parent, object_property_add_child will come back
          * with an error without doing anything.  If it has none, it will
          * never fail.  So we can just call it with a NULL Error pointer.
+         *
+         * Number the name from a monotonic counter rather than with the
+         * "[*]" wildcard: only this function creates these children, so
+         * the counter guarantees uniqueness, while the wildcard rescans
+         * every previously used index on each connection, which grows
+         * quadratically with the number of wired IRQs.
          */
+        gchar *gpio_name = g_strdup_printf("non-qdev-gpio[%d]",
+                                           non_qdev_gpio_count++);
+
         object_property_add_child(container_get(qdev_get_machine(),
                                                 "/unattached"),
-                                  "non-qdev-gpio[*]", OBJECT(pin), NULL);
+                                  gpio_name, OBJECT(pin), NULL);
+        g_free(gpio_name);
     }
     object_property_set_link(OBJECT(dev), OBJECT(pin), propname, &error_abort);
     g_free(propname);
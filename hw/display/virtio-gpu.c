@@ -392,7 +392,9 @@ static void virtio_gpu_transfer_to_host_2d(VirtIOGPU *g,
 {
     struct virtio_gpu_simple_resource *res;
     int h;
-    uint32_t src_offset, dst_offset, stride;
+    uint32_t dst_offset, stride;
+    unsigned int iov_idx;
+    size_t iov_off;
     int bpp;
     pixman_format_code_t format;
     struct virtio_gpu_transfer_to_host_2d t2d;
@@ -430,13 +432,27 @@ static void virtio_gpu_transfer_to_host_2d(VirtIOGPU *g,
     if (t2d.offset || t2d.r.x || t2d.r.y ||
         t2d.r.width != pixman_image_get_width(res->image)) {
         void *img_data = pixman_image_get_data(res->image);
+
+        /*
+         * The source offset advances by exactly one stride per row, so
+         * carry an iovec cursor across rows instead of letting
+         * iov_to_buf() skip from the first of the (typically page-sized)
+         * backing entries on every row.
+         */
+        iov_idx = 0;
+        iov_off = t2d.offset;
         for (h = 0; h < t2d.r.height; h++) {
-            src_offset = t2d.offset + stride * h;
+            while (iov_idx < res->iov_cnt &&
+                   iov_off >= res->iov[iov_idx].iov_len) {
+                iov_off -= res->iov[iov_idx].iov_len;
+                iov_idx++;
+            }
             dst_offset = (t2d.r.y + h) * stride + (t2d.r.x * bpp);
 
-            iov_to_buf(res->iov, res->iov_cnt, src_offset,
+            iov_to_buf(res->iov + iov_idx, res->iov_cnt - iov_idx, iov_off,
                        (uint8_t *)img_data
                        + dst_offset, t2d.r.width * bpp);
+            iov_off += stride;
         }
     } else {
         iov_to_buf(res->iov, res->iov_cnt, 0,
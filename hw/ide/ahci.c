@@ -584,15 +584,25 @@ static void ahci_reg_init(AHCIState *s)
 static void check_cmd(AHCIState *s, int port)
 {
     AHCIPortRegs *pr = &s->dev[port].port_regs;
+    BlockBackend *blk = s->dev[port].port.ifs[0].blk;
     uint8_t slot;
 
     if ((pr->cmd & PORT_CMD_START) && pr->cmd_issue) {
+        /* A doorbell write can issue several command slots at once
+         * (NCQ queues up to 32); plug the backend so they reach the
+         * block layer as one batch instead of one submission each. */
+        if (blk) {
+            blk_io_plug(blk);
+        }
         for (slot = 0; (slot < 32) && pr->cmd_issue; slot++) {
             if ((pr->cmd_issue & (1U << slot)) &&
                 !handle_cmd(s, port, slot)) {
                 pr->cmd_issue &= ~(1U << slot);
             }
         }
+        if (blk) {
+            blk_io_unplug(blk);
+        }
     }
 }
 
@@ -657,6 +667,7 @@ static void ahci_reset_port(AHCIState *s, int port)
     pr->sig = 0xFFFFFFFF;
     d->busy_slot = -1;
     d->init_d2h_sent = false;
+    dma_map_cache_invalidate(&d->prdt_cache);
 
     ide_state = &s->dev[port].port.ifs[0];
     if (!ide_state->blk) {
@@ -936,9 +947,10 @@ static int ahci_populate_sglist(AHCIDevice *ad, QEMUSGList *sglist,
         return -1;
     }
 
-    /* map PRDT */
-    if (!(prdt = dma_memory_map(ad->hba->as, prdt_addr, &prdt_len,
-                                DMA_DIRECTION_TO_DEVICE))){
+    /* map PRDT; the guest reuses the same table address every request,
+     * so this hits the translation cache in the steady state */
+    if (!(prdt = dma_map_cache_read(&ad->prdt_cache, prdt_addr,
+                                    &prdt_len))) {
         trace_ahci_populate_sglist_no_map(ad->hba, ad->port_no);
         return -1;
     }
@@ -983,8 +995,7 @@ static int ahci_populate_sglist(AHCIDevice *ad, QEMUSGList *sglist,
     }
 
 out:
-    dma_memory_unmap(ad->hba->as, prdt, prdt_len,
-                     DMA_DIRECTION_TO_DEVICE, prdt_len);
+    dma_map_cache_finish(&ad->prdt_cache, prdt, prdt_len);
     return r;
 }
 
@@ -1552,6 +1563,7 @@ void ahci_realize(AHCIState *s, DeviceState *qdev, AddressSpace *as, int ports)
         ad->port_no = i;
         ad->port.dma = &ad->dma;
         ad->port.dma->ops = &ahci_dma_ops;
+        dma_map_cache_init(&ad->prdt_cache, s->as);
         ide_register_restart_cb(&ad->port);
     }
     g_free(irqs);
@@ -1569,6 +1581,7 @@ void ahci_uninit(AHCIState *s)
 
             ide_exit(s);
         }
+        dma_map_cache_invalidate(&ad->prdt_cache);
         object_unparent(OBJECT(&ad->port));
     }
 
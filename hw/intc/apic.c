@@ -379,7 +379,16 @@ static void apic_update_irq(APICCommonState *s)
 
     cpu = CPU(s->cpu);
     if (!qemu_cpu_is_self(cpu)) {
-        cpu_interrupt(cpu, CPU_INTERRUPT_POLL);
+        /*
+         * Both sides touch interrupt_request with the BQL held, so once a
+         * poll is pending the vCPU is guaranteed to re-read the APIC state
+         * (including any IRR bits set above) when it services it.  Skipping
+         * the repeat cpu_interrupt() avoids kicking the vCPU once per
+         * delivered interrupt during IRQ-heavy I/O.
+         */
+        if (!(cpu->interrupt_request & CPU_INTERRUPT_POLL)) {
+            cpu_interrupt(cpu, CPU_INTERRUPT_POLL);
+        }
     } else if (apic_irq_pending(s) > 0) {
         cpu_interrupt(cpu, CPU_INTERRUPT_HARD);
     } else if (!apic_accept_pic_intr(dev) || !pic_get_output(isa_pic)) {
@@ -124,6 +124,16 @@ typedef struct E1000State_st {
 
     QEMUTimer *flush_queue_timer;
 
+    /*
+     * Persistent mapping of the RX descriptor ring, so that receiving a
+     * packet does not pay for a DMA address space lookup per descriptor.
+     * Dropped whenever the guest reprograms the ring registers or the
+     * memory map changes.
+     */
+    MemoryRegionCache rx_desc_cache;
+    bool rx_desc_cache_valid;
+    MemoryListener dma_listener;
+
 /* Compatibility flags for migration to/from qemu 1.3.0 and older */
 #define E1000_FLAG_AUTONEG_BIT 0
 #define E1000_FLAG_MIT_BIT 1
@@ -381,6 +391,10 @@ static void e1000_reset(void *opaque)
     memmove(d->mac_reg, mac_reg_init, sizeof mac_reg_init);
     d->rxbuf_min_shift = 1;
     memset(&d->tx, 0, sizeof d->tx);
+    if (d->rx_desc_cache_valid) {
+        address_space_cache_destroy(&d->rx_desc_cache);
+        d->rx_desc_cache_valid = false;
+    }
 
     if (qemu_get_queue(d->nic)->link_down) {
         e1000x_update_regs_on_link_down(d->mac_reg, d->phy_reg);
@@ -862,6 +876,77 @@ static uint64_t rx_desc_base(E1000State *s)
     return (bah << 32) + bal;
 }
 
+static void
+e1000_invalidate_rx_desc_cache(E1000State *s)
+{
+    if (s->rx_desc_cache_valid) {
+        address_space_cache_destroy(&s->rx_desc_cache);
+        s->rx_desc_cache_valid = false;
+    }
+}
+
+/* The mapping underneath the cache may be gone; look it up again. */
+static void
+e1000_dma_memory_commit(MemoryListener *listener)
+{
+    E1000State *s = container_of(listener, E1000State, dma_listener);
+
+    e1000_invalidate_rx_desc_cache(s);
+}
+
+/*
+ * Map the whole RX ring up front.  Returns false if the ring cannot be
+ * mapped contiguously; the caller then falls back to per-descriptor DMA.
+ */
+static bool
+e1000_rx_desc_cache_prepare(E1000State *s)
+{
+    int64_t len;
+
+    if (s->rx_desc_cache_valid) {
+        return true;
+    }
+    if (s->mac_reg[RDLEN] == 0) {
+        return false;
+    }
+    len = address_space_cache_init(&s->rx_desc_cache,
+                                   pci_get_address_space(PCI_DEVICE(s)),
+                                   rx_desc_base(s), s->mac_reg[RDLEN], true);
+    if (len < s->mac_reg[RDLEN]) {
+        address_space_cache_destroy(&s->rx_desc_cache);
+        return false;
+    }
+    s->rx_desc_cache_valid = true;
+    return true;
+}
+
+/*
+ * Push the descriptors written through the cache for one packet out to
+ * guest memory in at most two ranges (the ring may have wrapped).
+ */
+static void
+e1000_rx_desc_cache_writeback(E1000State *s, uint32_t rdh_start,
+                              uint32_t written)
+{
+    uint32_t ring_len = s->mac_reg[RDLEN] / sizeof(struct e1000_rx_desc);
+    uint32_t n;
+
+    if (rdh_start >= ring_len) {
+        /* never written through the cache; see e1000_receive_iov() */
+        return;
+    }
+    n = MIN(written, ring_len - rdh_start);
+
+    address_space_cache_invalidate(&s->rx_desc_cache,
+                                   rdh_start * sizeof(struct e1000_rx_desc),
+                                   n * sizeof(struct e1000_rx_desc));
+    if (n < written) {
+        address_space_cache_invalidate(&s->rx_desc_cache, 0,
+                                       (written - n) *
+                                       sizeof(struct e1000_rx_desc));
+    }
+}
+
 static void
 e1000_receiver_overrun(E1000State *s, size_t size)
 {
@@ -890,6 +975,8 @@ e1000_receive_iov(NetClientState *nc, const struct iovec *iov, int iovcnt)
     size_t desc_offset;
     size_t desc_size;
     size_t total_size;
+    uint32_t desc_written = 0;
+    bool cached;
 
     if (!e1000x_hw_rx_enabled(s->mac_reg)) {
         return -1;
@@ -946,13 +1033,29 @@ e1000_receive_iov(NetClientState *nc, const struct iovec *iov, int iovcnt)
         e1000_receiver_overrun(s, total_size);
         return -1;
     }
+    cached = e1000_rx_desc_cache_prepare(s);
+    if (cached && rdh_start >= s->mac_reg[RDLEN] / sizeof(desc)) {
+        /*
+         * The guest can write any 16-bit value to RDH, and the cached
+         * accessors assert that offsets lie within the mapped ring.  Fall
+         * back to per-descriptor DMA, which tolerates a bogus head; the
+         * wraparound check below then reports the overrun.
+         */
+        cached = false;
+    }
     do {
         desc_size = total_size - desc_offset;
         if (desc_size > s->rxbuf_size) {
             desc_size = s->rxbuf_size;
         }
         base = rx_desc_base(s) + sizeof(desc) * s->mac_reg[RDH];
-        pci_dma_read(d, base, &desc, sizeof(desc));
+        if (cached) {
+            address_space_read_cached(&s->rx_desc_cache,
+                                      sizeof(desc) * s->mac_reg[RDH],
+                                      &desc, sizeof(desc));
+        } else {
+            pci_dma_read(d, base, &desc, sizeof(desc));
+        }
         desc.special = vlan_special;
         desc.status |= (vlan_status | E1000_RXD_STAT_DD);
         if (desc.buffer_addr) {
@@ -987,7 +1090,14 @@ e1000_receive_iov(NetClientState *nc, const struct iovec *iov, int iovcnt)
         } else { // as per intel docs; skip descriptors with null buf addr
             DBGOUT(RX, "Null RX descriptor!!\n");
         }
-        pci_dma_write(d, base, &desc, sizeof(desc));
+        if (cached) {
+            address_space_write_cached(&s->rx_desc_cache,
+                                       sizeof(desc) * s->mac_reg[RDH],
+                                       &desc, sizeof(desc));
+            desc_written++;
+        } else {
+            pci_dma_write(d, base, &desc, sizeof(desc));
+        }
 
         if (++s->mac_reg[RDH] * sizeof(desc) >= s->mac_reg[RDLEN])
             s->mac_reg[RDH] = 0;
@@ -996,11 +1106,18 @@ e1000_receive_iov(NetClientState *nc, const struct iovec *iov, int iovcnt)
             rdh_start >= s->mac_reg[RDLEN] / sizeof(desc)) {
             DBGOUT(RXERR, "RDH wraparound @%x, RDT %x, RDLEN %x\n",
                    rdh_start, s->mac_reg[RDT], s->mac_reg[RDLEN]);
+            if (desc_written) {
+                e1000_rx_desc_cache_writeback(s, rdh_start, desc_written);
+            }
             e1000_receiver_overrun(s, total_size);
             return -1;
         }
     } while (desc_offset < total_size);
 
+    if (desc_written) {
+        e1000_rx_desc_cache_writeback(s, rdh_start, desc_written);
+    }
+
     e1000x_update_rx_total_stats(s->mac_reg, size, total_size);
 
     n = E1000_ICS_RXT0;
@@ -1120,6 +1237,20 @@ set_dlen(E1000State *s, int index, uint32_t val)
     s->mac_reg[index] = val & 0xfff80;
 }
 
+static void
+set_rdlen(E1000State *s, int index, uint32_t val)
+{
+    set_dlen(s, index, val);
+    e1000_invalidate_rx_desc_cache(s);
+}
+
+static void
+set_rdba(E1000State *s, int index, uint32_t val)
+{
+    s->mac_reg[index] = val;
+    e1000_invalidate_rx_desc_cache(s);
+}
+
 static void
 set_tctl(E1000State *s, int index, uint32_t val)
 {
@@ -1209,14 +1340,15 @@ enum { NREADOPS = ARRAY_SIZE(macreg_readops) };
 typedef void (*writeops)(E1000State *, int, uint32_t);
 static const writeops macreg_writeops[] = {
     putreg(PBA),      putreg(EERD),     putreg(SWSM),     putreg(WUFC),
-    putreg(TDBAL),    putreg(TDBAH),    putreg(TXDCTL),   putreg(RDBAH),
-    putreg(RDBAL),    putreg(LEDCTL),   putreg(VET),      putreg(FCRUC),
+    putreg(TDBAL),    putreg(TDBAH),    putreg(TXDCTL),
+    putreg(LEDCTL),   putreg(VET),      putreg(FCRUC),
     putreg(TDFH),     putreg(TDFT),     putreg(TDFHS),    putreg(TDFTS),
     putreg(TDFPC),    putreg(RDFH),     putreg(RDFT),     putreg(RDFHS),
     putreg(RDFTS),    putreg(RDFPC),    putreg(IPAV),     putreg(WUC),
     putreg(WUS),      putreg(AIT),
 
-    [TDLEN]  = set_dlen,   [RDLEN]  = set_dlen,       [TCTL] = set_tctl,
+    [TDLEN]  = set_dlen,   [RDLEN]  = set_rdlen,      [TCTL] = set_tctl,
+    [RDBAH]  = set_rdba,   [RDBAL]  = set_rdba,
     [TDT]    = set_tctl,   [MDIC]   = set_mdic,       [ICS]  = set_ics,
     [TDH]    = set_16bit,  [RDH]    = set_16bit,      [RDT]  = set_rdt,
     [IMC]    = set_imc,    [IMS]    = set_ims,        [ICR]  = set_icr,
@@ -1654,6 +1786,8 @@ pci_e1000_uninit(PCIDevice *dev)
     timer_free(d->mit_timer);
     timer_del(d->flush_queue_timer);
     timer_free(d->flush_queue_timer);
+    memory_listener_unregister(&d->dma_listener);
+    e1000_invalidate_rx_desc_cache(d);
     qemu_del_nic(d->nic);
 }
 
@@ -1719,6 +1853,9 @@ static void pci_e1000_realize(PCIDevice *pci_dev, Error **errp)
     d->mit_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, e1000_mit_timer, d);
     d->flush_queue_timer = timer_new_ms(QEMU_CLOCK_VIRTUAL,
                                         e1000_flush_queue_timer, d);
+
+    d->dma_listener.commit = e1000_dma_memory_commit;
+    memory_listener_register(&d->dma_listener, pci_get_address_space(pci_dev));
 }
 
 static void qdev_e1000_reset(DeviceState *dev)
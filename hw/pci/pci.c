@@ -1105,6 +1105,12 @@ static void pci_unregister_io_regions(PCIDevice *pci_dev)
     PCIIORegion *r;
     int i;
 
+    /*
+     * Batch the deletions so the address spaces are rebuilt once at
+     * commit time instead of once per BAR; unplug runs under the BQL
+     * and the rebuilds add up on large topologies.
+     */
+    memory_region_transaction_begin();
     for(i = 0; i < PCI_NUM_REGIONS; i++) {
         r = &pci_dev->io_regions[i];
         if (!r->size || r->addr == PCI_BAR_UNMAPPED)
@@ -1113,6 +1119,7 @@ static void pci_unregister_io_regions(PCIDevice *pci_dev)
     }
 
     pci_unregister_vga(pci_dev);
+    memory_region_transaction_commit();
 }
 
 static void pci_qdev_unrealize(DeviceState *dev, Error **errp)
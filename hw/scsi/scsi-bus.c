@@ -213,6 +213,8 @@ static void scsi_qdev_realize(DeviceState *qdev, Error **errp)
     }
 
     QTAILQ_INIT(&dev->requests);
+    QTAILQ_INIT(&dev->free_requests);
+    dev->free_request_count = 0;
     scsi_device_realize(dev, &local_err);
     if (local_err) {
         error_propagate(errp, local_err);
@@ -225,6 +227,7 @@ static void scsi_qdev_realize(DeviceState *qdev, Error **errp)
 static void scsi_qdev_unrealize(DeviceState *qdev, Error **errp)
 {
     SCSIDevice *dev = SCSI_DEVICE(qdev);
+    SCSIRequest *req, *next_req;
     Error *local_err = NULL;
 
     if (dev->vmsentry) {
@@ -233,6 +236,12 @@ static void scsi_qdev_unrealize(DeviceState *qdev, Error **errp)
 
     scsi_device_purge_requests(dev, SENSE_CODE(NO_SENSE));
 
+    QTAILQ_FOREACH_SAFE(req, &dev->free_requests, next, next_req) {
+        g_free(req);
+    }
+    QTAILQ_INIT(&dev->free_requests);
+    dev->free_request_count = 0;
+
     scsi_device_unrealize(dev, &local_err);
     if (local_err) {
         error_propagate(errp, local_err);
@@ -618,6 +627,9 @@ static const struct SCSIReqOps reqops_target_command = {
 };
 
 
+/* How many released requests to keep per device for reuse.  */
+#define SCSI_REQUEST_POOL_SIZE 16
+
 SCSIRequest *scsi_req_alloc(const SCSIReqOps *reqops, SCSIDevice *d,
                             uint32_t tag, uint32_t lun, void *hba_private)
 {
@@ -627,8 +639,20 @@ SCSIRequest *scsi_req_alloc(const SCSIReqOps *reqops, SCSIDevice *d,
     const int memset_off = offsetof(SCSIRequest, sense)
                            + sizeof(req->sense);
 
-    req = g_malloc(reqops->size);
-    memset((uint8_t *)req + memset_off, 0, reqops->size - memset_off);
+    req = QTAILQ_FIRST(&d->free_requests);
+    if (req) {
+        QTAILQ_REMOVE(&d->free_requests, req, next);
+        d->free_request_count--;
+        if (req->alloc_size < reqops->size) {
+            g_free(req);
+            req = NULL;
+        }
+    }
+    if (!req) {
+        req = g_malloc(reqops->size);
+        req->alloc_size = reqops->size;
+    }
+    memset((uint8_t *)req + memset_off, 0, req->alloc_size - memset_off);
     req->refcount = 1;
     req->bus = bus;
     req->dev = d;
@@ -1307,7 +1331,8 @@ void scsi_req_unref(SCSIRequest *req)
 {
     assert(req->refcount > 0);
     if (--req->refcount == 0) {
-        BusState *qbus = req->dev->qdev.parent_bus;
+        SCSIDevice *d = req->dev;
+        BusState *qbus = d->qdev.parent_bus;
         SCSIBus *bus = DO_UPCAST(SCSIBus, qbus, qbus);
 
         if (bus->info->free_request && req->hba_private) {
@@ -1316,9 +1341,15 @@ void scsi_req_unref(SCSIRequest *req)
         if (req->ops->free_req) {
             req->ops->free_req(req);
         }
-        object_unref(OBJECT(req->dev));
+        if (d->qdev.realized &&
+            d->free_request_count < SCSI_REQUEST_POOL_SIZE) {
+            QTAILQ_INSERT_HEAD(&d->free_requests, req, next);
+            d->free_request_count++;
+        } else {
+            g_free(req);
+        }
+        object_unref(OBJECT(d));
         object_unref(OBJECT(qbus->parent));
-        g_free(req);
     }
 }
 
@@ -2574,6 +2574,35 @@ static void scsi_disk_new_request_dump(uint32_t lun, uint32_t tag, uint8_t *buf)
     g_free(line_buffer);
 }
 
+/*
+ * READ(10) and WRITE(10) dominate I/O workloads; decode them directly
+ * instead of walking the generic CDB parser's opcode tables.  The result
+ * must match scsi_req_parse_cdb() exactly.  Everything else, including
+ * the rarely used 6/12/16-byte variants, takes the generic path.
+ */
+static int scsi_hd_parse_cdb(SCSIDevice *dev, SCSICommand *cmd,
+                             uint8_t *buf, void *hba_private)
+{
+    switch (buf[0]) {
+    case READ_10:
+    case WRITE_10:
+        cmd->len = 10;
+        cmd->xfer = lduw_be_p(&buf[7]) * (uint32_t)dev->blocksize;
+        cmd->lba = ldl_be_p(&buf[2]) & 0xffffffffULL;
+        if (!cmd->xfer) {
+            cmd->mode = SCSI_XFER_NONE;
+        } else if (buf[0] == WRITE_10) {
+            cmd->mode = SCSI_XFER_TO_DEV;
+        } else {
+            cmd->mode = SCSI_XFER_FROM_DEV;
+        }
+        memcpy(cmd->buf, buf, cmd->len);
+        return 0;
+    default:
+        return scsi_req_parse_cdb(dev, cmd, buf);
+    }
+}
+
 static SCSIRequest *scsi_new_request(SCSIDevice *d, uint32_t tag, uint32_t lun,
                                      uint8_t *buf, void *hba_private)
 {
@@ -3033,6 +3062,7 @@ static void scsi_hd_class_initfn(ObjectClass *klass, void *data)
     sc->realize      = scsi_hd_realize;
     sc->unrealize    = scsi_unrealize;
     sc->alloc_req    = scsi_new_request;
+    sc->parse_cdb    = scsi_hd_parse_cdb;
     sc->unit_attention_reported = scsi_disk_unit_attention_reported;
     dc->desc = "virtual SCSI disk";
     device_class_set_props(dc, scsi_hd_properties);
@@ -158,6 +158,8 @@ static int tpm_emulator_unix_tx_bufs(TPMEmulator *tpm_emu,
                                      Error **errp)
 {
     ssize_t ret;
+    uint32_t resp_size = 0;
+    size_t recvd = 0;
     bool is_selftest = false;
 
     if (selftest_done) {
@@ -170,17 +172,36 @@ static int tpm_emulator_unix_tx_bufs(TPMEmulator *tpm_emu,
         return -1;
     }
 
-    ret = qio_channel_read_all(tpm_emu->data_ioc, (char *)out,
-              sizeof(struct tpm_resp_hdr), errp);
-    if (ret != 0) {
-        return -1;
-    }
+    /*
+     * The response size is only known once the header has arrived, but
+     * swtpm sends the whole response in a single message.  Read whatever
+     * has already been received in one call instead of going back into
+     * the kernel separately for header and body, and loop only if the
+     * response was split.
+     */
+    while (recvd < sizeof(struct tpm_resp_hdr) || recvd < resp_size) {
+        size_t limit = resp_size ? resp_size : out_len;
 
-    ret = qio_channel_read_all(tpm_emu->data_ioc,
-              (char *)out + sizeof(struct tpm_resp_hdr),
-              tpm_cmd_get_size(out) - sizeof(struct tpm_resp_hdr), errp);
-    if (ret != 0) {
-        return -1;
+        ret = qio_channel_read(tpm_emu->data_ioc, (char *)out + recvd,
+                               limit - recvd, errp);
+        if (ret < 0) {
+            return -1;
+        }
+        if (ret == 0) {
+            error_setg(errp, "tpm-emulator: EOF reading response");
+            return -1;
+        }
+        recvd += ret;
+
+        if (!resp_size && recvd >= sizeof(struct tpm_resp_hdr)) {
+            resp_size = tpm_cmd_get_size(out);
+            if (resp_size < sizeof(struct tpm_resp_hdr) ||
+                resp_size > out_len) {
+                error_setg(errp, "tpm-emulator: bogus response size %u",
+                           resp_size);
+                return -1;
+            }
+        }
     }
 
     if (is_selftest) {
@@ -760,10 +760,37 @@ static TRBType xhci_ring_fetch(XHCIState *xhci, XHCIRing *ring, XHCITRB *trb,
     }
 }
 
-static int xhci_ring_chain_length(XHCIState *xhci, const XHCIRing *ring)
+/* TRBs read per DMA access when walking a transfer ring */
+#define TRB_RING_CHUNK 8
+
+/*
+ * Read up to @n consecutive TRBs starting at @dequeue in one DMA access.
+ * The read never crosses a page boundary, so a ring segment that ends
+ * without a link TRB cannot make us touch an unrelated region.
+ */
+static int xhci_ring_read_chunk(XHCIState *xhci, dma_addr_t dequeue,
+                                XHCITRB *trbs, int n)
 {
     PCIDevice *pci_dev = PCI_DEVICE(xhci);
+    dma_addr_t page_end = QEMU_ALIGN_UP(dequeue + TRB_SIZE, 4096);
+    int i;
+
+    n = MIN(n, (int)((page_end - dequeue) / TRB_SIZE));
+    pci_dma_read(pci_dev, dequeue, trbs, n * TRB_SIZE);
+    for (i = 0; i < n; i++) {
+        le64_to_cpus(&trbs[i].parameter);
+        le32_to_cpus(&trbs[i].status);
+        le32_to_cpus(&trbs[i].control);
+    }
+    return n;
+}
+
+static int xhci_ring_chain_length(XHCIState *xhci, const XHCIRing *ring)
+{
+    XHCITRB cache[TRB_RING_CHUNK];
     XHCITRB trb;
+    int cached = 0;
+    int idx = 0;
     int length = 0;
     dma_addr_t dequeue = ring->dequeue;
     bool ccs = ring->ccs;
@@ -773,10 +800,12 @@ static int xhci_ring_chain_length(XHCIState *xhci, const XHCIRing *ring)
 
     while (1) {
         TRBType type;
-        pci_dma_read(pci_dev, dequeue, &trb, TRB_SIZE);
-        le64_to_cpus(&trb.parameter);
-        le32_to_cpus(&trb.status);
-        le32_to_cpus(&trb.control);
+        if (idx == cached) {
+            cached = xhci_ring_read_chunk(xhci, dequeue, cache,
+                                          TRB_RING_CHUNK);
+            idx = 0;
+        }
+        trb = cache[idx++];
 
         if ((trb.control & TRB_C) != ccs) {
             return -length;
@@ -792,6 +821,7 @@ static int xhci_ring_chain_length(XHCIState *xhci, const XHCIRing *ring)
             if (trb.control & TRB_LK_TC) {
                 ccs = !ccs;
             }
+            cached = idx = 0;
             continue;
         }
 
@@ -810,6 +840,61 @@ static int xhci_ring_chain_length(XHCIState *xhci, const XHCIRing *ring)
     }
 }
 
+/*
+ * Fetch the @length TRBs counted by xhci_ring_chain_length() in one pass,
+ * reading the ring chunk-wise instead of one DMA access per TRB.  Behaves
+ * like repeated xhci_ring_fetch() calls, including the dequeue pointer
+ * and cycle state updates.  Returns false if the ring changed under us.
+ */
+static bool xhci_ring_fetch_td(XHCIState *xhci, XHCIRing *ring,
+                               XHCITRB *trbs, int length)
+{
+    XHCITRB cache[TRB_RING_CHUNK];
+    int cached = 0;
+    int idx = 0;
+    int i = 0;
+    uint32_t link_cnt = 0;
+
+    while (i < length) {
+        XHCITRB *trb;
+        TRBType type;
+
+        if (idx == cached) {
+            cached = xhci_ring_read_chunk(xhci, ring->dequeue, cache,
+                                          TRB_RING_CHUNK);
+            idx = 0;
+        }
+        trb = &cache[idx++];
+        trb->addr = ring->dequeue;
+        trb->ccs = ring->ccs;
+
+        trace_usb_xhci_fetch_trb(ring->dequeue, trb_name(trb),
+                                 trb->parameter, trb->status, trb->control);
+
+        if ((trb->control & TRB_C) != ring->ccs) {
+            return false;
+        }
+
+        type = TRB_TYPE(*trb);
+        if (type == TR_LINK) {
+            if (++link_cnt > TRB_LINK_LIMIT) {
+                trace_usb_xhci_enforced_limit("trb-link");
+                return false;
+            }
+            ring->dequeue = xhci_mask64(trb->parameter);
+            if (trb->control & TRB_LK_TC) {
+                ring->ccs = !ring->ccs;
+            }
+            cached = idx = 0;
+            continue;
+        }
+
+        trbs[i++] = *trb;
+        ring->dequeue += TRB_SIZE;
+    }
+    return true;
+}
+
 static void xhci_er_reset(XHCIState *xhci, int v)
 {
     XHCIInterrupter *intr = &xhci->intr[v];
@@ -1878,7 +1963,6 @@ static void xhci_kick_epctx(XHCIEPContext *epctx, unsigned int streamid)
     uint64_t mfindex;
     unsigned int count = 0;
     int length;
-    int i;
 
     trace_usb_xhci_ep_kick(epctx->slotid, epctx->epid, streamid);
     assert(!epctx->kick_active);
@@ -1975,15 +2059,11 @@ static void xhci_kick_epctx(XHCIEPContext *epctx, unsigned int streamid)
             break;
         }
 
-        for (i = 0; i < length; i++) {
-            TRBType type;
-            type = xhci_ring_fetch(xhci, ring, &xfer->trbs[i], NULL);
-            if (!type) {
-                xhci_die(xhci);
-                xhci_ep_free_xfer(xfer);
-                epctx->kick_active--;
-                return;
-            }
+        if (!xhci_ring_fetch_td(xhci, ring, xfer->trbs, length)) {
+            xhci_die(xhci);
+            xhci_ep_free_xfer(xfer);
+            epctx->kick_active--;
+            return;
         }
         xfer->streamid = streamid;
 
@@ -222,6 +222,14 @@ struct vhost_user {
 
     /* True once we've entered postcopy_listen */
     bool               postcopy_listen;
+
+    /* The last memory table sent to the backend on this connection,
+     * used to skip identical SET_MEM_TABLE messages during memory
+     * listener churn.  Starts out invalid, so a fresh connection
+     * always gets the table.
+     */
+    VhostUserMemory    shadow_mem;
+    bool               shadow_mem_valid;
 };
 
 static bool ioeventfd_enabled(void)
@@ -417,6 +425,11 @@ static int vhost_user_set_mem_table_postcopy(struct vhost_dev *dev,
     VhostUserMsg msg_reply;
     int region_i, msg_i;
 
+    /* The postcopy handshake rewrites the backend's table; make the
+     * non-postcopy path resend it afterwards.
+     */
+    u->shadow_mem_valid = false;
+
     VhostUserMsg msg = {
         .hdr.request = VHOST_USER_SET_MEM_TABLE,
         .hdr.flags = VHOST_USER_VERSION,
@@ -599,6 +612,16 @@ static int vhost_user_set_mem_table(struct vhost_dev *dev,
         return -1;
     }
 
+    /* The regions reference the same fd-backed RAMBlocks as last time,
+     * so the mapping in the backend cannot have changed; don't bother
+     * it with an identical table.
+     */
+    if (u->shadow_mem_valid &&
+        memcmp(&u->shadow_mem, &msg.payload.memory,
+               sizeof(msg.payload.memory)) == 0) {
+        return 0;
+    }
+
     msg.hdr.size = sizeof(msg.payload.memory.nregions);
     msg.hdr.size += sizeof(msg.payload.memory.padding);
     msg.hdr.size += fd_num * sizeof(VhostUserMemoryRegion);
@@ -608,9 +631,14 @@ static int vhost_user_set_mem_table(struct vhost_dev *dev,
     }
 
     if (reply_supported) {
-        return process_message_reply(dev, &msg);
+        int ret = process_message_reply(dev, &msg);
+        if (ret) {
+            return ret;
+        }
     }
 
+    u->shadow_mem = msg.payload.memory;
+    u->shadow_mem_valid = true;
     return 0;
 }
 
@@ -972,6 +972,34 @@ out:
     return ret;
 }
 
+/* Push device IOTLB entries covering [iova, iova + size) so the
+ * backend does not stall on a burst of misses the first time it walks
+ * the range.  Stops quietly at unmapped addresses; the backend will
+ * miss on access as before. */
+static void vhost_device_iotlb_prefetch(struct vhost_dev *dev,
+                                        uint64_t iova, uint64_t size,
+                                        int write)
+{
+    uint64_t end = iova + size;
+
+    while (iova < end) {
+        IOMMUTLBEntry iotlb;
+
+        WITH_RCU_READ_LOCK_GUARD() {
+            iotlb = address_space_get_iotlb_entry(dev->vdev->dma_as, iova,
+                                                  write,
+                                                  MEMTXATTRS_UNSPECIFIED);
+        }
+        if (iotlb.target_as == NULL) {
+            return;
+        }
+        if (vhost_device_iotlb_miss(dev, iova, write)) {
+            return;
+        }
+        iova = (iova & ~iotlb.addr_mask) + iotlb.addr_mask + 1;
+    }
+}
+
 static int vhost_virtqueue_start(struct vhost_dev *dev,
                                 struct VirtIODevice *vdev,
                                 struct vhost_virtqueue *vq,
@@ -1665,10 +1693,17 @@ int vhost_dev_start(struct vhost_dev *hdev, VirtIODevice *vdev)
         hdev->vhost_ops->vhost_set_iotlb_callback(hdev, true);
 
         /* Update used ring information for IOTLB to work correctly,
-         * vhost-kernel code requires for this.*/
+         * vhost-kernel code requires for this.  While at it, warm the
+         * device IOTLB with translations for all three rings of every
+         * virtqueue so the datapath does not start with a miss storm. */
         for (i = 0; i < hdev->nvqs; ++i) {
             struct vhost_virtqueue *vq = hdev->vqs + i;
-            vhost_device_iotlb_miss(hdev, vq->used_phys, true);
+            vhost_device_iotlb_prefetch(hdev, vq->desc_phys,
+                                        vq->desc_size, false);
+            vhost_device_iotlb_prefetch(hdev, vq->avail_phys,
+                                        vq->avail_size, false);
+            vhost_device_iotlb_prefetch(hdev, vq->used_phys,
+                                        vq->used_size, true);
         }
     }
     return 0;
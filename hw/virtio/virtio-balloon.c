@@ -63,9 +63,30 @@ static bool virtio_balloon_pbp_matches(PartiallyBalloonedPage *pbp,
     return pbp->base_gpa == base_gpa;
 }
 
+/* A run of contiguous pages queued for a single discard; guests hand
+ * back balloon pages in ascending runs, so batching them turns one
+ * madvise per 4k page into one per run. */
+typedef struct BalloonDiscardRun {
+    RAMBlock *rb;
+    ram_addr_t offset;
+    size_t len;
+} BalloonDiscardRun;
+
+static void balloon_discard_run_flush(BalloonDiscardRun *run)
+{
+    if (run->len) {
+        ram_block_discard_range(run->rb, run->offset, run->len);
+        /* We ignore errors from ram_block_discard_range(), because it
+         * has already reported them, and failing to discard a balloon
+         * page is not fatal */
+        run->len = 0;
+    }
+}
+
 static void balloon_inflate_page(VirtIOBalloon *balloon,
                                  MemoryRegion *mr, hwaddr mr_offset,
-                                 PartiallyBalloonedPage *pbp)
+                                 PartiallyBalloonedPage *pbp,
+                                 BalloonDiscardRun *run)
 {
     void *addr = memory_region_get_ram_ptr(mr) + mr_offset;
     ram_addr_t rb_offset, rb_aligned_offset, base_gpa;
@@ -79,12 +100,16 @@ static void balloon_inflate_page(VirtIOBalloon *balloon,
     rb_page_size = qemu_ram_pagesize(rb);
 
     if (rb_page_size == BALLOON_PAGE_SIZE) {
-        /* Easy case */
-
-        ram_block_discard_range(rb, rb_offset, rb_page_size);
-        /* We ignore errors from ram_block_discard_range(), because it
-         * has already reported them, and failing to discard a balloon
-         * page is not fatal */
+        /* Easy case: extend the pending run if contiguous, otherwise
+         * flush it and start a new one */
+        if (run->rb == rb && run->offset + run->len == rb_offset) {
+            run->len += rb_page_size;
+        } else {
+            balloon_discard_run_flush(run);
+            run->rb = rb;
+            run->offset = rb_offset;
+            run->len = rb_page_size;
+        }
         return;
     }
 
@@ -321,6 +346,46 @@ static void balloon_stats_set_poll_interval(Object *obj, Visitor *v,
     balloon_stats_change_timer(s, 0);
 }
 
+static void virtio_balloon_handle_report(VirtIODevice *vdev, VirtQueue *vq)
+{
+    VirtIOBalloon *dev = VIRTIO_BALLOON(vdev);
+    VirtQueueElement *elem;
+
+    while ((elem = virtqueue_pop(vq, sizeof(VirtQueueElement)))) {
+        unsigned int i;
+
+        /*
+         * When inhibited (e.g. by postcopy) the pages must not be
+         * touched; complete the requests without discarding so the
+         * guest can reuse the pages right away.
+         */
+        for (i = 0; i < elem->in_num && !qemu_balloon_is_inhibited(); i++) {
+            void *addr = elem->in_sg[i].iov_base;
+            size_t size = elem->in_sg[i].iov_len;
+            ram_addr_t ram_offset;
+            RAMBlock *rb;
+
+            rb = qemu_ram_block_from_host(addr, false, &ram_offset);
+            if (!rb || ram_offset + size > qemu_ram_get_used_length(rb)) {
+                trace_virtio_balloon_bad_addr((uintptr_t)addr);
+                continue;
+            }
+
+            trace_virtio_balloon_report_range(qemu_ram_get_idstr(rb),
+                                              ram_offset, size);
+            /*
+             * Errors are already reported by ram_block_discard_range();
+             * the page simply stays resident in that case.
+             */
+            ram_block_discard_range(rb, ram_offset, size);
+        }
+
+        virtqueue_push(vq, elem, 0);
+        virtio_notify(vdev, vq);
+        g_free(elem);
+    }
+}
+
 static void virtio_balloon_handle_output(VirtIODevice *vdev, VirtQueue *vq)
 {
     VirtIOBalloon *s = VIRTIO_BALLOON(vdev);
@@ -329,6 +394,7 @@ static void virtio_balloon_handle_output(VirtIODevice *vdev, VirtQueue *vq)
 
     for (;;) {
         PartiallyBalloonedPage pbp = {};
+        BalloonDiscardRun run = {};
         size_t offset = 0;
         uint32_t pfn;
 
@@ -363,7 +429,8 @@ static void virtio_balloon_handle_output(VirtIODevice *vdev, VirtQueue *vq)
             if (!qemu_balloon_is_inhibited()) {
                 if (vq == s->ivq) {
                     balloon_inflate_page(s, section.mr,
-                                         section.offset_within_region, &pbp);
+                                         section.offset_within_region,
+                                         &pbp, &run);
                 } else if (vq == s->dvq) {
                     balloon_deflate_page(s, section.mr, section.offset_within_region);
                 } else {
@@ -373,6 +440,7 @@ static void virtio_balloon_handle_output(VirtIODevice *vdev, VirtQueue *vq)
             memory_region_unref(section.mr);
         }
 
+        balloon_discard_run_flush(&run);
         virtqueue_push(vq, elem, offset);
         virtio_notify(vdev, vq);
         g_free(elem);
@@ -815,7 +883,24 @@ static void virtio_balloon_device_realize(DeviceState *dev, Error **errp)
             s->host_features &= ~(1 << VIRTIO_BALLOON_F_FREE_PAGE_HINT);
             virtio_error(vdev, "iothread is missing");
         }
+    } else if (virtio_has_feature(s->host_features,
+                                  VIRTIO_BALLOON_F_REPORTING)) {
+        /*
+         * The Linux driver numbers the queues by feature bit, not by what
+         * was negotiated: free page hinting is always queue 3 and page
+         * reporting queue 4.  Keep index 3 occupied with a dormant queue
+         * so the reporting queue lands at the index the driver expects.
+         * (A zero-sized queue would look like a free slot to
+         * virtio_add_queue() and be handed out again.)
+         */
+        s->free_page_vq = virtio_add_queue(vdev, 32, NULL);
+    }
+
+    if (virtio_has_feature(s->host_features, VIRTIO_BALLOON_F_REPORTING)) {
+        s->reporting_vq = virtio_add_queue(vdev, 32,
+                                           virtio_balloon_handle_report);
     }
+
     reset_stats(s);
 }
 
@@ -838,6 +923,9 @@ static void virtio_balloon_device_unrealize(DeviceState *dev, Error **errp)
     if (s->free_page_vq) {
         virtio_delete_queue(s->free_page_vq);
     }
+    if (s->reporting_vq) {
+        virtio_delete_queue(s->reporting_vq);
+    }
     virtio_cleanup(vdev);
 }
 
@@ -916,6 +1004,8 @@ static Property virtio_balloon_properties[] = {
                     VIRTIO_BALLOON_F_DEFLATE_ON_OOM, false),
     DEFINE_PROP_BIT("free-page-hint", VirtIOBalloon, host_features,
                     VIRTIO_BALLOON_F_FREE_PAGE_HINT, false),
+    DEFINE_PROP_BIT("free-page-reporting", VirtIOBalloon, host_features,
+                    VIRTIO_BALLOON_F_REPORTING, false),
     /* QEMU 4.0 accidentally changed the config size even when free-page-hint
      * is disabled, resulting in QEMU 3.1 migration incompatibility.  This
      * property retains this quirk for QEMU 4.1 machine types.
@@ -663,14 +663,14 @@ static uint32_t virtio_read_config(PCIDevice *pci_dev,
 }
 
 static int kvm_virtio_pci_vq_vector_use(VirtIOPCIProxy *proxy,
-                                        unsigned int queue_no,
-                                        unsigned int vector)
+                                        unsigned int vector,
+                                        KVMRouteChange *c)
 {
     VirtIOIRQFD *irqfd = &proxy->vector_irqfd[vector];
     int ret;
 
     if (irqfd->users == 0) {
-        ret = kvm_irqchip_add_msi_route(kvm_state, vector, &proxy->pci_dev);
+        ret = kvm_irqchip_add_msi_route(c, vector, &proxy->pci_dev);
         if (ret < 0) {
             return ret;
         }
@@ -721,7 +721,15 @@ static int kvm_virtio_pci_vector_use(VirtIOPCIProxy *proxy, int nvqs)
     VirtioDeviceClass *k = VIRTIO_DEVICE_GET_CLASS(vdev);
     unsigned int vector;
     int ret, queue_no;
+    KVMRouteChange c;
 
+    /*
+     * Allocate the MSI routes for all the queues first, so that the
+     * whole batch goes to the kernel in a single KVM_SET_GSI_ROUTING
+     * (which rewrites the full routing table every time) instead of
+     * one call per queue.
+     */
+    c = kvm_irqchip_begin_route_changes(kvm_state);
     for (queue_no = 0; queue_no < nvqs; queue_no++) {
         if (!virtio_queue_get_num(vdev, queue_no)) {
             break;
@@ -730,9 +738,21 @@ static int kvm_virtio_pci_vector_use(VirtIOPCIProxy *proxy, int nvqs)
         if (vector >= msix_nr_vectors_allocated(dev)) {
             continue;
         }
-        ret = kvm_virtio_pci_vq_vector_use(proxy, queue_no, vector);
+        ret = kvm_virtio_pci_vq_vector_use(proxy, vector, &c);
         if (ret < 0) {
-            goto undo;
+            goto undo_routes;
+        }
+    }
+    /* The irqfds below reference the virqs, so commit before that */
+    kvm_irqchip_commit_route_changes(&c);
+
+    for (queue_no = 0; queue_no < nvqs; queue_no++) {
+        if (!virtio_queue_get_num(vdev, queue_no)) {
+            break;
+        }
+        vector = virtio_queue_vector(vdev, queue_no);
+        if (vector >= msix_nr_vectors_allocated(dev)) {
+            continue;
         }
         /* If guest supports masking, set up irqfd now.
          * Otherwise, delay until unmasked in the frontend.
@@ -740,14 +760,13 @@ static int kvm_virtio_pci_vector_use(VirtIOPCIProxy *proxy, int nvqs)
         if (vdev->use_guest_notifier_mask && k->guest_notifier_mask) {
             ret = kvm_virtio_pci_irqfd_use(proxy, queue_no, vector);
             if (ret < 0) {
-                kvm_virtio_pci_vq_vector_release(proxy, vector);
-                goto undo;
+                goto undo_irqfds;
             }
         }
     }
     return 0;
 
-undo:
+undo_irqfds:
     while (--queue_no >= 0) {
         vector = virtio_queue_vector(vdev, queue_no);
         if (vector >= msix_nr_vectors_allocated(dev)) {
@@ -756,6 +775,15 @@ undo:
         if (vdev->use_guest_notifier_mask && k->guest_notifier_mask) {
             kvm_virtio_pci_irqfd_release(proxy, queue_no, vector);
         }
+    }
+    /* Fall through to drop the routes of all the queues */
+    queue_no = nvqs;
+undo_routes:
+    while (--queue_no >= 0) {
+        vector = virtio_queue_vector(vdev, queue_no);
+        if (vector >= msix_nr_vectors_allocated(dev)) {
+            continue;
+        }
         kvm_virtio_pci_vq_vector_release(proxy, vector);
     }
     return ret;
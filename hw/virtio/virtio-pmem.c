@@ -25,65 +25,84 @@
 #include "block/aio.h"
 #include "block/thread-pool.h"
 
-typedef struct VirtIODeviceRequest {
+struct VirtIODeviceRequest {
     VirtQueueElement elem;
-    int fd;
-    VirtIOPMEM *pmem;
-    VirtIODevice *vdev;
     struct virtio_pmem_req req;
     struct virtio_pmem_resp resp;
-} VirtIODeviceRequest;
+    QSIMPLEQ_ENTRY(VirtIODeviceRequest) entry;
+};
 
 static int worker_cb(void *opaque)
 {
-    VirtIODeviceRequest *req_data = opaque;
-    int err = 0;
+    VirtIOPMEM *pmem = opaque;
 
     /* flush raw backing image */
-    err = fsync(req_data->fd);
-    if (err != 0) {
-        err = 1;
-    }
+    return fsync(pmem->flush_fd) != 0 ? 1 : 0;
+}
+
+static void virtio_pmem_start_flush(VirtIOPMEM *pmem);
+
+static void done_cb(void *opaque, int ret)
+{
+    VirtIOPMEM *pmem = opaque;
+    VirtIODevice *vdev = VIRTIO_DEVICE(pmem);
+    VirtIODeviceRequest *req_data;
 
-    virtio_stw_p(req_data->vdev, &req_data->resp.ret, err);
+    /* Callbacks are serialized, so no need to use atomic ops.  The one
+     * fsync covers every request of the batch. */
+    while (!QSIMPLEQ_EMPTY(&pmem->flush_inflight_reqs)) {
+        int len;
+
+        req_data = QSIMPLEQ_FIRST(&pmem->flush_inflight_reqs);
+        QSIMPLEQ_REMOVE_HEAD(&pmem->flush_inflight_reqs, entry);
+        virtio_stw_p(vdev, &req_data->resp.ret, ret);
+        len = iov_from_buf(req_data->elem.in_sg, req_data->elem.in_num, 0,
+                           &req_data->resp, sizeof(struct virtio_pmem_resp));
+        virtqueue_push(pmem->rq_vq, &req_data->elem, len);
+        g_free(req_data);
+    }
+    virtio_notify(vdev, pmem->rq_vq);
 
-    return 0;
+    pmem->flush_in_flight = false;
+    if (!QSIMPLEQ_EMPTY(&pmem->flush_pending_reqs)) {
+        virtio_pmem_start_flush(pmem);
+    }
 }
 
-static void done_cb(void *opaque, int ret)
+static void virtio_pmem_start_flush(VirtIOPMEM *pmem)
 {
-    VirtIODeviceRequest *req_data = opaque;
-    int len = iov_from_buf(req_data->elem.in_sg, req_data->elem.in_num, 0,
-                              &req_data->resp, sizeof(struct virtio_pmem_resp));
-
-    /* Callbacks are serialized, so no need to use atomic ops. */
-    virtqueue_push(req_data->pmem->rq_vq, &req_data->elem, len);
-    virtio_notify((VirtIODevice *)req_data->pmem, req_data->pmem->rq_vq);
-    g_free(req_data);
+    HostMemoryBackend *backend = MEMORY_BACKEND(pmem->memdev);
+    ThreadPool *pool = aio_get_thread_pool(qemu_get_aio_context());
+
+    assert(!pmem->flush_in_flight);
+    QSIMPLEQ_CONCAT(&pmem->flush_inflight_reqs, &pmem->flush_pending_reqs);
+    pmem->flush_fd = memory_region_get_fd(&backend->mr);
+    pmem->flush_in_flight = true;
+    thread_pool_submit_aio(pool, worker_cb, pmem, done_cb, pmem);
 }
 
 static void virtio_pmem_flush(VirtIODevice *vdev, VirtQueue *vq)
 {
     VirtIODeviceRequest *req_data;
     VirtIOPMEM *pmem = VIRTIO_PMEM(vdev);
-    HostMemoryBackend *backend = MEMORY_BACKEND(pmem->memdev);
-    ThreadPool *pool = aio_get_thread_pool(qemu_get_aio_context());
 
-    req_data = virtqueue_pop(vq, sizeof(VirtIODeviceRequest));
-    if (!req_data) {
-        virtio_error(vdev, "virtio-pmem missing request data");
-        return;
+    /* Queue up everything the guest made available: requests that
+     * arrive while an fsync is running are completed together by the
+     * next one, so a flush storm costs one fsync per sync window
+     * instead of one per request.  An empty run is normal -- a prior
+     * run may have drained a request whose kick is still pending. */
+    while ((req_data = virtqueue_pop(vq, sizeof(VirtIODeviceRequest)))) {
+        if (req_data->elem.out_num < 1 || req_data->elem.in_num < 1) {
+            virtio_error(vdev, "virtio-pmem request not proper");
+            g_free(req_data);
+            return;
+        }
+        QSIMPLEQ_INSERT_TAIL(&pmem->flush_pending_reqs, req_data, entry);
     }
 
-    if (req_data->elem.out_num < 1 || req_data->elem.in_num < 1) {
-        virtio_error(vdev, "virtio-pmem request not proper");
-        g_free(req_data);
-        return;
+    if (!QSIMPLEQ_EMPTY(&pmem->flush_pending_reqs) && !pmem->flush_in_flight) {
+        virtio_pmem_start_flush(pmem);
     }
-    req_data->fd   = memory_region_get_fd(&backend->mr);
-    req_data->pmem = pmem;
-    req_data->vdev = vdev;
-    thread_pool_submit_aio(pool, worker_cb, req_data, done_cb, req_data);
 }
 
 static void virtio_pmem_get_config(VirtIODevice *vdev, uint8_t *config)
@@ -121,6 +140,8 @@ static void virtio_pmem_realize(DeviceState *dev, Error **errp)
     host_memory_backend_set_mapped(pmem->memdev, true);
     virtio_init(vdev, TYPE_VIRTIO_PMEM, VIRTIO_ID_PMEM,
                 sizeof(struct virtio_pmem_config));
+    QSIMPLEQ_INIT(&pmem->flush_inflight_reqs);
+    QSIMPLEQ_INIT(&pmem->flush_pending_reqs);
     pmem->rq_vq = virtio_add_queue(vdev, 128, virtio_pmem_flush);
 }
 
@@ -118,6 +118,16 @@ struct VirtQueue
     /* Notification enabled? */
     bool notification;
 
+    /*
+     * Interrupt coalescing state, used by virtio_notify_irqfd() only and
+     * therefore accessed only from the thread that runs the queue.
+     */
+    unsigned int coalesced_events;
+    QEMUTimer *coalesce_timer;
+    AioContext *coalesce_ctx; /* non-NULL while an aio handler is attached */
+    uint64_t irqs_delivered;
+    uint64_t irqs_suppressed;
+
     uint16_t queue_index;
 
     unsigned int inuse;
@@ -543,7 +553,7 @@ static void vring_packed_desc_read(VirtIODevice *vdev,
 static void vring_packed_desc_write_data(VirtIODevice *vdev,
                                          VRingPackedDesc *desc,
                                          MemoryRegionCache *cache,
-                                         int i)
+                                         int i, bool invalidate)
 {
     hwaddr off_id = i * sizeof(VRingPackedDesc) +
                     offsetof(VRingPackedDesc, id);
@@ -553,34 +563,41 @@ static void vring_packed_desc_write_data(VirtIODevice *vdev,
     virtio_tswap32s(vdev, &desc->len);
     virtio_tswap16s(vdev, &desc->id);
     address_space_write_cached(cache, off_id, &desc->id, sizeof(desc->id));
-    address_space_cache_invalidate(cache, off_id, sizeof(desc->id));
     address_space_write_cached(cache, off_len, &desc->len, sizeof(desc->len));
-    address_space_cache_invalidate(cache, off_len, sizeof(desc->len));
+    if (invalidate) {
+        address_space_cache_invalidate(cache, off_id, sizeof(desc->id));
+        address_space_cache_invalidate(cache, off_len, sizeof(desc->len));
+    }
 }
 
 static void vring_packed_desc_write_flags(VirtIODevice *vdev,
                                           VRingPackedDesc *desc,
                                           MemoryRegionCache *cache,
-                                          int i)
+                                          int i, bool invalidate)
 {
     hwaddr off = i * sizeof(VRingPackedDesc) + offsetof(VRingPackedDesc, flags);
 
     virtio_tswap16s(vdev, &desc->flags);
     address_space_write_cached(cache, off, &desc->flags, sizeof(desc->flags));
-    address_space_cache_invalidate(cache, off, sizeof(desc->flags));
+    if (invalidate) {
+        address_space_cache_invalidate(cache, off, sizeof(desc->flags));
+    }
 }
 
+/* If @invalidate is false the caller is responsible for invalidating
+ * the written range afterwards, e.g. once for a whole batch.
+ */
 static void vring_packed_desc_write(VirtIODevice *vdev,
                                     VRingPackedDesc *desc,
                                     MemoryRegionCache *cache,
-                                    int i, bool strict_order)
+                                    int i, bool strict_order, bool invalidate)
 {
-    vring_packed_desc_write_data(vdev, desc, cache, i);
+    vring_packed_desc_write_data(vdev, desc, cache, i, invalidate);
     if (strict_order) {
         /* Make sure data is wrote before flags. */
         smp_wmb();
     }
-    vring_packed_desc_write_flags(vdev, desc, cache, i);
+    vring_packed_desc_write_flags(vdev, desc, cache, i, invalidate);
 }
 
 static inline bool is_desc_avail(uint16_t flags, bool wrap_counter)
@@ -799,7 +816,8 @@ static void virtqueue_packed_fill(VirtQueue *vq, const VirtQueueElement *elem,
 static void virtqueue_packed_fill_desc(VirtQueue *vq,
                                        const VirtQueueElement *elem,
                                        unsigned int idx,
-                                       bool strict_order)
+                                       bool strict_order,
+                                       bool invalidate)
 {
     uint16_t head;
     VRingMemoryRegionCaches *caches;
@@ -831,7 +849,8 @@ static void virtqueue_packed_fill_desc(VirtQueue *vq,
         return;
     }
 
-    vring_packed_desc_write(vq->vdev, &desc, &caches->desc, head, strict_order);
+    vring_packed_desc_write(vq->vdev, &desc, &caches->desc, head,
+                            strict_order, invalidate);
 }
 
 /* Called within rcu_read_lock().  */
@@ -876,18 +895,37 @@ static void virtqueue_split_flush(VirtQueue *vq, unsigned int count)
 static void virtqueue_packed_flush(VirtQueue *vq, unsigned int count)
 {
     unsigned int i, ndescs = 0;
+    VRingMemoryRegionCaches *caches;
 
     if (unlikely(!vq->vring.desc)) {
         return;
     }
 
     for (i = 1; i < count; i++) {
-        virtqueue_packed_fill_desc(vq, &vq->used_elems[i], i, false);
+        virtqueue_packed_fill_desc(vq, &vq->used_elems[i], i, false, false);
         ndescs += vq->used_elems[i].ndescs;
     }
-    virtqueue_packed_fill_desc(vq, &vq->used_elems[0], 0, true);
+    virtqueue_packed_fill_desc(vq, &vq->used_elems[0], 0, true, false);
     ndescs += vq->used_elems[0].ndescs;
 
+    /* Update the dirty bitmap for the whole batch of used descriptors
+     * at once instead of field by field.
+     */
+    caches = vring_get_region_caches(vq);
+    if (caches) {
+        unsigned int num = MIN(count, vq->vring.num - vq->used_idx);
+
+        address_space_cache_invalidate(&caches->desc,
+                                       vq->used_idx *
+                                       sizeof(VRingPackedDesc),
+                                       num * sizeof(VRingPackedDesc));
+        if (num < count) {
+            address_space_cache_invalidate(&caches->desc, 0,
+                                           (count - num) *
+                                           sizeof(VRingPackedDesc));
+        }
+    }
+
     vq->inuse -= ndescs;
     vq->used_idx += ndescs;
     if (vq->used_idx >= vq->vring.num) {
@@ -1409,10 +1447,14 @@ static void *virtqueue_alloc_element(size_t sz, unsigned out_num, unsigned in_nu
     return elem;
 }
 
-static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
+/* Called within rcu_read_lock(), after the avail index has been read
+ * and the barrier in virtqueue_num_heads() issued, with the region
+ * caches already looked up and validated.
+ */
+static void *virtqueue_split_pop_one(VirtQueue *vq, size_t sz,
+                                     VRingMemoryRegionCaches *caches)
 {
     unsigned int i, head, max;
-    VRingMemoryRegionCaches *caches;
     MemoryRegionCache indirect_desc_cache = MEMORY_REGION_CACHE_INVALID;
     MemoryRegionCache *desc_cache;
     int64_t len;
@@ -1424,14 +1466,6 @@ static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
     VRingDesc desc;
     int rc;
 
-    RCU_READ_LOCK_GUARD();
-    if (virtio_queue_empty_rcu(vq)) {
-        goto done;
-    }
-    /* Needed after virtio_queue_empty(), see comment in
-     * virtqueue_num_heads(). */
-    smp_rmb();
-
     /* When we start there are none of either input nor output. */
     out_num = in_num = elem_entries = 0;
 
@@ -1452,17 +1486,6 @@ static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
 
     i = head;
 
-    caches = vring_get_region_caches(vq);
-    if (!caches) {
-        virtio_error(vdev, "Region caches not initialized");
-        goto done;
-    }
-
-    if (caches->desc.len < max * sizeof(VRingDesc)) {
-        virtio_error(vdev, "Cannot map descriptor ring");
-        goto done;
-    }
-
     desc_cache = &caches->desc;
     vring_split_desc_read(vdev, &desc, desc_cache, i);
     if (desc.flags & VRING_DESC_F_INDIRECT) {
@@ -1546,6 +1569,43 @@ err_undo_map:
     goto done;
 }
 
+static VRingMemoryRegionCaches *virtqueue_split_pop_caches(VirtQueue *vq)
+{
+    VRingMemoryRegionCaches *caches = vring_get_region_caches(vq);
+
+    if (!caches) {
+        virtio_error(vq->vdev, "Region caches not initialized");
+        return NULL;
+    }
+
+    if (caches->desc.len < vq->vring.num * sizeof(VRingDesc)) {
+        virtio_error(vq->vdev, "Cannot map descriptor ring");
+        return NULL;
+    }
+
+    return caches;
+}
+
+static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
+{
+    VRingMemoryRegionCaches *caches;
+
+    RCU_READ_LOCK_GUARD();
+    if (virtio_queue_empty_rcu(vq)) {
+        return NULL;
+    }
+    /* Needed after virtio_queue_empty(), see comment in
+     * virtqueue_num_heads(). */
+    smp_rmb();
+
+    caches = virtqueue_split_pop_caches(vq);
+    if (!caches) {
+        return NULL;
+    }
+
+    return virtqueue_split_pop_one(vq, sz, caches);
+}
+
 static void *virtqueue_packed_pop(VirtQueue *vq, size_t sz)
 {
     unsigned int i, max;
@@ -1694,6 +1754,52 @@ void *virtqueue_pop(VirtQueue *vq, size_t sz)
     }
 }
 
+unsigned int virtqueue_pop_batch(VirtQueue *vq, size_t sz, void **elems,
+                                 unsigned int n)
+{
+    unsigned int popped = 0;
+    VRingMemoryRegionCaches *caches;
+
+    if (virtio_device_disabled(vq->vdev)) {
+        return 0;
+    }
+
+    if (virtio_vdev_has_feature(vq->vdev, VIRTIO_F_RING_PACKED)) {
+        while (popped < n &&
+               (elems[popped] = virtqueue_packed_pop(vq, sz))) {
+            popped++;
+        }
+        return popped;
+    }
+
+    /* Amortize the RCU critical section and the region cache lookup
+     * and validation over the whole batch.
+     */
+    RCU_READ_LOCK_GUARD();
+    if (virtio_queue_empty_rcu(vq)) {
+        return 0;
+    }
+
+    caches = virtqueue_split_pop_caches(vq);
+    if (!caches) {
+        return 0;
+    }
+
+    do {
+        /* Needed after virtio_queue_empty(), see comment in
+         * virtqueue_num_heads(). */
+        smp_rmb();
+
+        elems[popped] = virtqueue_split_pop_one(vq, sz, caches);
+        if (!elems[popped]) {
+            break;
+        }
+        popped++;
+    } while (popped < n && !virtio_queue_empty_rcu(vq));
+
+    return popped;
+}
+
 static unsigned int virtqueue_packed_drop_all(VirtQueue *vq)
 {
     VRingMemoryRegionCaches *caches;
@@ -2026,6 +2132,10 @@ void virtio_reset(void *opaque)
         vdev->vq[i].notification = true;
         vdev->vq[i].vring.num = vdev->vq[i].vring.num_default;
         vdev->vq[i].inuse = 0;
+        vdev->vq[i].coalesced_events = 0;
+        if (vdev->vq[i].coalesce_timer) {
+            timer_del(vdev->vq[i].coalesce_timer);
+        }
         virtio_virtqueue_reset_region_cache(&vdev->vq[i]);
     }
 }
@@ -2424,6 +2534,12 @@ void virtio_delete_queue(VirtQueue *vq)
     vq->handle_aio_output = NULL;
     g_free(vq->used_elems);
     vq->used_elems = NULL;
+    if (vq->coalesce_timer) {
+        timer_del(vq->coalesce_timer);
+        timer_free(vq->coalesce_timer);
+        vq->coalesce_timer = NULL;
+    }
+    vq->coalesced_events = 0;
     virtio_virtqueue_reset_region_cache(vq);
 }
 
@@ -2523,6 +2639,35 @@ static bool virtio_should_notify(VirtIODevice *vdev, VirtQueue *vq)
     }
 }
 
+static void virtio_irq_coalesce_deliver(VirtQueue *vq)
+{
+    vq->coalesced_events = 0;
+    vq->irqs_delivered++;
+    virtio_set_isr(vq->vdev, 0x1);
+    event_notifier_set(&vq->guest_notifier);
+}
+
+static void virtio_irq_coalesce_timer(void *opaque)
+{
+    VirtQueue *vq = opaque;
+
+    if (vq->coalesced_events) {
+        trace_virtio_irq_coalesce_timeout(vq, vq->coalesced_events);
+        virtio_irq_coalesce_deliver(vq);
+    }
+}
+
+/* Deliver a suppressed interrupt now, e.g. before saving device state. */
+static void virtio_irq_coalesce_flush(VirtQueue *vq)
+{
+    if (vq->coalesce_timer) {
+        timer_del(vq->coalesce_timer);
+    }
+    if (vq->coalesced_events) {
+        virtio_irq_coalesce_deliver(vq);
+    }
+}
+
 void virtio_notify_irqfd(VirtIODevice *vdev, VirtQueue *vq)
 {
     WITH_RCU_READ_LOCK_GUARD() {
@@ -2531,6 +2676,36 @@ void virtio_notify_irqfd(VirtIODevice *vdev, VirtQueue *vq)
         }
     }
 
+    /*
+     * Hold back the interrupt until irq_coalesce_count events have
+     * accumulated or the timer fires, whichever comes first.  An empty
+     * queue means the guest may be blocked on this very completion, so
+     * deliver immediately in that case.
+     */
+    if (vdev->irq_coalesce_count > 1 && vq->inuse > 0) {
+        if (++vq->coalesced_events < vdev->irq_coalesce_count) {
+            if (!vq->coalesce_timer) {
+                AioContext *ctx = vq->coalesce_ctx ?: qemu_get_aio_context();
+
+                vq->coalesce_timer = aio_timer_new(ctx, QEMU_CLOCK_REALTIME,
+                                                   SCALE_NS,
+                                                   virtio_irq_coalesce_timer,
+                                                   vq);
+            }
+            if (!timer_pending(vq->coalesce_timer)) {
+                timer_mod(vq->coalesce_timer,
+                          qemu_clock_get_ns(QEMU_CLOCK_REALTIME) +
+                          vdev->irq_coalesce_ns);
+            }
+            vq->irqs_suppressed++;
+            trace_virtio_notify_irqfd_coalesced(vdev, vq,
+                                                vq->coalesced_events);
+            return;
+        }
+        timer_del(vq->coalesce_timer);
+        vq->coalesced_events = 0;
+    }
+
     trace_virtio_notify_irqfd(vdev, vq);
 
     /*
@@ -2549,6 +2724,7 @@ void virtio_notify_irqfd(VirtIODevice *vdev, VirtQueue *vq)
      * to an atomic operation.
      */
     virtio_set_isr(vq->vdev, 0x1);
+    vq->irqs_delivered++;
     event_notifier_set(&vq->guest_notifier);
 }
 
@@ -2863,6 +3039,14 @@ int virtio_save(VirtIODevice *vdev, QEMUFile *f)
     uint32_t guest_features_lo = (vdev->guest_features & 0xffffffff);
     int i;
 
+    /* Interrupts held back by coalescing are not migrated; deliver them. */
+    for (i = 0; i < VIRTIO_QUEUE_MAX; i++) {
+        if (vdev->vq[i].vring.num == 0) {
+            break;
+        }
+        virtio_irq_coalesce_flush(&vdev->vq[i]);
+    }
+
     if (k->save_config) {
         k->save_config(qbus->parent, f);
     }
@@ -3519,8 +3703,20 @@ static void virtio_queue_host_notifier_aio_poll_end(EventNotifier *n)
 void virtio_queue_aio_set_host_notifier_handler(VirtQueue *vq, AioContext *ctx,
                                                 VirtIOHandleAIOOutput handle_output)
 {
+    /*
+     * The queue is moving between contexts (both are drained at this
+     * point).  Hand back any coalesced interrupt and drop the timer so
+     * that it is recreated in the new context on demand.
+     */
+    virtio_irq_coalesce_flush(vq);
+    if (vq->coalesce_timer) {
+        timer_free(vq->coalesce_timer);
+        vq->coalesce_timer = NULL;
+    }
+
     if (handle_output) {
         vq->handle_aio_output = handle_output;
+        vq->coalesce_ctx = ctx;
         aio_set_event_notifier(ctx, &vq->host_notifier, true,
                                virtio_queue_host_notifier_aio_read,
                                virtio_queue_host_notifier_aio_poll);
@@ -3533,6 +3729,7 @@ void virtio_queue_aio_set_host_notifier_handler(VirtQueue *vq, AioContext *ctx,
          * in case poll callback didn't have time to run. */
         virtio_queue_host_notifier_aio_read(&vq->host_notifier);
         vq->handle_aio_output = NULL;
+        vq->coalesce_ctx = NULL;
     }
 }
 
@@ -3681,6 +3878,10 @@ static Property virtio_properties[] = {
     DEFINE_VIRTIO_COMMON_FEATURES(VirtIODevice, host_features),
     DEFINE_PROP_BOOL("use-started", VirtIODevice, use_started, true),
     DEFINE_PROP_BOOL("use-disabled-flag", VirtIODevice, use_disabled_flag, true),
+    DEFINE_PROP_UINT32("irq-coalesce-count", VirtIODevice, irq_coalesce_count,
+                       0),
+    DEFINE_PROP_UINT32("irq-coalesce-ns", VirtIODevice, irq_coalesce_ns,
+                       50000),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -129,6 +129,18 @@ struct AioContext {
     /* The list of registered AIO handlers.  Protected by ctx->list_lock. */
     AioHandlerList aio_handlers;
 
+    /* fd -> non-deleted AioHandler, so that aio_set_fd_handler() does not
+     * walk aio_handlers.  Protected by ctx->list_lock.  Unused on Windows.
+     */
+    GHashTable *aio_handler_by_fd;
+
+    /* How often a polling round made progress resp. fell through to a
+     * blocking wait.  Written only by the AioContext thread; reads from
+     * QMP are racy, which does not matter for statistics.
+     */
+    uint64_t poll_hits;
+    uint64_t poll_misses;
+
     /* The list of AIO handlers to be deleted.  Protected by ctx->list_lock. */
     AioHandlerList deleted_aio_handlers;
 
@@ -650,6 +662,25 @@ static inline bool aio_node_check(AioContext *ctx, bool is_external)
  */
 void aio_co_schedule(AioContext *ctx, struct Coroutine *co);
 
+/**
+ * aio_co_schedule_chain:
+ * @ctx: the aio context
+ * @first: the first coroutine of the chain
+ * @last: the last coroutine of the chain
+ *
+ * Start a chain of coroutines, linked from @first through @last via
+ * their co_scheduled_next field, on a remote AioContext.  The whole
+ * chain is pushed onto the context's ready list with a single atomic
+ * splice and a single event-loop notification, so releasing N waiters
+ * costs one wakeup instead of N.
+ *
+ * The same constraints as aio_co_schedule() apply to every coroutine
+ * in the chain.  Coroutines run in reverse chain order; to wake
+ * waiters in FIFO order, link the chain back to front.
+ */
+void aio_co_schedule_chain(AioContext *ctx, struct Coroutine *first,
+                           struct Coroutine *last);
+
 /**
  * aio_co_wake:
  * @co: the coroutine
@@ -34,4 +34,15 @@ int coroutine_fn thread_pool_submit_co(ThreadPool *pool,
         ThreadPoolFunc *func, void *arg);
 void thread_pool_submit(ThreadPool *pool, ThreadPoolFunc *func, void *arg);
 
+/* Variants that take an affinity key.  Requests with the same key are
+ * queued to the same preferred worker thread, which keeps sequential
+ * requests on one worker for cache locality.  This is only a hint; an
+ * idle worker will steal requests from a busy one.
+ */
+BlockAIOCB *thread_pool_submit_aio_affine(ThreadPool *pool,
+        ThreadPoolFunc *func, void *arg, unsigned long affinity,
+        BlockCompletionFunc *cb, void *opaque);
+int coroutine_fn thread_pool_submit_co_affine(ThreadPool *pool,
+        ThreadPoolFunc *func, void *arg, unsigned long affinity);
+
 #endif
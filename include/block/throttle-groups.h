@@ -48,6 +48,18 @@ typedef struct ThrottleGroupMember {
      */
     unsigned int restart_pending;
 
+    /* Cache of tokens withdrawn in batches from the group's ThrottleState,
+     * allowing requests to proceed without taking the group's lock while
+     * the cache lasts. The cache is spent and refilled only from the
+     * member's own AioContext; token_cache_gen is compared against the
+     * group's generation counter to detect configuration changes.
+     * UINT64_MAX means that the respective dimension is not limited.
+     */
+    int          token_cache_gen;
+    uint64_t     token_cache_bytes[2];
+    uint64_t     token_cache_ops[2];
+    uint64_t     token_cache_op_size;
+
     /* The following fields are protected by the ThrottleGroup lock.
      * See the ThrottleGroup documentation for details.
      * throttle_state tells us if I/O limits are configured. */
@@ -67,6 +67,16 @@ struct Chardev {
     int be_open;
     GSource *gsource;
     GMainContext *gcontext;
+    /*
+     * Optional bounded ring for writes that would block, drained by a
+     * G_IO_OUT watch; see qemu_chr_write_buffer().  All fields are
+     * protected by chr_write_lock.
+     */
+    uint8_t *wbuf;
+    size_t wbuf_size;
+    size_t wbuf_head;   /* next byte to drain */
+    size_t wbuf_len;
+    GSource *wbuf_src;
     DECLARE_BITMAP(features, QEMU_CHAR_FEATURE_LAST);
 };
 
@@ -168,6 +168,12 @@ typedef struct CPUTLBDesc {
     size_t n_used_entries;
     /* The next index to use in the tlb victim table.  */
     size_t vindex;
+    /*
+     * Bitmask of victim table entries in use; only ever accessed by the
+     * owning vCPU, and purely an acceleration hint for the miss-path
+     * scan: a stale set bit merely costs one useless comparison.
+     */
+    uint32_t vused;
     /* The tlb victim table, in two parts.  */
     CPUTLBEntry vtable[CPU_VTLB_SIZE];
     CPUIOTLBEntry viotlb[CPU_VTLB_SIZE];
@@ -449,13 +449,24 @@ uint64_t cpu_physical_memory_sync_dirty_bitmap(RAMBlock *rb,
     unsigned long word = BIT_WORD((start + rb->offset) >> TARGET_PAGE_BITS);
     uint64_t num_dirty = 0;
     unsigned long *dest = rb->bmap;
+    ram_addr_t aligned_len = 0;
 
-    /* start address and length is aligned at the start of a word? */
-    if (((word * BITS_PER_LONG) << TARGET_PAGE_BITS) ==
-         (start + rb->offset) &&
-        !(length & ((BITS_PER_LONG << TARGET_PAGE_BITS) - 1))) {
+    /* start address aligned at the start of a word? */
+    if (((word * BITS_PER_LONG) << TARGET_PAGE_BITS) == (start + rb->offset)) {
+        /*
+         * Process as many whole words as possible below; only the tail
+         * that does not fill a word (and, for an unaligned start, the
+         * whole range) falls back to the per-page loop.  Blocks whose
+         * page count is not a multiple of BITS_PER_LONG used to take
+         * the per-page path for their entire length.
+         */
+        aligned_len = length &
+            ~(((ram_addr_t)BITS_PER_LONG << TARGET_PAGE_BITS) - 1);
+    }
+
+    if (aligned_len) {
         int k;
-        int nr = BITS_TO_LONGS(length >> TARGET_PAGE_BITS);
+        int nr = BITS_TO_LONGS(aligned_len >> TARGET_PAGE_BITS);
         unsigned long * const *src;
         unsigned long idx = (word * BITS_PER_LONG) / DIRTY_MEMORY_BLOCK_SIZE;
         unsigned long offset = BIT_WORD((word * BITS_PER_LONG) %
@@ -489,15 +500,17 @@ uint64_t cpu_physical_memory_sync_dirty_bitmap(RAMBlock *rb,
              * dirty procedure into smaller chunks.
              */
             clear_bmap_set(rb, start >> TARGET_PAGE_BITS,
-                           length >> TARGET_PAGE_BITS);
+                           aligned_len >> TARGET_PAGE_BITS);
         } else {
             /* Slow path - still do that in a huge chunk */
-            memory_region_clear_dirty_bitmap(rb->mr, start, length);
+            memory_region_clear_dirty_bitmap(rb->mr, start, aligned_len);
         }
-    } else {
+    }
+
+    if (aligned_len != length) {
         ram_addr_t offset = rb->offset;
 
-        for (addr = 0; addr < length; addr += TARGET_PAGE_SIZE) {
+        for (addr = aligned_len; addr < length; addr += TARGET_PAGE_SIZE) {
             if (cpu_physical_memory_test_and_clear_dirty(
                         start + addr + offset,
                         TARGET_PAGE_SIZE,
@@ -38,6 +38,13 @@ tb_lookup__cpu_state(CPUState *cpu, target_ulong *pc, target_ulong *cs_base,
                tb->flags == *flags &&
                tb->trace_vcpu_dstate == *cpu->trace_dstate &&
                (tb_cflags(tb) & (CF_HASH_MASK | CF_INVALID)) == cf_mask)) {
+        /*
+         * Start pulling the translated code towards the core while the
+         * caller is still winding its way through the dispatch loop.
+         * L2 is unified on all hosts we care about, so a data prefetch
+         * still helps the subsequent instruction fetch.
+         */
+        __builtin_prefetch(tb->tc.ptr);
         return tb;
     }
     tb = tb_htable_lookup(cpu, *pc, *cs_base, *flags, cf_mask);
@@ -45,6 +52,7 @@ tb_lookup__cpu_state(CPUState *cpu, target_ulong *pc, target_ulong *cs_base,
         return NULL;
     }
     atomic_set(&cpu->tb_jmp_cache[hash], tb);
+    __builtin_prefetch(tb->tc.ptr);
     return tb;
 }
 
@@ -412,6 +412,8 @@ struct CPUState {
     int kvm_fd;
     struct KVMState *kvm_state;
     struct kvm_run *kvm_run;
+    struct kvm_dirty_gfn *kvm_dirty_gfns;
+    uint32_t kvm_fetch_index;
 
     /* Used for events with 'vcpu' and *without* the 'disabled' properties */
     DECLARE_BITMAP(trace_dstate_delayed, CPU_TRACE_DSTATE_MAX_EVENTS);
@@ -436,6 +438,11 @@ struct CPUState {
      */
     bool throttle_thread_scheduled;
 
+    /* Per-vcpu throttle percentage; overrides the global one when nonzero.
+     * Accessed with atomic operations.
+     */
+    unsigned int throttle_percentage;
+
     bool ignore_memory_transaction_failures;
 
     struct hax_vcpu_state *hax_vcpu;
@@ -856,6 +863,27 @@ bool cpu_throttle_active(void);
  */
 int cpu_throttle_get_percentage(void);
 
+/**
+ * cpu_throttle_set_vcpu:
+ * @cpu: The vcpu to throttle.
+ * @new_throttle_pct: Percent of sleep time. Valid range is 1 to 99,
+ *                    or 0 to remove the per-vcpu throttle.
+ *
+ * Throttles a single vcpu, overriding the global percentage set with
+ * cpu_throttle_set for that vcpu.  A per-vcpu throttle of 0 makes the
+ * vcpu follow the global percentage again.
+ */
+void cpu_throttle_set_vcpu(CPUState *cpu, int new_throttle_pct);
+
+/**
+ * cpu_throttle_get_vcpu_percentage:
+ * @cpu: The vcpu to query.
+ *
+ * Returns: The per-vcpu throttle percentage, or 0 if @cpu follows the
+ * global percentage.
+ */
+int cpu_throttle_get_vcpu_percentage(CPUState *cpu);
+
 #ifndef CONFIG_USER_ONLY
 
 typedef void (*CPUInterruptHandler)(CPUState *, int);
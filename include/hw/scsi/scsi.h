@@ -22,6 +22,7 @@ struct SCSIRequest {
     SCSIBus           *bus;
     SCSIDevice        *dev;
     const SCSIReqOps  *ops;
+    size_t            alloc_size;
     uint32_t          refcount;
     uint32_t          tag;
     uint32_t          lun;
@@ -79,6 +80,9 @@ struct SCSIDevice
     uint8_t sense[SCSI_SENSE_BUF_SIZE];
     uint32_t sense_len;
     QTAILQ_HEAD(, SCSIRequest) requests;
+    /* Released SCSIRequest allocations kept around for scsi_req_alloc() */
+    QTAILQ_HEAD(, SCSIRequest) free_requests;
+    uint32_t free_request_count;
     uint32_t channel;
     uint32_t lun;
     int blocksize;
@@ -131,7 +131,10 @@ typedef struct VirtIONetQueue {
     VirtQueue *tx_vq;
     QEMUTimer *tx_timer;
     QEMUBH *tx_bh;
+    QEMUBH *rx_bh;
     uint32_t tx_waiting;
+    uint32_t rx_pending_pkts;
+    uint32_t rx_pending_bytes;
     struct {
         VirtQueueElement *elem;
     } async_tx;
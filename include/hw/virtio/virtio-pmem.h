@@ -29,12 +29,23 @@
 #define VIRTIO_PMEM_ADDR_PROP "memaddr"
 #define VIRTIO_PMEM_MEMDEV_PROP "memdev"
 
+typedef struct VirtIODeviceRequest VirtIODeviceRequest;
+
 typedef struct VirtIOPMEM {
     VirtIODevice parent_obj;
 
     VirtQueue *rq_vq;
     uint64_t start;
     HostMemoryBackend *memdev;
+
+    /* Flush coalescing state, only touched from the main loop.  All
+     * requests of one fsync sit on flush_inflight_reqs; requests that
+     * arrive while it runs queue up on flush_pending_reqs and share
+     * the next fsync. */
+    bool flush_in_flight;
+    int flush_fd;
+    QSIMPLEQ_HEAD(, VirtIODeviceRequest) flush_inflight_reqs;
+    QSIMPLEQ_HEAD(, VirtIODeviceRequest) flush_pending_reqs;
 } VirtIOPMEM;
 
 typedef struct VirtIOPMEMClass {
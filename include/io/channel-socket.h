@@ -48,8 +48,18 @@ struct QIOChannelSocket {
     socklen_t localAddrLen;
     struct sockaddr_storage remoteAddr;
     socklen_t remoteAddrLen;
+    bool zero_copy_enabled;
+    uint64_t zero_copy_queued;
+    uint64_t zero_copy_completed;
 };
 
+/*
+ * Minimum size of an I/O vector before a zero copy send is attempted
+ * for it; smaller vectors (protocol headers and the like) are always
+ * sent with a plain copy.
+ */
+#define QIO_CHANNEL_SOCKET_ZERO_COPY_MIN (64 * 1024)
+
 
 /**
  * qio_channel_socket_new:
@@ -260,5 +270,59 @@ QIOChannelSocket *
 qio_channel_socket_accept(QIOChannelSocket *ioc,
                           Error **errp);
 
+/**
+ * qio_channel_socket_set_zero_copy:
+ * @ioc: the socket channel object
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Enable zero copy sends on the socket (MSG_ZEROCOPY on Linux).
+ * Subsequent writes of at least QIO_CHANNEL_SOCKET_ZERO_COPY_MIN
+ * bytes spread over page-sized-or-larger vectors share the caller's
+ * pages with the kernel instead of copying them. The caller must
+ * keep such buffers unchanged until
+ * the completion counter returned by
+ * qio_channel_socket_zero_copy_reap() reaches the value that
+ * qio_channel_socket_zero_copy_queued() reported after the write.
+ *
+ * Returns: 0 on success, -1 on error
+ */
+int qio_channel_socket_set_zero_copy(QIOChannelSocket *ioc,
+                                     Error **errp);
+
+/**
+ * qio_channel_socket_zero_copy_queued:
+ * @ioc: the socket channel object
+ *
+ * Returns: the number of zero copy sends issued on @ioc so far
+ */
+uint64_t qio_channel_socket_zero_copy_queued(QIOChannelSocket *ioc);
+
+/**
+ * qio_channel_socket_zero_copy_reap:
+ * @ioc: the socket channel object
+ *
+ * Collect any zero copy completions that the kernel has posted on
+ * the socket error queue. This never blocks; completions that are
+ * still outstanding are picked up by a later call.
+ *
+ * Returns: the number of zero copy sends whose pages the kernel has
+ * released
+ */
+uint64_t qio_channel_socket_zero_copy_reap(QIOChannelSocket *ioc);
+
+/**
+ * qio_channel_socket_zero_copy_flush:
+ * @ioc: the socket channel object
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Block until the kernel has released the pages of every zero copy
+ * send issued on @ioc so far. Once this returns success the caller
+ * may reuse or free all buffers passed to earlier writes.
+ *
+ * Returns: 0 on success, -1 on error
+ */
+int qio_channel_socket_zero_copy_flush(QIOChannelSocket *ioc,
+                                       Error **errp);
+
 
 #endif /* QIO_CHANNEL_SOCKET_H */
@@ -99,6 +99,16 @@ struct NetClientState {
     int vring_enable;
     int vnet_hdr_len;
     QTAILQ_HEAD(, NetFilterState) filters;
+    /*
+     * Dense per-direction arrays of the filters that are actually
+     * active, rebuilt by qemu_netfilter_chain_update() whenever a
+     * filter is added, removed or toggled.  The per-packet path walks
+     * these instead of skipping disabled entries in the full list.
+     */
+    NetFilterState **filters_tx;
+    NetFilterState **filters_rx;
+    int nfilters_tx;
+    int nfilters_rx;
 };
 
 typedef struct NICState {
@@ -151,6 +161,16 @@ ssize_t qemu_send_packet(NetClientState *nc, const uint8_t *buf, int size);
 ssize_t qemu_send_packet_raw(NetClientState *nc, const uint8_t *buf, int size);
 ssize_t qemu_send_packet_async(NetClientState *nc, const uint8_t *buf,
                                int size, NetPacketSent *sent_cb);
+/*
+ * Send several packets in one call; each iovec element carries one
+ * complete packet.  Packets that cannot be delivered right away are
+ * queued and @sent_cb runs for each once it is.  Returns the number of
+ * packets delivered immediately; when it is less than @npkts the caller
+ * should stop sending until the callback has run.
+ */
+int qemu_send_packet_batch(NetClientState *nc, const struct iovec *pkts,
+                           int npkts, NetPacketSent *sent_cb);
+void qemu_netfilter_chain_update(NetClientState *nc);
 void qemu_purge_queued_packets(NetClientState *nc);
 void qemu_flush_queued_packets(NetClientState *nc);
 void qemu_flush_or_purge_queued_packets(NetClientState *nc, bool purge);
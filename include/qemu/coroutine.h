@@ -65,6 +65,16 @@ typedef void coroutine_fn CoroutineEntry(void *opaque);
  */
 Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque);
 
+/**
+ * Pre-populate the calling thread's coroutine pool
+ *
+ * Allocates up to @count pooled coroutines so that the first burst of
+ * qemu_coroutine_create() calls in this thread does not pay the stack
+ * allocation cost.  Capped at the thread-local pool size; excess
+ * requests are ignored.
+ */
+void qemu_coroutine_pool_prealloc(unsigned int count);
+
 /**
  * Transfer control to a coroutine
  */
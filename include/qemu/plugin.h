@@ -104,6 +104,8 @@ struct qemu_plugin_dyn_cb {
         struct {
             enum qemu_plugin_op op;
             uint64_t imm;
+            /* apply the op to ((uint64_t *)userp)[cpu_index] */
+            bool per_vcpu;
         } inline_insn;
     };
 };
@@ -278,6 +278,37 @@ void qemu_plugin_register_vcpu_insn_exec_inline(struct qemu_plugin_insn *insn,
                                                 enum qemu_plugin_op op,
                                                 void *ptr, uint64_t imm);
 
+/**
+ * qemu_plugin_register_vcpu_tb_exec_inline_per_vcpu() - per-vCPU inline op
+ * @tb: the opaque qemu_plugin_tb handle for the translation
+ * @op: the type of qemu_plugin_op (e.g. ADD_U64)
+ * @ptr: pointer to an array of uint64_t, one entry per vCPU index
+ * @imm: the op data (e.g. 1)
+ *
+ * Like qemu_plugin_register_vcpu_tb_exec_inline(), except the op is
+ * applied to @ptr[vcpu_index] rather than to a single shared counter,
+ * so concurrent vCPUs do not race on the same memory location.  The
+ * array must have one entry for every vCPU index that can occur; in
+ * full-system mode qemu_plugin_n_max_vcpus() entries are enough.
+ */
+void qemu_plugin_register_vcpu_tb_exec_inline_per_vcpu(
+    struct qemu_plugin_tb *tb, enum qemu_plugin_op op,
+    void *ptr, uint64_t imm);
+
+/**
+ * qemu_plugin_register_vcpu_insn_exec_inline_per_vcpu() - per-vCPU inline op
+ * @insn: the opaque qemu_plugin_insn handle for an instruction
+ * @op: the type of qemu_plugin_op (e.g. ADD_U64)
+ * @ptr: pointer to an array of uint64_t, one entry per vCPU index
+ * @imm: the op data (e.g. 1)
+ *
+ * As qemu_plugin_register_vcpu_tb_exec_inline_per_vcpu(), but applied
+ * every time the instruction executes.
+ */
+void qemu_plugin_register_vcpu_insn_exec_inline_per_vcpu(
+    struct qemu_plugin_insn *insn, enum qemu_plugin_op op,
+    void *ptr, uint64_t imm);
+
 /*
  * Helpers to query information about the instructions in a block
  */
@@ -350,6 +381,22 @@ void qemu_plugin_register_vcpu_mem_inline(struct qemu_plugin_insn *insn,
                                           enum qemu_plugin_op op, void *ptr,
                                           uint64_t imm);
 
+/**
+ * qemu_plugin_register_vcpu_mem_inline_per_vcpu() - per-vCPU inline op
+ * @insn: the opaque qemu_plugin_insn handle for an instruction
+ * @rw: apply to reads, writes or both
+ * @op: the type of qemu_plugin_op (e.g. ADD_U64)
+ * @ptr: pointer to an array of uint64_t, one entry per vCPU index
+ * @imm: the op data (e.g. 1)
+ *
+ * As qemu_plugin_register_vcpu_mem_inline(), except the op is applied
+ * to @ptr[vcpu_index], so concurrent vCPUs do not race on the same
+ * memory location.
+ */
+void qemu_plugin_register_vcpu_mem_inline_per_vcpu(
+    struct qemu_plugin_insn *insn, enum qemu_plugin_mem_rw rw,
+    enum qemu_plugin_op op, void *ptr, uint64_t imm);
+
 
 
 typedef void
@@ -23,5 +23,7 @@ bool qsp_is_enabled(void);
 void qsp_enable(void);
 void qsp_disable(void);
 void qsp_reset(void);
+unsigned int qsp_get_sample_period(void);
+void qsp_set_sample_period(unsigned int period);
 
 #endif /* QEMU_QSP_H */
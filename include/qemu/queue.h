@@ -222,6 +222,18 @@ struct {                                                                \
                  save_sle_next);                                             \
 } while (/*CONSTCOND*/0)
 
+/*
+ * Insert a chain of elements, linked from @first through @last, at the
+ * head of the list in a single atomic operation.
+ */
+#define QSLIST_INSERT_CHAIN_ATOMIC(head, first, last, field) do {            \
+        typeof(first) save_sle_next;                                         \
+        do {                                                                 \
+            save_sle_next = (last)->field.sle_next = (head)->slh_first;      \
+        } while (atomic_cmpxchg(&(head)->slh_first, save_sle_next,           \
+                                (first)) != save_sle_next);                  \
+} while (/*CONSTCOND*/0)
+
 #define QSLIST_MOVE_ATOMIC(dest, src) do {                               \
         (dest)->slh_first = atomic_xchg(&(src)->slh_first, NULL);        \
 } while (/*CONSTCOND*/0)
@@ -27,6 +27,7 @@
 #include "qemu/thread.h"
 #include "qemu/queue.h"
 #include "qemu/atomic.h"
+#include "qemu/notify.h"
 #include "qemu/sys_membarrier.h"
 
 #ifdef __cplusplus
@@ -66,6 +67,13 @@ struct rcu_reader_data {
 
     /* Data used for registry, protected by rcu_registry_lock */
     QLIST_ENTRY(rcu_reader_data) node;
+
+    /*
+     * NotifierList used to force an RCU grace period.  Accessed under
+     * rcu_registry_lock.  Note that the notifier is called _outside_
+     * the thread!
+     */
+    NotifierList force_rcu;
 };
 
 extern __thread struct rcu_reader_data rcu_reader;
@@ -118,6 +126,15 @@ extern void synchronize_rcu(void);
 extern void rcu_register_thread(void);
 extern void rcu_unregister_thread(void);
 
+/*
+ * Add/remove a notifier that a grace period is waiting on the calling
+ * thread.  The notifier is invoked from another thread, with
+ * rcu_registry_lock held, and should only kick the reader out of its
+ * read-side critical section (e.g. with cpu_exit).
+ */
+extern void rcu_add_force_rcu_notifier(Notifier *n);
+extern void rcu_remove_force_rcu_notifier(Notifier *n);
+
 /*
  * Support for fork().  fork() support is enabled at startup.
  */
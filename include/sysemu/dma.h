@@ -146,6 +146,32 @@ static inline void dma_memory_unmap(AddressSpace *as,
                         dir == DMA_DIRECTION_FROM_DEVICE, access_len);
 }
 
+/*
+ * A single-entry cache for mappings that a device repeats at the same
+ * guest address on every request (PRD tables, descriptor rings, ...).
+ * On a hit the cached host pointer is returned without translating the
+ * address again; the entry is discarded whenever the address space
+ * installs a new FlatView, so memory hotplug or any other topology
+ * change invalidates it.
+ *
+ * Only DMA_DIRECTION_TO_DEVICE mappings are cached, since they need no
+ * dirty tracking when the access completes.  Callers must serialize
+ * access to the cache; device models running under the BQL already do.
+ */
+typedef struct DMAMapCache {
+    AddressSpace *as;
+    struct FlatView *fv;
+    dma_addr_t addr;
+    dma_addr_t len;
+    void *ptr;
+} DMAMapCache;
+
+void dma_map_cache_init(DMAMapCache *cache, AddressSpace *as);
+void *dma_map_cache_read(DMAMapCache *cache, dma_addr_t addr,
+                         dma_addr_t *len);
+void dma_map_cache_finish(DMAMapCache *cache, void *ptr, dma_addr_t len);
+void dma_map_cache_invalidate(DMAMapCache *cache);
+
 #define DEFINE_LDST_DMA(_lname, _sname, _bits, _end) \
     static inline uint##_bits##_t ld##_lname##_##_end##_dma(AddressSpace *as, \
                                                             dma_addr_t addr) \
@@ -37,6 +37,13 @@ typedef struct {
     int64_t poll_max_ns;
     int64_t poll_grow;
     int64_t poll_shrink;
+
+    /* Coroutines to pre-allocate in the thread's pool at startup */
+    int64_t coroutine_pool_prealloc;
+
+    /* Host CPUs the thread may run on, NULL means unrestricted */
+    unsigned long *cpu_affinity;
+    unsigned long cpu_affinity_bits;
 } IOThread;
 
 #define IOTHREAD(obj) \
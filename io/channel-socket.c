@@ -27,6 +27,20 @@
 #include "trace.h"
 #include "qapi/clone-visitor.h"
 
+#ifdef CONFIG_LINUX
+#include <linux/errqueue.h>
+/* The definitions below were added in Linux 4.14 */
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#endif /* CONFIG_LINUX */
+
 #define SOCKET_MAX_FDS 16
 
 SocketAddress *
@@ -533,12 +547,47 @@ static ssize_t qio_channel_socket_writev(QIOChannel *ioc,
     char control[CMSG_SPACE(sizeof(int) * SOCKET_MAX_FDS)];
     size_t fdsize = sizeof(int) * nfds;
     struct cmsghdr *cmsg;
+    int sflags = 0;
 
     memset(control, 0, CMSG_SPACE(sizeof(int) * SOCKET_MAX_FDS));
 
     msg.msg_iov = (struct iovec *)iov;
     msg.msg_iovlen = niov;
 
+#ifdef CONFIG_LINUX
+    if (sioc->zero_copy_enabled && !nfds) {
+        /*
+         * The pages of a zero copy send stay shared with the kernel
+         * until the completion arrives, so restrict it to the leading
+         * run of page-sized-or-larger vectors, whose lifetime the
+         * caller controls. Small vectors such as protocol headers,
+         * which typically live on the stack, take the plain copying
+         * branch below; the short write makes the caller retry with
+         * the rest.
+         */
+        size_t run = 0;
+        size_t run_len = 0;
+
+        while (run < niov &&
+               iov[run].iov_len >= qemu_real_host_page_size) {
+            run_len += iov[run].iov_len;
+            run++;
+        }
+        if (run && run_len >= QIO_CHANNEL_SOCKET_ZERO_COPY_MIN) {
+            msg.msg_iovlen = run;
+            sflags |= MSG_ZEROCOPY;
+        } else {
+            size_t small = 1;
+
+            while (small < niov &&
+                   iov[small].iov_len < qemu_real_host_page_size) {
+                small++;
+            }
+            msg.msg_iovlen = small;
+        }
+    }
+#endif
+
     if (nfds) {
         if (nfds > SOCKET_MAX_FDS) {
             error_setg_errno(errp, EINVAL,
@@ -558,7 +607,7 @@ static ssize_t qio_channel_socket_writev(QIOChannel *ioc,
     }
 
  retry:
-    ret = sendmsg(sioc->fd, &msg, 0);
+    ret = sendmsg(sioc->fd, &msg, sflags);
     if (ret <= 0) {
         if (errno == EAGAIN) {
             return QIO_CHANNEL_ERR_BLOCK;
@@ -566,10 +615,22 @@ static ssize_t qio_channel_socket_writev(QIOChannel *ioc,
         if (errno == EINTR) {
             goto retry;
         }
+#ifdef CONFIG_LINUX
+        if (errno == ENOBUFS && (sflags & MSG_ZEROCOPY)) {
+            /* Hit the locked memory limit; fall back to copying */
+            sflags &= ~MSG_ZEROCOPY;
+            goto retry;
+        }
+#endif
         error_setg_errno(errp, errno,
                          "Unable to write to socket");
         return -1;
     }
+#ifdef CONFIG_LINUX
+    if (sflags & MSG_ZEROCOPY) {
+        sioc->zero_copy_queued++;
+    }
+#endif
     return ret;
 }
 #else /* WIN32 */
@@ -658,6 +719,125 @@ static ssize_t qio_channel_socket_writev(QIOChannel *ioc,
 }
 #endif /* WIN32 */
 
+int qio_channel_socket_set_zero_copy(QIOChannelSocket *ioc,
+                                     Error **errp)
+{
+#ifdef CONFIG_LINUX
+    int v = 1;
+
+    if (setsockopt(ioc->fd, SOL_SOCKET, SO_ZEROCOPY, &v, sizeof(v)) < 0) {
+        error_setg_errno(errp, errno,
+                         "Unable to enable zero copy on socket");
+        return -1;
+    }
+    ioc->zero_copy_enabled = true;
+    return 0;
+#else
+    error_setg(errp, "Zero copy not available on this platform");
+    return -1;
+#endif
+}
+
+uint64_t qio_channel_socket_zero_copy_queued(QIOChannelSocket *ioc)
+{
+    return ioc->zero_copy_queued;
+}
+
+uint64_t qio_channel_socket_zero_copy_reap(QIOChannelSocket *ioc)
+{
+#ifdef CONFIG_LINUX
+    while (ioc->zero_copy_completed < ioc->zero_copy_queued) {
+        struct msghdr msg = { NULL, };
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+        struct cmsghdr *cmsg;
+        struct sock_extended_err *serr;
+        uint32_t done;
+        uint64_t delta;
+
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(ioc->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* EAGAIN: the remaining completions are still in flight */
+            break;
+        }
+
+        cmsg = CMSG_FIRSTHDR(&msg);
+        if (!cmsg ||
+            (cmsg->cmsg_level != SOL_IP && cmsg->cmsg_level != SOL_IPV6)) {
+            continue;
+        }
+        serr = (struct sock_extended_err *)CMSG_DATA(cmsg);
+        if (serr->ee_errno != 0 ||
+            serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+            continue;
+        }
+
+        /*
+         * ee_info..ee_data is an inclusive range of send numbers,
+         * counted from zero modulo 2^32, whose pages the kernel no
+         * longer references. TCP releases them in order, so tracking
+         * the high watermark is enough.
+         */
+        done = serr->ee_data + 1;
+        delta = (uint32_t)(done - (uint32_t)ioc->zero_copy_completed);
+        if (delta <= ioc->zero_copy_queued - ioc->zero_copy_completed) {
+            ioc->zero_copy_completed += delta;
+        }
+    }
+#endif
+    return ioc->zero_copy_completed;
+}
+
+int qio_channel_socket_zero_copy_flush(QIOChannelSocket *ioc,
+                                       Error **errp)
+{
+#ifdef CONFIG_LINUX
+    while (qio_channel_socket_zero_copy_reap(ioc) < ioc->zero_copy_queued) {
+        GPollFD pfd = {
+            .fd = ioc->fd,
+            /*
+             * Error queue readiness is signalled as an error
+             * condition; POLLERR cannot be masked, so no events are
+             * requested.
+             */
+            .events = 0,
+        };
+        int ret;
+
+        ret = qemu_poll_ns(&pfd, 1, -1);
+        if (ret < 0) {
+            error_setg_errno(errp, errno,
+                             "Failed to wait for zero copy completions");
+            return -1;
+        }
+        if (pfd.revents & (G_IO_HUP | G_IO_NVAL)) {
+            error_setg(errp, "Socket closed while zero copy sends pending");
+            return -1;
+        }
+        if (pfd.revents & G_IO_ERR) {
+            int err = 0;
+            socklen_t errlen = sizeof(err);
+
+            /*
+             * G_IO_ERR is also how error queue readiness is reported;
+             * only a pending socket error is fatal.
+             */
+            if (getsockopt(ioc->fd, SOL_SOCKET, SO_ERROR,
+                           &err, &errlen) == 0 && err) {
+                error_setg_errno(errp, err,
+                                 "Socket error while zero copy sends pending");
+                return -1;
+            }
+        }
+    }
+#endif
+    return 0;
+}
+
 static int
 qio_channel_socket_set_blocking(QIOChannel *ioc,
                                 bool enabled,
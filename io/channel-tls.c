@@ -294,6 +294,9 @@ static ssize_t qio_channel_tls_readv(QIOChannel *ioc,
 }
 
 
+/* Maximum plaintext payload of one TLS record */
+#define QIO_CHANNEL_TLS_RECORD_MAX 16384
+
 static ssize_t qio_channel_tls_writev(QIOChannel *ioc,
                                       const struct iovec *iov,
                                       size_t niov,
@@ -305,10 +308,34 @@ static ssize_t qio_channel_tls_writev(QIOChannel *ioc,
     size_t i;
     ssize_t done = 0;
 
-    for (i = 0 ; i < niov ; i++) {
-        ssize_t ret = qcrypto_tls_session_write(tioc->session,
-                                                iov[i].iov_base,
-                                                iov[i].iov_len);
+    for (i = 0 ; i < niov ; ) {
+        char scratch[QIO_CHANNEL_TLS_RECORD_MAX];
+        const char *base = iov[i].iov_base;
+        size_t len = iov[i].iov_len;
+        size_t next = i + 1;
+        ssize_t ret;
+
+        /*
+         * Each write becomes (at least) one TLS record with its own
+         * framing, crypto operation and push to the transport.  Combine
+         * consecutive small elements into one full record rather than
+         * paying that per element; migration in particular sends long
+         * vectors of page sized buffers.  The coalescing is
+         * deterministic so that a retry after a partial write re-creates
+         * the record that gnutls may have cached.
+         */
+        if (len < QIO_CHANNEL_TLS_RECORD_MAX && next < niov) {
+            memcpy(scratch, base, len);
+            while (next < niov &&
+                   len + iov[next].iov_len <= QIO_CHANNEL_TLS_RECORD_MAX) {
+                memcpy(scratch + len, iov[next].iov_base, iov[next].iov_len);
+                len += iov[next].iov_len;
+                next++;
+            }
+            base = scratch;
+        }
+
+        ret = qcrypto_tls_session_write(tioc->session, base, len);
         if (ret <= 0) {
             if (errno == EAGAIN) {
                 if (done) {
@@ -323,9 +350,10 @@ static ssize_t qio_channel_tls_writev(QIOChannel *ioc,
             return -1;
         }
         done += ret;
-        if (ret < iov[i].iov_len) {
+        if (ret < len) {
             break;
         }
+        i = next;
     }
     return done;
 }
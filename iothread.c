@@ -19,10 +19,13 @@
 #include "block/block.h"
 #include "sysemu/iothread.h"
 #include "qapi/error.h"
+#include "qapi/qapi-builtin-visit.h"
 #include "qapi/qapi-commands-misc.h"
+#include "qemu/bitmap.h"
 #include "qemu/error-report.h"
 #include "qemu/rcu.h"
 #include "qemu/main-loop.h"
+#include "qemu/coroutine.h"
 
 typedef ObjectClass IOThreadClass;
 
@@ -88,6 +91,14 @@ static void *iothread_run(void *opaque)
     return NULL;
 }
 
+/* Runs in iothread_run() thread */
+static void iothread_coroutine_pool_prealloc_bh(void *opaque)
+{
+    IOThread *iothread = opaque;
+
+    qemu_coroutine_pool_prealloc(iothread->coroutine_pool_prealloc);
+}
+
 /* Runs in iothread_run() thread */
 static void iothread_stop_bh(void *opaque)
 {
@@ -141,6 +152,8 @@ static void iothread_instance_finalize(Object *obj)
         aio_context_unref(iothread->ctx);
         iothread->ctx = NULL;
     }
+    g_free(iothread->cpu_affinity);
+    iothread->cpu_affinity = NULL;
     if (iothread->worker_context) {
         g_main_context_unref(iothread->worker_context);
         iothread->worker_context = NULL;
@@ -207,6 +220,25 @@ static void iothread_complete(UserCreatable *obj, Error **errp)
     while (iothread->thread_id == -1) {
         qemu_sem_wait(&iothread->init_done_sem);
     }
+
+    if (iothread->cpu_affinity) {
+        int ret = qemu_thread_set_affinity(&iothread->thread,
+                                           iothread->cpu_affinity,
+                                           iothread->cpu_affinity_bits);
+        if (ret) {
+            /*
+             * The object is unref'ed on failure and instance_finalize
+             * stops the thread for us.
+             */
+            error_setg_errno(errp, -ret, "cannot set CPU affinity");
+            return;
+        }
+    }
+
+    if (iothread->coroutine_pool_prealloc) {
+        aio_bh_schedule_oneshot(iothread->ctx,
+                                iothread_coroutine_pool_prealloc_bh, iothread);
+    }
 }
 
 typedef struct {
@@ -268,6 +300,105 @@ out:
     error_propagate(errp, local_err);
 }
 
+static void iothread_get_coroutine_pool_prealloc(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+
+    visit_type_int64(v, name, &iothread->coroutine_pool_prealloc, errp);
+}
+
+static void iothread_set_coroutine_pool_prealloc(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+    Error *local_err = NULL;
+    int64_t value;
+
+    visit_type_int64(v, name, &value, &local_err);
+    if (local_err) {
+        error_propagate(errp, local_err);
+        return;
+    }
+
+    if (value < 0) {
+        error_setg(errp, "%s value must be in range [0, %" PRId64 "]",
+                   name, INT64_MAX);
+        return;
+    }
+
+    iothread->coroutine_pool_prealloc = value;
+}
+
+static void iothread_get_cpu_affinity(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+    uint16List *cpus = NULL;
+    uint16List **node = &cpus;
+    unsigned long value;
+
+    for (value = find_first_bit(iothread->cpu_affinity,
+                                iothread->cpu_affinity_bits);
+         value < iothread->cpu_affinity_bits;
+         value = find_next_bit(iothread->cpu_affinity,
+                               iothread->cpu_affinity_bits, value + 1)) {
+        *node = g_new0(uint16List, 1);
+        (*node)->value = value;
+        node = &(*node)->next;
+    }
+
+    visit_type_uint16List(v, name, &cpus, errp);
+    qapi_free_uint16List(cpus);
+}
+
+static void iothread_set_cpu_affinity(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+    uint16List *l, *cpus = NULL;
+    unsigned long *bitmap;
+    unsigned long nbits = 0;
+    Error *local_err = NULL;
+
+    visit_type_uint16List(v, name, &cpus, &local_err);
+    if (local_err) {
+        error_propagate(errp, local_err);
+        return;
+    }
+
+    if (!cpus) {
+        error_setg(errp, "%s list cannot be empty", name);
+        return;
+    }
+
+    for (l = cpus; l; l = l->next) {
+        nbits = MAX(nbits, l->value + 1ul);
+    }
+    bitmap = bitmap_new(nbits);
+    for (l = cpus; l; l = l->next) {
+        bitmap_set(bitmap, l->value, 1);
+    }
+
+    if (iothread->ctx) {
+        /* The thread is already running, re-pin it right away */
+        int ret = qemu_thread_set_affinity(&iothread->thread, bitmap, nbits);
+
+        if (ret) {
+            error_setg_errno(errp, -ret, "cannot set CPU affinity");
+            g_free(bitmap);
+            goto out;
+        }
+    }
+
+    g_free(iothread->cpu_affinity);
+    iothread->cpu_affinity = bitmap;
+    iothread->cpu_affinity_bits = nbits;
+
+out:
+    qapi_free_uint16List(cpus);
+}
+
 static void iothread_class_init(ObjectClass *klass, void *class_data)
 {
     UserCreatableClass *ucc = USER_CREATABLE_CLASS(klass);
@@ -285,6 +416,14 @@ static void iothread_class_init(ObjectClass *klass, void *class_data)
                               iothread_get_poll_param,
                               iothread_set_poll_param,
                               NULL, &poll_shrink_info, &error_abort);
+    object_class_property_add(klass, "coroutine-pool-prealloc", "int",
+                              iothread_get_coroutine_pool_prealloc,
+                              iothread_set_coroutine_pool_prealloc,
+                              NULL, NULL, &error_abort);
+    object_class_property_add(klass, "cpu-affinity", "int",
+                              iothread_get_cpu_affinity,
+                              iothread_set_cpu_affinity,
+                              NULL, NULL, &error_abort);
 }
 
 static const TypeInfo iothread_info = {
@@ -335,6 +474,8 @@ static int query_one_iothread(Object *object, void *opaque)
     info->poll_max_ns = iothread->poll_max_ns;
     info->poll_grow = iothread->poll_grow;
     info->poll_shrink = iothread->poll_shrink;
+    info->poll_hits = iothread->ctx->poll_hits;
+    info->poll_misses = iothread->ctx->poll_misses;
 
     elem = g_new0(IOThreadInfoList, 1);
     elem->value = info;
@@ -12153,6 +12153,7 @@ abi_long do_syscall(void *cpu_env, int num, abi_long arg1,
                     abi_long arg8)
 {
     CPUState *cpu = env_cpu(cpu_env);
+    bool strace = unlikely(qemu_loglevel_mask(LOG_STRACE));
     abi_long ret;
 
 #ifdef DEBUG_ERESTARTSYS
@@ -12172,14 +12173,14 @@ abi_long do_syscall(void *cpu_env, int num, abi_long arg1,
     record_syscall_start(cpu, num, arg1,
                          arg2, arg3, arg4, arg5, arg6, arg7, arg8);
 
-    if (unlikely(qemu_loglevel_mask(LOG_STRACE))) {
+    if (strace) {
         print_syscall(num, arg1, arg2, arg3, arg4, arg5, arg6);
     }
 
     ret = do_syscall1(cpu_env, num, arg1, arg2, arg3, arg4,
                       arg5, arg6, arg7, arg8);
 
-    if (unlikely(qemu_loglevel_mask(LOG_STRACE))) {
+    if (strace) {
         print_syscall_ret(num, ret);
     }
 
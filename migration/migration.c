@@ -807,6 +807,8 @@ MigrationParameters *qmp_query_migrate_parameters(Error **errp)
     params->multifd_zlib_level = s->parameters.multifd_zlib_level;
     params->has_multifd_zstd_level = true;
     params->multifd_zstd_level = s->parameters.multifd_zstd_level;
+    params->has_multifd_cpu_list = true;
+    params->multifd_cpu_list = g_strdup(s->parameters.multifd_cpu_list);
     params->has_xbzrle_cache_size = true;
     params->xbzrle_cache_size = s->parameters.xbzrle_cache_size;
     params->has_max_postcopy_bandwidth = true;
@@ -1078,6 +1080,18 @@ static bool migrate_caps_check(bool *cap_list,
         }
     }
 
+    if (cap_list[MIGRATION_CAPABILITY_ZERO_COPY_SEND]) {
+#ifdef CONFIG_LINUX
+        if (!cap_list[MIGRATION_CAPABILITY_MULTIFD]) {
+            error_setg(errp, "Zero copy send requires multifd");
+            return false;
+        }
+#else
+        error_setg(errp, "Zero copy send is only available on Linux");
+        return false;
+#endif
+    }
+
     return true;
 }
 
@@ -1237,6 +1251,16 @@ static bool migrate_params_check(MigrationParameters *params, Error **errp)
         return false;
     }
 
+    if (params->has_multifd_cpu_list && params->multifd_cpu_list[0]) {
+        GArray *cpus = g_array_new(FALSE, FALSE, sizeof(int));
+        bool ok = multifd_cpu_list_parse(params->multifd_cpu_list, cpus, errp);
+
+        g_array_free(cpus, TRUE);
+        if (!ok) {
+            return false;
+        }
+    }
+
     if (params->has_xbzrle_cache_size &&
         (params->xbzrle_cache_size < qemu_target_page_size() ||
          !is_power_of_2(params->xbzrle_cache_size))) {
@@ -1354,6 +1378,10 @@ static void migrate_params_test_apply(MigrateSetParameters *params,
     if (params->has_multifd_compression) {
         dest->multifd_compression = params->multifd_compression;
     }
+    if (params->has_multifd_cpu_list) {
+        assert(params->multifd_cpu_list->type == QTYPE_QSTRING);
+        dest->multifd_cpu_list = g_strdup(params->multifd_cpu_list->u.s);
+    }
     if (params->has_xbzrle_cache_size) {
         dest->xbzrle_cache_size = params->xbzrle_cache_size;
     }
@@ -1457,6 +1485,11 @@ static void migrate_params_apply(MigrateSetParameters *params, Error **errp)
     if (params->has_multifd_compression) {
         s->parameters.multifd_compression = params->multifd_compression;
     }
+    if (params->has_multifd_cpu_list) {
+        g_free(s->parameters.multifd_cpu_list);
+        assert(params->multifd_cpu_list->type == QTYPE_QSTRING);
+        s->parameters.multifd_cpu_list = g_strdup(params->multifd_cpu_list->u.s);
+    }
     if (params->has_xbzrle_cache_size) {
         s->parameters.xbzrle_cache_size = params->xbzrle_cache_size;
         xbzrle_cache_resize(params->xbzrle_cache_size, errp);
@@ -1503,6 +1536,13 @@ void qmp_migrate_set_parameters(MigrateSetParameters *params, Error **errp)
         params->tls_hostname->type = QTYPE_QSTRING;
         params->tls_hostname->u.s = strdup("");
     }
+    /* TODO Rewrite "" to null instead */
+    if (params->has_multifd_cpu_list
+        && params->multifd_cpu_list->type == QTYPE_QNULL) {
+        qobject_unref(params->multifd_cpu_list->u.n);
+        params->multifd_cpu_list->type = QTYPE_QSTRING;
+        params->multifd_cpu_list->u.s = strdup("");
+    }
 
     migrate_params_test_apply(params, &tmp);
 
@@ -2263,6 +2303,15 @@ bool migrate_use_multifd(void)
     return s->enabled_capabilities[MIGRATION_CAPABILITY_MULTIFD];
 }
 
+bool migrate_use_zero_copy_send(void)
+{
+    MigrationState *s;
+
+    s = migrate_get_current();
+
+    return s->enabled_capabilities[MIGRATION_CAPABILITY_ZERO_COPY_SEND];
+}
+
 bool migrate_pause_before_switchover(void)
 {
     MigrationState *s;
@@ -2309,6 +2358,15 @@ int migrate_multifd_zstd_level(void)
     return s->parameters.multifd_zstd_level;
 }
 
+const char *migrate_multifd_cpu_list(void)
+{
+    MigrationState *s;
+
+    s = migrate_get_current();
+
+    return s->parameters.multifd_cpu_list;
+}
+
 int migrate_use_xbzrle(void)
 {
     MigrationState *s;
@@ -3664,6 +3722,7 @@ static void migration_instance_finalize(Object *obj)
     qemu_mutex_destroy(&ms->qemu_file_lock);
     g_free(params->tls_hostname);
     g_free(params->tls_creds);
+    g_free(params->multifd_cpu_list);
     qemu_sem_destroy(&ms->wait_unplug_sem);
     qemu_sem_destroy(&ms->rate_limit_sem);
     qemu_sem_destroy(&ms->pause_sem);
@@ -3686,6 +3745,7 @@ static void migration_instance_init(Object *obj)
 
     params->tls_hostname = g_strdup("");
     params->tls_creds = g_strdup("");
+    params->multifd_cpu_list = g_strdup("");
 
     /* Set has_* up only for parameter checks */
     params->has_compress_level = true;
@@ -3702,6 +3762,7 @@ static void migration_instance_init(Object *obj)
     params->has_multifd_compression = true;
     params->has_multifd_zlib_level = true;
     params->has_multifd_zstd_level = true;
+    params->has_multifd_cpu_list = true;
     params->has_xbzrle_cache_size = true;
     params->has_max_postcopy_bandwidth = true;
     params->has_max_cpu_throttle = true;
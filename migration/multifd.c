@@ -11,12 +11,15 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/ctype.h"
+#include "qemu/cutils.h"
 #include "qemu/rcu.h"
 #include "exec/target_page.h"
 #include "sysemu/sysemu.h"
 #include "exec/ramblock.h"
 #include "qemu/error-report.h"
 #include "qapi/error.h"
+#include "io/channel-socket.h"
 #include "ram.h"
 #include "migration.h"
 #include "socket.h"
@@ -605,6 +608,76 @@ void multifd_send_sync_main(QEMUFile *f)
     trace_multifd_send_sync_main(multifd_send_state->packet_num);
 }
 
+bool multifd_cpu_list_parse(const char *cpu_list, GArray *cpus, Error **errp)
+{
+    const char *s = cpu_list;
+
+    while (true) {
+        unsigned long first, last;
+        unsigned long i;
+
+        if (!qemu_isdigit(*s) || qemu_strtoul(s, &s, 10, &first) < 0) {
+            goto invalid;
+        }
+        last = first;
+        if (*s == '-') {
+            s++;
+            if (!qemu_isdigit(*s) || qemu_strtoul(s, &s, 10, &last) < 0 ||
+                last < first) {
+                goto invalid;
+            }
+        }
+        for (i = first; i <= last; i++) {
+            int cpu = i;
+
+            g_array_append_val(cpus, cpu);
+        }
+        if (*s == '\0') {
+            return true;
+        }
+        if (*s != ',') {
+            goto invalid;
+        }
+        s++;
+    }
+
+invalid:
+    error_setg(errp, "Invalid CPU list '%s', expected e.g. '0-3,8'", cpu_list);
+    return false;
+}
+
+/*
+ * Pin a multifd channel thread to one CPU of the multifd-cpu-list
+ * parameter, assigned round-robin by channel id. Failure to pin only
+ * costs locality, so it is reported but not fatal.
+ */
+static void multifd_thread_set_affinity(int id)
+{
+#ifdef CONFIG_LINUX
+    const char *cpu_list = migrate_multifd_cpu_list();
+    GArray *cpus;
+    cpu_set_t set;
+    int cpu, err;
+
+    if (!cpu_list || !cpu_list[0]) {
+        return;
+    }
+    cpus = g_array_new(FALSE, FALSE, sizeof(int));
+    /* the list was validated when the parameter was set */
+    if (multifd_cpu_list_parse(cpu_list, cpus, NULL)) {
+        cpu = g_array_index(cpus, int, id % cpus->len);
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err) {
+            warn_report("multifd: cannot pin channel %d to CPU %d: %s",
+                        id, cpu, strerror(err));
+        }
+    }
+    g_array_free(cpus, TRUE);
+#endif
+}
+
 static void *multifd_send_thread(void *opaque)
 {
     MultiFDSendParams *p = opaque;
@@ -614,6 +687,7 @@ static void *multifd_send_thread(void *opaque)
 
     trace_multifd_send_thread_start(p->id);
     rcu_register_thread();
+    multifd_thread_set_affinity(p->id);
 
     if (multifd_send_initial_packet(p, &local_err) < 0) {
         ret = -1;
@@ -672,6 +746,18 @@ static void *multifd_send_thread(void *opaque)
             qemu_mutex_unlock(&p->mutex);
 
             if (flags & MULTIFD_FLAG_SYNC) {
+                /*
+                 * The main thread takes sem_sync as a promise that the
+                 * pages of this round are on the wire, so collect all
+                 * outstanding zero copy sends first.
+                 */
+                if (p->zero_copy) {
+                    ret = qio_channel_socket_zero_copy_flush(
+                            QIO_CHANNEL_SOCKET(p->c), &local_err);
+                    if (ret != 0) {
+                        break;
+                    }
+                }
                 qemu_sem_post(&p->sem_sync);
             }
             qemu_sem_post(&multifd_send_state->channels_ready);
@@ -730,6 +816,16 @@ static void multifd_new_send_channel_async(QIOTask *task, gpointer opaque)
     } else {
         p->c = QIO_CHANNEL(sioc);
         qio_channel_set_delay(p->c, false);
+        if (migrate_use_zero_copy_send()) {
+            if (qio_channel_socket_set_zero_copy(QIO_CHANNEL_SOCKET(sioc),
+                                                 &local_err) == 0) {
+                p->zero_copy = true;
+            } else {
+                /* fall back to copying sends on this channel */
+                warn_report_err(local_err);
+                local_err = NULL;
+            }
+        }
         p->running = true;
         qemu_thread_create(&p->thread, p->name, multifd_send_thread, p,
                            QEMU_THREAD_JOINABLE);
@@ -913,6 +1009,7 @@ static void *multifd_recv_thread(void *opaque)
 
     trace_multifd_recv_thread_start(p->id);
     rcu_register_thread();
+    multifd_thread_set_affinity(p->id);
 
     while (true) {
         uint32_t used;
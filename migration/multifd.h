@@ -22,6 +22,7 @@ bool multifd_recv_new_channel(QIOChannel *ioc, Error **errp);
 void multifd_recv_sync_main(void);
 void multifd_send_sync_main(QEMUFile *f);
 int multifd_queue_page(QEMUFile *f, RAMBlock *block, ram_addr_t offset);
+bool multifd_cpu_list_parse(const char *cpu_list, GArray *cpus, Error **errp);
 
 /* Multifd Compression flags */
 #define MULTIFD_FLAG_SYNC (1 << 0)
@@ -75,6 +76,8 @@ typedef struct {
     QemuThread thread;
     /* communication channel */
     QIOChannel *c;
+    /* channel sends pages with MSG_ZEROCOPY */
+    bool zero_copy;
     /* sem where to wait for more work */
     QemuSemaphore sem;
     /* this mutex protects the following parameters */
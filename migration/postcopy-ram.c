@@ -869,6 +869,66 @@ static bool postcopy_pause_fault_thread(MigrationIncomingState *mis)
     return true;
 }
 
+/*
+ * How many host pages around a faulting page to ask for in the
+ * background, on top of the faulted page itself. Faults cluster, so
+ * pulling the neighbourhood forward in the stream saves the guest the
+ * next few stalls; the window is kept small so that it cannot starve
+ * requests for pages other vCPUs are actually blocked on.
+ */
+#define POSTCOPY_PREFETCH_BEHIND 2
+#define POSTCOPY_PREFETCH_AHEAD 8
+
+/*
+ * Request the not-yet-received pages around a faulting page, so that
+ * the source reorders its background stream around the guest's
+ * current working set rather than only jumping to the faulted page.
+ * The faulted page itself has already been requested by the caller.
+ * Failures are ignored; they are advisory requests and a broken
+ * channel is caught by the next demand request.
+ *
+ * Returns the end offset of the window, so the caller can avoid
+ * re-requesting it for the next fault in the same neighbourhood.
+ */
+static ram_addr_t postcopy_prefetch_around(MigrationIncomingState *mis,
+                                           RAMBlock *rb, ram_addr_t rb_offset)
+{
+    size_t pagesize = qemu_ram_pagesize(rb);
+    ram_addr_t limit = qemu_ram_get_used_length(rb) & ~(pagesize - 1);
+    ram_addr_t start, end, offset, run_start = 0;
+    bool in_run = false;
+
+    if (rb_offset > POSTCOPY_PREFETCH_BEHIND * pagesize) {
+        start = rb_offset - POSTCOPY_PREFETCH_BEHIND * pagesize;
+    } else {
+        start = 0;
+    }
+    end = rb_offset + (POSTCOPY_PREFETCH_AHEAD + 1) * pagesize;
+    if (end > limit) {
+        end = limit;
+    }
+
+    /* request each run of pages that have not been received yet */
+    for (offset = start; offset <= end; offset += pagesize) {
+        bool wanted = offset < end && offset != rb_offset &&
+                      !ramblock_recv_bitmap_test_byte_offset(rb, offset);
+
+        if (wanted && !in_run) {
+            run_start = offset;
+            in_run = true;
+        } else if (!wanted && in_run) {
+            trace_postcopy_prefetch_around(qemu_ram_get_idstr(rb), run_start,
+                                           offset - run_start);
+            /* the caller has just sent a request for this block */
+            migrate_send_rp_req_pages(mis, NULL, run_start,
+                                      offset - run_start);
+            in_run = false;
+        }
+    }
+
+    return end;
+}
+
 /*
  * Handle faults detected by the USERFAULT markings
  */
@@ -879,6 +939,9 @@ static void *postcopy_ram_fault_thread(void *opaque)
     int ret;
     size_t index;
     RAMBlock *rb = NULL;
+    /* window already covered by postcopy_prefetch_around() */
+    RAMBlock *prefetch_rb = NULL;
+    ram_addr_t prefetch_start = 0, prefetch_end = 0;
 
     trace_postcopy_ram_fault_thread_entry();
     rcu_register_thread();
@@ -1030,6 +1093,17 @@ retry:
                     break;
                 }
             }
+
+            /*
+             * Ask for the pages around the fault too, unless a recent
+             * fault already covered this neighbourhood.
+             */
+            if (rb != prefetch_rb || rb_offset < prefetch_start ||
+                rb_offset >= prefetch_end) {
+                prefetch_rb = rb;
+                prefetch_start = rb_offset;
+                prefetch_end = postcopy_prefetch_around(mis, rb, rb_offset);
+            }
         }
 
         /* Now handle any requests from external processes on shared memory */
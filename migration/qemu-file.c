@@ -31,7 +31,13 @@
 #include "qapi/error.h"
 
 #define IO_BUF_SIZE 32768
-#define MAX_IOV_SIZE MIN(IOV_MAX, 64)
+/*
+ * The iovec array sizes the batch handed to writev_buffer: once it is
+ * full the stream has to flush, serialising the saver against the
+ * socket. Device state made of many referenced buffers fills slots
+ * much faster than it fills IO_BUF_SIZE, so allow a deeper batch.
+ */
+#define MAX_IOV_SIZE MIN(IOV_MAX, 256)
 
 struct QEMUFile {
     const QEMUFileOps *ops;
@@ -615,21 +615,35 @@ static size_t save_page_header(RAMState *rs, QEMUFile *f,  RAMBlock *block,
  * which we can transfer pages to the destination then we should be
  * able to complete migration. Some workloads dirty memory way too
  * fast and will not effectively converge, even with auto-converge.
+ *
+ * The new throttle percentage is computed from the measured ratio of
+ * dirtied bytes to transferred bytes: the share of CPU time the guest
+ * keeps is scaled by how far the dirty rate is above the trigger
+ * threshold, so a fast dirtier converges in a couple of periods
+ * instead of climbing there in fixed increments.
+ * cpu_throttle_increment stays the minimum step, so existing tunings
+ * keep at least their previous convergence speed.
  */
-static void mig_throttle_guest_down(void)
+static void mig_throttle_guest_down(uint64_t bytes_dirty_period,
+                                    uint64_t bytes_dirty_threshold)
 {
     MigrationState *s = migrate_get_current();
     uint64_t pct_initial = s->parameters.cpu_throttle_initial;
-    uint64_t pct_icrement = s->parameters.cpu_throttle_increment;
+    uint64_t pct_increment = s->parameters.cpu_throttle_increment;
     int pct_max = s->parameters.max_cpu_throttle;
 
+    uint64_t throttle_now = cpu_throttle_get_percentage();
+    uint64_t cpu_now, cpu_ideal, pct_ideal;
+
     /* We have not started throttling yet. Let's start it. */
     if (!cpu_throttle_active()) {
         cpu_throttle_set(pct_initial);
     } else {
-        /* Throttling already on, just increase the rate */
-        cpu_throttle_set(MIN(cpu_throttle_get_percentage() + pct_icrement,
-                         pct_max));
+        /* Throttling already on, adjust the rate */
+        cpu_now = 100 - throttle_now;
+        cpu_ideal = cpu_now * bytes_dirty_threshold / bytes_dirty_period;
+        pct_ideal = MAX(100 - cpu_ideal, throttle_now + pct_increment);
+        cpu_throttle_set(MIN(pct_ideal, pct_max));
     }
 }
 
@@ -919,7 +933,8 @@ static void migration_trigger_throttle(RAMState *rs)
             (++rs->dirty_rate_high_cnt >= 2)) {
             trace_migration_throttle();
             rs->dirty_rate_high_cnt = 0;
-            mig_throttle_guest_down();
+            mig_throttle_guest_down(bytes_dirty_period,
+                                    bytes_dirty_threshold);
         }
     }
 }
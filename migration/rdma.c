@@ -54,6 +54,14 @@
 
 #define RDMA_REG_CHUNK_SHIFT 20 /* 1 MB */
 
+/*
+ * Cap on a single merged RDMA write for hugepage-backed RAMBlocks.
+ * Writes are allowed to grow to the backing page size so that a
+ * gigantic-page guest is moved in large transfers, but they are still
+ * bounded so that completions (and accounting) keep flowing.
+ */
+#define RDMA_MERGE_MAX_HUGE (128 * 1024 * 1024)
+
 /*
  * This is only for non-live state being migrated.
  * Instead of RDMA_WRITE messages, we use RDMA_SEND
@@ -212,6 +220,7 @@ typedef struct RDMALocalBlock {
     uint64_t       remote_host_addr; /* remote virtual address */
     uint64_t       offset;
     uint64_t       length;
+    uint64_t       pagesize;        /* host backing page size */
     struct         ibv_mr **pmr;    /* MRs for chunk-level registration */
     struct         ibv_mr *mr;      /* MR for non-chunk-level registration */
     uint32_t      *remote_keys;     /* rkeys for chunk-level registration */
@@ -562,7 +571,8 @@ static inline uint8_t *ram_chunk_end(const RDMALocalBlock *rdma_ram_block,
 
 static int rdma_add_block(RDMAContext *rdma, const char *block_name,
                          void *host_addr,
-                         ram_addr_t block_offset, uint64_t length)
+                         ram_addr_t block_offset, uint64_t length,
+                         uint64_t pagesize)
 {
     RDMALocalBlocks *local = &rdma->local_ram_blocks;
     RDMALocalBlock *block;
@@ -592,6 +602,7 @@ static int rdma_add_block(RDMAContext *rdma, const char *block_name,
     block->local_host_addr = host_addr;
     block->offset = block_offset;
     block->length = length;
+    block->pagesize = pagesize;
     block->index = local->nb_blocks;
     block->src_index = ~0U; /* Filled in by the receipt of the block list */
     block->nb_chunks = ram_chunk_index(host_addr, host_addr + length) + 1UL;
@@ -631,7 +642,8 @@ static int qemu_rdma_init_one_block(RAMBlock *rb, void *opaque)
     void *host_addr = qemu_ram_get_host_addr(rb);
     ram_addr_t block_offset = qemu_ram_get_offset(rb);
     ram_addr_t length = qemu_ram_get_used_length(rb);
-    return rdma_add_block(opaque, block_name, host_addr, block_offset, length);
+    return rdma_add_block(opaque, block_name, host_addr, block_offset, length,
+                          qemu_ram_pagesize(rb));
 }
 
 /*
@@ -1187,6 +1199,24 @@ static int qemu_rdma_register_and_get_keys(RDMAContext *rdma,
         uint32_t *lkey, uint32_t *rkey, int chunk,
         uint8_t *chunk_start, uint8_t *chunk_end)
 {
+    /*
+     * Hugepage-backed RAMBlocks are pinned by their backing at page
+     * granularity already, so chunk-level registration buys nothing
+     * there and costs one ibv_reg_mr() per megabyte of guest RAM.
+     * Register the whole block with a single MR instead; if that is
+     * refused (e.g. per-MR size limits), fall back to chunks.
+     */
+    if (!block->mr && block->is_ram_block &&
+        block->pagesize > qemu_real_host_page_size) {
+        block->mr = ibv_reg_mr(rdma->pd, block->local_host_addr,
+                               block->length,
+                               (rkey ? (IBV_ACCESS_LOCAL_WRITE |
+                                       IBV_ACCESS_REMOTE_WRITE) : 0));
+        if (block->mr) {
+            rdma->total_registrations++;
+        }
+    }
+
     if (block->mr) {
         if (lkey) {
             *lkey = block->mr->lkey;
@@ -2230,7 +2260,26 @@ static inline int qemu_rdma_buffer_mergable(RDMAContext *rdma,
 
     block = &(rdma->local_ram_blocks.block[rdma->current_index]);
     host_addr = block->local_host_addr + (offset - block->offset);
-    chunk_end = ram_chunk_end(block, rdma->current_chunk);
+
+    /*
+     * Hugepage-backed blocks are covered by a single MR, so merged
+     * writes only need to stop at the backing page (the registration
+     * protocol already supports multi-chunk spans); everything else
+     * keeps the chunk as the merge boundary.
+     */
+    if (block->is_ram_block && block->pagesize > qemu_real_host_page_size) {
+        uint8_t *run_start = block->local_host_addr +
+                             (rdma->current_addr - block->offset);
+
+        chunk_end = (uint8_t *)QEMU_ALIGN_DOWN((uintptr_t)run_start,
+                                               block->pagesize) +
+                    block->pagesize;
+        if (chunk_end > block->local_host_addr + block->length) {
+            chunk_end = block->local_host_addr + block->length;
+        }
+    } else {
+        chunk_end = ram_chunk_end(block, rdma->current_chunk);
+    }
 
     if (rdma->current_length == 0) {
         return 0;
@@ -2275,6 +2324,8 @@ static int qemu_rdma_write(QEMUFile *f, RDMAContext *rdma,
     uint64_t current_addr = block_offset + offset;
     uint64_t index = rdma->current_index;
     uint64_t chunk = rdma->current_chunk;
+    uint64_t merge_max;
+    RDMALocalBlock *block;
     int ret;
 
     /* If we cannot merge it, we flush the current buffer first. */
@@ -2300,7 +2351,12 @@ static int qemu_rdma_write(QEMUFile *f, RDMAContext *rdma,
     rdma->current_length += len;
 
     /* flush it if buffer is too large */
-    if (rdma->current_length >= RDMA_MERGE_MAX) {
+    merge_max = RDMA_MERGE_MAX;
+    block = &(rdma->local_ram_blocks.block[rdma->current_index]);
+    if (block->pagesize > merge_max) {
+        merge_max = MIN(block->pagesize, RDMA_MERGE_MAX_HUGE);
+    }
+    if (rdma->current_length >= merge_max) {
         return qemu_rdma_write_flush(f, rdma);
     }
 
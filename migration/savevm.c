@@ -127,30 +127,102 @@ static struct mig_cmd_args {
 /***********************************************************/
 /* savevm/loadvm support */
 
-static ssize_t block_writev_buffer(void *opaque, struct iovec *iov, int iovcnt,
-                                   int64_t pos, Error **errp)
+/*
+ * Each vmstate write is a synchronous round trip through the block
+ * layer in the main loop, so the size of the batches handed to
+ * bdrv_writev_vmstate() directly sets how often the monitor stalls
+ * during savevm. Coalesce the QEMUFile's flushes into multi-megabyte
+ * writes before they hit the block layer.
+ */
+#define BDRV_VMSTATE_BUF_SIZE (4 * 1024 * 1024)
+
+typedef struct BdrvVmstateFile {
+    BlockDriverState *bs;
+    /* coalesces vmstate writes, unused when reading */
+    uint8_t *buf;
+    size_t buf_used;
+    int64_t buf_pos; /* vmstate offset of buf[0] */
+} BdrvVmstateFile;
+
+static ssize_t bdrv_vmstate_flush(BdrvVmstateFile *bf)
 {
-    int ret;
     QEMUIOVector qiov;
+    struct iovec iov = {
+        .iov_base = bf->buf,
+        .iov_len = bf->buf_used,
+    };
+    int ret;
 
-    qemu_iovec_init_external(&qiov, iov, iovcnt);
-    ret = bdrv_writev_vmstate(opaque, &qiov, pos);
+    if (!bf->buf_used) {
+        return 0;
+    }
+
+    qemu_iovec_init_external(&qiov, &iov, 1);
+    ret = bdrv_writev_vmstate(bf->bs, &qiov, bf->buf_pos);
     if (ret < 0) {
         return ret;
     }
 
-    return qiov.size;
+    bf->buf_pos += bf->buf_used;
+    bf->buf_used = 0;
+    return 0;
+}
+
+static ssize_t block_writev_buffer(void *opaque, struct iovec *iov, int iovcnt,
+                                   int64_t pos, Error **errp)
+{
+    BdrvVmstateFile *bf = opaque;
+    ssize_t done = 0;
+    int ret, i;
+
+    /* the QEMUFile on top writes strictly sequentially */
+    assert(pos == bf->buf_pos + (int64_t)bf->buf_used);
+
+    for (i = 0; i < iovcnt; i++) {
+        const uint8_t *base = iov[i].iov_base;
+        size_t len = iov[i].iov_len;
+
+        while (len) {
+            size_t l = MIN(len, BDRV_VMSTATE_BUF_SIZE - bf->buf_used);
+
+            memcpy(bf->buf + bf->buf_used, base, l);
+            bf->buf_used += l;
+            base += l;
+            len -= l;
+            done += l;
+
+            if (bf->buf_used == BDRV_VMSTATE_BUF_SIZE) {
+                ret = bdrv_vmstate_flush(bf);
+                if (ret < 0) {
+                    return ret;
+                }
+            }
+        }
+    }
+
+    return done;
 }
 
 static ssize_t block_get_buffer(void *opaque, uint8_t *buf, int64_t pos,
                                 size_t size, Error **errp)
 {
-    return bdrv_load_vmstate(opaque, buf, pos, size);
+    BdrvVmstateFile *bf = opaque;
+
+    return bdrv_load_vmstate(bf->bs, buf, pos, size);
 }
 
 static int bdrv_fclose(void *opaque, Error **errp)
 {
-    return bdrv_flush(opaque);
+    BdrvVmstateFile *bf = opaque;
+    int ret;
+
+    ret = bdrv_vmstate_flush(bf);
+    if (ret == 0) {
+        ret = bdrv_flush(bf->bs);
+    }
+    g_free(bf->buf);
+    g_free(bf);
+    return ret;
 }
 
 static const QEMUFileOps bdrv_read_ops = {
@@ -165,10 +237,14 @@ static const QEMUFileOps bdrv_write_ops = {
 
 static QEMUFile *qemu_fopen_bdrv(BlockDriverState *bs, int is_writable)
 {
+    BdrvVmstateFile *bf = g_new0(BdrvVmstateFile, 1);
+
+    bf->bs = bs;
     if (is_writable) {
-        return qemu_fopen_ops(bs, &bdrv_write_ops);
+        bf->buf = g_malloc(BDRV_VMSTATE_BUF_SIZE);
+        return qemu_fopen_ops(bf, &bdrv_write_ops);
     }
-    return qemu_fopen_ops(bs, &bdrv_read_ops);
+    return qemu_fopen_ops(bf, &bdrv_read_ops);
 }
 
 
@@ -1361,6 +1437,7 @@ int qemu_savevm_state_complete_precopy_non_iterable(QEMUFile *f,
     g_autoptr(QJSON) vmdesc = NULL;
     int vmdesc_len;
     SaveStateEntry *se;
+    int64_t start_ts;
     int ret;
 
     vmdesc = qjson_new();
@@ -1377,6 +1454,7 @@ int qemu_savevm_state_complete_precopy_non_iterable(QEMUFile *f,
         }
 
         trace_savevm_section_start(se->idstr, se->section_id);
+        start_ts = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
 
         json_start_object(vmdesc, NULL);
         json_prop_str(vmdesc, "name", se->idstr);
@@ -1390,6 +1468,9 @@ int qemu_savevm_state_complete_precopy_non_iterable(QEMUFile *f,
         }
         trace_savevm_section_end(se->idstr, se->section_id, 0);
         save_section_footer(f, se);
+        trace_vmstate_downtime_save(se->idstr, se->instance_id,
+                                    qemu_clock_get_us(QEMU_CLOCK_REALTIME) -
+                                    start_ts);
 
         json_end_object(vmdesc);
     }
@@ -2251,6 +2332,7 @@ qemu_loadvm_section_start_full(QEMUFile *f, MigrationIncomingState *mis)
     uint32_t instance_id, version_id, section_id;
     SaveStateEntry *se;
     char idstr[256];
+    int64_t start_ts;
     int ret;
 
     /* Read section start */
@@ -2297,12 +2379,16 @@ qemu_loadvm_section_start_full(QEMUFile *f, MigrationIncomingState *mis)
         return -EINVAL;
     }
 
+    start_ts = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
     ret = vmstate_load(f, se);
     if (ret < 0) {
         error_report("error while loading state for instance 0x%"PRIx32" of"
                      " device '%s'", instance_id, idstr);
         return ret;
     }
+    trace_vmstate_downtime_load(se->idstr, se->instance_id,
+                                qemu_clock_get_us(QEMU_CLOCK_REALTIME) -
+                                start_ts);
     if (!check_section_footer(f, se)) {
         return -EINVAL;
     }
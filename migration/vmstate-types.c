@@ -482,11 +482,29 @@ static int get_buffer(QEMUFile *f, void *pv, size_t size,
     return 0;
 }
 
+/*
+ * Buffers at least this big are referenced from the stream's iovec
+ * instead of being copied through the QEMUFile buffer. Smaller ones
+ * are still copied, so that runs of little fields coalesce instead of
+ * burning an iovec slot each.
+ */
+#define VMSTATE_BUFFER_REF_MIN 1024
+
 static int put_buffer(QEMUFile *f, void *pv, size_t size,
                       const VMStateField *field, QJSON *vmdesc)
 {
     uint8_t *v = pv;
-    qemu_put_buffer(f, v, size);
+
+    if (size >= VMSTATE_BUFFER_REF_MIN) {
+        /*
+         * The buffer is part of the device state, which is quiesced
+         * while it is serialized and stays allocated at least until
+         * the stream is next flushed, so it can be sent by reference.
+         */
+        qemu_put_buffer_async(f, v, size, false);
+    } else {
+        qemu_put_buffer(f, v, size);
+    }
     return 0;
 }
 
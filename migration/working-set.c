@@ -0,0 +1,283 @@
+/*
+ * Guest working set estimation
+ *
+ * Estimates how much guest memory is actively written by sampling
+ * random pages, hashing them, and hashing them again after a
+ * configurable interval.  The fraction of samples that changed scales
+ * up to a per-RAM-block estimate.  Unlike approaches based on the KVM
+ * dirty log this does not touch the dirty page tracking machinery, so
+ * it is cheap and can run while a migration owns the dirty bitmaps.
+ *
+ * Copyright (c) 2020 the QEMU contributors
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include <zlib.h>
+#include "qemu/atomic.h"
+#include "qemu/rcu.h"
+#include "qemu/thread.h"
+#include "qemu/timer.h"
+#include "qemu/units.h"
+#include "qapi/error.h"
+#include "qapi/qapi-commands-migration.h"
+#include "exec/ram_addr.h"
+
+#define WORKING_SET_MIN_CALC_TIME      1
+#define WORKING_SET_MAX_CALC_TIME      60
+
+/* Sampling density; enough for a few percent accuracy per block */
+#define WORKING_SET_SAMPLES_PER_GIB    512
+#define WORKING_SET_MIN_SAMPLES        128
+#define WORKING_SET_MAX_SAMPLES        16384
+
+typedef struct WorkingSetSample {
+    char *idstr;
+    uint64_t size;              /* used_length when first sampled */
+    uint64_t npages;
+    uint64_t nsamples;
+    uint64_t *pages;            /* page indexes within the block */
+    uint32_t *hashes;
+    uint64_t touched;
+    bool revisited;             /* block still existed for the 2nd pass */
+} WorkingSetSample;
+
+typedef struct WorkingSetResult {
+    char *name;
+    uint64_t size;
+    uint64_t sample_pages;
+    uint64_t touched_pages;
+} WorkingSetResult;
+
+/*
+ * Status is written by the measurement thread and read under the BQL;
+ * everything below it is only touched by the thread while the status
+ * is 'measuring' and only read once it has moved on to 'measured'.
+ */
+static int working_set_status = WORKING_SET_STATUS_UNSTARTED;
+static int64_t working_set_start_time;
+static int64_t working_set_calc_time;
+static WorkingSetResult *working_set_results;
+static int working_set_nresults;
+
+static uint32_t working_set_hash_page(RAMBlock *rb, uint64_t page)
+{
+    return crc32(0, rb->host + (page << TARGET_PAGE_BITS),
+                 TARGET_PAGE_SIZE);
+}
+
+static bool working_set_block_skipped(RAMBlock *rb)
+{
+    return !qemu_ram_is_migratable(rb) || !rb->host ||
+           rb->used_length < TARGET_PAGE_SIZE;
+}
+
+static uint64_t working_set_nsamples(uint64_t npages)
+{
+    uint64_t nsamples;
+
+    nsamples = npages * TARGET_PAGE_SIZE / GiB * WORKING_SET_SAMPLES_PER_GIB;
+    nsamples = MAX(nsamples, WORKING_SET_MIN_SAMPLES);
+    nsamples = MIN(nsamples, WORKING_SET_MAX_SAMPLES);
+    return MIN(nsamples, npages);
+}
+
+/* Called within RCU critical section */
+static void working_set_sample_block(WorkingSetSample *sample, RAMBlock *rb,
+                                     GRand *rand)
+{
+    uint64_t i;
+
+    sample->idstr = g_strdup(rb->idstr);
+    sample->size = rb->used_length;
+    sample->npages = rb->used_length >> TARGET_PAGE_BITS;
+    sample->nsamples = working_set_nsamples(sample->npages);
+    sample->pages = g_new(uint64_t, sample->nsamples);
+    sample->hashes = g_new(uint32_t, sample->nsamples);
+
+    for (i = 0; i < sample->nsamples; i++) {
+        uint64_t page = g_rand_double(rand) * sample->npages;
+
+        page = MIN(page, sample->npages - 1);
+        sample->pages[i] = page;
+        sample->hashes[i] = working_set_hash_page(rb, page);
+    }
+}
+
+static WorkingSetSample *working_set_first_pass(int *out_nblocks)
+{
+    GRand *rand = g_rand_new();
+    WorkingSetSample *samples;
+    RAMBlock *rb;
+    int nblocks = 0;
+    int i = 0;
+
+    WITH_RCU_READ_LOCK_GUARD() {
+        RAMBLOCK_FOREACH(rb) {
+            if (!working_set_block_skipped(rb)) {
+                nblocks++;
+            }
+        }
+
+        samples = g_new0(WorkingSetSample, nblocks);
+        RAMBLOCK_FOREACH(rb) {
+            if (!working_set_block_skipped(rb)) {
+                working_set_sample_block(&samples[i++], rb, rand);
+            }
+        }
+    }
+
+    g_rand_free(rand);
+    *out_nblocks = nblocks;
+    return samples;
+}
+
+static void working_set_second_pass(WorkingSetSample *samples, int nblocks)
+{
+    int i;
+
+    WITH_RCU_READ_LOCK_GUARD() {
+        for (i = 0; i < nblocks; i++) {
+            WorkingSetSample *sample = &samples[i];
+            RAMBlock *rb = qemu_ram_block_by_name(sample->idstr);
+            uint64_t j;
+
+            /*
+             * A block that was removed or resized in the meantime
+             * cannot be compared; leave it out of the results.
+             */
+            if (!rb || rb->used_length != sample->size || !rb->host) {
+                continue;
+            }
+
+            for (j = 0; j < sample->nsamples; j++) {
+                if (working_set_hash_page(rb, sample->pages[j]) !=
+                    sample->hashes[j]) {
+                    sample->touched++;
+                }
+            }
+            sample->revisited = true;
+        }
+    }
+}
+
+static void working_set_free_results(void)
+{
+    int i;
+
+    for (i = 0; i < working_set_nresults; i++) {
+        g_free(working_set_results[i].name);
+    }
+    g_free(working_set_results);
+    working_set_results = NULL;
+    working_set_nresults = 0;
+}
+
+static void *working_set_thread(void *opaque)
+{
+    int64_t calc_time = (intptr_t)opaque;
+    WorkingSetSample *samples;
+    int nblocks, nresults = 0;
+    int i;
+
+    rcu_register_thread();
+
+    samples = working_set_first_pass(&nblocks);
+    g_usleep(calc_time * G_USEC_PER_SEC);
+    working_set_second_pass(samples, nblocks);
+
+    working_set_results = g_new0(WorkingSetResult, nblocks);
+    for (i = 0; i < nblocks; i++) {
+        WorkingSetSample *sample = &samples[i];
+
+        if (sample->revisited) {
+            WorkingSetResult *res = &working_set_results[nresults++];
+
+            res->name = sample->idstr;
+            sample->idstr = NULL;
+            res->size = sample->size;
+            res->sample_pages = sample->nsamples;
+            res->touched_pages = sample->touched;
+        }
+        g_free(sample->idstr);
+        g_free(sample->pages);
+        g_free(sample->hashes);
+    }
+    g_free(samples);
+    working_set_nresults = nresults;
+
+    /* Publish the results before the status change makes them visible */
+    smp_wmb();
+    atomic_set(&working_set_status, WORKING_SET_STATUS_MEASURED);
+
+    rcu_unregister_thread();
+    return NULL;
+}
+
+void qmp_calc_working_set(int64_t calc_time, Error **errp)
+{
+    QemuThread thread;
+
+    if (calc_time < WORKING_SET_MIN_CALC_TIME ||
+        calc_time > WORKING_SET_MAX_CALC_TIME) {
+        error_setg(errp, "calc-time (%" PRIi64 ") must be between %d "
+                   "and %d seconds", calc_time,
+                   WORKING_SET_MIN_CALC_TIME, WORKING_SET_MAX_CALC_TIME);
+        return;
+    }
+
+    if (atomic_read(&working_set_status) == WORKING_SET_STATUS_MEASURING) {
+        error_setg(errp, "a working set measurement is already in progress");
+        return;
+    }
+
+    working_set_free_results();
+    working_set_start_time = qemu_clock_get_ms(QEMU_CLOCK_HOST);
+    working_set_calc_time = calc_time;
+    atomic_set(&working_set_status, WORKING_SET_STATUS_MEASURING);
+
+    qemu_thread_create(&thread, "working-set", working_set_thread,
+                       (void *)(intptr_t)calc_time, QEMU_THREAD_DETACHED);
+}
+
+WorkingSetInfo *qmp_query_working_set(Error **errp)
+{
+    WorkingSetInfo *info = g_new0(WorkingSetInfo, 1);
+
+    info->status = atomic_read(&working_set_status);
+    if (info->status == WORKING_SET_STATUS_UNSTARTED) {
+        return info;
+    }
+
+    info->has_start_time = true;
+    info->start_time = working_set_start_time;
+    info->has_calc_time = true;
+    info->calc_time = working_set_calc_time;
+
+    if (info->status == WORKING_SET_STATUS_MEASURED) {
+        WorkingSetRamBlockList **node = &info->blocks;
+        int i;
+
+        smp_rmb();
+        info->has_blocks = true;
+        for (i = 0; i < working_set_nresults; i++) {
+            WorkingSetResult *res = &working_set_results[i];
+            WorkingSetRamBlock *block = g_new0(WorkingSetRamBlock, 1);
+
+            block->name = g_strdup(res->name);
+            block->size = res->size;
+            block->sample_pages = res->sample_pages;
+            block->touched_pages = res->touched_pages;
+            block->estimated_bytes = res->size / res->sample_pages *
+                                     res->touched_pages;
+
+            *node = g_new0(WorkingSetRamBlockList, 1);
+            (*node)->value = block;
+            node = &(*node)->next;
+        }
+    }
+
+    return info;
+}
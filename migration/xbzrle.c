@@ -12,6 +12,7 @@
  */
 #include "qemu/osdep.h"
 #include "qemu/cutils.h"
+#include "qemu/host-utils.h"
 #include "xbzrle.h"
 
 /*
@@ -24,8 +25,8 @@
 
   length = uleb128 encoded integer
  */
-int xbzrle_encode_buffer(uint8_t *old_buf, uint8_t *new_buf, int slen,
-                         uint8_t *dst, int dlen)
+static int xbzrle_encode_buffer_int(uint8_t *old_buf, uint8_t *new_buf,
+                                    int slen, uint8_t *dst, int dlen)
 {
     uint32_t zrun_len = 0, nzrun_len = 0;
     int d = 0, i = 0;
@@ -126,6 +127,146 @@ int xbzrle_encode_buffer(uint8_t *old_buf, uint8_t *new_buf, int slen,
     return d;
 }
 
+#ifdef CONFIG_AVX2_OPT
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#include <immintrin.h>
+
+/*
+ * Same encoding as xbzrle_encode_buffer_int(), but the old/new page
+ * comparison looks at 32 bytes per step. Both run boundaries are found
+ * from the byte equality mask of a vector compare, so the scalar loops
+ * only run over the sub-vector tail of the page.
+ */
+static int xbzrle_encode_buffer_avx2(uint8_t *old_buf, uint8_t *new_buf,
+                                     int slen, uint8_t *dst, int dlen)
+{
+    uint32_t zrun_len = 0, nzrun_len = 0;
+    int d = 0, i = 0;
+    uint8_t *nzrun_start = NULL;
+
+    while (i < slen) {
+        /* overflow */
+        if (d + 2 > dlen) {
+            return -1;
+        }
+
+        /* 32 bytes at a time until the end of the zero run is in sight */
+        while (i + 32 <= slen) {
+            __m256i o = _mm256_loadu_si256((__m256i *)(old_buf + i));
+            __m256i n = _mm256_loadu_si256((__m256i *)(new_buf + i));
+            uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(o, n));
+
+            if (eq != UINT32_MAX) {
+                /* low bits correspond to low addresses */
+                int run = ctz32(~eq);
+
+                zrun_len += run;
+                i += run;
+                break;
+            }
+            zrun_len += 32;
+            i += 32;
+        }
+
+        /* go over the tail */
+        while (i < slen && old_buf[i] == new_buf[i]) {
+            zrun_len++;
+            i++;
+        }
+
+        /* buffer unchanged */
+        if (zrun_len == slen) {
+            return 0;
+        }
+
+        /* skip last zero run */
+        if (i == slen) {
+            return d;
+        }
+
+        d += uleb128_encode_small(dst + d, zrun_len);
+
+        zrun_len = 0;
+        nzrun_start = new_buf + i;
+
+        /* overflow */
+        if (d + 2 > dlen) {
+            return -1;
+        }
+
+        /* 32 bytes at a time until a matching byte ends the nzrun */
+        while (i + 32 <= slen) {
+            __m256i o = _mm256_loadu_si256((__m256i *)(old_buf + i));
+            __m256i n = _mm256_loadu_si256((__m256i *)(new_buf + i));
+            uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(o, n));
+
+            if (eq) {
+                int run = ctz32(eq);
+
+                nzrun_len += run;
+                i += run;
+                break;
+            }
+            nzrun_len += 32;
+            i += 32;
+        }
+
+        /* go over the tail */
+        while (i < slen && old_buf[i] != new_buf[i]) {
+            nzrun_len++;
+            i++;
+        }
+
+        d += uleb128_encode_small(dst + d, nzrun_len);
+        /* overflow */
+        if (d + nzrun_len > dlen) {
+            return -1;
+        }
+        memcpy(dst + d, nzrun_start, nzrun_len);
+        d += nzrun_len;
+        nzrun_len = 0;
+    }
+
+    return d;
+}
+#pragma GCC pop_options
+
+#include "qemu/cpuid.h"
+
+static int (*xbzrle_encode_accel)(uint8_t *, uint8_t *, int, uint8_t *, int)
+    = xbzrle_encode_buffer_int;
+
+static void __attribute__((constructor)) init_xbzrle_accel(void)
+{
+    int max = __get_cpuid_max(0, NULL);
+    int a, b, c, d;
+
+    if (max >= 7) {
+        __cpuid(1, a, b, c, d);
+        /* We must check that AVX is not just available, but usable.  */
+        if ((c & bit_OSXSAVE) && (c & bit_AVX)) {
+            int bv;
+            __asm("xgetbv" : "=a"(bv), "=d"(d) : "c"(0));
+            __cpuid_count(7, 0, a, b, c, d);
+            if ((bv & 6) == 6 && (b & bit_AVX2)) {
+                xbzrle_encode_accel = xbzrle_encode_buffer_avx2;
+            }
+        }
+    }
+}
+#endif /* CONFIG_AVX2_OPT */
+
+int xbzrle_encode_buffer(uint8_t *old_buf, uint8_t *new_buf, int slen,
+                         uint8_t *dst, int dlen)
+{
+#ifdef CONFIG_AVX2_OPT
+    return xbzrle_encode_accel(old_buf, new_buf, slen, dst, dlen);
+#else
+    return xbzrle_encode_buffer_int(old_buf, new_buf, slen, dst, dlen);
+#endif
+}
+
 int xbzrle_decode_buffer(uint8_t *src, int slen, uint8_t *dst, int dlen)
 {
     int i = 0, d = 0;
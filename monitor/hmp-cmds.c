@@ -453,6 +453,9 @@ void hmp_info_migrate_parameters(Monitor *mon, const QDict *qdict)
         monitor_printf(mon, "%s: %s\n",
             MigrationParameter_str(MIGRATION_PARAMETER_MULTIFD_COMPRESSION),
             MultiFDCompression_str(params->multifd_compression));
+        monitor_printf(mon, "%s: '%s'\n",
+            MigrationParameter_str(MIGRATION_PARAMETER_MULTIFD_CPU_LIST),
+            params->has_multifd_cpu_list ? params->multifd_cpu_list : "");
         monitor_printf(mon, "%s: %" PRIu64 "\n",
             MigrationParameter_str(MIGRATION_PARAMETER_XBZRLE_CACHE_SIZE),
             params->xbzrle_cache_size);
@@ -918,8 +921,13 @@ void hmp_sync_profile(Monitor *mon, const QDict *qdict)
 
     if (op == NULL) {
         bool on = qsp_is_enabled();
+        unsigned int period = qsp_get_sample_period();
 
         monitor_printf(mon, "sync-profile is %s\n", on ? "on" : "off");
+        if (period > 1) {
+            monitor_printf(mon, "sampling 1 out of every %u acquisitions\n",
+                           period);
+        }
         return;
     }
     if (!strcmp(op, "on")) {
@@ -928,6 +936,18 @@ void hmp_sync_profile(Monitor *mon, const QDict *qdict)
         qsp_disable();
     } else if (!strcmp(op, "reset")) {
         qsp_reset();
+    } else if (!strcmp(op, "sample")) {
+        int64_t period = qdict_get_try_int(qdict, "period", 1);
+
+        if (period < 1 || period > UINT_MAX) {
+            Error *err = NULL;
+
+            error_setg(&err, QERR_INVALID_PARAMETER_VALUE, "period",
+                       "a positive integer");
+            hmp_handle_error(mon, err);
+            return;
+        }
+        qsp_set_sample_period(period);
     } else {
         Error *err = NULL;
 
@@ -1337,6 +1357,12 @@ void hmp_migrate_set_parameter(Monitor *mon, const QDict *qdict)
         p->has_multifd_zstd_level = true;
         visit_type_int(v, param, &p->multifd_zstd_level, &err);
         break;
+    case MIGRATION_PARAMETER_MULTIFD_CPU_LIST:
+        p->has_multifd_cpu_list = true;
+        p->multifd_cpu_list = g_new0(StrOrNull, 1);
+        p->multifd_cpu_list->type = QTYPE_QSTRING;
+        visit_type_str(v, param, &p->multifd_cpu_list->u.s, &err);
+        break;
     case MIGRATION_PARAMETER_XBZRLE_CACHE_SIZE:
         p->has_xbzrle_cache_size = true;
         visit_type_size(v, param, &cache_size, &err);
@@ -29,6 +29,7 @@
 #include "qapi/qapi-emit-events.h"
 #include "qapi/qapi-visit-control.h"
 #include "qapi/qmp/qdict.h"
+#include "qapi/qmp/qjson.h"
 #include "qapi/qmp/qstring.h"
 #include "qemu/error-report.h"
 #include "qemu/option.h"
@@ -257,6 +258,7 @@ static void monitor_qapi_event_emit(QAPIEvent event, QDict *qdict)
 {
     Monitor *mon;
     MonitorQMP *qmp_mon;
+    QString *json = NULL;
 
     trace_monitor_protocol_event_emit(event, qdict);
     QTAILQ_FOREACH(mon, &mon_list, entry) {
@@ -265,10 +267,22 @@ static void monitor_qapi_event_emit(QAPIEvent event, QDict *qdict)
         }
 
         qmp_mon = container_of(mon, MonitorQMP, common);
-        if (qmp_mon->commands != &qmp_cap_negotiation_commands) {
+        if (qmp_mon->commands == &qmp_cap_negotiation_commands) {
+            continue;
+        }
+        if (qmp_mon->pretty) {
+            /* Pretty-printing is per monitor, take the slow path */
             qmp_send_response(qmp_mon, qdict);
+            continue;
+        }
+        if (!json) {
+            /* Serialize only once for all monitors */
+            json = qobject_to_json(QOBJECT(qdict));
+            qstring_append_chr(json, '\n');
         }
+        monitor_puts(mon, qstring_get_str(json));
     }
+    qobject_unref(json);
 }
 
 static void monitor_qapi_event_handler(void *opaque);
@@ -85,8 +85,8 @@ static void monitor_qmp_cleanup_queue_and_resume(MonitorQMP *mon)
      * Also, the queue should not be empty either, otherwise the
      * monitor hasn't been suspended yet (or was already resumed).
      */
-    bool need_resume = (!qmp_oob_enabled(mon) ||
-        mon->qmp_requests->length == QMP_REQ_QUEUE_LEN_MAX)
+    bool need_resume =
+        mon->qmp_requests->length == QMP_REQ_QUEUE_LEN_MAX
         && !g_queue_is_empty(mon->qmp_requests);
 
     monitor_qmp_cleanup_req_queue_locked(mon);
@@ -223,9 +223,7 @@ void monitor_qmp_bh_dispatcher(void *data)
     }
 
     mon = req_obj->mon;
-    /*  qmp_oob_enabled() might change after "qmp_capabilities" */
-    need_resume = !qmp_oob_enabled(mon) ||
-        mon->qmp_requests->length == QMP_REQ_QUEUE_LEN_MAX - 1;
+    need_resume = mon->qmp_requests->length == QMP_REQ_QUEUE_LEN_MAX - 1;
     qemu_mutex_unlock(&mon->qmp_queue_lock);
     if (req_obj->req) {
         QDict *qdict = qobject_to(QDict, req_obj->req);
@@ -289,12 +287,12 @@ static void handle_qmp_command(void *opaque, QObject *req, Error *err)
     /*
      * Suspend the monitor when we can't queue more requests after
      * this one.  Dequeuing in monitor_qmp_bh_dispatcher() or
-     * monitor_qmp_cleanup_queue_and_resume() will resume it.
-     * Note that when OOB is disabled, we queue at most one command,
-     * for backward compatibility.
+     * monitor_qmp_cleanup_queue_and_resume() will resume it.  Clients
+     * may pipeline up to QMP_REQ_QUEUE_LEN_MAX requests regardless of
+     * OOB negotiation; the dispatcher executes them in order, so the
+     * responses keep their time order either way.
      */
-    if (!qmp_oob_enabled(mon) ||
-        mon->qmp_requests->length == QMP_REQ_QUEUE_LEN_MAX - 1) {
+    if (mon->qmp_requests->length == QMP_REQ_QUEUE_LEN_MAX - 1) {
         monitor_suspend(&mon->common);
     }
 
@@ -72,10 +72,23 @@ static int system_errno_to_nbd_errno(int err)
 
 typedef struct NBDRequestData NBDRequestData;
 
+/*
+ * A reply buffer whose pages the kernel still shares after a zero
+ * copy send; it may be freed once the completion counter of the
+ * socket reaches @end.
+ */
+typedef struct NBDZeroCopyBuf {
+    QSIMPLEQ_ENTRY(NBDZeroCopyBuf) entry;
+    uint8_t *data;
+    uint64_t end;
+} NBDZeroCopyBuf;
+
 struct NBDRequestData {
     QSIMPLEQ_ENTRY(NBDRequestData) entry;
     NBDClient *client;
     uint8_t *data;
+    uint64_t zero_copy_end; /* free data only once zero copy sends up to
+                               this number have completed */
     bool complete;
 };
 
@@ -133,6 +146,9 @@ struct NBDClient {
     int nb_requests;
     bool closing;
 
+    bool zero_copy; /* whether MSG_ZEROCOPY is enabled on sioc */
+    QSIMPLEQ_HEAD(, NBDZeroCopyBuf) zero_copy_bufs;
+
     uint32_t check_align; /* If non-zero, check for aligned client requests */
 
     bool structured_reply;
@@ -1360,6 +1376,24 @@ static int nbd_receive_request(QIOChannel *ioc, NBDRequest *request,
 
 #define MAX_NBD_REQUESTS 16
 
+/*
+ * Free reply buffers whose zero copy sends the kernel has completed.
+ * With @force, free all of them: only valid once the socket has been
+ * shut down, so that none of the pages can be transmitted any more.
+ */
+static void nbd_zero_copy_reap(NBDClient *client, bool force)
+{
+    uint64_t done = qio_channel_socket_zero_copy_reap(client->sioc);
+    NBDZeroCopyBuf *buf;
+
+    while ((buf = QSIMPLEQ_FIRST(&client->zero_copy_bufs)) &&
+           (force || buf->end <= done)) {
+        QSIMPLEQ_REMOVE_HEAD(&client->zero_copy_bufs, entry);
+        qemu_vfree(buf->data);
+        g_free(buf);
+    }
+}
+
 void nbd_client_get(NBDClient *client)
 {
     client->refcount++;
@@ -1373,6 +1407,7 @@ void nbd_client_put(NBDClient *client)
          */
         assert(client->closing);
 
+        nbd_zero_copy_reap(client, true);
         qio_channel_detach_aio_context(client->ioc);
         object_unref(OBJECT(client->sioc));
         object_unref(OBJECT(client->ioc));
@@ -1425,8 +1460,21 @@ static void nbd_request_put(NBDRequestData *req)
 {
     NBDClient *client = req->client;
 
+    if (client->zero_copy) {
+        nbd_zero_copy_reap(client, false);
+    }
     if (req->data) {
-        qemu_vfree(req->data);
+        if (req->zero_copy_end >
+            qio_channel_socket_zero_copy_reap(client->sioc)) {
+            /* The kernel still shares the pages; free once completed */
+            NBDZeroCopyBuf *buf = g_new(NBDZeroCopyBuf, 1);
+
+            buf->data = req->data;
+            buf->end = req->zero_copy_end;
+            QSIMPLEQ_INSERT_TAIL(&client->zero_copy_bufs, buf, entry);
+        } else {
+            qemu_vfree(req->data);
+        }
     }
     g_free(req);
 
@@ -2460,6 +2508,17 @@ static coroutine_fn void nbd_trip(void *opaque)
         error_free(export_err);
     } else {
         ret = nbd_handle_request(client, &request, req->data, &local_err);
+        if (client->zero_copy && request.type == NBD_CMD_READ &&
+            request.len >= QIO_CHANNEL_SOCKET_ZERO_COPY_MIN) {
+            /*
+             * The reply data may have gone out with MSG_ZEROCOPY, so
+             * the buffer must not be reused before every send issued
+             * so far has completed. This bound is conservative, but
+             * completions usually arrive within a round trip.
+             */
+            req->zero_copy_end =
+                qio_channel_socket_zero_copy_queued(client->sioc);
+        }
     }
     if (ret < 0) {
         error_prepend(&local_err, "Failed to send reply: ");
@@ -2512,6 +2571,13 @@ static coroutine_fn void nbd_co_client_start(void *opaque)
         return;
     }
 
+    if (client->ioc == QIO_CHANNEL(client->sioc)) {
+        /* Plain data channel (no TLS): try to send read replies with
+         * zero copy. Failure just means older kernels keep copying. */
+        client->zero_copy =
+            qio_channel_socket_set_zero_copy(client->sioc, NULL) == 0;
+    }
+
     nbd_client_receive_next_request(client);
 }
 
@@ -2540,6 +2606,7 @@ void nbd_client_new(QIOChannelSocket *sioc,
     client->ioc = QIO_CHANNEL(sioc);
     object_ref(OBJECT(client->ioc));
     client->close_fn = close_fn;
+    QSIMPLEQ_INIT(&client->zero_copy_bufs);
 
     co = qemu_coroutine_create(nbd_co_client_start, client);
     qemu_coroutine_enter(co);
@@ -19,12 +19,95 @@
 #include "net/checksum.h"
 #include "net/eth.h"
 
-uint32_t net_checksum_add_cont(int len, uint8_t *buf, int seq)
+/* Each 16-bit lane of the masked 64-bit word holds one byte, so a lane
+ * can take 256 additions before it may carry into its neighbour.
+ */
+#define CSUM_LANE_MASK   0x00ff00ff00ff00ffULL
+#define CSUM_BLOCK_SIZE  (256 * 8)
+
+static uint32_t net_checksum_add_int(int len, uint8_t *buf, int seq)
 {
     uint32_t sum1 = 0, sum2 = 0;
-    int i;
+    int i = 0;
+
+    /* Sum the even- and odd-offset bytes eight at a time, folding the
+     * 16-bit lane accumulators back into the 32-bit sums before the
+     * lanes can overflow.
+     */
+    while (len - i >= 8) {
+        uint64_t lanes1 = 0, lanes2 = 0;
+        int stop = MIN(len - 7, i + CSUM_BLOCK_SIZE);
+
+        for (; i < stop; i += 8) {
+            uint64_t x = ldq_he_p(buf + i);
+
+#ifdef HOST_WORDS_BIGENDIAN
+            lanes1 += (x >> 8) & CSUM_LANE_MASK;
+            lanes2 += x & CSUM_LANE_MASK;
+#else
+            lanes1 += x & CSUM_LANE_MASK;
+            lanes2 += (x >> 8) & CSUM_LANE_MASK;
+#endif
+        }
+        sum1 += (lanes1 & 0xffff) + ((lanes1 >> 16) & 0xffff) +
+                ((lanes1 >> 32) & 0xffff) + (lanes1 >> 48);
+        sum2 += (lanes2 & 0xffff) + ((lanes2 >> 16) & 0xffff) +
+                ((lanes2 >> 32) & 0xffff) + (lanes2 >> 48);
+    }
+
+    for (; i < len - 1; i += 2) {
+        sum1 += (uint32_t)buf[i];
+        sum2 += (uint32_t)buf[i + 1];
+    }
+    if (i < len) {
+        sum1 += (uint32_t)buf[i];
+    }
+
+    if (seq & 1) {
+        return sum1 + (sum2 << 8);
+    } else {
+        return sum2 + (sum1 << 8);
+    }
+}
 
-    for (i = 0; i < len - 1; i += 2) {
+#ifdef CONFIG_AVX2_OPT
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#include <immintrin.h>
+
+static uint32_t net_checksum_add_avx2(int len, uint8_t *buf, int seq)
+{
+    __m256i lanes1 = _mm256_setzero_si256();
+    __m256i lanes2 = _mm256_setzero_si256();
+    const __m256i mask = _mm256_set1_epi16(0x00ff);
+    const __m256i ones = _mm256_set1_epi16(1);
+    uint32_t tmp[8];
+    uint32_t sum1, sum2;
+    int i = 0, j;
+
+    /* Split each 32-byte chunk into its even- and odd-offset bytes and
+     * sum pairs of them into 32-bit lanes; the lanes cannot overflow
+     * for any packet that fits in an int.
+     */
+    for (; len - i >= 32; i += 32) {
+        __m256i x = _mm256_loadu_si256((__m256i *)(buf + i));
+
+        lanes1 = _mm256_add_epi32(lanes1,
+                 _mm256_madd_epi16(_mm256_and_si256(x, mask), ones));
+        lanes2 = _mm256_add_epi32(lanes2,
+                 _mm256_madd_epi16(_mm256_srli_epi16(x, 8), ones));
+    }
+
+    _mm256_storeu_si256((__m256i *)tmp, lanes1);
+    for (sum1 = 0, j = 0; j < 8; j++) {
+        sum1 += tmp[j];
+    }
+    _mm256_storeu_si256((__m256i *)tmp, lanes2);
+    for (sum2 = 0, j = 0; j < 8; j++) {
+        sum2 += tmp[j];
+    }
+
+    for (; i < len - 1; i += 2) {
         sum1 += (uint32_t)buf[i];
         sum2 += (uint32_t)buf[i + 1];
     }
@@ -38,6 +121,42 @@ uint32_t net_checksum_add_cont(int len, uint8_t *buf, int seq)
         return sum2 + (sum1 << 8);
     }
 }
+#pragma GCC pop_options
+
+#include "qemu/cpuid.h"
+
+static uint32_t (*net_checksum_accel)(int, uint8_t *, int) =
+    net_checksum_add_int;
+
+static void __attribute__((constructor)) init_checksum_accel(void)
+{
+    int max = __get_cpuid_max(0, NULL);
+    int a, b, c, d;
+
+    if (max >= 7) {
+        __cpuid(1, a, b, c, d);
+        /* We must check that AVX is not just available, but usable.  */
+        if ((c & bit_OSXSAVE) && (c & bit_AVX)) {
+            int bv;
+            __asm("xgetbv" : "=a"(bv), "=d"(d) : "c"(0));
+            __cpuid_count(7, 0, a, b, c, d);
+            if ((bv & 6) == 6 && (b & bit_AVX2)) {
+                net_checksum_accel = net_checksum_add_avx2;
+            }
+        }
+    }
+}
+#else
+#define net_checksum_accel net_checksum_add_int
+#endif /* CONFIG_AVX2_OPT */
+
+uint32_t net_checksum_add_cont(int len, uint8_t *buf, int seq)
+{
+    if (len >= 64) {
+        return net_checksum_accel(len, buf, seq);
+    }
+    return net_checksum_add_int(len, buf, seq);
+}
 
 uint16_t net_checksum_finish(uint32_t sum)
 {
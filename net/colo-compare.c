@@ -24,6 +24,7 @@
 #include "qom/object.h"
 #include "net/queue.h"
 #include "chardev/char-fe.h"
+#include "qemu/crc32c.h"
 #include "qemu/sockets.h"
 #include "colo.h"
 #include "sysemu/iothread.h"
@@ -308,6 +309,25 @@ static int colo_compare_packet_payload(Packet *ppkt,
     return memcmp(ppkt->data + poffset, spkt->data + soffset, len);
 }
 
+/*
+ * CRC of the packet's payload from @offset to the end, computed once
+ * per packet and cached. While a packet waits for its counterpart it
+ * can be compared against every arrival on the peer queue; rejecting
+ * mismatches on the cached CRC leaves at most one full payload
+ * comparison per packet. Only usable by the callers that always
+ * compare the whole payload at a fixed offset, i.e. not by the TCP
+ * path with its moving per-packet offsets.
+ */
+static uint32_t colo_packet_payload_crc(Packet *pkt, uint16_t offset)
+{
+    if (!pkt->payload_crc_valid) {
+        pkt->payload_crc = crc32c(0xffffffff, (uint8_t *)pkt->data + offset,
+                                  pkt->size - offset);
+        pkt->payload_crc_valid = true;
+    }
+    return pkt->payload_crc;
+}
+
 /*
  * return true means that the payload is consist and
  * need to make the next comparison, false means do
@@ -492,7 +512,9 @@ static int colo_packet_compare_udp(Packet *spkt, Packet *ppkt)
         trace_colo_compare_main("UDP: payload size of packets are different");
         return -1;
     }
-    if (colo_compare_packet_payload(ppkt, spkt, offset, offset,
+    if (colo_packet_payload_crc(ppkt, offset) !=
+        colo_packet_payload_crc(spkt, offset) ||
+        colo_compare_packet_payload(ppkt, spkt, offset, offset,
                                     ppkt->size - offset)) {
         trace_colo_compare_udp_miscompare("primary pkt size", ppkt->size);
         trace_colo_compare_udp_miscompare("Secondary pkt size", spkt->size);
@@ -533,7 +555,9 @@ static int colo_packet_compare_icmp(Packet *spkt, Packet *ppkt)
         trace_colo_compare_main("ICMP: payload size of packets are different");
         return -1;
     }
-    if (colo_compare_packet_payload(ppkt, spkt, offset, offset,
+    if (colo_packet_payload_crc(ppkt, offset) !=
+        colo_packet_payload_crc(spkt, offset) ||
+        colo_compare_packet_payload(ppkt, spkt, offset, offset,
                                     ppkt->size - offset)) {
         trace_colo_compare_icmp_miscompare("primary pkt size",
                                            ppkt->size);
@@ -577,6 +601,10 @@ static int colo_packet_compare_other(Packet *spkt, Packet *ppkt)
         trace_colo_compare_main("Other: payload size of packets are different");
         return -1;
     }
+    if (colo_packet_payload_crc(ppkt, offset) !=
+        colo_packet_payload_crc(spkt, offset)) {
+        return -1;
+    }
     return colo_compare_packet_payload(ppkt, spkt, offset, offset,
                                        ppkt->size - offset);
 }
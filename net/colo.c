@@ -173,6 +173,8 @@ Packet *packet_new(const void *data, int size, int vnet_hdr_len)
     pkt->payload_size = 0;
     pkt->offset = 0;
     pkt->flags = 0;
+    pkt->payload_crc = 0;
+    pkt->payload_crc_valid = false;
 
     return pkt;
 }
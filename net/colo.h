@@ -54,6 +54,9 @@ typedef struct Packet {
     /* record the payload offset(the length that has been compared) */
     uint16_t offset;
     uint8_t flags; /* Flags(aka Control bits) */
+    /* CRC of the compared payload region, computed on first use */
+    uint32_t payload_crc;
+    bool payload_crc_valid;
 } Packet;
 
 typedef struct ConnectionKey {
@@ -166,8 +166,11 @@ static void netfilter_set_status(Object *obj, const char *str, Error **errp)
         return;
     }
     nf->on = !nf->on;
-    if (nf->netdev && nfc->status_changed) {
-        nfc->status_changed(nf, errp);
+    if (nf->netdev) {
+        qemu_netfilter_chain_update(nf->netdev);
+        if (nfc->status_changed) {
+            nfc->status_changed(nf, errp);
+        }
     }
 }
 
@@ -318,6 +321,7 @@ static void netfilter_complete(UserCreatable *uc, Error **errp)
     } else if (!strcmp(nf->position, "tail")) {
         QTAILQ_INSERT_TAIL(&nf->netdev->filters, nf, next);
     }
+    qemu_netfilter_chain_update(nf->netdev);
 }
 
 static void netfilter_finalize(Object *obj)
@@ -332,6 +336,7 @@ static void netfilter_finalize(Object *obj)
     if (nf->netdev && !QTAILQ_EMPTY(&nf->netdev->filters) &&
         QTAILQ_IN_USE(nf, next)) {
         QTAILQ_REMOVE(&nf->netdev->filters, nf, next);
+        qemu_netfilter_chain_update(nf->netdev);
     }
     g_free(nf->netdev_id);
     g_free(nf->position);
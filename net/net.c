@@ -344,6 +344,8 @@ static void qemu_free_net_client(NetClientState *nc)
     }
     g_free(nc->name);
     g_free(nc->model);
+    g_free(nc->filters_tx);
+    g_free(nc->filters_rx);
     if (nc->destructor) {
         nc->destructor(nc);
     }
@@ -537,6 +539,34 @@ int qemu_can_send_packet(NetClientState *sender)
     return 1;
 }
 
+void qemu_netfilter_chain_update(NetClientState *nc)
+{
+    NetFilterState *nf;
+    int n = 0;
+
+    QTAILQ_FOREACH(nf, &nc->filters, next) {
+        n++;
+    }
+
+    g_free(nc->filters_tx);
+    g_free(nc->filters_rx);
+    nc->filters_tx = n ? g_new(NetFilterState *, n) : NULL;
+    nc->filters_rx = n ? g_new(NetFilterState *, n) : NULL;
+    nc->nfilters_tx = 0;
+    nc->nfilters_rx = 0;
+
+    QTAILQ_FOREACH(nf, &nc->filters, next) {
+        if (nf->on && nf->direction != NET_FILTER_DIRECTION_RX) {
+            nc->filters_tx[nc->nfilters_tx++] = nf;
+        }
+    }
+    QTAILQ_FOREACH_REVERSE(nf, &nc->filters, next) {
+        if (nf->on && nf->direction != NET_FILTER_DIRECTION_TX) {
+            nc->filters_rx[nc->nfilters_rx++] = nf;
+        }
+    }
+}
+
 static ssize_t filter_receive_iov(NetClientState *nc,
                                   NetFilterDirection direction,
                                   NetClientState *sender,
@@ -546,23 +576,23 @@ static ssize_t filter_receive_iov(NetClientState *nc,
                                   NetPacketSent *sent_cb)
 {
     ssize_t ret = 0;
-    NetFilterState *nf = NULL;
+    NetFilterState **chain;
+    int n;
+    int i;
 
     if (direction == NET_FILTER_DIRECTION_TX) {
-        QTAILQ_FOREACH(nf, &nc->filters, next) {
-            ret = qemu_netfilter_receive(nf, direction, sender, flags, iov,
-                                         iovcnt, sent_cb);
-            if (ret) {
-                return ret;
-            }
-        }
+        chain = nc->filters_tx;
+        n = nc->nfilters_tx;
     } else {
-        QTAILQ_FOREACH_REVERSE(nf, &nc->filters, next) {
-            ret = qemu_netfilter_receive(nf, direction, sender, flags, iov,
-                                         iovcnt, sent_cb);
-            if (ret) {
-                return ret;
-            }
+        chain = nc->filters_rx;
+        n = nc->nfilters_rx;
+    }
+
+    for (i = 0; i < n; i++) {
+        ret = qemu_netfilter_receive(chain[i], direction, sender, flags, iov,
+                                     iovcnt, sent_cb);
+        if (ret) {
+            return ret;
         }
     }
 
@@ -667,6 +697,32 @@ ssize_t qemu_send_packet(NetClientState *nc, const uint8_t *buf, int size)
     return qemu_send_packet_async(nc, buf, size, NULL);
 }
 
+int qemu_send_packet_batch(NetClientState *sender,
+                           const struct iovec *pkts, int npkts,
+                           NetPacketSent *sent_cb)
+{
+    int delivered = 0;
+    int i;
+
+    for (i = 0; i < npkts; i++) {
+        ssize_t ret = qemu_send_packet_async_with_flags(sender,
+                                                        QEMU_NET_PACKET_FLAG_NONE,
+                                                        pkts[i].iov_base,
+                                                        pkts[i].iov_len,
+                                                        sent_cb);
+        if (ret == 0) {
+            /*
+             * The receiver is blocked; this and all later packets are
+             * queued and @sent_cb will run for each of them.  Keep going
+             * so that no packet the caller already read is dropped.
+             */
+            continue;
+        }
+        delivered++;
+    }
+    return delivered;
+}
+
 ssize_t qemu_send_packet_raw(NetClientState *nc, const uint8_t *buf, int size)
 {
     return qemu_send_packet_async_with_flags(nc, QEMU_NET_PACKET_FLAG_RAW,
@@ -79,25 +79,35 @@ pkt_copy(const void *_src, void *_dst, int l)
 #endif /* __FreeBSD__ */
 
 /*
- * Open a netmap device. We assume there is only one queue
- * (which is the case for the VALE bridge).
+ * Open a netmap device. With a single queue (which is always the case
+ * for the VALE bridge) the port is opened as-is and all of its rings
+ * are bound; with multiple queues each open binds exactly one hardware
+ * ring pair, selected by appending the "-<ring>" suffix that nm_open()
+ * understands.
  */
 static struct nm_desc *netmap_open(const NetdevNetmapOptions *nm_opts,
+                                   unsigned int queue, unsigned int queues,
                                    Error **errp)
 {
     struct nm_desc *nmd;
     struct nmreq req;
+    char *ifname;
 
     memset(&req, 0, sizeof(req));
 
-    nmd = nm_open(nm_opts->ifname, &req, NETMAP_NO_TX_POLL,
+    if (queues > 1) {
+        ifname = g_strdup_printf("%s-%u", nm_opts->ifname, queue);
+    } else {
+        ifname = g_strdup(nm_opts->ifname);
+    }
+
+    nmd = nm_open(ifname, &req, NETMAP_NO_TX_POLL,
                   NULL);
     if (nmd == NULL) {
-        error_setg_errno(errp, errno, "Failed to nm_open() %s",
-                         nm_opts->ifname);
-        return NULL;
+        error_setg_errno(errp, errno, "Failed to nm_open() %s", ifname);
     }
 
+    g_free(ifname);
     return nmd;
 }
 
@@ -407,25 +417,39 @@ int net_init_netmap(const Netdev *netdev,
                     const char *name, NetClientState *peer, Error **errp)
 {
     const NetdevNetmapOptions *netmap_opts = &netdev->u.netmap;
-    struct nm_desc *nmd;
-    NetClientState *nc;
-    Error *err = NULL;
-    NetmapState *s;
+    unsigned int queues;
+    unsigned int i;
 
-    nmd = netmap_open(netmap_opts, &err);
-    if (err) {
-        error_propagate(errp, err);
+    queues = netmap_opts->has_queues ? netmap_opts->queues : 1;
+    if (queues < 1 || queues > MAX_QUEUE_NUM) {
+        error_setg(errp, "Invalid number of queues %u for netmap backend",
+                   queues);
         return -1;
     }
-    /* Create the object. */
-    nc = qemu_new_net_client(&net_netmap_info, peer, "netmap", name);
-    s = DO_UPCAST(NetmapState, nc, nc);
-    s->nmd = nmd;
-    s->tx = NETMAP_TXRING(nmd->nifp, 0);
-    s->rx = NETMAP_RXRING(nmd->nifp, 0);
-    s->vnet_hdr_len = 0;
-    pstrcpy(s->ifname, sizeof(s->ifname), netmap_opts->ifname);
-    netmap_read_poll(s, true); /* Initially only poll for reads. */
+
+    /* Create one client per queue, as the multiqueue tap backend does;
+     * a multiqueue NIC picks them up as its subqueues. */
+    for (i = 0; i < queues; i++) {
+        struct nm_desc *nmd;
+        NetClientState *nc;
+        Error *err = NULL;
+        NetmapState *s;
+
+        nmd = netmap_open(netmap_opts, i, queues, &err);
+        if (err) {
+            error_propagate(errp, err);
+            return -1;
+        }
+        /* Create the object. */
+        nc = qemu_new_net_client(&net_netmap_info, peer, "netmap", name);
+        s = DO_UPCAST(NetmapState, nc, nc);
+        s->nmd = nmd;
+        s->tx = NETMAP_TXRING(nmd->nifp, nmd->first_tx_ring);
+        s->rx = NETMAP_RXRING(nmd->nifp, nmd->first_rx_ring);
+        s->vnet_hdr_len = 0;
+        pstrcpy(s->ifname, sizeof(s->ifname), netmap_opts->ifname);
+        netmap_read_poll(s, true); /* Initially only poll for reads. */
+    }
 
     return 0;
 }
@@ -23,6 +23,7 @@
 
 #include "qemu/osdep.h"
 #include "net/queue.h"
+#include "qemu/host-utils.h"
 #include "qemu/queue.h"
 #include "net/net.h"
 
@@ -45,10 +46,15 @@ struct NetPacket {
     NetClientState *sender;
     unsigned flags;
     int size;
+    size_t alloc;       /* capacity of data[] */
     NetPacketSent *sent_cb;
     uint8_t data[0];
 };
 
+/* Released packets kept around so queueing does not malloc each time */
+#define NET_QUEUE_POOL_SIZE 32
+#define NET_QUEUE_POOL_MIN_ALLOC 2048
+
 struct NetQueue {
     void *opaque;
     uint32_t nq_maxlen;
@@ -56,10 +62,44 @@ struct NetQueue {
     NetQueueDeliverFunc *deliver;
 
     QTAILQ_HEAD(, NetPacket) packets;
+    QTAILQ_HEAD(, NetPacket) free_packets;
+    uint32_t free_count;
 
     unsigned delivering : 1;
 };
 
+static NetPacket *net_packet_alloc(NetQueue *queue, size_t size)
+{
+    NetPacket *packet = QTAILQ_FIRST(&queue->free_packets);
+
+    if (packet) {
+        QTAILQ_REMOVE(&queue->free_packets, packet, entry);
+        queue->free_count--;
+        if (packet->alloc < size) {
+            g_free(packet);
+            packet = NULL;
+        }
+    }
+    if (!packet) {
+        /* round up so that a recycled packet fits most future sizes */
+        size_t alloc = pow2ceil(MAX(size, NET_QUEUE_POOL_MIN_ALLOC));
+
+        packet = g_malloc(sizeof(NetPacket) + alloc);
+        packet->alloc = alloc;
+    }
+    return packet;
+}
+
+static void net_packet_free(NetQueue *queue, NetPacket *packet)
+{
+    if (queue->free_count < NET_QUEUE_POOL_SIZE) {
+        QTAILQ_INSERT_HEAD(&queue->free_packets, packet, entry);
+        queue->free_count++;
+    } else {
+        g_free(packet);
+    }
+}
+
 NetQueue *qemu_new_net_queue(NetQueueDeliverFunc *deliver, void *opaque)
 {
     NetQueue *queue;
@@ -72,6 +112,8 @@ NetQueue *qemu_new_net_queue(NetQueueDeliverFunc *deliver, void *opaque)
     queue->deliver = deliver;
 
     QTAILQ_INIT(&queue->packets);
+    QTAILQ_INIT(&queue->free_packets);
+    queue->free_count = 0;
 
     queue->delivering = 0;
 
@@ -86,6 +128,10 @@ void qemu_del_net_queue(NetQueue *queue)
         QTAILQ_REMOVE(&queue->packets, packet, entry);
         g_free(packet);
     }
+    QTAILQ_FOREACH_SAFE(packet, &queue->free_packets, entry, next) {
+        QTAILQ_REMOVE(&queue->free_packets, packet, entry);
+        g_free(packet);
+    }
 
     g_free(queue);
 }
@@ -102,7 +148,7 @@ static void qemu_net_queue_append(NetQueue *queue,
     if (queue->nq_count >= queue->nq_maxlen && !sent_cb) {
         return; /* drop if queue full and no callback */
     }
-    packet = g_malloc(sizeof(NetPacket) + size);
+    packet = net_packet_alloc(queue, size);
     packet->sender = sender;
     packet->flags = flags;
     packet->size = size;
@@ -131,7 +177,7 @@ void qemu_net_queue_append_iov(NetQueue *queue,
         max_len += iov[i].iov_len;
     }
 
-    packet = g_malloc(sizeof(NetPacket) + max_len);
+    packet = net_packet_alloc(queue, max_len);
     packet->sender = sender;
     packet->sent_cb = sent_cb;
     packet->flags = flags;
@@ -243,7 +289,7 @@ void qemu_net_queue_purge(NetQueue *queue, NetClientState *from)
             if (packet->sent_cb) {
                 packet->sent_cb(packet->sender, 0);
             }
-            g_free(packet);
+            net_packet_free(queue, packet);
         }
     }
 }
@@ -273,7 +319,7 @@ bool qemu_net_queue_flush(NetQueue *queue)
             packet->sent_cb(packet->sender, ret);
         }
 
-        g_free(packet);
+        net_packet_free(queue, packet);
     }
     return true;
 }
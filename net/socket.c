@@ -113,6 +113,40 @@ static ssize_t net_socket_receive(NetClientState *nc, const uint8_t *buf, size_t
     return size;
 }
 
+static ssize_t net_socket_receive_iov(NetClientState *nc,
+                                      const struct iovec *iov, int iovcnt)
+{
+    NetSocketState *s = DO_UPCAST(NetSocketState, nc, nc);
+    size_t size = iov_size(iov, iovcnt);
+    uint32_t len = htonl(size);
+    struct iovec *iov2 = g_alloca((iovcnt + 1) * sizeof(*iov2));
+    size_t remaining;
+    ssize_t ret;
+
+    /* Prepend the length header and send without flattening the payload */
+    iov2[0].iov_base = &len;
+    iov2[0].iov_len  = sizeof(len);
+    memcpy(&iov2[1], iov, iovcnt * sizeof(*iov));
+
+    remaining = sizeof(len) + size - s->send_index;
+    ret = iov_send(s->fd, iov2, iovcnt + 1, s->send_index, remaining);
+
+    if (ret == -1 && errno == EAGAIN) {
+        ret = 0; /* handled further down */
+    }
+    if (ret == -1) {
+        s->send_index = 0;
+        return -errno;
+    }
+    if (ret < (ssize_t)remaining) {
+        s->send_index += ret;
+        net_socket_write_poll(s, true);
+        return 0;
+    }
+    s->send_index = 0;
+    return size;
+}
+
 static ssize_t net_socket_receive_dgram(NetClientState *nc, const uint8_t *buf, size_t size)
 {
     NetSocketState *s = DO_UPCAST(NetSocketState, nc, nc);
@@ -418,6 +452,7 @@ static NetClientInfo net_socket_info = {
     .type = NET_CLIENT_DRIVER_SOCKET,
     .size = sizeof(NetSocketState),
     .receive = net_socket_receive,
+    .receive_iov = net_socket_receive_iov,
     .cleanup = net_socket_cleanup,
 };
 
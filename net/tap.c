@@ -52,7 +52,15 @@ typedef struct TAPState {
     int fd;
     char down_script[1024];
     char down_script_arg[128];
-    uint8_t buf[NET_BUFSIZE];
+    /*
+     * Arena for batched receive: each read() still returns a single
+     * packet (tap is a character device, so there is no recvmmsg-style
+     * multi-packet syscall), but packets are packed back to back here
+     * and handed over in one qemu_send_packet_batch() call.  Every read
+     * must be able to accept a maximum-sized packet, so the usable part
+     * of the arena is sizeof(buf) - NET_BUFSIZE.
+     */
+    uint8_t buf[4 * NET_BUFSIZE];
     bool read_poll;
     bool write_poll;
     bool using_vnet_hdr;
@@ -181,31 +189,55 @@ static void tap_send_completed(NetClientState *nc, ssize_t len)
     tap_read_poll(s, true);
 }
 
+#define TAP_SEND_BATCH 32
+
 static void tap_send(void *opaque)
 {
     TAPState *s = opaque;
-    int size;
     int packets = 0;
+    bool eagain = false;
 
-    while (true) {
-        uint8_t *buf = s->buf;
+    while (!eagain) {
+        struct iovec pkts[TAP_SEND_BATCH];
+        size_t offset = 0;
+        int npkts = 0;
+        int size;
 
-        size = tap_read_packet(s->fd, s->buf, sizeof(s->buf));
-        if (size <= 0) {
-            break;
+        /*
+         * Gather a batch of packets.  Each read must be able to accept a
+         * maximum-sized packet, so stop once less than NET_BUFSIZE of the
+         * buffer is left.
+         */
+        while (npkts < TAP_SEND_BATCH &&
+               sizeof(s->buf) - offset >= NET_BUFSIZE) {
+            uint8_t *buf = s->buf + offset;
+
+            size = tap_read_packet(s->fd, buf, NET_BUFSIZE);
+            if (size <= 0) {
+                eagain = true;
+                break;
+            }
+            offset += size;
+
+            if (s->host_vnet_hdr_len && !s->using_vnet_hdr) {
+                buf  += s->host_vnet_hdr_len;
+                size -= s->host_vnet_hdr_len;
+            }
+
+            pkts[npkts].iov_base = buf;
+            pkts[npkts].iov_len = size;
+            npkts++;
         }
 
-        if (s->host_vnet_hdr_len && !s->using_vnet_hdr) {
-            buf  += s->host_vnet_hdr_len;
-            size -= s->host_vnet_hdr_len;
+        if (npkts == 0) {
+            break;
         }
 
-        size = qemu_send_packet_async(&s->nc, buf, size, tap_send_completed);
-        if (size == 0) {
+        if (qemu_send_packet_batch(&s->nc, pkts, npkts,
+                                   tap_send_completed) < npkts) {
+            /* some packets were queued; wait for tap_send_completed */
             tap_read_poll(s, false);
             break;
-        } else if (size < 0) {
-            break;
         }
 
         /*
@@ -214,7 +246,7 @@ static void tap_send(void *opaque)
          * packets that are processed per tap_send() callback to prevent
          * stalling the guest.
          */
-        packets++;
+        packets += npkts;
         if (packets >= 50) {
             break;
         }
@@ -1099,6 +1099,12 @@ static int64_t find_nonzero(const uint8_t *buf, int64_t n)
     int64_t i;
     int64_t end = QEMU_ALIGN_DOWN(n, BDRV_SECTOR_SIZE);
 
+    /* Cover the common all-zero case with a single pass before falling
+     * back to the per-sector scan for the position of the mismatch. */
+    if (buffer_is_zero(buf, n)) {
+        return -1;
+    }
+
     for (i = 0; i < end; i += BDRV_SECTOR_SIZE) {
         if (!buffer_is_zero(buf + i, BDRV_SECTOR_SIZE)) {
             return i;
@@ -1131,10 +1137,16 @@ static int is_allocated_sectors(const uint8_t *buf, int n, int *pnum,
         return 0;
     }
     is_zero = buffer_is_zero(buf, 512);
-    for(i = 1; i < n; i++) {
-        buf += 512;
-        if (is_zero != buffer_is_zero(buf, 512)) {
-            break;
+    if (is_zero && n > 1 && buffer_is_zero(buf + 512, (n - 1) * 512)) {
+        /* Common case of a completely zero buffer: one pass over the
+         * whole buffer beats n separate 512 byte checks. */
+        i = n;
+    } else {
+        for(i = 1; i < n; i++) {
+            buf += 512;
+            if (is_zero != buffer_is_zero(buf, 512)) {
+                break;
+            }
         }
     }
 
@@ -1217,6 +1229,13 @@ static int compare_buffers(const uint8_t *buf1, const uint8_t *buf2,
 
     assert(bytes > 0);
 
+    /* Identical buffers are the common case when comparing images that
+     * do match; one large memcmp beats the per-sector loop below. */
+    if (memcmp(buf1, buf2, bytes) == 0) {
+        *pnum = bytes;
+        return 0;
+    }
+
     res = !!memcmp(buf1, buf2, i);
     while (i < bytes) {
         int64_t len = MIN(bytes - i, BDRV_SECTOR_SIZE);
@@ -1572,7 +1591,7 @@ enum ImgConvertBlockStatus {
     BLK_BACKING_FILE,
 };
 
-#define MAX_COROUTINES 16
+#define MAX_COROUTINES 64
 
 typedef struct ImgConvertState {
     BlockBackend **src;
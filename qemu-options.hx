@@ -123,6 +123,7 @@ DEF("accel", HAS_ARG, QEMU_OPTION_accel,
     "                igd-passthru=on|off (enable Xen integrated Intel graphics passthrough, default=off)\n"
     "                kernel-irqchip=on|off|split controls accelerated irqchip support (default=on)\n"
     "                kvm-shadow-mem=size of KVM shadow MMU in bytes\n"
+    "                dirty-ring-size=n (KVM dirty ring GFN count, default 0)\n"
     "                tb-size=n (TCG translation block cache size)\n"
     "                thread=single|multi (enable multi-threaded TCG)\n", QEMU_ARCH_ALL)
 SRST
@@ -148,6 +149,16 @@ SRST
     ``kvm-shadow-mem=size``
         Defines the size of the KVM shadow MMU.
 
+    ``dirty-ring-size=n``
+        When KVM is enabled, it controls the size of the per-vCPU dirty
+        page ring buffer (number of entries for each vCPU). It should
+        be a value that is power of two, and it should be 1024 or
+        bigger (but still less than the maximum value that the kernel
+        supports).  4096 could be a good initial value if you have no
+        idea which is the best.  Set this value to 0 to disable the
+        feature.  By default, this feature is disabled
+        (dirty-ring-size=0); KVM then records dirty pages in a bitmap.
+
     ``tb-size=n``
         Controls the size (in MiB) of the TCG translation block cache.
 
@@ -3811,6 +3822,20 @@ SRST
     changes to the disk image.
 ERST
 
+#ifdef CONFIG_LINUX
+DEF("async-teardown", 0, QEMU_OPTION_asyncteardown, \
+    "-async-teardown enable asynchronous teardown\n", QEMU_ARCH_ALL)
+#endif
+SRST
+``-async-teardown``
+    Enable asynchronous teardown. A new teardown process is spawned at
+    startup, sharing the address space of the main QEMU process. At
+    shutdown the main process exits immediately; unmapping the guest
+    memory and tearing down the page tables, which can take a long time
+    for very large guests, is charged to the teardown process, which
+    exits as soon as the main process is gone.
+ERST
+
 DEF("loadvm", HAS_ARG, QEMU_OPTION_loadvm, \
     "-loadvm [tag|id]\n" \
     "                start right away with a saved state (loadvm in monitor)\n",
@@ -4994,6 +5019,20 @@ SRST
         the polling time when the algorithm detects it is spending too
         long polling without encountering events.
 
+        The ``coroutine-pool-prealloc`` parameter is the number of
+        coroutines to allocate into the IOThread's coroutine pool before
+        it starts processing requests, so that the first burst of I/O
+        does not pay the coroutine stack allocation cost. The default is
+        0 (no pre-allocation).
+
+        The ``cpu-affinity`` parameter is the list of host CPU numbers
+        the IOThread may run on, for example to keep the thread on the
+        NUMA node of the device backing the disk. By default the thread
+        inherits the main thread's affinity. Unlike external pinning
+        based on the thread ID, the affinity is applied before the
+        thread processes any requests and can be changed with
+        ``qom-set`` when devices are hot-plugged.
+
         The polling parameters can be modified at run-time using the
         ``qom-set`` command (where ``iothread1`` is the IOThread's
         ``id``):
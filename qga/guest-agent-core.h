@@ -17,6 +17,12 @@
 #include "qga-qapi-types.h"
 
 #define QGA_READ_COUNT_DEFAULT 4096
+/*
+ * Maximum value for the 'count' argument of guest-file-read.  The agent
+ * is single-threaded, so a single huge read stalls every other command
+ * (including health probes) and the base64 reply would be bigger still.
+ */
+#define QGA_READ_COUNT_MAX (48 * 1024 * 1024)
 
 typedef struct GAState GAState;
 typedef struct GACommandState GACommandState;
@@ -227,6 +227,20 @@ static void to_json(const QObject *obj, QString *str, int pretty, int indent)
         qstring_append(str, "\"");
 
         for (; *ptr; ptr = end) {
+            /*
+             * Printable ASCII other than '"' and '\' passes through
+             * unescaped; append whole runs of it at once instead of
+             * paying the codepoint decode and append call per byte.
+             */
+            for (end = (char *)ptr;
+                 *end >= 0x20 && *end < 0x7F && *end != '\"' && *end != '\\';
+                 end++) {
+                continue;
+            }
+            if (end != ptr) {
+                qstring_append_len(str, ptr, end - ptr);
+                continue;
+            }
             cp = mod_utf8_codepoint(ptr, 6, &end);
             switch (cp) {
             case '\"':
@@ -240,6 +240,33 @@ static bool type_is_ancestor(TypeImpl *type, TypeImpl *target_type)
     return false;
 }
 
+/*
+ * Check whether @type is a subtype of @target, or implements it as an
+ * interface.  This only walks TypeImpls, so it can be used to filter
+ * types without initializing their classes first.
+ */
+static bool type_implements(TypeImpl *type, TypeImpl *target)
+{
+    TypeImpl *t;
+    int i;
+
+    if (type_is_ancestor(type, target)) {
+        return true;
+    }
+
+    for (t = type; t; t = type_get_parent(t)) {
+        for (i = 0; i < t->num_interfaces; i++) {
+            TypeImpl *iface = type_get_by_name(t->interfaces[i].typename);
+
+            if (iface && type_is_ancestor(iface, target)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 static void type_initialize(TypeImpl *ti);
 
 static void type_initialize_interface(TypeImpl *ti, TypeImpl *interface_type,
@@ -280,6 +307,27 @@ static void object_property_free(gpointer data)
     g_free(prop);
 }
 
+static ObjectProperty *object_property_copy(ObjectProperty *prop)
+{
+    ObjectProperty *copy = g_new0(ObjectProperty, 1);
+
+    copy->name = g_strdup(prop->name);
+    copy->type = g_strdup(prop->type);
+    copy->description = g_strdup(prop->description);
+    copy->get = prop->get;
+    copy->set = prop->set;
+    copy->resolve = prop->resolve;
+    copy->release = prop->release;
+    copy->init = prop->init;
+    copy->opaque = prop->opaque;
+    copy->defval = prop->defval;
+    if (copy->defval) {
+        qobject_ref(copy->defval);
+    }
+
+    return copy;
+}
+
 static void type_initialize(TypeImpl *ti)
 {
     TypeImpl *parent;
@@ -309,6 +357,8 @@ static void type_initialize(TypeImpl *ti)
     parent = type_get_parent(ti);
     if (parent) {
         type_initialize(parent);
+        GHashTableIter iter;
+        gpointer prop;
         GSList *e;
         int i;
 
@@ -319,6 +369,20 @@ static void type_initialize(TypeImpl *ti)
         ti->class->properties = g_hash_table_new_full(
             g_str_hash, g_str_equal, NULL, object_property_free);
 
+        /*
+         * Flatten the inherited class properties into our own table, so
+         * that property lookup and iteration need not walk the parent
+         * chain.  The parent's class_init has already run at this point,
+         * and object_class_property_add() refuses names that clash
+         * anywhere in the hierarchy, so the copies cannot be shadowed.
+         */
+        g_hash_table_iter_init(&iter, parent->class->properties);
+        while (g_hash_table_iter_next(&iter, NULL, &prop)) {
+            ObjectProperty *copy = object_property_copy(prop);
+
+            g_hash_table_insert(ti->class->properties, copy->name, copy);
+        }
+
         for (e = parent->class->interfaces; e; e = e->next) {
             InterfaceClass *iface = e->data;
             ObjectClass *klass = OBJECT_CLASS(iface);
@@ -1002,6 +1066,7 @@ typedef struct OCFData
 {
     void (*fn)(ObjectClass *klass, void *opaque);
     const char *implements_type;
+    TypeImpl *implements_impl;
     bool include_abstract;
     void *opaque;
 } OCFData;
@@ -1013,6 +1078,16 @@ static void object_class_foreach_tramp(gpointer key, gpointer value,
     TypeImpl *type = value;
     ObjectClass *k;
 
+    /*
+     * Filter on the TypeImpl before touching the class, so that
+     * enumerating e.g. machine types does not initialize the class of
+     * every device this binary will never use.
+     */
+    if (data->implements_impl &&
+        !type_implements(type, data->implements_impl)) {
+        return;
+    }
+
     type_initialize(type);
     k = type->class;
 
@@ -1020,7 +1095,7 @@ static void object_class_foreach_tramp(gpointer key, gpointer value,
         return;
     }
 
-    if (data->implements_type && 
+    if (data->implements_type &&
         !object_class_dynamic_cast(k, data->implements_type)) {
         return;
     }
@@ -1032,7 +1107,9 @@ void object_class_foreach(void (*fn)(ObjectClass *klass, void *opaque),
                           const char *implements_type, bool include_abstract,
                           void *opaque)
 {
-    OCFData data = { fn, implements_type, include_abstract, opaque };
+    OCFData data = { fn, implements_type,
+                     type_get_by_name(implements_type),
+                     include_abstract, opaque };
 
     enumerating_types = true;
     g_hash_table_foreach(type_table_get(), object_class_foreach_tramp, &data);
@@ -1247,7 +1324,8 @@ ObjectProperty *object_property_iter_next(ObjectPropertyIterator *iter)
             return NULL;
         }
         g_hash_table_iter_init(&iter->iter, iter->nextclass->properties);
-        iter->nextclass = object_class_get_parent(iter->nextclass);
+        /* The class table already includes the inherited properties */
+        iter->nextclass = NULL;
     }
     return val;
 }
@@ -1256,23 +1334,20 @@ void object_class_property_iter_init(ObjectPropertyIterator *iter,
                                      ObjectClass *klass)
 {
     g_hash_table_iter_init(&iter->iter, klass->properties);
-    iter->nextclass = object_class_get_parent(klass);
+    /* The class table already includes the inherited properties */
+    iter->nextclass = NULL;
 }
 
 ObjectProperty *object_class_property_find(ObjectClass *klass, const char *name,
                                            Error **errp)
 {
     ObjectProperty *prop;
-    ObjectClass *parent_klass;
-
-    parent_klass = object_class_get_parent(klass);
-    if (parent_klass) {
-        prop = object_class_property_find(parent_klass, name, NULL);
-        if (prop) {
-            return prop;
-        }
-    }
 
+    /*
+     * Inherited properties were flattened into each class's own table
+     * when the type was initialized, so one lookup covers the whole
+     * hierarchy.
+     */
     prop = g_hash_table_lookup(klass->properties, name);
     if (!prop) {
         error_setg(errp, "Property '.%s' not found", name);
@@ -55,6 +55,16 @@ static void *qtest_server_send_opaque;
  * so clients should always handle many async messages before the response
  * comes in.
  *
+ * Commands may be pipelined: the server processes every complete line it
+ * receives, in order, and replies in the same order.  A client driving many
+ * small accesses should write them in one chunk and collect the responses
+ * afterwards instead of paying a socket round trip per access.  For bulk
+ * data, prefer the b64read/b64write commands over per-byte accesses.
+ *
+ * An embedding process (e.g. a fuzzer) can bypass the chardev transport
+ * entirely by registering a send handler with qtest_server_set_send_handler()
+ * and feeding commands to qtest_server_inproc_recv().
+ *
  * Valid requests
  *
  * Clock management:
@@ -10,6 +10,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bswap.h"
 #include "sysemu/replay.h"
 #include "sysemu/runstate.h"
 #include "replay-internal.h"
@@ -57,22 +58,46 @@ void replay_put_event(uint8_t event)
 }
 
 
+/*
+ * Multi-byte values go through a single fwrite()/fread() of their
+ * big-endian encoding instead of one stdio call per byte; each stdio
+ * call locks and unlocks the FILE, which dominates the cost of
+ * logging an event.
+ */
 void replay_put_word(uint16_t word)
 {
-    replay_put_byte(word >> 8);
-    replay_put_byte(word);
+    uint8_t buf[sizeof(word)];
+
+    if (replay_file) {
+        stw_be_p(buf, word);
+        if (fwrite(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_write_error();
+        }
+    }
 }
 
 void replay_put_dword(uint32_t dword)
 {
-    replay_put_word(dword >> 16);
-    replay_put_word(dword);
+    uint8_t buf[sizeof(dword)];
+
+    if (replay_file) {
+        stl_be_p(buf, dword);
+        if (fwrite(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_write_error();
+        }
+    }
 }
 
 void replay_put_qword(int64_t qword)
 {
-    replay_put_dword(qword >> 32);
-    replay_put_dword(qword);
+    uint8_t buf[sizeof(qword)];
+
+    if (replay_file) {
+        stq_be_p(buf, qword);
+        if (fwrite(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_write_error();
+        }
+    }
 }
 
 void replay_put_array(const uint8_t *buf, size_t size)
@@ -100,10 +125,14 @@ uint8_t replay_get_byte(void)
 
 uint16_t replay_get_word(void)
 {
+    uint8_t buf[sizeof(uint16_t)];
     uint16_t word = 0;
+
     if (replay_file) {
-        word = replay_get_byte();
-        word = (word << 8) + replay_get_byte();
+        if (fread(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_read_error();
+        }
+        word = lduw_be_p(buf);
     }
 
     return word;
@@ -111,10 +140,14 @@ uint16_t replay_get_word(void)
 
 uint32_t replay_get_dword(void)
 {
+    uint8_t buf[sizeof(uint32_t)];
     uint32_t dword = 0;
+
     if (replay_file) {
-        dword = replay_get_word();
-        dword = (dword << 16) + replay_get_word();
+        if (fread(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_read_error();
+        }
+        dword = ldl_be_p(buf);
     }
 
     return dword;
@@ -122,10 +155,14 @@ uint32_t replay_get_dword(void)
 
 int64_t replay_get_qword(void)
 {
+    uint8_t buf[sizeof(uint64_t)];
     int64_t qword = 0;
+
     if (replay_file) {
-        qword = replay_get_dword();
-        qword = (qword << 32) + replay_get_dword();
+        if (fread(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_read_error();
+        }
+        qword = ldq_be_p(buf);
     }
 
     return qword;
@@ -10,6 +10,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/units.h"
 #include "qapi/error.h"
 #include "sysemu/replay.h"
 #include "sysemu/runstate.h"
@@ -268,6 +269,13 @@ static void replay_enable(const char *fname, int mode)
         exit(1);
     }
 
+    /*
+     * The log is accessed one event at a time under the replay mutex;
+     * a buffer well above the stdio default keeps busy phases from
+     * issuing a read(2)/write(2) every few events.
+     */
+    setvbuf(replay_file, NULL, _IOFBF, 1 * MiB);
+
     replay_filename = g_strdup(fname);
     replay_mode = mode;
     replay_mutex_init();
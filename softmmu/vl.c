@@ -92,6 +92,7 @@
 #include "trace-root.h"
 #include "trace/control.h"
 #include "qemu/plugin.h"
+#include "qemu/async-teardown.h"
 #include "qemu/queue.h"
 #include "sysemu/arch_init.h"
 
@@ -2807,6 +2808,25 @@ static void create_default_memdev(MachineState *ms, const char *path)
                             &error_fatal);
 }
 
+/*
+ * Mark the end of a startup phase.  Run with "-trace vl_startup_phase"
+ * to attribute cold start time to option parsing, backend creation,
+ * board init, device realization and ROM loading.  The first call only
+ * records the baseline; its event is dropped because the trace backends
+ * are not up yet.
+ */
+static void startup_phase(const char *phase)
+{
+    static int64_t start, prev;
+    int64_t now = g_get_monotonic_time();
+
+    if (!start) {
+        start = prev = now;
+    }
+    trace_vl_startup_phase(phase, now - prev, now - start);
+    prev = now;
+}
+
 void qemu_init(int argc, char **argv, char **envp)
 {
     int i;
@@ -2843,6 +2863,9 @@ void qemu_init(int argc, char **argv, char **envp)
     char *dir, **dirs;
     const char *mem_path = NULL;
     bool have_custom_ram_size;
+#ifdef CONFIG_LINUX
+    bool enable_async_teardown = false;
+#endif
     BlockdevOptionsQueue bdo_queue = QSIMPLEQ_HEAD_INITIALIZER(bdo_queue);
     QemuPluginList plugin_list = QTAILQ_HEAD_INITIALIZER(plugin_list);
     int mem_prealloc = 0; /* force preallocation of physical target memory */
@@ -2851,6 +2874,7 @@ void qemu_init(int argc, char **argv, char **envp)
 
     error_init(argv[0]);
     module_call_init(MODULE_INIT_TRACE);
+    startup_phase("start");
 
     qemu_init_cpu_list();
     qemu_init_cpu_loop();
@@ -3524,6 +3548,11 @@ void qemu_init(int argc, char **argv, char **envp)
             case QEMU_OPTION_no_shutdown:
                 no_shutdown = 1;
                 break;
+#ifdef CONFIG_LINUX
+            case QEMU_OPTION_asyncteardown:
+                enable_async_teardown = true;
+                break;
+#endif
             case QEMU_OPTION_show_cursor:
                 warn_report("The -show-cursor option is deprecated, "
                             "use -display {sdl,gtk},show-cursor=on instead");
@@ -3886,6 +3915,7 @@ void qemu_init(int argc, char **argv, char **envp)
         exit(1);
     }
     trace_init_file(trace_file);
+    startup_phase("options-parsed");
 
     /* Open the logfile at this point and set the log mask if necessary.
      */
@@ -4123,6 +4153,7 @@ void qemu_init(int argc, char **argv, char **envp)
      * them.
      */
     configure_blockdev(&bdo_queue, machine_class, snapshot);
+    startup_phase("block-backends");
 
     machine_opts = qemu_get_machine_opts();
     qemu_opt_foreach(machine_opts, machine_set_property, current_machine,
@@ -4133,6 +4164,7 @@ void qemu_init(int argc, char **argv, char **envp)
      * after machine_set_property().
      */
     configure_accelerators(argv[0]);
+    startup_phase("accelerator");
 
     /*
      * Beware, QOM objects created before this point miss global and
@@ -4230,6 +4262,7 @@ void qemu_init(int argc, char **argv, char **envp)
         error_report_err(err);
         exit(1);
     }
+    startup_phase("net-clients");
 
     qemu_opts_foreach(qemu_find_opts("object"),
                       user_creatable_add_opts_foreach,
@@ -4322,6 +4355,7 @@ void qemu_init(int argc, char **argv, char **envp)
 
     /* from here on runstate is RUN_STATE_PRELAUNCH */
     machine_run_board_init(current_machine);
+    startup_phase("board-init");
 
     realtime_init();
 
@@ -4344,6 +4378,7 @@ void qemu_init(int argc, char **argv, char **envp)
     rom_set_order_override(FW_CFG_ORDER_OVERRIDE_DEVICE);
     qemu_opts_foreach(qemu_find_opts("device"),
                       device_init_func, NULL, &error_fatal);
+    startup_phase("devices");
 
     cpu_synchronize_all_post_init();
 
@@ -4409,6 +4444,7 @@ void qemu_init(int argc, char **argv, char **envp)
         error_report("rom check and register reset failed");
         exit(1);
     }
+    startup_phase("rom-load");
 
     replay_start();
 
@@ -4450,6 +4486,17 @@ void qemu_init(int argc, char **argv, char **envp)
 
     accel_setup_post(current_machine);
     os_setup_post();
+    startup_phase("startup-complete");
+
+#ifdef CONFIG_LINUX
+    /*
+     * Spawned after os_setup_post(), so that the teardown process
+     * shares the address space of the daemonized process.
+     */
+    if (enable_async_teardown) {
+        init_async_teardown();
+    }
+#endif
 
     return;
 }
@@ -100,6 +100,16 @@ static inline bool reloc_pc19(tcg_insn_unit *code_ptr, tcg_insn_unit *target)
     return false;
 }
 
+static inline bool reloc_pc14(tcg_insn_unit *code_ptr, tcg_insn_unit *target)
+{
+    ptrdiff_t offset = target - code_ptr;
+    if (offset == sextract64(offset, 0, 14)) {
+        *code_ptr = deposit32(*code_ptr, 5, 14, offset);
+        return true;
+    }
+    return false;
+}
+
 static inline bool patch_reloc(tcg_insn_unit *code_ptr, int type,
                                intptr_t value, intptr_t addend)
 {
@@ -110,6 +120,8 @@ static inline bool patch_reloc(tcg_insn_unit *code_ptr, int type,
         return reloc_pc26(code_ptr, (tcg_insn_unit *)value);
     case R_AARCH64_CONDBR19:
         return reloc_pc19(code_ptr, (tcg_insn_unit *)value);
+    case R_AARCH64_TSTBR14:
+        return reloc_pc14(code_ptr, (tcg_insn_unit *)value);
     default:
         g_assert_not_reached();
     }
@@ -407,6 +419,10 @@ typedef enum {
     I3201_CBZ       = 0x34000000,
     I3201_CBNZ      = 0x35000000,
 
+    /* Test and branch (immediate).  */
+    I3205_TBZ       = 0x36000000,
+    I3205_TBNZ      = 0x37000000,
+
     /* Conditional branch (immediate).  */
     I3202_B_C       = 0x54000000,
 
@@ -634,6 +650,13 @@ static void tcg_out_insn_3201(TCGContext *s, AArch64Insn insn, TCGType ext,
     tcg_out32(s, insn | ext << 31 | (imm19 & 0x7ffff) << 5 | rt);
 }
 
+static void tcg_out_insn_3205(TCGContext *s, AArch64Insn insn,
+                              TCGReg rt, int imm6, int imm14)
+{
+    tcg_out32(s, insn | (imm6 & 0x20) << 26 | (imm6 & 0x1f) << 19
+              | (imm14 & 0x3fff) << 5 | rt);
+}
+
 static void tcg_out_insn_3202(TCGContext *s, AArch64Insn insn,
                               TCGCond c, int imm19)
 {
@@ -1382,25 +1405,36 @@ static void tcg_out_brcond(TCGContext *s, TCGType ext, TCGCond c, TCGArg a,
                            TCGArg b, bool b_const, TCGLabel *l)
 {
     intptr_t offset;
-    bool need_cmp;
+    bool need_cmp = false;
+    bool need_tst = false;
 
     if (b_const && b == 0 && (c == TCG_COND_EQ || c == TCG_COND_NE)) {
-        need_cmp = false;
+        /* cbz/cbnz below */
+    } else if (b_const && b == 0 && (c == TCG_COND_LT || c == TCG_COND_GE)) {
+        /* Sign comparisons against zero only test bit 63/31: tbnz/tbz.  */
+        need_tst = true;
     } else {
         need_cmp = true;
         tcg_out_cmp(s, ext, a, b, b_const);
     }
 
     if (!l->has_value) {
-        tcg_out_reloc(s, s->code_ptr, R_AARCH64_CONDBR19, l, 0);
+        tcg_out_reloc(s, s->code_ptr, need_tst ? R_AARCH64_TSTBR14
+                                               : R_AARCH64_CONDBR19, l, 0);
         offset = tcg_in32(s) >> 5;
     } else {
         offset = l->u.value_ptr - s->code_ptr;
-        tcg_debug_assert(offset == sextract64(offset, 0, 19));
+        tcg_debug_assert(offset == sextract64(offset, 0, need_tst ? 14 : 19));
     }
 
     if (need_cmp) {
         tcg_out_insn(s, 3202, B_C, c, offset);
+    } else if (need_tst) {
+        if (c == TCG_COND_LT) {
+            tcg_out_insn(s, 3205, TBNZ, a, ext ? 63 : 31, offset);
+        } else {
+            tcg_out_insn(s, 3205, TBZ, a, ext ? 63 : 31, offset);
+        }
     } else if (c == TCG_COND_EQ) {
         tcg_out_insn(s, 3201, CBZ, ext, a, offset);
     } else {
@@ -619,29 +619,26 @@ void tcg_optimize(TCGContext *s)
         TCGOpcode opc = op->opc;
         const TCGOpDef *def = &tcg_op_defs[opc];
 
-        /* Count the arguments, and initialize the temps that are
-           going to be used */
+        /* Count the arguments, initialize the temps that are going to
+           be used, and propagate copies into the input arguments, all
+           in one pass over the argument array.  This is the hottest
+           loop of the pass, so avoid touching each argument twice. */
         if (opc == INDEX_op_call) {
             nb_oargs = TCGOP_CALLO(op);
             nb_iargs = TCGOP_CALLI(op);
-            for (i = 0; i < nb_oargs + nb_iargs; i++) {
-                TCGTemp *ts = arg_temp(op->args[i]);
-                if (ts) {
-                    init_ts_info(infos, &temps_used, ts);
-                }
-            }
         } else {
             nb_oargs = def->nb_oargs;
             nb_iargs = def->nb_iargs;
-            for (i = 0; i < nb_oargs + nb_iargs; i++) {
-                init_arg_info(infos, &temps_used, op->args[i]);
-            }
         }
-
-        /* Do copy propagation */
-        for (i = nb_oargs; i < nb_oargs + nb_iargs; i++) {
+        for (i = 0; i < nb_oargs + nb_iargs; i++) {
             TCGTemp *ts = arg_temp(op->args[i]);
-            if (ts && ts_is_copy(ts)) {
+
+            if (ts == NULL) {
+                continue;
+            }
+            init_ts_info(infos, &temps_used, ts);
+            /* Do copy propagation on the input arguments */
+            if (i >= nb_oargs && ts_is_copy(ts)) {
                 op->args[i] = temp_arg(find_better_copy(s, ts));
             }
         }
@@ -518,7 +518,22 @@ void tcg_gen_ctpop_i32(TCGv_i32 ret, TCGv_i32 arg1)
         tcg_gen_extrl_i64_i32(ret, t);
         tcg_temp_free_i64(t);
     } else {
-        gen_helper_ctpop_i32(ret, arg1);
+        /* Expand the classic parallel bit count inline; a handful of
+           ALU ops beats a helper call on any host.  */
+        TCGv_i32 t = tcg_temp_new_i32();
+        tcg_gen_shri_i32(t, arg1, 1);
+        tcg_gen_andi_i32(t, t, 0x55555555);
+        tcg_gen_sub_i32(t, arg1, t);
+        tcg_gen_shri_i32(ret, t, 2);
+        tcg_gen_andi_i32(ret, ret, 0x33333333);
+        tcg_gen_andi_i32(t, t, 0x33333333);
+        tcg_gen_add_i32(t, t, ret);
+        tcg_gen_shri_i32(ret, t, 4);
+        tcg_gen_add_i32(t, t, ret);
+        tcg_gen_andi_i32(t, t, 0x0f0f0f0f);
+        tcg_gen_muli_i32(t, t, 0x01010101);
+        tcg_gen_shri_i32(ret, t, 24);
+        tcg_temp_free_i32(t);
     }
 }
 
@@ -1935,13 +1950,28 @@ void tcg_gen_ctpop_i64(TCGv_i64 ret, TCGv_i64 arg1)
 {
     if (TCG_TARGET_HAS_ctpop_i64) {
         tcg_gen_op2_i64(INDEX_op_ctpop_i64, ret, arg1);
-    } else if (TCG_TARGET_REG_BITS == 32 && TCG_TARGET_HAS_ctpop_i32) {
+    } else if (TCG_TARGET_REG_BITS == 32) {
+        /* The 32-bit expansion is inline even without ctpop_i32.  */
         tcg_gen_ctpop_i32(TCGV_HIGH(ret), TCGV_HIGH(arg1));
         tcg_gen_ctpop_i32(TCGV_LOW(ret), TCGV_LOW(arg1));
         tcg_gen_add_i32(TCGV_LOW(ret), TCGV_LOW(ret), TCGV_HIGH(ret));
         tcg_gen_movi_i32(TCGV_HIGH(ret), 0);
     } else {
-        gen_helper_ctpop_i64(ret, arg1);
+        /* As for the 32-bit case, a parallel bit count beats a call.  */
+        TCGv_i64 t = tcg_temp_new_i64();
+        tcg_gen_shri_i64(t, arg1, 1);
+        tcg_gen_andi_i64(t, t, 0x5555555555555555ull);
+        tcg_gen_sub_i64(t, arg1, t);
+        tcg_gen_shri_i64(ret, t, 2);
+        tcg_gen_andi_i64(ret, ret, 0x3333333333333333ull);
+        tcg_gen_andi_i64(t, t, 0x3333333333333333ull);
+        tcg_gen_add_i64(t, t, ret);
+        tcg_gen_shri_i64(ret, t, 4);
+        tcg_gen_add_i64(t, t, ret);
+        tcg_gen_andi_i64(t, t, 0x0f0f0f0f0f0f0f0full);
+        tcg_gen_muli_i64(t, t, 0x0101010101010101ull);
+        tcg_gen_shri_i64(ret, t, 56);
+        tcg_temp_free_i64(t);
     }
 }
 
@@ -547,13 +547,20 @@ static void tcg_region_assign(TCGContext *s, size_t curr_region)
     s->code_gen_highwater = end - TCG_HIGHWATER;
 }
 
-static bool tcg_region_alloc__locked(TCGContext *s)
+/*
+ * Claim the next free region.  The hand-out is lock-free: a fetch-and-add
+ * on region.current arbitrates between racing vCPU threads, and the only
+ * writer that rewinds it, tcg_region_reset_all(), runs from a safe-work
+ * context with all vCPUs quiesced.
+ */
+static bool tcg_region_claim(TCGContext *s)
 {
-    if (region.current == region.n) {
+    size_t idx = atomic_fetch_inc(&region.current);
+
+    if (idx >= region.n) {
         return true;
     }
-    tcg_region_assign(s, region.current);
-    region.current++;
+    tcg_region_assign(s, idx);
     return false;
 }
 
@@ -563,17 +570,14 @@ static bool tcg_region_alloc__locked(TCGContext *s)
  */
 static bool tcg_region_alloc(TCGContext *s)
 {
-    bool err;
-    /* read the region size now; alloc__locked will overwrite it on success */
+    /* read the region size now; claiming will overwrite it on success */
     size_t size_full = s->code_gen_buffer_size;
 
-    qemu_mutex_lock(&region.lock);
-    err = tcg_region_alloc__locked(s);
-    if (!err) {
-        region.agg_size_full += size_full - TCG_HIGHWATER;
+    if (tcg_region_claim(s)) {
+        return true;
     }
-    qemu_mutex_unlock(&region.lock);
-    return err;
+    atomic_add(&region.agg_size_full, size_full - TCG_HIGHWATER);
+    return false;
 }
 
 /*
@@ -582,7 +586,7 @@ static bool tcg_region_alloc(TCGContext *s)
  */
 static inline bool tcg_region_initial_alloc__locked(TCGContext *s)
 {
-    return tcg_region_alloc__locked(s);
+    return tcg_region_claim(s);
 }
 
 /* Call from a safe-work context */
@@ -592,8 +596,8 @@ void tcg_region_reset_all(void)
     unsigned int i;
 
     qemu_mutex_lock(&region.lock);
-    region.current = 0;
-    region.agg_size_full = 0;
+    atomic_set(&region.current, 0);
+    atomic_set(&region.agg_size_full, 0);
 
     for (i = 0; i < n_ctxs; i++) {
         TCGContext *s = atomic_read(&tcg_ctxs[i]);
@@ -814,17 +818,19 @@ size_t tcg_code_size(void)
     unsigned int i;
     size_t total;
 
-    qemu_mutex_lock(&region.lock);
-    total = region.agg_size_full;
+    total = atomic_read(&region.agg_size_full);
     for (i = 0; i < n_ctxs; i++) {
         const TCGContext *s = atomic_read(&tcg_ctxs[i]);
         size_t size;
 
+        /*
+         * Region hand-out is lock-free, so we can race with a context
+         * moving to a fresh region; tolerate a transiently inconsistent
+         * ptr/buffer pair since this is only a statistic.
+         */
         size = atomic_read(&s->code_gen_ptr) - s->code_gen_buffer;
-        g_assert(size <= s->code_gen_buffer_size);
-        total += size;
+        total += MIN(size, s->code_gen_buffer_size);
     }
-    qemu_mutex_unlock(&region.lock);
     return total;
 }
 
@@ -3229,7 +3235,10 @@ static TCGReg tcg_reg_alloc(TCGContext *s, TCGRegSet required_regs,
         }
     }
 
-    /* We must spill something.  */
+    /* We must spill something.  Prefer a victim whose memory copy is
+       coherent, so that freeing the register costs no store; in long TBs
+       the blind first-fit choice here forces redundant spill/reload
+       pairs of live dirty temps.  */
     for (j = f; j < 2; j++) {
         TCGRegSet set = reg_ct[j];
 
@@ -3239,13 +3248,24 @@ static TCGReg tcg_reg_alloc(TCGContext *s, TCGRegSet required_regs,
             tcg_reg_free(s, reg, allocated_regs);
             return reg;
         } else {
+            int dirty = -1;
+
             for (i = 0; i < n; i++) {
                 TCGReg reg = order[i];
                 if (tcg_regset_test_reg(set, reg)) {
-                    tcg_reg_free(s, reg, allocated_regs);
-                    return reg;
+                    if (s->reg_to_temp[reg]->mem_coherent) {
+                        tcg_reg_free(s, reg, allocated_regs);
+                        return reg;
+                    }
+                    if (dirty < 0) {
+                        dirty = reg;
+                    }
                 }
             }
+            if (dirty >= 0) {
+                tcg_reg_free(s, dirty, allocated_regs);
+                return dirty;
+            }
         }
     }
 
@@ -4079,7 +4099,14 @@ int tcg_gen_code(TCGContext *s, TranslationBlock *tb)
 #endif
 
 #ifdef USE_TCG_OPTIMIZATIONS
-    tcg_optimize(s);
+    /*
+     * CF_NOCACHE TBs are executed once and freed, so time spent in the
+     * optimizer is pure vCPU-thread latency that can never be amortized.
+     * Liveness analysis below is still required for correctness.
+     */
+    if (!(s->tb_cflags & CF_NOCACHE)) {
+        tcg_optimize(s);
+    }
 #endif
 
 #ifdef CONFIG_PROFILER
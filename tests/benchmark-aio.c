@@ -0,0 +1,216 @@
+/*
+ * Event loop primitive speed benchmark
+ *
+ * Measures the cost of the building blocks that every event loop
+ * change touches: bottom half wakeup latency from a foreign thread,
+ * thread pool submit-to-complete latency, and CoMutex contention
+ * scaling.  Results are printed as one JSON object per line so runs
+ * can be diffed mechanically.  Coroutine create/yield costs are
+ * already covered by the /perf/ cases in test-coroutine.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * (at your option) any later version.  See the COPYING file in the
+ * top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "qemu-common.h"
+#include "block/aio.h"
+#include "block/thread-pool.h"
+#include "qapi/error.h"
+#include "qemu/coroutine.h"
+#include "qemu/main-loop.h"
+#include "qemu/timer.h"
+
+#define LATENCY_SAMPLES 10000
+
+static AioContext *ctx;
+
+static int64_t bench_now_ns(void)
+{
+    return qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void report_latency(const char *name, int64_t *samples, int n)
+{
+    qsort(samples, n, sizeof(samples[0]), cmp_i64);
+    g_print("{\"bench\": \"%s\", \"samples\": %d, \"min_ns\": %" PRId64
+            ", \"p50_ns\": %" PRId64 ", \"p99_ns\": %" PRId64
+            ", \"max_ns\": %" PRId64 "}\n",
+            name, n, samples[0], samples[n / 2],
+            samples[n - n / 100 - 1], samples[n - 1]);
+}
+
+/*
+ * Bottom half wakeup latency: a foreign thread schedules a one-shot BH
+ * and the main thread sits in aio_poll(), like an iothread being kicked
+ * by a vCPU.
+ */
+typedef struct {
+    int64_t t0;
+    int64_t *samples;
+    int n;
+    int count;
+    QemuEvent handled;
+} WakeupBench;
+
+static void bh_wakeup_cb(void *opaque)
+{
+    WakeupBench *s = opaque;
+
+    /* Runs in the aio_poll() thread, so count needs no locking. */
+    s->samples[s->count++] = bench_now_ns() - s->t0;
+    qemu_event_set(&s->handled);
+}
+
+static void *bh_wakeup_thread(void *opaque)
+{
+    WakeupBench *s = opaque;
+    int i;
+
+    for (i = 0; i < s->n; i++) {
+        qemu_event_reset(&s->handled);
+        s->t0 = bench_now_ns();
+        aio_bh_schedule_oneshot(ctx, bh_wakeup_cb, s);
+        qemu_event_wait(&s->handled);
+    }
+    return NULL;
+}
+
+static void bench_bh_wakeup(void)
+{
+    WakeupBench s = { .n = LATENCY_SAMPLES };
+    QemuThread thread;
+
+    s.samples = g_new(int64_t, s.n);
+    qemu_event_init(&s.handled, false);
+    qemu_thread_create(&thread, "bh-wakeup", bh_wakeup_thread, &s,
+                       QEMU_THREAD_JOINABLE);
+    while (s.count < s.n) {
+        aio_poll(ctx, true);
+    }
+    qemu_thread_join(&thread);
+    qemu_event_destroy(&s.handled);
+
+    report_latency("bh-wakeup", s.samples, s.n);
+    g_free(s.samples);
+}
+
+/*
+ * Thread pool submit-to-complete latency for a no-op work item,
+ * i.e. the fixed cost that the pool adds on top of the actual work.
+ */
+typedef struct {
+    int64_t t0;
+    int64_t *samples;
+    int count;
+    bool done;
+} PoolBench;
+
+static int pool_nop_worker(void *opaque)
+{
+    return 0;
+}
+
+static void pool_done_cb(void *opaque, int ret)
+{
+    PoolBench *s = opaque;
+
+    s->samples[s->count++] = bench_now_ns() - s->t0;
+    s->done = true;
+}
+
+static void bench_thread_pool(void)
+{
+    ThreadPool *pool = aio_get_thread_pool(ctx);
+    PoolBench s = { 0 };
+    int i;
+
+    s.samples = g_new(int64_t, LATENCY_SAMPLES);
+    for (i = 0; i < LATENCY_SAMPLES; i++) {
+        s.done = false;
+        s.t0 = bench_now_ns();
+        thread_pool_submit_aio(pool, pool_nop_worker, NULL,
+                               pool_done_cb, &s);
+        while (!s.done) {
+            aio_poll(ctx, true);
+        }
+    }
+
+    report_latency("thread-pool", s.samples, s.count);
+    g_free(s.samples);
+}
+
+/*
+ * CoMutex contention: each contender reschedules itself while holding
+ * the lock, so every other contender really blocks on the mutex and
+ * the handoff path is exercised on each iteration.
+ */
+typedef struct {
+    CoMutex mutex;
+    int iters;
+    int running;
+    unsigned long long counter;
+} MutexBench;
+
+static void coroutine_fn comutex_bench_co(void *opaque)
+{
+    MutexBench *s = opaque;
+    int i;
+
+    for (i = 0; i < s->iters; i++) {
+        qemu_co_mutex_lock(&s->mutex);
+        aio_co_schedule(ctx, qemu_coroutine_self());
+        qemu_coroutine_yield();
+        s->counter++;
+        qemu_co_mutex_unlock(&s->mutex);
+    }
+    s->running--;
+}
+
+static void bench_comutex_contention(void)
+{
+    static const int ncoros[] = { 1, 2, 8, 32 };
+    size_t n;
+
+    for (n = 0; n < ARRAY_SIZE(ncoros); n++) {
+        MutexBench s = { .iters = 10000, .running = ncoros[n] };
+        int64_t t0, dt;
+        int i;
+
+        qemu_co_mutex_init(&s.mutex);
+        t0 = bench_now_ns();
+        for (i = 0; i < ncoros[n]; i++) {
+            aio_co_schedule(ctx, qemu_coroutine_create(comutex_bench_co, &s));
+        }
+        while (s.running > 0) {
+            aio_poll(ctx, true);
+        }
+        dt = bench_now_ns() - t0;
+
+        g_assert_cmpint(s.counter, ==, (uint64_t)s.iters * ncoros[n]);
+        g_print("{\"bench\": \"comutex-contention\", \"coroutines\": %d"
+                ", \"locked_sections\": %llu, \"ns_per_section\": %" PRId64
+                "}\n", ncoros[n], s.counter, dt / (int64_t)s.counter);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    qemu_init_main_loop(&error_fatal);
+    ctx = qemu_get_aio_context();
+
+    g_test_add_func("/aio/bench/bh-wakeup", bench_bh_wakeup);
+    g_test_add_func("/aio/bench/thread-pool", bench_thread_pool);
+    g_test_add_func("/aio/bench/comutex-contention", bench_comutex_contention);
+
+    return g_test_run();
+}
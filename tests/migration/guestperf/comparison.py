@@ -109,6 +109,47 @@ COMPARISONS = [
     ]),
 
 
+    # Looking at effect of multifd with varying numbers of channels
+    Comparison("compr-multifd", scenarios = [
+        Scenario("compr-multifd-channels-2",
+                 multifd=True, multifd_channels=2),
+        Scenario("compr-multifd-channels-4",
+                 multifd=True, multifd_channels=4),
+        Scenario("compr-multifd-channels-8",
+                 multifd=True, multifd_channels=8),
+        Scenario("compr-multifd-channels-16",
+                 multifd=True, multifd_channels=16),
+    ]),
+
+
+    # Looking at effect of multifd packet compression methods
+    # with a fixed channel count
+    Comparison("compr-multifd-compression", scenarios = [
+        Scenario("compr-multifd-compression-none",
+                 multifd=True, multifd_channels=4),
+        Scenario("compr-multifd-compression-zlib",
+                 multifd=True, multifd_channels=4,
+                 multifd_compression="zlib"),
+        Scenario("compr-multifd-compression-zstd",
+                 multifd=True, multifd_channels=4,
+                 multifd_compression="zstd"),
+    ]),
+
+
+    # Looking at how convergence behaves as the guest dirties
+    # memory at increasing rates
+    Comparison("dirty-rate", scenarios = [
+        Scenario("dirty-rate-100mbs",
+                 dirty_rate=100),
+        Scenario("dirty-rate-300mbs",
+                 dirty_rate=300),
+        Scenario("dirty-rate-1000mbs",
+                 dirty_rate=1000),
+        Scenario("dirty-rate-3000mbs",
+                 dirty_rate=3000),
+    ]),
+
+
     # Looking at effect of xbzrle compression with varying
     # cache sizes
     Comparison("compr-xbzrle", scenarios = [
@@ -167,6 +167,9 @@ static unsigned long long now(void)
     return (tv.tv_sec * 1000ull) + (tv.tv_usec / 1000ull);
 }
 
+/* Target dirty rate in MB/sec per stress thread. 0 == unthrottled */
+static unsigned long long dirtyrateMB;
+
 static int stressone(unsigned long long ramsizeMB)
 {
     size_t pagesPerMB = 1024 * 1024 / PAGE_SIZE;
@@ -175,8 +178,8 @@ static int stressone(unsigned long long ramsizeMB)
     size_t i, j, k;
     char *data = malloc(PAGE_SIZE);
     char *dataptr;
-    size_t nMB = 0;
-    unsigned long long before, after;
+    size_t nMB = 0, rateMB = 0;
+    unsigned long long before, after, ratestart;
 
     if (!ram) {
         fprintf(stderr, "%s (%05d): ERROR: cannot allocate %llu MB of RAM: %s\n",
@@ -204,6 +207,7 @@ static int stressone(unsigned long long ramsizeMB)
     }
 
     before = now();
+    ratestart = before;
 
     while (1) {
 
@@ -218,6 +222,16 @@ static int stressone(unsigned long long ramsizeMB)
                 }
             }
 
+            /* Pace the loop so each second dirties dirtyrateMB MB */
+            if (dirtyrateMB && ++rateMB >= dirtyrateMB) {
+                unsigned long long elapsed = now() - ratestart;
+                if (elapsed < 1000) {
+                    usleep((1000 - elapsed) * 1000);
+                }
+                ratestart = now();
+                rateMB = 0;
+            }
+
             if (nMB == 1024) {
                 after = now();
                 fprintf(stderr, "%s (%05d): INFO: %06llums copied 1 GB in %05llums\n",
@@ -293,14 +307,16 @@ static int mount_all(void)
 int main(int argc, char **argv)
 {
     unsigned long long ramsizeGB = 1;
+    unsigned long long dirtyrateGuestMB = 0;
     char *end;
     int ch;
     int opt_ind = 0;
-    const char *sopt = "hr:c:";
+    const char *sopt = "hr:c:d:";
     struct option lopt[] = {
         { "help", no_argument, NULL, 'h' },
         { "ramsize", required_argument, NULL, 'r' },
         { "cpus", required_argument, NULL, 'c' },
+        { "dirtyrate", required_argument, NULL, 'd' },
         { NULL, 0, NULL, 0 }
     };
     int ret;
@@ -330,9 +346,21 @@ int main(int argc, char **argv)
             }
             break;
 
+        case 'd':
+            errno = 0;
+            dirtyrateGuestMB = strtoll(optarg, &end, 10);
+            if (errno != 0 || *end) {
+                fprintf(stderr, "%s (%05d): ERROR: Cannot parse dirty rate %s\n",
+                        argv0, gettid(), optarg);
+                exit_failure();
+            }
+            break;
+
         case '?':
         case 'h':
-            fprintf(stderr, "%s: [--help][--ramsize GB][--cpus N]\n", argv0);
+            fprintf(stderr,
+                    "%s: [--help][--ramsize GB][--cpus N][--dirtyrate MB/s]\n",
+                    argv0);
             exit_failure();
         }
     }
@@ -344,13 +372,24 @@ int main(int argc, char **argv)
         ret = get_command_arg_ull("ramsize", &ramsizeGB);
         if (ret < 0)
             exit_failure();
+
+        ret = get_command_arg_ull("dirtyrate", &dirtyrateGuestMB);
+        if (ret < 0)
+            exit_failure();
     }
 
     if (ncpus == 0)
         ncpus = sysconf(_SC_NPROCESSORS_ONLN);
 
-    fprintf(stdout, "%s (%05d): INFO: RAM %llu GiB across %d CPUs\n",
-            argv0, gettid(), ramsizeGB, ncpus);
+    if (dirtyrateGuestMB) {
+        dirtyrateMB = dirtyrateGuestMB / ncpus;
+        if (dirtyrateMB == 0)
+            dirtyrateMB = 1;
+    }
+
+    fprintf(stdout, "%s (%05d): INFO: RAM %llu GiB across %d CPUs, "
+            "dirty rate %llu MB/s\n",
+            argv0, gettid(), ramsizeGB, ncpus, dirtyrateGuestMB);
 
     if (stress(ramsizeGB, ncpus) < 0)
         exit_failure();
@@ -0,0 +1,182 @@
+/*
+ * TCG translation-quality benchmark.
+ *
+ * Runs a set of pinned, self-checking kernels and reports wall-clock
+ * time per kernel as JSON, one object per line.  The workloads are
+ * fixed (no calibration), so a run under the same guest binary is
+ * directly comparable across QEMU builds and makes a usable trend
+ * metric for translation quality.  Run via "make check-tcg-perf";
+ * this is deliberately not part of the correctness suite.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t iterations, int64_t ns,
+                   uint64_t check)
+{
+    printf("{\"bench\": \"%s\", \"iterations\": %" PRIu64
+           ", \"ns\": %" PRId64 ", \"check\": \"%016" PRIx64 "\"}\n",
+           name, iterations, ns, check);
+}
+
+/*
+ * Integer ALU/branch kernel: xorshift64* PRNG feeding a
+ * data-dependent branch.  Stresses flag handling, shifts and
+ * conditional branches.
+ */
+#define INT_ITERS 20000000ull
+
+static uint64_t bench_int(void)
+{
+    uint64_t x = 0x9e3779b97f4a7c15ull;
+    uint64_t acc = 0;
+    uint64_t i;
+
+    for (i = 0; i < INT_ITERS; i++) {
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        if (x & 1) {
+            acc += x * 0x2545f4914f6cdd1dull;
+        } else {
+            acc ^= x >> 7;
+        }
+    }
+    return acc;
+}
+
+/*
+ * Memory kernel: byte-wise checksum sweeps over a buffer larger than
+ * a page so the softmmu TLB and user-mode g2h paths both get
+ * exercised along with load merging.
+ */
+#define MEM_BUF_SIZE (256 * 1024)
+#define MEM_SWEEPS 200ull
+
+static uint64_t bench_mem(void)
+{
+    static unsigned char buf[MEM_BUF_SIZE];
+    uint64_t acc = 0;
+    uint64_t s;
+    size_t i;
+
+    for (i = 0; i < MEM_BUF_SIZE; i++) {
+        buf[i] = (unsigned char)(i * 131 + 7);
+    }
+    for (s = 0; s < MEM_SWEEPS; s++) {
+        for (i = 0; i < MEM_BUF_SIZE; i += 8) {
+            uint64_t v;
+            memcpy(&v, &buf[i], 8);
+            acc = (acc << 1 | acc >> 63) + v;
+        }
+    }
+    return acc;
+}
+
+/*
+ * Floating point kernel: fused-style multiply/add chain.  Stresses
+ * the softfloat (or host FPU) paths and FP register allocation.
+ */
+#define FLOAT_ITERS 5000000ull
+
+static uint64_t bench_float(void)
+{
+    double a = 1.0, b = 1.5, c = -0.25;
+    uint64_t r;
+    uint64_t i;
+
+    for (i = 0; i < FLOAT_ITERS; i++) {
+        a = a * b + c;
+        if (a > 1e10 || a < -1e10) {
+            a *= 1e-10;
+        }
+    }
+    memcpy(&r, &a, 8);
+    return r;
+}
+
+/*
+ * Atomic kernel: two threads hammering one counter with CAS.  Forces
+ * parallel code generation, so the measured cost is the real atomic
+ * op emission (or EXCP_ATOMIC fallback), not the single-threaded
+ * simplification.
+ */
+#define ATOMIC_ITERS 1000000ull
+
+static uint64_t atomic_counter;
+
+static void *atomic_worker(void *arg)
+{
+    uint64_t i;
+
+    for (i = 0; i < ATOMIC_ITERS; i++) {
+        uint64_t old, new;
+        do {
+            old = __atomic_load_n(&atomic_counter, __ATOMIC_RELAXED);
+            new = old + 1;
+        } while (!__atomic_compare_exchange_n(&atomic_counter, &old, new,
+                                              0, __ATOMIC_SEQ_CST,
+                                              __ATOMIC_RELAXED));
+    }
+    return NULL;
+}
+
+static uint64_t bench_atomic(void)
+{
+    pthread_t thr;
+
+    atomic_counter = 0;
+    pthread_create(&thr, NULL, atomic_worker, NULL);
+    atomic_worker(NULL);
+    pthread_join(thr, NULL);
+    return atomic_counter;
+}
+
+struct bench {
+    const char *name;
+    uint64_t (*fn)(void);
+    uint64_t iterations;
+    uint64_t expected;      /* 0 = unchecked */
+};
+
+static const struct bench benches[] = {
+    { "int_alu", bench_int, INT_ITERS, 0 },
+    { "mem_sweep", bench_mem, MEM_SWEEPS * (MEM_BUF_SIZE / 8), 0 },
+    { "float_madd", bench_float, FLOAT_ITERS, 0 },
+    { "atomic_cas", bench_atomic, 2 * ATOMIC_ITERS, 2 * ATOMIC_ITERS },
+};
+
+int main(void)
+{
+    size_t i;
+    int ret = 0;
+
+    for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        const struct bench *b = &benches[i];
+        int64_t t0 = now_ns();
+        uint64_t check = b->fn();
+        int64_t t1 = now_ns();
+
+        report(b->name, b->iterations, t1 - t0, check);
+        if (b->expected && check != b->expected) {
+            fprintf(stderr, "%s: bad result %016llx\n", b->name,
+                    (unsigned long long)check);
+            ret = 1;
+        }
+    }
+    return ret;
+}
@@ -671,6 +671,46 @@ static void test_accounting(void)
                                 (64.0 / 13)));
 }
 
+static void test_account_lease(void)
+{
+    uint64_t bytes, ops;
+
+    throttle_init(&ts);
+    throttle_config_init(&cfg);
+    cfg.buckets[THROTTLE_BPS_TOTAL].avg = 1000;
+    cfg.buckets[THROTTLE_OPS_TOTAL].avg = 100;
+    throttle_config(&ts, QEMU_CLOCK_VIRTUAL, &cfg);
+
+    /* A lease is a tenth of a second worth of I/O and is accounted to
+     * the buckets immediately */
+    throttle_account_lease(&ts, false, &bytes, &ops);
+    g_assert(bytes == 100);
+    g_assert(ops == 10);
+    g_assert(double_cmp(ts.cfg.buckets[THROTTLE_BPS_TOTAL].level, 100));
+    g_assert(double_cmp(ts.cfg.buckets[THROTTLE_OPS_TOTAL].level, 10));
+
+    /* The buckets are now at the point where the next request would
+     * have to wait, so no further tokens are granted */
+    throttle_account_lease(&ts, false, &bytes, &ops);
+    g_assert(bytes == 0);
+    g_assert(ops == 0);
+
+    /* Unlimited dimensions are reported as UINT64_MAX and the buckets
+     * are left untouched */
+    throttle_config_init(&cfg);
+    cfg.buckets[THROTTLE_BPS_WRITE].avg = 1000;
+    throttle_config(&ts, QEMU_CLOCK_VIRTUAL, &cfg);
+
+    throttle_account_lease(&ts, true, &bytes, &ops);
+    g_assert(bytes == 100);
+    g_assert(ops == UINT64_MAX);
+
+    throttle_account_lease(&ts, false, &bytes, &ops);
+    g_assert(bytes == UINT64_MAX);
+    g_assert(ops == UINT64_MAX);
+    g_assert(double_cmp(ts.cfg.buckets[THROTTLE_BPS_READ].level, 0));
+}
+
 static void test_groups(void)
 {
     ThrottleConfig cfg1, cfg2;
@@ -764,6 +804,7 @@ int main(int argc, char **argv)
                     test_iops_size_is_missing_limit);
     g_test_add_func("/throttle/config_functions",   test_config_functions);
     g_test_add_func("/throttle/accounting",         test_accounting);
+    g_test_add_func("/throttle/account_lease",      test_account_lease);
     g_test_add_func("/throttle/groups",             test_groups);
     return g_test_run();
 }
@@ -41,7 +41,8 @@ static GMutex trace_lock;
 static GCond trace_available_cond;
 static GCond trace_empty_cond;
 
-static bool trace_available;
+/* accessed with atomics so that producers can test it without trace_lock */
+static gint trace_available;
 static bool trace_writeout_enabled;
 
 enum {
@@ -81,14 +82,12 @@ static unsigned int write_to_buffer(unsigned int idx, void *dataptr, size_t size
 
 static void clear_buffer_range(unsigned int idx, size_t len)
 {
-    uint32_t num = 0;
-    while (num < len) {
-        if (idx >= TRACE_BUF_LEN) {
-            idx = idx % TRACE_BUF_LEN;
-        }
-        trace_buf[idx++] = 0;
-        num++;
-    }
+    size_t first;
+
+    idx %= TRACE_BUF_LEN;
+    first = MIN(len, (size_t)(TRACE_BUF_LEN - idx));
+    memset(trace_buf + idx, 0, first);
+    memset(trace_buf, 0, len - first);
 }
 /**
  * Read a trace record from the trace buffer
@@ -132,8 +131,19 @@ static bool get_trace_record(unsigned int idx, TraceRecord **recordptr)
  */
 static void flush_trace_file(bool wait)
 {
+    /*
+     * Once the buffer runs more than a flush threshold ahead of the
+     * writeout thread, every record completion ends up here; skip the
+     * mutex when a kick is already pending.  The writeout thread only
+     * clears the flag under trace_lock before draining, so at worst a
+     * record completed during the drain waits for the next kick.
+     */
+    if (!wait && g_atomic_int_get(&trace_available)) {
+        return;
+    }
+
     g_mutex_lock(&trace_lock);
-    trace_available = true;
+    g_atomic_int_set(&trace_available, 1);
     g_cond_signal(&trace_available_cond);
 
     if (wait) {
@@ -146,11 +156,11 @@ static void flush_trace_file(bool wait)
 static void wait_for_trace_records_available(void)
 {
     g_mutex_lock(&trace_lock);
-    while (!(trace_available && trace_writeout_enabled)) {
+    while (!(g_atomic_int_get(&trace_available) && trace_writeout_enabled)) {
         g_cond_signal(&trace_empty_cond);
         g_cond_wait(&trace_available_cond, &trace_lock);
     }
-    trace_available = false;
+    g_atomic_int_set(&trace_available, 0);
     g_mutex_unlock(&trace_lock);
 }
 
@@ -244,26 +254,25 @@ int trace_record_start(TraceBufferRecord *rec, uint32_t event, size_t datasize)
 static void read_from_buffer(unsigned int idx, void *dataptr, size_t size)
 {
     uint8_t *data_ptr = dataptr;
-    uint32_t x = 0;
-    while (x < size) {
-        if (idx >= TRACE_BUF_LEN) {
-            idx = idx % TRACE_BUF_LEN;
-        }
-        data_ptr[x++] = trace_buf[idx++];
-    }
+    size_t first;
+
+    idx %= TRACE_BUF_LEN;
+    first = MIN(size, (size_t)(TRACE_BUF_LEN - idx));
+    memcpy(data_ptr, trace_buf + idx, first);
+    memcpy(data_ptr + first, trace_buf, size - first);
 }
 
 static unsigned int write_to_buffer(unsigned int idx, void *dataptr, size_t size)
 {
     uint8_t *data_ptr = dataptr;
-    uint32_t x = 0;
-    while (x < size) {
-        if (idx >= TRACE_BUF_LEN) {
-            idx = idx % TRACE_BUF_LEN;
-        }
-        trace_buf[idx++] = data_ptr[x++];
-    }
-    return idx; /* most callers wants to know where to write next */
+    size_t first;
+
+    idx %= TRACE_BUF_LEN;
+    first = MIN(size, (size_t)(TRACE_BUF_LEN - idx));
+    memcpy(trace_buf + idx, data_ptr, first);
+    memcpy(trace_buf, data_ptr + first, size - first);
+    /* most callers want to know where to write next */
+    return (idx + size) % TRACE_BUF_LEN;
 }
 
 void trace_record_finish(TraceBufferRecord *rec)
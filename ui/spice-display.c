@@ -183,6 +183,17 @@ static void qemu_spice_create_one_update(SimpleSpiceDisplay *ssd,
     QTAILQ_INSERT_TAIL(&ssd->updates, update, next);
 }
 
+static gint qemu_spice_rect_cmp(gconstpointer a, gconstpointer b)
+{
+    const QXLRect *ra = a;
+    const QXLRect *rb = b;
+
+    if (ra->top != rb->top) {
+        return ra->top - rb->top;
+    }
+    return ra->left - rb->left;
+}
+
 static void qemu_spice_create_update(SimpleSpiceDisplay *ssd)
 {
     static const int blksize = 32;
@@ -191,8 +202,12 @@ static void qemu_spice_create_update(SimpleSpiceDisplay *ssd)
     int y, yoff1, yoff2, x, xoff, blk, bw;
     int bpp = surface_bytes_per_pixel(ssd->ds);
     uint8_t *guest, *mirror;
+    GArray *rects = g_array_new(FALSE, FALSE, sizeof(QXLRect));
+    QXLRect *merged = NULL;
+    guint i;
 
     if (qemu_spice_rect_is_empty(&ssd->dirty)) {
+        g_array_free(rects, TRUE);
         return;
     };
 
@@ -219,7 +234,7 @@ static void qemu_spice_create_update(SimpleSpiceDisplay *ssd)
                         .left   = x,
                         .right  = x + bw,
                     };
-                    qemu_spice_create_one_update(ssd, &update);
+                    g_array_append_val(rects, update);
                     dirty_top[blk] = -1;
                 }
             } else {
@@ -240,11 +255,36 @@ static void qemu_spice_create_update(SimpleSpiceDisplay *ssd)
                 .left   = x,
                 .right  = x + bw,
             };
-            qemu_spice_create_one_update(ssd, &update);
+            g_array_append_val(rects, update);
             dirty_top[blk] = -1;
         }
     }
 
+    /* The per-column scan above splits a change spanning the width of
+     * the screen into one run per 32 pixel column, and each update
+     * carries a drawable, a bitmap allocation and two blits.  Merge
+     * horizontally adjacent runs with identical vertical extent back
+     * into a single update before emitting; a redrawn terminal line
+     * then costs one update instead of dozens. */
+    g_array_sort(rects, qemu_spice_rect_cmp);
+    for (i = 0; i < rects->len; i++) {
+        QXLRect *r = &g_array_index(rects, QXLRect, i);
+
+        if (merged && merged->top == r->top &&
+            merged->bottom == r->bottom && merged->right == r->left) {
+            merged->right = r->right;
+        } else {
+            if (merged) {
+                qemu_spice_create_one_update(ssd, merged);
+            }
+            merged = r;
+        }
+    }
+    if (merged) {
+        qemu_spice_create_one_update(ssd, merged);
+    }
+    g_array_free(rects, TRUE);
+
     memset(&ssd->dirty, 0, sizeof(ssd->dirty));
 }
 
@@ -52,19 +52,34 @@
  * and copy its output buffer in vs->output.
  */
 
+#define VNC_MAX_WORKER_THREADS 4
+
+typedef struct VncJobQueue VncJobQueue;
+
+typedef struct VncWorker {
+    VncJobQueue *queue;
+    int index;
+} VncWorker;
+
 struct VncJobQueue {
     QemuCond cond;
     QemuMutex mutex;
-    QemuThread thread;
+    QemuThread threads[VNC_MAX_WORKER_THREADS];
+    VncWorker workers[VNC_MAX_WORKER_THREADS];
+    /* Clients whose job is currently running on some worker thread. */
+    VncState *processing[VNC_MAX_WORKER_THREADS];
+    int n_threads;
+    int n_running;
     bool exit;
     QTAILQ_HEAD(, VncJob) jobs;
 };
 
-typedef struct VncJobQueue VncJobQueue;
-
 /*
- * We use a single global queue, but most of the functions are
- * already reentrant, so we can easily add more than one encoding thread
+ * We use a single global queue served by a small pool of encoding
+ * threads.  Jobs for different clients are encoded in parallel; jobs
+ * for the same client are kept in submission order and never run
+ * concurrently, so the client's output stream and its persistent
+ * encoder state (zlib/tight/zrle streams) stay consistent.
  */
 static VncJobQueue *queue;
 
@@ -117,10 +132,25 @@ void vnc_job_push(VncJob *job)
     vnc_unlock_queue(queue);
 }
 
+static bool vnc_processing_locked(VncJobQueue *queue, VncState *vs)
+{
+    int i;
+
+    for (i = 0; i < queue->n_threads; i++) {
+        if (queue->processing[i] && (!vs || queue->processing[i] == vs)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static bool vnc_has_job_locked(VncState *vs)
 {
     VncJob *job;
 
+    if (vnc_processing_locked(queue, vs)) {
+        return true;
+    }
     QTAILQ_FOREACH(job, &queue->jobs, next) {
         if (job->vs == vs || !vs) {
             return true;
@@ -201,26 +231,44 @@ static void vnc_async_encoding_end(VncState *orig, VncState *local)
     orig->lossy_rect = local->lossy_rect;
 }
 
-static int vnc_worker_thread_loop(VncJobQueue *queue)
+/*
+ * Pick the oldest job whose client is not already being served by
+ * another worker; jobs are submitted in order, so this keeps each
+ * client's updates sequential.
+ */
+static VncJob *vnc_pop_runnable_job_locked(VncJobQueue *queue, int worker)
 {
     VncJob *job;
+
+    QTAILQ_FOREACH(job, &queue->jobs, next) {
+        if (!vnc_processing_locked(queue, job->vs)) {
+            QTAILQ_REMOVE(&queue->jobs, job, next);
+            queue->processing[worker] = job->vs;
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static int vnc_worker_thread_loop(VncJobQueue *queue, int worker)
+{
+    VncJob *job = NULL;
     VncRectEntry *entry, *tmp;
     VncState vs = {};
     int n_rectangles;
     int saved_offset;
 
     vnc_lock_queue(queue);
-    while (QTAILQ_EMPTY(&queue->jobs) && !queue->exit) {
+    while (!queue->exit &&
+           (job = vnc_pop_runnable_job_locked(queue, worker)) == NULL) {
         qemu_cond_wait(&queue->cond, &queue->mutex);
     }
-    /* Here job can only be NULL if queue->exit is true */
-    job = QTAILQ_FIRST(&queue->jobs);
     vnc_unlock_queue(queue);
-    assert(job->vs->magic == VNC_MAGIC);
 
     if (queue->exit) {
         return -1;
     }
+    assert(job->vs->magic == VNC_MAGIC);
 
     vnc_lock_output(job->vs);
     if (job->vs->ioc == NULL || job->vs->abort == true) {
@@ -248,12 +296,12 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
     saved_offset = vs.output.offset;
     vnc_write_u16(&vs, 0);
 
-    vnc_lock_display(job->vs->vd);
+    vnc_lock_display_shared(job->vs->vd);
     QLIST_FOREACH_SAFE(entry, &job->rectangles, next, tmp) {
         int n;
 
         if (job->vs->ioc == NULL) {
-            vnc_unlock_display(job->vs->vd);
+            vnc_unlock_display_shared(job->vs->vd);
             /* Copy persistent encoding data */
             vnc_async_encoding_end(job->vs, &vs);
             goto disconnected;
@@ -267,7 +315,7 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
         }
         g_free(entry);
     }
-    vnc_unlock_display(job->vs->vd);
+    vnc_unlock_display_shared(job->vs->vd);
 
     /* Put n_rectangles at the beginning of the message */
     vs.output.buffer[saved_offset] = (n_rectangles >> 8) & 0xFF;
@@ -289,7 +337,7 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
 
 disconnected:
     vnc_lock_queue(queue);
-    QTAILQ_REMOVE(&queue->jobs, job, next);
+    queue->processing[worker] = NULL;
     vnc_unlock_queue(queue);
     qemu_cond_broadcast(&queue->cond);
     g_free(job);
@@ -317,12 +365,21 @@ static void vnc_queue_clear(VncJobQueue *q)
 
 static void *vnc_worker_thread(void *arg)
 {
-    VncJobQueue *queue = arg;
+    VncWorker *worker = arg;
+    VncJobQueue *queue = worker->queue;
+    bool last;
+
+    qemu_thread_get_self(&queue->threads[worker->index]);
 
-    qemu_thread_get_self(&queue->thread);
+    while (!vnc_worker_thread_loop(queue, worker->index)) ;
 
-    while (!vnc_worker_thread_loop(queue)) ;
-    vnc_queue_clear(queue);
+    /* Only the last worker to exit may tear the queue down. */
+    vnc_lock_queue(queue);
+    last = --queue->n_running == 0;
+    vnc_unlock_queue(queue);
+    if (last) {
+        vnc_queue_clear(queue);
+    }
     return NULL;
 }
 
@@ -334,12 +391,22 @@ static bool vnc_worker_thread_running(void)
 void vnc_start_worker_thread(void)
 {
     VncJobQueue *q;
+    int i;
 
     if (vnc_worker_thread_running())
         return ;
 
     q = vnc_queue_init();
-    qemu_thread_create(&q->thread, "vnc_worker", vnc_worker_thread, q,
-                       QEMU_THREAD_DETACHED);
+    q->n_threads = MIN(VNC_MAX_WORKER_THREADS, g_get_num_processors());
+    q->n_running = q->n_threads;
+    for (i = 0; i < q->n_threads; i++) {
+        char *name = g_strdup_printf("vnc_worker/%d", i);
+
+        q->workers[i].queue = q;
+        q->workers[i].index = i;
+        qemu_thread_create(&q->threads[i], name, vnc_worker_thread,
+                           &q->workers[i], QEMU_THREAD_DETACHED);
+        g_free(name);
+    }
     queue = q; /* Set global queue */
 }
@@ -42,16 +42,38 @@ void vnc_start_worker_thread(void);
 /* Locks */
 static inline int vnc_trylock_display(VncDisplay *vd)
 {
-    return qemu_mutex_trylock(&vd->mutex);
+    int err = qemu_mutex_trylock(&vd->mutex);
+
+    if (!err && vd->shared_encoders > 0) {
+        /* An encoding thread is reading the server surface. */
+        qemu_mutex_unlock(&vd->mutex);
+        err = -EBUSY;
+    }
+    return err;
 }
 
-static inline void vnc_lock_display(VncDisplay *vd)
+static inline void vnc_unlock_display(VncDisplay *vd)
+{
+    qemu_mutex_unlock(&vd->mutex);
+}
+
+/*
+ * Encoding threads hold the display in shared mode: they only read the
+ * server surface, so they may run concurrently with each other but not
+ * with vnc_refresh_server_surface(), which skips the refresh while any
+ * encoder is active.
+ */
+static inline void vnc_lock_display_shared(VncDisplay *vd)
 {
     qemu_mutex_lock(&vd->mutex);
+    vd->shared_encoders++;
+    qemu_mutex_unlock(&vd->mutex);
 }
 
-static inline void vnc_unlock_display(VncDisplay *vd)
+static inline void vnc_unlock_display_shared(VncDisplay *vd)
 {
+    qemu_mutex_lock(&vd->mutex);
+    vd->shared_encoders--;
     qemu_mutex_unlock(&vd->mutex);
 }
 
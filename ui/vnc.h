@@ -157,6 +157,9 @@ struct VncDisplay
     int ledstate;
     QKbdState *kbd;
     QemuMutex mutex;
+    /* Number of encoding threads reading the server surface, protected
+     * by @mutex; see vnc_lock_display_shared(). */
+    int shared_encoders;
 
     QEMUCursor *cursor;
     int cursor_msize;
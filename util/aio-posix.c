@@ -43,15 +43,11 @@ static AioHandler *find_aio_handler(AioContext *ctx, int fd)
 {
     AioHandler *node;
 
-    QLIST_FOREACH(node, &ctx->aio_handlers, node) {
-        if (node->pfd.fd == fd) {
-            if (!QLIST_IS_INSERTED(node, node_deleted)) {
-                return node;
-            }
-        }
-    }
+    node = g_hash_table_lookup(ctx->aio_handler_by_fd, GINT_TO_POINTER(fd));
 
-    return NULL;
+    /* Deleted handlers are dropped from the hash table right away */
+    assert(!node || !QLIST_IS_INSERTED(node, node_deleted));
+    return node;
 }
 
 static bool aio_remove_fd_handler(AioContext *ctx, AioHandler *node)
@@ -113,6 +109,7 @@ void aio_set_fd_handler(AioContext *ctx,
         /* Clean events in order to unregister fd from the ctx epoll. */
         node->pfd.events = 0;
 
+        g_hash_table_remove(ctx->aio_handler_by_fd, GINT_TO_POINTER(fd));
         poll_disable_change = -!node->io_poll;
     } else {
         poll_disable_change = !io_poll - (node && !node->io_poll);
@@ -140,6 +137,10 @@ void aio_set_fd_handler(AioContext *ctx,
         new_node->pfd.events |= (io_write ? G_IO_OUT | G_IO_ERR : 0);
 
         QLIST_INSERT_HEAD_RCU(&ctx->aio_handlers, new_node, node);
+
+        /* This drops the mapping to the replaced node, if any */
+        g_hash_table_replace(ctx->aio_handler_by_fd, GINT_TO_POINTER(fd),
+                             new_node);
     }
 
     /* No need to order poll_disable_cnt writes against other updates;
@@ -499,6 +500,16 @@ static bool run_poll_handlers(AioContext *ctx, int64_t max_ns, int64_t *timeout)
         assert(!(max_ns && progress));
     } while (elapsed_time < max_ns && !ctx->fdmon_ops->need_wait(ctx));
 
+    /*
+     * The fdmon implementation has ready completions (e.g. cqes in the
+     * io_uring cq ring observed while busy-polling).  Don't block in
+     * ->wait() to reap them; a zero timeout turns it into a cheap
+     * non-blocking flush of the ring.
+     */
+    if (ctx->fdmon_ops->need_wait(ctx)) {
+        *timeout = 0;
+    }
+
     if (remove_idle_poll_handlers(ctx, start_time + elapsed_time)) {
         *timeout = 0;
         progress = true;
@@ -539,8 +550,10 @@ static bool try_poll_mode(AioContext *ctx, int64_t *timeout)
         poll_set_started(ctx, true);
 
         if (run_poll_handlers(ctx, max_ns, timeout)) {
+            ctx->poll_hits++;
             return true;
         }
+        ctx->poll_misses++;
     }
 
     if (poll_set_started(ctx, false)) {
@@ -652,6 +665,7 @@ bool aio_poll(AioContext *ctx, bool blocking)
 
 void aio_context_setup(AioContext *ctx)
 {
+    ctx->aio_handler_by_fd = g_hash_table_new(NULL, NULL);
     ctx->fdmon_ops = &fdmon_poll_ops;
     ctx->epollfd = -1;
 
@@ -667,6 +681,8 @@ void aio_context_destroy(AioContext *ctx)
 {
     fdmon_io_uring_destroy(ctx);
     fdmon_epoll_disable(ctx);
+    g_hash_table_destroy(ctx->aio_handler_by_fd);
+    ctx->aio_handler_by_fd = NULL;
 }
 
 void aio_context_set_poll_params(AioContext *ctx, int64_t max_ns,
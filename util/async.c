@@ -81,7 +81,18 @@ static void aio_bh_enqueue(QEMUBH *bh, unsigned new_flags)
         QSLIST_INSERT_HEAD_ATOMIC(&ctx->bh_list, bh, next);
     }
 
-    aio_notify(ctx);
+    /*
+     * A BH that is pending and scheduled to run (and not merely idle)
+     * already notified the event loop when it was first enqueued, and
+     * aio_bh_dequeue() clears the flags with a full barrier before the
+     * callback runs, so the loop cannot go back to sleep with this BH
+     * outstanding.  Skipping the redundant notification lets a burst of
+     * schedules (e.g. coroutine wakeups) pay for a single wakeup.
+     */
+    if ((old_flags & (BH_PENDING | BH_SCHEDULED | BH_IDLE)) !=
+        (BH_PENDING | BH_SCHEDULED)) {
+        aio_notify(ctx);
+    }
 }
 
 /* Only called from aio_bh_poll() and aio_ctx_finalize() */
@@ -550,6 +561,37 @@ void aio_co_schedule(AioContext *ctx, Coroutine *co)
     aio_context_unref(ctx);
 }
 
+void aio_co_schedule_chain(AioContext *ctx, Coroutine *first, Coroutine *last)
+{
+    Coroutine *co = first;
+
+    for (;;) {
+        const char *scheduled = atomic_cmpxchg(&co->scheduled, NULL,
+                                               __func__);
+
+        trace_aio_co_schedule(ctx, co);
+        if (scheduled) {
+            fprintf(stderr,
+                    "%s: Co-routine was already scheduled in '%s'\n",
+                    __func__, scheduled);
+            abort();
+        }
+        if (co == last) {
+            break;
+        }
+        co = QSLIST_NEXT(co, co_scheduled_next);
+    }
+
+    /* See the ctx lifetime comment in aio_co_schedule().  */
+    aio_context_ref(ctx);
+
+    QSLIST_INSERT_CHAIN_ATOMIC(&ctx->scheduled_coroutines,
+                               first, last, co_scheduled_next);
+    qemu_bh_schedule(ctx->co_schedule_bh);
+
+    aio_context_unref(ctx);
+}
+
 void aio_co_wake(struct Coroutine *co)
 {
     AioContext *ctx;
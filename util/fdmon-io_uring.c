@@ -282,8 +282,16 @@ static int fdmon_io_uring_wait(AioContext *ctx, AioHandlerList *ready_list,
 
     fill_sq_ring(ctx);
 
-    ret = io_uring_submit_and_wait(&ctx->fdmon_io_uring, wait_nr);
-    assert(ret >= 0);
+    /*
+     * The cq ring lives in shared memory, so a non-blocking call with
+     * nothing to submit needs no io_uring_enter(2) at all.  This is the
+     * hot case when the adaptive polling loop in aio-posix.c noticed
+     * ready cqes and handed us a zero timeout to reap them.
+     */
+    if (wait_nr > 0 || io_uring_sq_ready(&ctx->fdmon_io_uring) > 0) {
+        ret = io_uring_submit_and_wait(&ctx->fdmon_io_uring, wait_nr);
+        assert(ret >= 0);
+    }
 
     return process_cq_ring(ctx, ready_list);
 }
@@ -309,6 +309,14 @@ static uint64_t hb_count_between(HBitmap *hb, uint64_t start, uint64_t last)
     unsigned long cur;
     size_t pos;
 
+    /* Trivially empty and full bitmaps don't need the level walk */
+    if (hb->count == 0) {
+        return 0;
+    }
+    if (hb->count == hb->size) {
+        return last - start + 1;
+    }
+
     hbitmap_iter_init(&hbi, hb, start << hb->granularity);
     for (;;) {
         pos = hbitmap_iter_next_word(&hbi, &cur);
@@ -399,6 +407,11 @@ void hbitmap_set(HBitmap *hb, uint64_t start, uint64_t count)
     assert(last < hb->size);
     n = last - first + 1;
 
+    /* Setting bits in a fully set bitmap is a no-op */
+    if (hb->count == hb->size) {
+        return;
+    }
+
     hb->count += n - hb_count_between(hb, first, last);
     if (hb_set_between(hb, HBITMAP_LEVELS - 1, first, last) &&
         hb->meta) {
@@ -496,6 +509,11 @@ void hbitmap_reset(HBitmap *hb, uint64_t start, uint64_t count)
     last >>= hb->granularity;
     assert(last < hb->size);
 
+    /* Resetting bits in an empty bitmap is a no-op */
+    if (hb->count == 0) {
+        return;
+    }
+
     hb->count -= hb_count_between(hb, first, last);
     if (hb_reset_between(hb, HBITMAP_LEVELS - 1, first, last) &&
         hb->meta) {
@@ -22,22 +22,36 @@
 #include "qemu/sockets.h"
 #include "qemu/cutils.h"
 
+/* Skip the elements that `offset' points past, so that the copy loops
+ * below need not re-test the offset on every element.  Returns the index
+ * of the first element that offset points into, with *offset updated to
+ * be relative to that element.
+ */
+static unsigned int iov_skip_offset(const struct iovec *iov,
+                                    unsigned int iov_cnt, size_t *offset)
+{
+    unsigned int i;
+
+    for (i = 0; i < iov_cnt && *offset >= iov[i].iov_len; i++) {
+        *offset -= iov[i].iov_len;
+    }
+    assert(i < iov_cnt || *offset == 0);
+    return i;
+}
+
 size_t iov_from_buf_full(const struct iovec *iov, unsigned int iov_cnt,
                          size_t offset, const void *buf, size_t bytes)
 {
     size_t done;
     unsigned int i;
-    for (i = 0, done = 0; (offset || done < bytes) && i < iov_cnt; i++) {
-        if (offset < iov[i].iov_len) {
-            size_t len = MIN(iov[i].iov_len - offset, bytes - done);
-            memcpy(iov[i].iov_base + offset, buf + done, len);
-            done += len;
-            offset = 0;
-        } else {
-            offset -= iov[i].iov_len;
-        }
+
+    i = iov_skip_offset(iov, iov_cnt, &offset);
+    for (done = 0; done < bytes && i < iov_cnt; i++) {
+        size_t len = MIN(iov[i].iov_len - offset, bytes - done);
+        memcpy(iov[i].iov_base + offset, buf + done, len);
+        done += len;
+        offset = 0;
     }
-    assert(offset == 0);
     return done;
 }
 
@@ -46,17 +60,14 @@ size_t iov_to_buf_full(const struct iovec *iov, const unsigned int iov_cnt,
 {
     size_t done;
     unsigned int i;
-    for (i = 0, done = 0; (offset || done < bytes) && i < iov_cnt; i++) {
-        if (offset < iov[i].iov_len) {
-            size_t len = MIN(iov[i].iov_len - offset, bytes - done);
-            memcpy(buf + done, iov[i].iov_base + offset, len);
-            done += len;
-            offset = 0;
-        } else {
-            offset -= iov[i].iov_len;
-        }
+
+    i = iov_skip_offset(iov, iov_cnt, &offset);
+    for (done = 0; done < bytes && i < iov_cnt; i++) {
+        size_t len = MIN(iov[i].iov_len - offset, bytes - done);
+        memcpy(buf + done, iov[i].iov_base + offset, len);
+        done += len;
+        offset = 0;
     }
-    assert(offset == 0);
     return done;
 }
 
@@ -65,17 +76,14 @@ size_t iov_memset(const struct iovec *iov, const unsigned int iov_cnt,
 {
     size_t done;
     unsigned int i;
-    for (i = 0, done = 0; (offset || done < bytes) && i < iov_cnt; i++) {
-        if (offset < iov[i].iov_len) {
-            size_t len = MIN(iov[i].iov_len - offset, bytes - done);
-            memset(iov[i].iov_base + offset, fillc, len);
-            done += len;
-            offset = 0;
-        } else {
-            offset -= iov[i].iov_len;
-        }
+
+    i = iov_skip_offset(iov, iov_cnt, &offset);
+    for (done = 0; done < bytes && i < iov_cnt; i++) {
+        size_t len = MIN(iov[i].iov_len - offset, bytes - done);
+        memset(iov[i].iov_base + offset, fillc, len);
+        done += len;
+        offset = 0;
     }
-    assert(offset == 0);
     return done;
 }
 
@@ -38,6 +38,10 @@
 #include <sys/wait.h>
 #endif
 
+#ifdef CONFIG_EPOLL_CREATE1
+#include <sys/epoll.h>
+#endif
+
 #ifndef _WIN32
 
 /* If we have signalfd, we mask out the signals we want to handle and then
@@ -220,21 +224,228 @@ static void glib_pollfds_poll(void)
     }
 }
 
-#define MAX_MAIN_LOOP_SPIN (1000)
+#ifdef CONFIG_EPOLL_CREATE1
+
+/* The glib descriptor set is rebuilt from scratch on every iteration,
+ * but the descriptors themselves rarely change between one iteration
+ * and the next.  Above this many descriptors, mirror the set into a
+ * persistent epoll instance so that waiting is a single-fd ppoll on
+ * the epoll descriptor plus an O(ready) epoll_wait, instead of an
+ * O(n) kernel scan of every descriptor.  The threshold matches
+ * EPOLL_ENABLE_THRESHOLD in fdmon-epoll.c; below it plain ppoll is
+ * just as fast.
+ */
+#define MAIN_LOOP_EPOLL_ENABLE_THRESHOLD 64
+
+typedef struct MainLoopEpollFd {
+    int events;         /* last event mask handed to epoll_ctl, or -1 if
+                         * the fd was never registered; only picks ADD
+                         * vs MOD, registration is never assumed current
+                         */
+    unsigned gen;       /* generation this fd was last seen in */
+    unsigned idx;       /* index into gpollfds for generation gen */
+} MainLoopEpollFd;
+
+static int main_loop_epollfd = -1;
+static GHashTable *main_loop_epoll_fds;     /* fd -> MainLoopEpollFd */
+static unsigned main_loop_epoll_gen;
+static bool main_loop_epoll_broken;
+
+static int main_loop_epoll_events(int pfd_events)
+{
+    return (pfd_events & G_IO_IN ? EPOLLIN : 0) |
+           (pfd_events & G_IO_OUT ? EPOLLOUT : 0) |
+           (pfd_events & G_IO_PRI ? EPOLLPRI : 0) |
+           (pfd_events & G_IO_HUP ? EPOLLHUP : 0) |
+           (pfd_events & G_IO_ERR ? EPOLLERR : 0);
+}
+
+static int main_loop_epoll_revents(int ev)
+{
+    return (ev & EPOLLIN ? G_IO_IN : 0) |
+           (ev & EPOLLOUT ? G_IO_OUT : 0) |
+           (ev & EPOLLPRI ? G_IO_PRI : 0) |
+           (ev & EPOLLHUP ? G_IO_HUP : 0) |
+           (ev & EPOLLERR ? G_IO_ERR : 0);
+}
+
+static void main_loop_epoll_disable(void)
+{
+    main_loop_epoll_broken = true;
+    if (main_loop_epollfd >= 0) {
+        close(main_loop_epollfd);
+        main_loop_epollfd = -1;
+    }
+    g_clear_pointer(&main_loop_epoll_fds, g_hash_table_destroy);
+}
+
+static int main_loop_epoll_register(GPollFD *pfd, MainLoopEpollFd *e, int op)
+{
+    struct epoll_event ev;
+
+    ev.events = main_loop_epoll_events(pfd->events);
+    ev.data.fd = pfd->fd;
+    if (epoll_ctl(main_loop_epollfd, op, pfd->fd, &ev) < 0) {
+        /* The fd number may have been closed and reused behind our
+         * back, in which case the kernel dropped the registration.
+         */
+        op = op == EPOLL_CTL_MOD ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        if (epoll_ctl(main_loop_epollfd, op, pfd->fd, &ev) < 0) {
+            return -errno;
+        }
+    }
+    e->events = pfd->events;
+    return 0;
+}
+
+/* Bring the epoll set in sync with gpollfds.  Returns false if epoll
+ * cannot be used for this iteration and the caller must fall back to
+ * qemu_poll_ns.
+ */
+static bool main_loop_epoll_prepare(void)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    guint i;
+
+    if (main_loop_epoll_broken ||
+        gpollfds->len < MAIN_LOOP_EPOLL_ENABLE_THRESHOLD) {
+        return false;
+    }
+    if (main_loop_epollfd == -1) {
+        main_loop_epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if (main_loop_epollfd == -1) {
+            main_loop_epoll_broken = true;
+            return false;
+        }
+        main_loop_epoll_fds = g_hash_table_new_full(g_direct_hash,
+                                                    g_direct_equal,
+                                                    NULL, g_free);
+    }
+
+    main_loop_epoll_gen++;
+    for (i = 0; i < gpollfds->len; i++) {
+        GPollFD *pfd = &g_array_index(gpollfds, GPollFD, i);
+        MainLoopEpollFd *e;
+
+        pfd->revents = 0;
+        e = g_hash_table_lookup(main_loop_epoll_fds,
+                                GINT_TO_POINTER(pfd->fd));
+        if (e && e->gen == main_loop_epoll_gen) {
+            /* epoll registers each fd only once; if two sources poll
+             * the same fd, leave this iteration to ppoll.  The epoll
+             * set stays consistent and is reconciled next time.
+             */
+            return false;
+        }
+        if (!e) {
+            e = g_new(MainLoopEpollFd, 1);
+            e->events = -1;
+            g_hash_table_insert(main_loop_epoll_fds,
+                                GINT_TO_POINTER(pfd->fd), e);
+        }
+        e->gen = main_loop_epoll_gen;
+        e->idx = i;
+        /* An epoll registration dies with the file description, so a
+         * matching cached event mask proves nothing: the fd may have
+         * been closed and the number reused since the last iteration
+         * without us noticing.  Re-issue epoll_ctl unconditionally
+         * (MOD, falling back to ADD if the kernel has dropped the
+         * registration) instead of trusting the cache.
+         */
+        if (main_loop_epoll_register(pfd, e,
+                                     e->events == -1 ? EPOLL_CTL_ADD
+                                                     : EPOLL_CTL_MOD) < 0) {
+            /* e.g. EPERM for regular files, which poll accepts */
+            main_loop_epoll_disable();
+            return false;
+        }
+    }
+
+    /* Deregister fds that have gone away.  Closed fds left the epoll
+     * set on their own; ignore errors.
+     */
+    g_hash_table_iter_init(&iter, main_loop_epoll_fds);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        MainLoopEpollFd *e = value;
+
+        if (e->gen != main_loop_epoll_gen) {
+            epoll_ctl(main_loop_epollfd, EPOLL_CTL_DEL,
+                      GPOINTER_TO_INT(key), NULL);
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+    return true;
+}
+
+static int main_loop_epoll_wait(int64_t timeout)
+{
+    GPollFD pfd = {
+        .fd = main_loop_epollfd,
+        .events = G_IO_IN | G_IO_OUT | G_IO_HUP | G_IO_ERR,
+    };
+    struct epoll_event events[128];
+    int i, nev, ret = 0;
+
+    if (timeout > 0) {
+        ret = qemu_poll_ns(&pfd, 1, timeout);
+        if (ret <= 0) {
+            return ret;
+        }
+        timeout = 0;
+    }
+
+    /* timeout is now 0 or -1, both valid epoll_wait timeouts */
+    nev = epoll_wait(main_loop_epollfd, events, ARRAY_SIZE(events),
+                     (int)timeout);
+    for (i = 0; i < nev; i++) {
+        MainLoopEpollFd *e;
+        GPollFD *gpfd;
+
+        e = g_hash_table_lookup(main_loop_epoll_fds,
+                                GINT_TO_POINTER(events[i].data.fd));
+        if (!e || e->gen != main_loop_epoll_gen) {
+            continue;
+        }
+        gpfd = &g_array_index(gpollfds, GPollFD, e->idx);
+        gpfd->revents = main_loop_epoll_revents(events[i].events);
+    }
+    return nev;
+}
+
+#else
+
+static bool main_loop_epoll_prepare(void)
+{
+    return false;
+}
+
+static int main_loop_epoll_wait(int64_t timeout)
+{
+    abort();
+}
+
+#endif /* CONFIG_EPOLL_CREATE1 */
 
 static int os_host_main_loop_wait(int64_t timeout)
 {
     GMainContext *context = g_main_context_default();
+    bool use_epoll;
     int ret;
 
     g_main_context_acquire(context);
 
     glib_pollfds_fill(&timeout);
+    use_epoll = main_loop_epoll_prepare();
 
     qemu_mutex_unlock_iothread();
     replay_mutex_unlock();
 
-    ret = qemu_poll_ns((GPollFD *)gpollfds->data, gpollfds->len, timeout);
+    if (use_epoll) {
+        ret = main_loop_epoll_wait(timeout);
+    } else {
+        ret = qemu_poll_ns((GPollFD *)gpollfds->data, gpollfds->len, timeout);
+    }
 
     replay_mutex_lock();
     qemu_mutex_lock_iothread();
@@ -504,6 +504,10 @@ void os_mem_prealloc(int fd, char *area, size_t memory, int smp_cpus,
     struct sigaction act, oldact;
     size_t hpagesize = qemu_fd_getpagesize(fd);
     size_t numpages = DIV_ROUND_UP(memory, hpagesize);
+    int64_t start_us = g_get_monotonic_time();
+
+    trace_os_mem_prealloc_begin(hpagesize, numpages,
+                                get_memset_num_threads(smp_cpus));
 
     memset(&act, 0, sizeof(act));
     act.sa_handler = &sigbus_handler;
@@ -519,7 +523,11 @@ void os_mem_prealloc(int fd, char *area, size_t memory, int smp_cpus,
     /* touch pages simultaneously */
     if (touch_all_pages(area, hpagesize, numpages, smp_cpus)) {
         error_setg(errp, "os_mem_prealloc: Insufficient free host memory "
-            "pages available to allocate guest RAM");
+            "pages available to allocate guest RAM (%zu pages of size %zu)",
+            numpages, hpagesize);
+    } else {
+        trace_os_mem_prealloc_done(hpagesize, numpages,
+                                   g_get_monotonic_time() - start_us);
     }
 
     ret = sigaction(SIGBUS, &oldact, NULL);
@@ -38,39 +38,44 @@ static inline int qdist_cmp_double(double a, double b)
     return 0;
 }
 
-static int qdist_cmp(const void *ap, const void *bp)
-{
-    const struct qdist_entry *a = ap;
-    const struct qdist_entry *b = bp;
-
-    return qdist_cmp_double(a->x, b->x);
-}
-
 void qdist_add(struct qdist *dist, double x, long count)
 {
-    struct qdist_entry *entry = NULL;
-
-    if (dist->n) {
-        struct qdist_entry e;
-
-        e.x = x;
-        entry = bsearch(&e, dist->entries, dist->n, sizeof(e), qdist_cmp);
-    }
-
-    if (entry) {
-        entry->count += count;
-        return;
+    struct qdist_entry *entry;
+    size_t lo, hi;
+
+    /*
+     * Binary search for @x. If it is not there, @lo ends up at the
+     * insertion point that keeps the entries sorted, so that we can
+     * insert with a single memmove instead of re-sorting the whole
+     * array. Appends (the common case when building histograms in
+     * ascending order, e.g. qdist_bin__internal()) then move no data.
+     */
+    lo = 0;
+    hi = dist->n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = qdist_cmp_double(x, dist->entries[mid].x);
+
+        if (cmp == 0) {
+            dist->entries[mid].count += count;
+            return;
+        } else if (cmp > 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
 
     if (unlikely(dist->n == dist->size)) {
         dist->size *= 2;
         dist->entries = g_renew(struct qdist_entry, dist->entries, dist->size);
     }
+    memmove(&dist->entries[lo + 1], &dist->entries[lo],
+            (dist->n - lo) * sizeof(*dist->entries));
     dist->n++;
-    entry = &dist->entries[dist->n - 1];
+    entry = &dist->entries[lo];
     entry->x = x;
     entry->count = count;
-    qsort(dist->entries, dist->n, sizeof(*entry), qdist_cmp);
 }
 
 void qdist_inc(struct qdist *dist, double x)
@@ -69,6 +69,10 @@ void coroutine_fn qemu_co_queue_wait_impl(CoQueue *queue, QemuLockable *lock)
 
 static bool qemu_co_queue_do_restart(CoQueue *queue, bool single)
 {
+    AioContext *cur = qemu_get_current_aio_context();
+    QSLIST_HEAD(, Coroutine) chain = QSLIST_HEAD_INITIALIZER(chain);
+    AioContext *chain_ctx = NULL;
+    Coroutine *chain_last = NULL;
     Coroutine *next;
 
     if (QSIMPLEQ_EMPTY(&queue->entries)) {
@@ -76,11 +80,47 @@ static bool qemu_co_queue_do_restart(CoQueue *queue, bool single)
     }
 
     while ((next = QSIMPLEQ_FIRST(&queue->entries)) != NULL) {
+        AioContext *ctx;
+
         QSIMPLEQ_REMOVE_HEAD(&queue->entries, co_queue_next);
-        aio_co_wake(next);
         if (single) {
+            aio_co_wake(next);
             break;
         }
+
+        /* Read next before next->ctx; matches the smp_wmb() in
+         * qemu_aio_coroutine_enter().
+         */
+        smp_read_barrier_depends();
+        ctx = atomic_read(&next->ctx);
+        if (ctx == cur) {
+            /* Queued on the current coroutine's wakeup list, no atomics. */
+            aio_co_enter(ctx, next);
+            continue;
+        }
+
+        /*
+         * Remote wakeups are collected into per-context chains and
+         * handed to aio_co_schedule_chain() in one go, so that a herd
+         * of waiters costs a single list splice and event-loop
+         * notification rather than one per coroutine.  Head insertion
+         * reverses the order, which aio_co_schedule_chain() undoes.
+         */
+        if (chain_last && ctx != chain_ctx) {
+            aio_co_schedule_chain(chain_ctx, QSLIST_FIRST(&chain),
+                                  chain_last);
+            QSLIST_INIT(&chain);
+            chain_last = NULL;
+        }
+        if (!chain_last) {
+            chain_ctx = ctx;
+            chain_last = next;
+        }
+        QSLIST_INSERT_HEAD(&chain, next, co_scheduled_next);
+    }
+
+    if (chain_last) {
+        aio_co_schedule_chain(chain_ctx, QSLIST_FIRST(&chain), chain_last);
     }
     return true;
 }
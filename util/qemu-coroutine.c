@@ -42,6 +42,14 @@ static void coroutine_pool_cleanup(Notifier *n, void *value)
     }
 }
 
+static void coroutine_pool_cleanup_register(void)
+{
+    if (!coroutine_pool_cleanup_notifier.notify) {
+        coroutine_pool_cleanup_notifier.notify = coroutine_pool_cleanup;
+        qemu_thread_atexit_add(&coroutine_pool_cleanup_notifier);
+    }
+}
+
 Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque)
 {
     Coroutine *co = NULL;
@@ -51,10 +59,7 @@ Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque)
         if (!co) {
             if (release_pool_size > POOL_BATCH_SIZE) {
                 /* Slow path; a good place to register the destructor, too.  */
-                if (!coroutine_pool_cleanup_notifier.notify) {
-                    coroutine_pool_cleanup_notifier.notify = coroutine_pool_cleanup;
-                    qemu_thread_atexit_add(&coroutine_pool_cleanup_notifier);
-                }
+                coroutine_pool_cleanup_register();
 
                 /* This is not exact; there could be a little skew between
                  * release_pool_size and the actual size of release_pool.  But
@@ -81,17 +86,59 @@ Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque)
     return co;
 }
 
+void qemu_coroutine_pool_prealloc(unsigned int count)
+{
+    if (!CONFIG_COROUTINE_POOL) {
+        return;
+    }
+
+    coroutine_pool_cleanup_register();
+
+    while (count-- && alloc_pool_size < POOL_BATCH_SIZE * 2) {
+        Coroutine *co = qemu_coroutine_new();
+
+        QSLIST_INSERT_HEAD(&alloc_pool, co, pool_next);
+        alloc_pool_size++;
+    }
+}
+
 static void coroutine_delete(Coroutine *co)
 {
     co->caller = NULL;
 
     if (CONFIG_COROUTINE_POOL) {
-        if (release_pool_size < POOL_BATCH_SIZE * 2) {
-            QSLIST_INSERT_HEAD_ATOMIC(&release_pool, co, pool_next);
-            atomic_inc(&release_pool_size);
+        coroutine_pool_cleanup_register();
+
+        if (alloc_pool_size < POOL_BATCH_SIZE * 2) {
+            QSLIST_INSERT_HEAD(&alloc_pool, co, pool_next);
+            alloc_pool_size++;
             return;
         }
-        if (alloc_pool_size < POOL_BATCH_SIZE) {
+        if (release_pool_size < POOL_BATCH_SIZE * 2) {
+            QSLIST_HEAD(, Coroutine) batch = QSLIST_HEAD_INITIALIZER(batch);
+            Coroutine *last = NULL;
+            unsigned int i;
+
+            /*
+             * The thread-local pool is full.  Hand one batch back to the
+             * global pool with a single list splice instead of paying for
+             * one atomic operation per freed coroutine, which becomes a
+             * contended cache line when many threads release at once.
+             */
+            for (i = 0; i < POOL_BATCH_SIZE; i++) {
+                Coroutine *tmp = QSLIST_FIRST(&alloc_pool);
+
+                QSLIST_REMOVE_HEAD(&alloc_pool, pool_next);
+                QSLIST_INSERT_HEAD(&batch, tmp, pool_next);
+                if (!last) {
+                    last = tmp;
+                }
+            }
+            alloc_pool_size -= POOL_BATCH_SIZE;
+            QSLIST_INSERT_CHAIN_ATOMIC(&release_pool, QSLIST_FIRST(&batch),
+                                       last, pool_next);
+            atomic_add(&release_pool_size, POOL_BATCH_SIZE);
+
             QSLIST_INSERT_HEAD(&alloc_pool, co, pool_next);
             alloc_pool_size++;
             return;
@@ -61,6 +61,14 @@ static QEMUClock qemu_clocks[QEMU_CLOCK_MAX];
  * reenabling the clock can call all the notifiers.
  */
 
+/* Timers expiring at least this far in the future are kept on an
+ * unsorted "far" list and only merged into the sorted active list once
+ * the horizon catches up with them.  Appending to the far list is O(1)
+ * while insertion into the sorted list is O(n), which matters when a
+ * guest arms tens of thousands of mostly long-term timers.
+ */
+#define TIMERLIST_FAR_HORIZON_NS (10 * SCALE_MS)
+
 struct QEMUTimerList {
     QEMUClock *clock;
     QemuMutex active_timers_lock;
@@ -69,6 +77,18 @@ struct QEMUTimerList {
     QEMUTimerListNotifyCB *notify_cb;
     void *notify_opaque;
 
+    /* Unsorted timers expiring at or after far_horizon, appended in
+     * modification order via far_tail_link.  far_deadline is a lower
+     * bound on their expiry; it can become stale (too small) after a
+     * deletion, which at worst causes a harmless early wakeup.  All
+     * of these are protected by active_timers_lock, like
+     * active_timers.
+     */
+    QEMUTimer *far_timers;
+    QEMUTimer **far_tail_link;
+    int64_t far_horizon;
+    int64_t far_deadline;
+
     /* lightweight method to mark the end of timerlist's running */
     QemuEvent timers_done_ev;
 };
@@ -101,6 +121,8 @@ QEMUTimerList *timerlist_new(QEMUClockType type,
     timer_list = g_malloc0(sizeof(QEMUTimerList));
     qemu_event_init(&timer_list->timers_done_ev, true);
     timer_list->clock = clock;
+    timer_list->far_tail_link = &timer_list->far_timers;
+    timer_list->far_deadline = INT64_MAX;
     timer_list->notify_cb = cb;
     timer_list->notify_opaque = opaque;
     qemu_mutex_init(&timer_list->active_timers_lock);
@@ -169,7 +191,8 @@ void qemu_clock_enable(QEMUClockType type, bool enabled)
 
 bool timerlist_has_timers(QEMUTimerList *timer_list)
 {
-    return !!atomic_read(&timer_list->active_timers);
+    return atomic_read(&timer_list->active_timers) ||
+           atomic_read(&timer_list->far_timers);
 }
 
 bool qemu_clock_has_timers(QEMUClockType type)
@@ -178,22 +201,37 @@ bool qemu_clock_has_timers(QEMUClockType type)
         main_loop_tlg.tl[type]);
 }
 
+/* Earliest expiry across the sorted and far lists, or -1 if no timer
+ * is pending.  Called with active_timers_lock held.
+ */
+static int64_t timerlist_deadline_locked(QEMUTimerList *timer_list)
+{
+    int64_t expire_time = INT64_MAX;
+
+    if (timer_list->active_timers) {
+        expire_time = timer_list->active_timers->expire_time;
+    }
+    if (timer_list->far_timers) {
+        expire_time = MIN(expire_time, timer_list->far_deadline);
+    }
+    return expire_time == INT64_MAX ? -1 : expire_time;
+}
+
 bool timerlist_expired(QEMUTimerList *timer_list)
 {
     int64_t expire_time;
 
-    if (!atomic_read(&timer_list->active_timers)) {
+    if (!timerlist_has_timers(timer_list)) {
         return false;
     }
 
     qemu_mutex_lock(&timer_list->active_timers_lock);
-    if (!timer_list->active_timers) {
-        qemu_mutex_unlock(&timer_list->active_timers_lock);
-        return false;
-    }
-    expire_time = timer_list->active_timers->expire_time;
+    expire_time = timerlist_deadline_locked(timer_list);
     qemu_mutex_unlock(&timer_list->active_timers_lock);
 
+    if (expire_time == -1) {
+        return false;
+    }
     return expire_time <= qemu_clock_get_ns(timer_list->clock->type);
 }
 
@@ -213,7 +251,7 @@ int64_t timerlist_deadline_ns(QEMUTimerList *timer_list)
     int64_t delta;
     int64_t expire_time;
 
-    if (!atomic_read(&timer_list->active_timers)) {
+    if (!timerlist_has_timers(timer_list)) {
         return -1;
     }
 
@@ -226,12 +264,12 @@ int64_t timerlist_deadline_ns(QEMUTimerList *timer_list)
      * the caller should notice the change and there is no race condition.
      */
     qemu_mutex_lock(&timer_list->active_timers_lock);
-    if (!timer_list->active_timers) {
-        qemu_mutex_unlock(&timer_list->active_timers_lock);
+    expire_time = timerlist_deadline_locked(timer_list);
+    qemu_mutex_unlock(&timer_list->active_timers_lock);
+
+    if (expire_time == -1) {
         return -1;
     }
-    expire_time = timer_list->active_timers->expire_time;
-    qemu_mutex_unlock(&timer_list->active_timers_lock);
 
     delta = expire_time - qemu_clock_get_ns(timer_list->clock->type);
 
@@ -252,6 +290,7 @@ int64_t qemu_clock_deadline_ns_all(QEMUClockType type, int attr_mask)
     int64_t deadline = -1;
     int64_t delta;
     int64_t expire_time;
+    int64_t now = -1;
     QEMUTimer *ts;
     QEMUTimerList *timer_list;
     QEMUClock *clock = qemu_clock_ptr(type);
@@ -267,14 +306,27 @@ int64_t qemu_clock_deadline_ns_all(QEMUClockType type, int attr_mask)
         while (ts && (ts->attributes & ~attr_mask)) {
             ts = ts->next;
         }
-        if (!ts) {
-            qemu_mutex_unlock(&timer_list->active_timers_lock);
-            continue;
+        expire_time = ts ? ts->expire_time : INT64_MAX;
+        /* The far list is unsorted, so look at every entry */
+        for (ts = timer_list->far_timers; ts; ts = ts->next) {
+            if (!(ts->attributes & ~attr_mask)) {
+                expire_time = MIN(expire_time, ts->expire_time);
+            }
         }
-        expire_time = ts->expire_time;
         qemu_mutex_unlock(&timer_list->active_timers_lock);
+        if (expire_time == INT64_MAX) {
+            continue;
+        }
 
-        delta = expire_time - qemu_clock_get_ns(type);
+        /*
+         * Read the clock once and use it for every list.  This matters
+         * with icount, where reading QEMU_CLOCK_VIRTUAL takes a seqlock
+         * and folds the executed instructions into the global counter.
+         */
+        if (now == -1) {
+            now = qemu_clock_get_ns(type);
+        }
+        delta = expire_time - now;
         if (delta <= 0) {
             delta = 0;
         }
@@ -387,6 +439,25 @@ static void timer_del_locked(QEMUTimerList *timer_list, QEMUTimer *ts)
             break;
         if (t == ts) {
             atomic_set(pt, t->next);
+            return;
+        }
+        pt = &t->next;
+    }
+
+    /* Not on the sorted list; it may be on the far list.  far_deadline
+     * is left alone: a stale value only wakes us up early.
+     */
+    pt = &timer_list->far_timers;
+    for (;;) {
+        t = *pt;
+        if (!t) {
+            break;
+        }
+        if (t == ts) {
+            atomic_set(pt, t->next);
+            if (timer_list->far_tail_link == &ts->next) {
+                timer_list->far_tail_link = pt;
+            }
             break;
         }
         pt = &t->next;
@@ -398,22 +469,66 @@ static bool timer_mod_ns_locked(QEMUTimerList *timer_list,
 {
     QEMUTimer **pt, *t;
 
+    ts->expire_time = MAX(expire_time, 0);
+
+    /* Far timers are simply appended; they are merged into the sorted
+     * list once the horizon catches up with them (see
+     * timerlist_fold_far_timers).
+     */
+    if (ts->expire_time >= timer_list->far_horizon) {
+        bool rearm = !timer_list->active_timers &&
+                     ts->expire_time < timer_list->far_deadline;
+
+        timer_list->far_deadline = MIN(timer_list->far_deadline,
+                                       ts->expire_time);
+        ts->next = NULL;
+        atomic_set(timer_list->far_tail_link, ts);
+        timer_list->far_tail_link = &ts->next;
+        return rearm;
+    }
+
     /* add the timer in the sorted list */
     pt = &timer_list->active_timers;
     for (;;) {
         t = *pt;
-        if (!timer_expired_ns(t, expire_time)) {
+        if (!timer_expired_ns(t, ts->expire_time)) {
             break;
         }
         pt = &t->next;
     }
-    ts->expire_time = MAX(expire_time, 0);
     ts->next = *pt;
     atomic_set(pt, ts);
 
     return pt == &timer_list->active_timers;
 }
 
+/* Merge far timers that the horizon has caught up with into the sorted
+ * list and move the horizon forward.  Reinserting preserves the
+ * relative order of timers with equal expiry.  Called with
+ * active_timers_lock held.
+ */
+static void timerlist_fold_far_timers(QEMUTimerList *timer_list,
+                                      int64_t current_time)
+{
+    QEMUTimer *ts, *next;
+
+    if (current_time < timer_list->far_horizon) {
+        return;
+    }
+    timer_list->far_horizon = current_time + TIMERLIST_FAR_HORIZON_NS;
+
+    ts = timer_list->far_timers;
+    atomic_set(&timer_list->far_timers, NULL);
+    timer_list->far_tail_link = &timer_list->far_timers;
+    timer_list->far_deadline = INT64_MAX;
+
+    while (ts) {
+        next = ts->next;
+        timer_mod_ns_locked(timer_list, ts, ts->expire_time);
+        ts = next;
+    }
+}
+
 static void timerlist_rearm(QEMUTimerList *timer_list)
 {
     /* Interrupt execution to force deadline recalculation.  */
@@ -505,7 +620,7 @@ bool timerlist_run_timers(QEMUTimerList *timer_list)
     void *opaque;
     bool need_replay_checkpoint = false;
 
-    if (!atomic_read(&timer_list->active_timers)) {
+    if (!timerlist_has_timers(timer_list)) {
         return false;
     }
 
@@ -554,6 +669,7 @@ bool timerlist_run_timers(QEMUTimerList *timer_list)
      */
     current_time = qemu_clock_get_ns(timer_list->clock->type);
     qemu_mutex_lock(&timer_list->active_timers_lock);
+    timerlist_fold_far_timers(timer_list, current_time);
     while ((ts = timer_list->active_timers)) {
         if (!timer_expired_ns(ts, current_time)) {
             /* No expired timers left.  The checkpoint can be skipped
@@ -31,6 +31,11 @@
  * chaining items has two advantages:
  * - Failed lookups fail fast, and touch a minimum number of cache lines.
  * - Resizing the hash table with concurrent lookups is easy.
+ * On 64-bit hosts the four hash values fit in a single 16-byte vector,
+ * so when the compiler supports them lookups compare a bucket's full
+ * hash array against the sought hash in one vector operation.  Storing
+ * the full hashes rather than smaller per-entry tags means a match
+ * cannot be a hash false positive.
  *
  * There are two types of buckets:
  * 1. "head" buckets are the ones allocated in the array of buckets in qht_map.
@@ -69,6 +74,7 @@
 #include "qemu/qht.h"
 #include "qemu/atomic.h"
 #include "qemu/rcu.h"
+#include "qemu/host-utils.h"
 
 //#define QHT_DEBUG
 
@@ -141,15 +147,54 @@ static inline void qht_unlock(struct qht *ht)
  * be grabbed first.
  */
 struct qht_bucket {
+    /* @hashes is first so that it is 16-byte aligned for vector probing */
+    uint32_t hashes[QHT_BUCKET_ENTRIES];
     QemuSpin lock;
     QemuSeqLock sequence;
-    uint32_t hashes[QHT_BUCKET_ENTRIES];
     void *pointers[QHT_BUCKET_ENTRIES];
     struct qht_bucket *next;
 } QEMU_ALIGNED(QHT_BUCKET_ALIGN);
 
 QEMU_BUILD_BUG_ON(sizeof(struct qht_bucket) > QHT_BUCKET_ALIGN);
 
+/*
+ * Compare all of a bucket's hashes against @hash in one go, returning a
+ * bitmask with bit i set if hashes[i] matches.
+ *
+ * The vector variant reads the hash array non-atomically.  This is safe
+ * because lookups run under the head bucket's seqlock: a concurrent
+ * write forces a retry, and a stale or torn value can only yield a
+ * false match, which the pointer check and cmp function reject.
+ */
+#if defined(CONFIG_VECTOR16) && QHT_BUCKET_ENTRIES == 4
+
+QEMU_BUILD_BUG_ON(offsetof(struct qht_bucket, hashes) & 0xf);
+
+typedef uint32_t qht_vec32 __attribute__((vector_size(16)));
+typedef int32_t qht_svec32 __attribute__((vector_size(16)));
+
+static inline unsigned int qht_bucket_match(const struct qht_bucket *b,
+                                            uint32_t hash)
+{
+    const qht_vec32 vhash = { hash, hash, hash, hash };
+    qht_svec32 eq = *(const qht_vec32 *)b->hashes == vhash;
+
+    return (eq[0] & 1) | (eq[1] & 2) | (eq[2] & 4) | (eq[3] & 8);
+}
+#else
+static inline unsigned int qht_bucket_match(const struct qht_bucket *b,
+                                            uint32_t hash)
+{
+    unsigned int matches = 0;
+    int i;
+
+    for (i = 0; i < QHT_BUCKET_ENTRIES; i++) {
+        matches |= (atomic_read(&b->hashes[i]) == hash) << i;
+    }
+    return matches;
+}
+#endif /* CONFIG_VECTOR16 && QHT_BUCKET_ENTRIES == 4 */
+
 /**
  * struct qht_map - structure to track an array of buckets
  * @rcu: used by RCU. Keep it as the top field in the struct to help valgrind
@@ -487,21 +532,22 @@ void *qht_do_lookup(const struct qht_bucket *head, qht_lookup_func_t func,
                     const void *userp, uint32_t hash)
 {
     const struct qht_bucket *b = head;
-    int i;
 
     do {
-        for (i = 0; i < QHT_BUCKET_ENTRIES; i++) {
-            if (atomic_read(&b->hashes[i]) == hash) {
-                /* The pointer is dereferenced before seqlock_read_retry,
-                 * so (unlike qht_insert__locked) we need to use
-                 * atomic_rcu_read here.
-                 */
-                void *p = atomic_rcu_read(&b->pointers[i]);
-
-                if (likely(p) && likely(func(p, userp))) {
-                    return p;
-                }
+        unsigned int matches = qht_bucket_match(b, hash);
+
+        while (matches) {
+            int i = ctz32(matches);
+            /* The pointer is dereferenced before seqlock_read_retry,
+             * so (unlike qht_insert__locked) we need to use
+             * atomic_rcu_read here.
+             */
+            void *p = atomic_rcu_read(&b->pointers[i]);
+
+            if (likely(p) && likely(func(p, userp))) {
+                return p;
             }
+            matches &= matches - 1;
         }
         b = atomic_rcu_read(&b->next);
     } while (b);
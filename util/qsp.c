@@ -117,6 +117,17 @@ static struct qht qsp_ht;
 static QSPSnapshot *qsp_snapshot;
 static bool qsp_initialized, qsp_initializing;
 
+/*
+ * Sample period: profile one out of every @qsp_sample_period acquisitions
+ * per thread. With the default of 1, every acquisition is profiled; larger
+ * periods make always-on profiling cheap enough for production, since
+ * skipped acquisitions avoid both clock reads and the hash table lookup.
+ * Sampled measurements are scaled by the period when recorded, so reports
+ * remain in absolute terms regardless of the sampling rate.
+ */
+static unsigned int qsp_sample_period = 1;
+static __thread unsigned int qsp_sample_skipped;
+
 static const char * const qsp_typenames[] = {
     [QSP_MUTEX]     = "mutex",
     [QSP_BQL_MUTEX] = "BQL mutex",
@@ -344,46 +355,73 @@ static QSPEntry *qsp_entry_get(const void *obj, const char *file, int line,
  * @e is in the global hash table; it is only written to by the current thread,
  * so we write to it atomically (as in "write once") to prevent torn reads.
  */
-static inline void do_qsp_entry_record(QSPEntry *e, int64_t delta, bool acq)
+static inline void
+do_qsp_entry_record(QSPEntry *e, int64_t delta, unsigned int n_acqs)
 {
     atomic_set_u64(&e->ns, e->ns + delta);
-    if (acq) {
-        atomic_set_u64(&e->n_acqs, e->n_acqs + 1);
+    if (n_acqs) {
+        atomic_set_u64(&e->n_acqs, e->n_acqs + n_acqs);
     }
 }
 
-static inline void qsp_entry_record(QSPEntry *e, int64_t delta)
+/*
+ * Decide whether to profile this acquisition. Returns the sampling period
+ * in use (to scale the sampled measurement with), or 0 to skip it.
+ * Skipped acquisitions only pay for this check: a load of the period and
+ * a thread-local counter increment.
+ */
+static inline unsigned int qsp_sample(void)
 {
-    do_qsp_entry_record(e, delta, true);
+    unsigned int period = atomic_read(&qsp_sample_period);
+
+    if (likely(period == 1)) {
+        return 1;
+    }
+    if (++qsp_sample_skipped < period) {
+        return 0;
+    }
+    qsp_sample_skipped = 0;
+    return period;
 }
 
 #define QSP_GEN_VOID(type_, qsp_t_, func_, impl_)                       \
     static void func_(type_ *obj, const char *file, int line)           \
     {                                                                   \
+        unsigned int period = qsp_sample();                             \
         QSPEntry *e;                                                    \
         int64_t t0, t1;                                                 \
                                                                         \
+        if (!period) {                                                  \
+            impl_(obj, file, line);                                     \
+            return;                                                     \
+        }                                                               \
+                                                                        \
         t0 = get_clock();                                               \
         impl_(obj, file, line);                                         \
         t1 = get_clock();                                               \
                                                                         \
         e = qsp_entry_get(obj, file, line, qsp_t_);                     \
-        qsp_entry_record(e, t1 - t0);                                   \
+        do_qsp_entry_record(e, (t1 - t0) * period, period);             \
     }
 
 #define QSP_GEN_RET1(type_, qsp_t_, func_, impl_)                       \
     static int func_(type_ *obj, const char *file, int line)            \
     {                                                                   \
+        unsigned int period = qsp_sample();                             \
         QSPEntry *e;                                                    \
         int64_t t0, t1;                                                 \
         int err;                                                        \
                                                                         \
+        if (!period) {                                                  \
+            return impl_(obj, file, line);                              \
+        }                                                               \
+                                                                        \
         t0 = get_clock();                                               \
         err = impl_(obj, file, line);                                   \
         t1 = get_clock();                                               \
                                                                         \
         e = qsp_entry_get(obj, file, line, qsp_t_);                     \
-        do_qsp_entry_record(e, t1 - t0, !err);                          \
+        do_qsp_entry_record(e, (t1 - t0) * period, err ? 0 : period);   \
         return err;                                                     \
     }
 
@@ -402,31 +440,42 @@ QSP_GEN_RET1(QemuRecMutex, QSP_REC_MUTEX, qsp_rec_mutex_trylock,
 static void
 qsp_cond_wait(QemuCond *cond, QemuMutex *mutex, const char *file, int line)
 {
+    unsigned int period = qsp_sample();
     QSPEntry *e;
     int64_t t0, t1;
 
+    if (!period) {
+        qemu_cond_wait_impl(cond, mutex, file, line);
+        return;
+    }
+
     t0 = get_clock();
     qemu_cond_wait_impl(cond, mutex, file, line);
     t1 = get_clock();
 
     e = qsp_entry_get(cond, file, line, QSP_CONDVAR);
-    qsp_entry_record(e, t1 - t0);
+    do_qsp_entry_record(e, (t1 - t0) * period, period);
 }
 
 static bool
 qsp_cond_timedwait(QemuCond *cond, QemuMutex *mutex, int ms,
                    const char *file, int line)
 {
+    unsigned int period = qsp_sample();
     QSPEntry *e;
     int64_t t0, t1;
     bool ret;
 
+    if (!period) {
+        return qemu_cond_timedwait_impl(cond, mutex, ms, file, line);
+    }
+
     t0 = get_clock();
     ret = qemu_cond_timedwait_impl(cond, mutex, ms, file, line);
     t1 = get_clock();
 
     e = qsp_entry_get(cond, file, line, QSP_CONDVAR);
-    qsp_entry_record(e, t1 - t0);
+    do_qsp_entry_record(e, (t1 - t0) * period, period);
     return ret;
 }
 
@@ -435,6 +484,17 @@ bool qsp_is_enabled(void)
     return atomic_read(&qemu_mutex_lock_func) == qsp_mutex_lock;
 }
 
+unsigned int qsp_get_sample_period(void)
+{
+    return atomic_read(&qsp_sample_period);
+}
+
+void qsp_set_sample_period(unsigned int period)
+{
+    g_assert(period > 0);
+    atomic_set(&qsp_sample_period, period);
+}
+
 void qsp_enable(void)
 {
     atomic_set(&qemu_mutex_lock_func, qsp_mutex_lock);
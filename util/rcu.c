@@ -74,6 +74,8 @@ static void wait_for_readers(void)
 {
     ThreadList qsreaders = QLIST_HEAD_INITIALIZER(qsreaders);
     struct rcu_reader_data *index, *tmp;
+    int sleeps = 0;
+    bool forced = false;
 
     for (;;) {
         /* We want to be notified of changes made to rcu_gp_ongoing
@@ -106,6 +108,13 @@ static void wait_for_readers(void)
                  * get some extra futex wakeups.
                  */
                 atomic_set(&index->waiting, false);
+            } else if (forced) {
+                /* The thread may be stuck in a read-side critical section
+                 * that never reaches a quiescent state on its own, for
+                 * example a TCG vCPU executing a tight loop of translated
+                 * code.  Ask it to get out.
+                 */
+                notifier_list_notify(&index->force_rcu, NULL);
             }
         }
 
@@ -131,7 +140,18 @@ static void wait_for_readers(void)
          * rcu_registry_lock is released.
          */
         qemu_mutex_unlock(&rcu_registry_lock);
-        qemu_event_wait(&rcu_gp_event);
+        if (forced) {
+            qemu_event_wait(&rcu_gp_event);
+        } else {
+            /* Sleep for a while before escalating to force_rcu: readers
+             * normally reach a quiescent state quickly, and interrupting
+             * a vCPU is not free.
+             */
+            g_usleep(10000);
+            if (++sleeps >= 5) {
+                forced = true;
+            }
+        }
         qemu_mutex_lock(&rcu_registry_lock);
     }
 
@@ -177,6 +197,13 @@ void synchronize_rcu(void)
 
 #define RCU_CALL_MIN_SIZE        30
 
+/* Number of callbacks to run before dropping and re-acquiring the
+ * iothread lock.  Reclamation storms (e.g. a FlatView being unreffed
+ * by every AddressSpace) can queue thousands of callbacks at once;
+ * without this, vCPUs and the monitor starve until the storm is over.
+ */
+#define RCU_CALL_CHUNK_SIZE      64
+
 /* Multi-producer, single-consumer queue based on urcu/static/wfqueue.h
  * from liburcu.  Note that head is only used by the consumer.
  */
@@ -267,20 +294,31 @@ static void *call_rcu_thread(void *opaque)
         synchronize_rcu();
         qemu_mutex_lock_iothread();
         while (n > 0) {
-            node = try_dequeue();
-            while (!node) {
-                qemu_mutex_unlock_iothread();
-                qemu_event_reset(&rcu_call_ready_event);
+            int chunk = MIN(n, RCU_CALL_CHUNK_SIZE);
+
+            while (chunk > 0) {
                 node = try_dequeue();
-                if (!node) {
-                    qemu_event_wait(&rcu_call_ready_event);
+                while (!node) {
+                    qemu_mutex_unlock_iothread();
+                    qemu_event_reset(&rcu_call_ready_event);
                     node = try_dequeue();
+                    if (!node) {
+                        qemu_event_wait(&rcu_call_ready_event);
+                        node = try_dequeue();
+                    }
+                    qemu_mutex_lock_iothread();
                 }
-                qemu_mutex_lock_iothread();
+
+                n--;
+                chunk--;
+                node->func(node);
             }
 
-            n--;
-            node->func(node);
+            /* Let other threads in between chunks.  */
+            if (n > 0) {
+                qemu_mutex_unlock_iothread();
+                qemu_mutex_lock_iothread();
+            }
         }
         qemu_mutex_unlock_iothread();
     }
@@ -310,6 +348,20 @@ void rcu_unregister_thread(void)
     qemu_mutex_unlock(&rcu_registry_lock);
 }
 
+void rcu_add_force_rcu_notifier(Notifier *n)
+{
+    qemu_mutex_lock(&rcu_registry_lock);
+    notifier_list_add(&rcu_reader.force_rcu, n);
+    qemu_mutex_unlock(&rcu_registry_lock);
+}
+
+void rcu_remove_force_rcu_notifier(Notifier *n)
+{
+    qemu_mutex_lock(&rcu_registry_lock);
+    notifier_remove(n);
+    qemu_mutex_unlock(&rcu_registry_lock);
+}
+
 static void rcu_init_complete(void)
 {
     QemuThread thread;
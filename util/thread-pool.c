@@ -26,6 +26,12 @@ static void do_spawn_thread(ThreadPool *pool);
 
 typedef struct ThreadPoolElement ThreadPoolElement;
 
+/* Number of affinity queues per pool.  Workers are assigned to the
+ * queues round-robin, so with more than this many workers some share a
+ * queue; that only dilutes the locality hint.
+ */
+#define THREAD_POOL_NSLOTS 16
+
 enum ThreadState {
     THREAD_QUEUED,
     THREAD_ACTIVE,
@@ -35,6 +41,19 @@ enum ThreadState {
 struct ThreadPoolElement {
     BlockAIOCB common;
     ThreadPool *pool;
+    /* The pool whose request_list holds this element while queued.
+     * Differs from pool when the request was donated to an idle
+     * sibling pool.  It only changes if the sibling shuts down and
+     * returns the element to its home pool, which happens with
+     * thread_pool_list_lock and both pools' locks held (see
+     * thread_pool_free); anyone other than the submitter must resolve
+     * it under thread_pool_list_lock (see thread_pool_cancel).
+     */
+    ThreadPool *queue_pool;
+    /* Affinity queue index within queue_pool, or -1 for the shared
+     * request list.  Protected like queue_pool.
+     */
+    int slot;
     ThreadPoolFunc *func;
     void *arg;
 
@@ -52,6 +71,8 @@ struct ThreadPoolElement {
     QLIST_ENTRY(ThreadPoolElement) all;
 };
 
+typedef QTAILQ_HEAD(, ThreadPoolElement) ThreadPoolRequestList;
+
 struct ThreadPool {
     AioContext *ctx;
     QEMUBH *completion_bh;
@@ -65,52 +86,116 @@ struct ThreadPool {
     QLIST_HEAD(, ThreadPoolElement) head;
 
     /* The following variables are protected by lock.  */
-    QTAILQ_HEAD(, ThreadPoolElement) request_list;
+    ThreadPoolRequestList request_list;
+    ThreadPoolRequestList affinity_queues[THREAD_POOL_NSLOTS];
+    unsigned next_worker_slot;
     int cur_threads;
     int idle_threads;
     int new_threads;     /* backlog of threads we need to create */
     int pending_threads; /* threads created but not running yet */
     bool stopping;
+
+    /* Access to this list is protected by thread_pool_list_lock.  */
+    QLIST_ENTRY(ThreadPool) all_pools_next;
 };
 
+/* All pools in the process, so that a saturated pool can hand requests
+ * to an idle sibling instead of spawning yet another worker thread.
+ * Lock ordering: thread_pool_list_lock before any ThreadPool.lock.
+ */
+static QemuMutex thread_pool_list_lock;
+static QLIST_HEAD(, ThreadPool) thread_pool_list =
+    QLIST_HEAD_INITIALIZER(thread_pool_list);
+
+static void __attribute__((constructor)) thread_pool_global_init(void)
+{
+    qemu_mutex_init(&thread_pool_list_lock);
+}
+
+/* Called with pool->lock held */
+static ThreadPoolRequestList *thread_pool_queue(ThreadPool *pool, int slot)
+{
+    return slot < 0 ? &pool->request_list : &pool->affinity_queues[slot];
+}
+
+/* Called with pool->lock held */
+static bool thread_pool_has_requests(ThreadPool *pool)
+{
+    int i;
+
+    if (!QTAILQ_EMPTY(&pool->request_list)) {
+        return true;
+    }
+    for (i = 0; i < THREAD_POOL_NSLOTS; i++) {
+        if (!QTAILQ_EMPTY(&pool->affinity_queues[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static void *worker_thread(void *opaque)
 {
     ThreadPool *pool = opaque;
+    unsigned slot;
 
     qemu_mutex_lock(&pool->lock);
     pool->pending_threads--;
+    slot = pool->next_worker_slot++ % THREAD_POOL_NSLOTS;
     do_spawn_thread(pool);
 
     while (!pool->stopping) {
         ThreadPoolElement *req;
+        ThreadPool *home;
+        unsigned i;
         int ret;
 
         do {
+            int ms;
+
             pool->idle_threads++;
+            /* Reap surplus workers quickly once more than half of them
+             * sit idle, but keep a warm reserve around for bursts.
+             */
+            ms = pool->idle_threads > pool->cur_threads / 2 ? 1000 : 10000;
             qemu_mutex_unlock(&pool->lock);
-            ret = qemu_sem_timedwait(&pool->sem, 10000);
+            ret = qemu_sem_timedwait(&pool->sem, ms);
             qemu_mutex_lock(&pool->lock);
             pool->idle_threads--;
-        } while (ret == -1 && !QTAILQ_EMPTY(&pool->request_list));
+        } while (ret == -1 && thread_pool_has_requests(pool));
         if (ret == -1 || pool->stopping) {
             break;
         }
 
-        req = QTAILQ_FIRST(&pool->request_list);
-        QTAILQ_REMOVE(&pool->request_list, req, reqs);
+        /* Serve our own affinity queue first, then the shared list,
+         * then steal from the other affinity queues.
+         */
+        req = QTAILQ_FIRST(&pool->affinity_queues[slot]);
+        if (!req) {
+            req = QTAILQ_FIRST(&pool->request_list);
+        }
+        for (i = 1; !req && i < THREAD_POOL_NSLOTS; i++) {
+            req = QTAILQ_FIRST(
+                &pool->affinity_queues[(slot + i) % THREAD_POOL_NSLOTS]);
+        }
+        QTAILQ_REMOVE(thread_pool_queue(pool, req->slot), req, reqs);
         req->state = THREAD_ACTIVE;
         qemu_mutex_unlock(&pool->lock);
 
         ret = req->func(req->arg);
 
         req->ret = ret;
+        /* Completion runs in the home pool's context; it may free req
+         * as soon as it observes THREAD_DONE, so read req->pool first.
+         */
+        home = req->pool;
         /* Write ret before state.  */
         smp_wmb();
         req->state = THREAD_DONE;
 
         qemu_mutex_lock(&pool->lock);
 
-        qemu_bh_schedule(pool->completion_bh);
+        qemu_bh_schedule(home->completion_bh);
     }
 
     pool->cur_threads--;
@@ -206,26 +291,36 @@ restart:
 static void thread_pool_cancel(BlockAIOCB *acb)
 {
     ThreadPoolElement *elem = (ThreadPoolElement *)acb;
-    ThreadPool *pool = elem->pool;
+    ThreadPool *qpool;
 
     trace_thread_pool_cancel(elem, elem->common.opaque);
 
-    qemu_mutex_lock(&pool->lock);
+    /* Resolve queue_pool under thread_pool_list_lock: a pool is torn
+     * down and donated elements are returned home entirely inside that
+     * lock (see thread_pool_free), so the pool we read here is alive at
+     * least until we release the list lock, by which point we hold its
+     * lock; and queue_pool cannot be repointed while we do.
+     */
+    qemu_mutex_lock(&thread_pool_list_lock);
+    qpool = elem->queue_pool;
+    qemu_mutex_lock(&qpool->lock);
+    qemu_mutex_unlock(&thread_pool_list_lock);
+
     if (elem->state == THREAD_QUEUED &&
         /* No thread has yet started working on elem. we can try to "steal"
          * the item from the worker if we can get a signal from the
          * semaphore.  Because this is non-blocking, we can do it with
          * the lock taken and ensure that elem will remain THREAD_QUEUED.
          */
-        qemu_sem_timedwait(&pool->sem, 0) == 0) {
-        QTAILQ_REMOVE(&pool->request_list, elem, reqs);
-        qemu_bh_schedule(pool->completion_bh);
+        qemu_sem_timedwait(&qpool->sem, 0) == 0) {
+        QTAILQ_REMOVE(thread_pool_queue(qpool, elem->slot), elem, reqs);
+        qemu_bh_schedule(elem->pool->completion_bh);
 
         elem->state = THREAD_DONE;
         elem->ret = -ECANCELED;
     }
 
-    qemu_mutex_unlock(&pool->lock);
+    qemu_mutex_unlock(&qpool->lock);
 }
 
 static AioContext *thread_pool_get_aio_context(BlockAIOCB *acb)
@@ -241,11 +336,35 @@ static const AIOCBInfo thread_pool_aiocb_info = {
     .get_aio_context    = thread_pool_get_aio_context,
 };
 
-BlockAIOCB *thread_pool_submit_aio(ThreadPool *pool,
-        ThreadPoolFunc *func, void *arg,
+/* Find a sibling pool with an idle worker.  Returns with the sibling's
+ * lock held, or NULL if every pool is busy.
+ */
+static ThreadPool *thread_pool_find_idle(ThreadPool *pool)
+{
+    ThreadPool *p;
+
+    qemu_mutex_lock(&thread_pool_list_lock);
+    QLIST_FOREACH(p, &thread_pool_list, all_pools_next) {
+        if (p == pool) {
+            continue;
+        }
+        qemu_mutex_lock(&p->lock);
+        if (p->idle_threads > 0 && !p->stopping) {
+            qemu_mutex_unlock(&thread_pool_list_lock);
+            return p;
+        }
+        qemu_mutex_unlock(&p->lock);
+    }
+    qemu_mutex_unlock(&thread_pool_list_lock);
+    return NULL;
+}
+
+static BlockAIOCB *thread_pool_submit_aio_slot(ThreadPool *pool,
+        ThreadPoolFunc *func, void *arg, int slot,
         BlockCompletionFunc *cb, void *opaque)
 {
     ThreadPoolElement *req;
+    bool busy;
 
     req = qemu_aio_get(&thread_pool_aiocb_info, NULL, cb, opaque);
     req->func = func;
@@ -258,15 +377,57 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPool *pool,
     trace_thread_pool_submit(pool, req, arg);
 
     qemu_mutex_lock(&pool->lock);
+    busy = pool->idle_threads == 0;
+    if (busy && slot < 0) {
+        ThreadPool *donate;
+
+        /* All our workers are occupied.  Hand the request to an idle
+         * sibling pool, if any, rather than spawning another thread.
+         * The work function runs in an arbitrary worker anyway, and
+         * completion still happens in our own context via the home
+         * pool's completion_bh.  Requests with an affinity are not
+         * donated; locality is their whole point.
+         */
+        qemu_mutex_unlock(&pool->lock);
+        donate = thread_pool_find_idle(pool);
+        if (donate) {
+            req->queue_pool = donate;
+            req->slot = -1;
+            QTAILQ_INSERT_TAIL(&donate->request_list, req, reqs);
+            qemu_mutex_unlock(&donate->lock);
+            trace_thread_pool_donate(pool, donate, req);
+            qemu_sem_post(&donate->sem);
+            return &req->common;
+        }
+        qemu_mutex_lock(&pool->lock);
+    }
     if (pool->idle_threads == 0 && pool->cur_threads < pool->max_threads) {
         spawn_thread(pool);
     }
-    QTAILQ_INSERT_TAIL(&pool->request_list, req, reqs);
+    req->queue_pool = pool;
+    req->slot = slot;
+    QTAILQ_INSERT_TAIL(thread_pool_queue(pool, slot), req, reqs);
     qemu_mutex_unlock(&pool->lock);
     qemu_sem_post(&pool->sem);
     return &req->common;
 }
 
+BlockAIOCB *thread_pool_submit_aio(ThreadPool *pool,
+        ThreadPoolFunc *func, void *arg,
+        BlockCompletionFunc *cb, void *opaque)
+{
+    return thread_pool_submit_aio_slot(pool, func, arg, -1, cb, opaque);
+}
+
+BlockAIOCB *thread_pool_submit_aio_affine(ThreadPool *pool,
+        ThreadPoolFunc *func, void *arg, unsigned long affinity,
+        BlockCompletionFunc *cb, void *opaque)
+{
+    return thread_pool_submit_aio_slot(pool, func, arg,
+                                       affinity % THREAD_POOL_NSLOTS,
+                                       cb, opaque);
+}
+
 typedef struct ThreadPoolCo {
     Coroutine *co;
     int ret;
@@ -290,6 +451,18 @@ int coroutine_fn thread_pool_submit_co(ThreadPool *pool, ThreadPoolFunc *func,
     return tpc.ret;
 }
 
+int coroutine_fn thread_pool_submit_co_affine(ThreadPool *pool,
+                                              ThreadPoolFunc *func, void *arg,
+                                              unsigned long affinity)
+{
+    ThreadPoolCo tpc = { .co = qemu_coroutine_self(), .ret = -EINPROGRESS };
+    assert(qemu_in_coroutine());
+    thread_pool_submit_aio_affine(pool, func, arg, affinity,
+                                  thread_pool_co_cb, &tpc);
+    qemu_coroutine_yield();
+    return tpc.ret;
+}
+
 void thread_pool_submit(ThreadPool *pool, ThreadPoolFunc *func, void *arg)
 {
     thread_pool_submit_aio(pool, func, arg, NULL, NULL);
@@ -297,6 +470,8 @@ void thread_pool_submit(ThreadPool *pool, ThreadPoolFunc *func, void *arg)
 
 static void thread_pool_init_one(ThreadPool *pool, AioContext *ctx)
 {
+    int i;
+
     if (!ctx) {
         ctx = qemu_get_aio_context();
     }
@@ -312,6 +487,13 @@ static void thread_pool_init_one(ThreadPool *pool, AioContext *ctx)
 
     QLIST_INIT(&pool->head);
     QTAILQ_INIT(&pool->request_list);
+    for (i = 0; i < THREAD_POOL_NSLOTS; i++) {
+        QTAILQ_INIT(&pool->affinity_queues[i]);
+    }
+
+    qemu_mutex_lock(&thread_pool_list_lock);
+    QLIST_INSERT_HEAD(&thread_pool_list, pool, all_pools_next);
+    qemu_mutex_unlock(&thread_pool_list_lock);
 }
 
 ThreadPool *thread_pool_new(AioContext *ctx)
@@ -323,12 +505,25 @@ ThreadPool *thread_pool_new(AioContext *ctx)
 
 void thread_pool_free(ThreadPool *pool)
 {
+    ThreadPoolElement *req;
+
     if (!pool) {
         return;
     }
 
     assert(QLIST_EMPTY(&pool->head));
 
+    /* Unregister so that siblings stop donating requests to us, and keep
+     * holding the list lock for the whole teardown: cancellers resolve
+     * elem->queue_pool under it, so no new reference to this pool can be
+     * taken once we own it, and the requeue loop below runs before any
+     * such canceller gets to look again.  A donor that already picked us
+     * keeps holding our lock until its request is queued, so taking the
+     * lock below synchronizes with it.
+     */
+    qemu_mutex_lock(&thread_pool_list_lock);
+    QLIST_REMOVE(pool, all_pools_next);
+
     qemu_mutex_lock(&pool->lock);
 
     /* Stop new threads from spawning */
@@ -343,7 +538,26 @@ void thread_pool_free(ThreadPool *pool)
         qemu_cond_wait(&pool->worker_stopped, &pool->lock);
     }
 
+    /* Return requests that were donated to us to their home pools.  Our
+     * own requests have all completed (pool->head is empty), so whatever
+     * is left on the request list belongs to a sibling.  This is the only
+     * place that takes two ThreadPool locks at once; it cannot deadlock
+     * because no worker of ours is running anymore.
+     */
+    while ((req = QTAILQ_FIRST(&pool->request_list)) != NULL) {
+        ThreadPool *home = req->pool;
+
+        assert(home != pool);
+        QTAILQ_REMOVE(&pool->request_list, req, reqs);
+        qemu_mutex_lock(&home->lock);
+        req->queue_pool = home;
+        QTAILQ_INSERT_TAIL(&home->request_list, req, reqs);
+        qemu_mutex_unlock(&home->lock);
+        qemu_sem_post(&home->sem);
+    }
+
     qemu_mutex_unlock(&pool->lock);
+    qemu_mutex_unlock(&thread_pool_list_lock);
 
     qemu_bh_delete(pool->completion_bh);
     qemu_sem_destroy(&pool->sem);
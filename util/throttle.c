@@ -485,6 +485,100 @@ void throttle_account(ThrottleState *ts, bool is_write, uint64_t size)
     }
 }
 
+/* Compute how many units a bucket can still absorb before the next
+ * request would have to wait
+ *
+ * @bkt: the leaky bucket we operate on
+ * @ret: the number of units that fit without triggering a wait
+ */
+static uint64_t throttle_compute_headroom(LeakyBucket *bkt)
+{
+    double bucket_size;
+    double room;
+
+    /* Same thresholds as in throttle_compute_wait() */
+    if (!bkt->max) {
+        bucket_size = (double) bkt->avg / 10;
+    } else {
+        bucket_size = bkt->max * bkt->burst_length;
+    }
+
+    room = bucket_size - bkt->level;
+    if (bkt->burst_length > 1) {
+        double burst_room = (double) bkt->max / 10 - bkt->burst_level;
+        room = MIN(room, burst_room);
+    }
+
+    return room > 0 ? (uint64_t) room : 0;
+}
+
+/* Withdraw a batch of budget from a pair of buckets
+ *
+ * @bkts: the buckets to withdraw from
+ * @ret:  the granted amount, UINT64_MAX if neither bucket is limited
+ */
+static uint64_t throttle_lease_from(LeakyBucket *bkts[2])
+{
+    uint64_t grant = UINT64_MAX;
+    unsigned i;
+
+    for (i = 0; i < 2; i++) {
+        LeakyBucket *bkt = bkts[i];
+
+        if (!bkt->avg) {
+            continue;
+        }
+        grant = MIN(grant, MIN(bkt->avg / 10,
+                               throttle_compute_headroom(bkt)));
+    }
+
+    if (grant == UINT64_MAX) {
+        return grant;
+    }
+
+    for (i = 0; i < 2; i++) {
+        LeakyBucket *bkt = bkts[i];
+
+        if (!bkt->avg) {
+            continue;
+        }
+        bkt->level += grant;
+        if (bkt->burst_length > 1) {
+            bkt->burst_level += grant;
+        }
+    }
+
+    return grant;
+}
+
+/* Withdraw a batch of budget from the buckets of one I/O direction
+ *
+ * The batch is accounted as if the I/O had already been performed, so the
+ * caller may later admit that much I/O without touching the ThrottleState
+ * again. The batch is limited to a tenth of a second worth of I/O and to
+ * what the buckets can absorb without making the next request wait, so
+ * handing it out in advance never violates the configured limits.
+ *
+ * @is_write: the type of operation (read/write)
+ * @bytes:    output, granted bytes, UINT64_MAX if bytes are not limited
+ * @ops:      output, granted operations, UINT64_MAX if ops are not limited
+ */
+void throttle_account_lease(ThrottleState *ts, bool is_write,
+                            uint64_t *bytes, uint64_t *ops)
+{
+    LeakyBucket *size_bkts[2] = {
+        &ts->cfg.buckets[THROTTLE_BPS_TOTAL],
+        &ts->cfg.buckets[is_write ? THROTTLE_BPS_WRITE : THROTTLE_BPS_READ],
+    };
+    LeakyBucket *unit_bkts[2] = {
+        &ts->cfg.buckets[THROTTLE_OPS_TOTAL],
+        &ts->cfg.buckets[is_write ? THROTTLE_OPS_WRITE : THROTTLE_OPS_READ],
+    };
+
+    *bytes = throttle_lease_from(size_bkts);
+    *ops = throttle_lease_from(unit_bkts);
+}
+
 /* return a ThrottleConfig based on the options in a ThrottleLimits
  *
  * @arg:    the ThrottleLimits object to read from